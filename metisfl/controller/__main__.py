@@ -13,7 +13,17 @@ def init_controller(controller_server_entity_protobuff_serialized_hexadecimal,
                     global_model_specs_protobuff_serialized_hexadecimal=None,
                     communication_specs_protobuff_serialized_hexadecimal=None,
                     model_hyperparameters_protobuff_serialized_hexadecimal=None,
-                    model_store_config_protobuff_serialized_hexadecimal=None):
+                    model_store_config_protobuff_serialized_hexadecimal=None,
+                    checkpoint_dir=None,
+                    checkpoint_interval=None,
+                    num_control_workers=None,
+                    num_model_workers=None,
+                    max_retained_rounds=None,
+                    max_retained_local_tasks=None,
+                    lineage_spill_dir=None,
+                    heartbeat_interval_secs=None,
+                    suspect_after_missed_beats=None,
+                    dead_after_missed_beats=None):
 
     # For all incoming hexadecimal representations, we need to first convert them
     # to bytes and later pass them as initialization to the proto message object.
@@ -76,12 +86,36 @@ def init_controller(controller_server_entity_protobuff_serialized_hexadecimal,
             name="InMemory",
             eviction_policy="NoEviction")
 
+    # Checkpointing is disabled, if no checkpoint directory is given.
+    checkpoint_specs_pb = MetisProtoMessages.construct_checkpoint_specs_pb(
+        checkpoint_dir=checkpoint_dir,
+        checkpoint_interval=checkpoint_interval)
+
+    servicer_specs_pb = MetisProtoMessages.construct_servicer_specs_pb(
+        num_control_workers=num_control_workers,
+        num_model_workers=num_model_workers)
+
+    lineage_specs_pb = MetisProtoMessages.construct_lineage_specs_pb(
+        max_retained_rounds=max_retained_rounds,
+        max_retained_local_tasks=max_retained_local_tasks,
+        spill_dir=lineage_spill_dir)
+
+    # The learners' liveness is not tracked, if no heartbeat interval is given.
+    liveness_specs_pb = MetisProtoMessages.construct_liveness_specs_pb(
+        heartbeat_interval_secs=heartbeat_interval_secs,
+        suspect_after_missed_beats=suspect_after_missed_beats,
+        dead_after_missed_beats=dead_after_missed_beats)
+
     controller_params_pb = MetisProtoMessages.construct_controller_params_pb(
         controller_server_entity_pb,
         global_model_specs_pb,
         communication_specs_pb,
         model_store_config_pb,
-        model_hyperparams_pb)
+        model_hyperparams_pb,
+        checkpoint_specs_pb,
+        servicer_specs_pb,
+        lineage_specs_pb,
+        liveness_specs_pb)
 
     MetisLogger.info("Controller Parameters: \"\"\"{}\"\"\"".format(controller_params_pb))
 
@@ -111,6 +145,37 @@ if __name__ == "__main__":
     parser.add_argument("-s", "--model_store_config_protobuff_serialized_hexadecimal", type=str,
                         default=None,
                         help="A serialized Model Store Config protobuf message.")
+    parser.add_argument("--checkpoint_dir", type=str,
+                        default=None,
+                        help="Directory to periodically snapshot the controller state to and "
+                             "to restore the controller state from when (re)started.")
+    parser.add_argument("--checkpoint_interval", type=int,
+                        default=None,
+                        help="Number of global iterations between two consecutive snapshots.")
+    parser.add_argument("--num_control_workers", type=int,
+                        default=None,
+                        help="Number of threads serving the control requests, e.g., join federation.")
+    parser.add_argument("--num_model_workers", type=int,
+                        default=None,
+                        help="Number of threads serving the requests carrying models, e.g., completed tasks.")
+    parser.add_argument("--max_retained_rounds", type=int,
+                        default=None,
+                        help="Number of most recent federation rounds whose metadata are kept in memory.")
+    parser.add_argument("--max_retained_local_tasks", type=int,
+                        default=None,
+                        help="Number of most recent tasks whose metadata are kept in memory for every learner.")
+    parser.add_argument("--lineage_spill_dir", type=str,
+                        default=None,
+                        help="Directory to which the metadata of the older federation rounds are appended.")
+    parser.add_argument("--heartbeat_interval_secs", type=int,
+                        default=None,
+                        help="How often the learners send a heartbeat. If not set, liveness is not tracked.")
+    parser.add_argument("--suspect_after_missed_beats", type=int,
+                        default=None,
+                        help="Number of missed heartbeats after which a learner is no longer awaited.")
+    parser.add_argument("--dead_after_missed_beats", type=int,
+                        default=None,
+                        help="Number of missed heartbeats after which a learner is evicted.")
 
     args = parser.parse_args()
     init_controller(
@@ -118,4 +183,14 @@ if __name__ == "__main__":
         global_model_specs_protobuff_serialized_hexadecimal=args.global_model_specs_protobuff_serialized_hexadecimal,
         communication_specs_protobuff_serialized_hexadecimal=args.communication_specs_protobuff_serialized_hexadecimal,
         model_hyperparameters_protobuff_serialized_hexadecimal=args.model_hyperparameters_protobuff_serialized_hexadecimal,
-        model_store_config_protobuff_serialized_hexadecimal=args.model_store_config_protobuff_serialized_hexadecimal)
+        model_store_config_protobuff_serialized_hexadecimal=args.model_store_config_protobuff_serialized_hexadecimal,
+        checkpoint_dir=args.checkpoint_dir,
+        checkpoint_interval=args.checkpoint_interval,
+        num_control_workers=args.num_control_workers,
+        num_model_workers=args.num_model_workers,
+        max_retained_rounds=args.max_retained_rounds,
+        max_retained_local_tasks=args.max_retained_local_tasks,
+        lineage_spill_dir=args.lineage_spill_dir,
+        heartbeat_interval_secs=args.heartbeat_interval_secs,
+        suspect_after_missed_beats=args.suspect_after_missed_beats,
+        dead_after_missed_beats=args.dead_after_missed_beats)
@@ -2,6 +2,10 @@
 #ifndef METISFL_METISFL_CONTROLLER_AGGREGATION_AGGREGATION_FUNCTION_H_
 #define METISFL_METISFL_CONTROLLER_AGGREGATION_AGGREGATION_FUNCTION_H_
 
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 #include <utility>
 
@@ -9,6 +13,25 @@
 
 namespace metisfl::controller {
 
+// Returns the (serialized) values of a tensor of a model to aggregate.
+using TensorValueResolver =
+    std::function<std::shared_ptr<const std::string>(const TensorSpec &)>;
+
+// Returns the values of the tensor through the resolver, or the values that
+// the tensor spec carries if no resolver is set.
+inline std::shared_ptr<const std::string>
+ResolveTensorValue(const TensorValueResolver &resolver, const TensorSpec &tensor_spec) {
+  if (!resolver) {
+    // The value is owned by the model, which outlives the aggregation.
+    return {std::shared_ptr<const std::string>(), &tensor_spec.value()};
+  }
+  auto value = resolver(tensor_spec);
+  if (!value) {
+    throw std::runtime_error("Cannot resolve the tensor value.");
+  }
+  return value;
+}
+
 // Given that we need to define an interface, we basically need to provide the
 // signature of pure virtual functions Recall that, a pure virtual function is
 // a function that has to be assigned the value of 0.
@@ -35,6 +58,17 @@ class AggregationFunction {
   [[nodiscard]] inline virtual std::string Name() const = 0;
 
   virtual void Reset() = 0;
+
+  // Sets how the tensor values of the models to aggregate are restored. The
+  // models selected from the model store carry the digests of their tensor
+  // values, which the store restores on demand, one variable at a time. By
+  // default, the models carry their tensor values.
+  void SetTensorValueResolver(TensorValueResolver resolver) {
+    tensor_value_resolver_ = std::move(resolver);
+  }
+
+ protected:
+  TensorValueResolver tensor_value_resolver_;
 };
 
 } // namespace metisfl::controller
@@ -14,6 +14,7 @@ using ::proto::SerializeTensor;
 template<typename T>
 void AddTensors(std::vector<T> &tensor_left,
                 const TensorSpec &tensor_spec_right,
+                const std::string &tensor_value_right,
                 double scaling_factor_right) {
 
   /**
@@ -22,7 +23,7 @@ void AddTensors(std::vector<T> &tensor_left,
    * scaled right-hand-side tensor to the left-hand-side tensor. Finally, it serialized
    * the aggregated tensor and returns its string representation.
    */
-  auto t2_r = DeserializeTensor<T>(tensor_spec_right);
+  auto t2_r = DeserializeTensor<T>(tensor_spec_right, tensor_value_right);
 
   // Scale the right tensor by its scaling factor.
   // Careful here: if the data type is uint or int then there are no precision
@@ -39,6 +40,7 @@ void AddTensors(std::vector<T> &tensor_left,
 template<typename T>
 std::vector<T> AggregateTensorAtIndex(
     std::vector<std::vector<std::pair<const Model *, double>>> &pairs,
+    const TensorValueResolver &tensor_value_resolver,
     int var_idx,
     uint32_t var_num_values) {
 
@@ -48,8 +50,11 @@ std::vector<T> AggregateTensorAtIndex(
     const double local_model_contrib_value = pair.front().second;
     const auto &local_variable = local_model->variables(var_idx);
     if (local_variable.has_plaintext_tensor()) {
+      // The value is restored for this variable only and released once added.
+      const auto &tensor_spec = local_variable.plaintext_tensor().tensor_spec();
       AddTensors(aggregated_tensor,
-                 local_variable.plaintext_tensor().tensor_spec(),
+                 tensor_spec,
+                 *ResolveTensorValue(tensor_value_resolver, tensor_spec),
                  local_model_contrib_value);
     } else {
       throw std::runtime_error("Unsupported variable type.");
@@ -105,34 +110,34 @@ FederatedAverage::Aggregate(
 
       std::vector<char> serialized_tensor;
       if (var_data_type == DType_Type_UINT8) {
-        auto aggregated_tensor = AggregateTensorAtIndex<unsigned char>(pairs, var_idx, var_num_values);
+        auto aggregated_tensor = AggregateTensorAtIndex<unsigned char>(pairs, tensor_value_resolver_, var_idx, var_num_values);
         serialized_tensor = SerializeTensor<unsigned char>(aggregated_tensor);
       } else if (var_data_type == DType_Type_UINT16) {
-        auto aggregated_tensor = AggregateTensorAtIndex<unsigned short>(pairs, var_idx, var_num_values);
+        auto aggregated_tensor = AggregateTensorAtIndex<unsigned short>(pairs, tensor_value_resolver_, var_idx, var_num_values);
         serialized_tensor = SerializeTensor<unsigned short>(aggregated_tensor);
       } else if (var_data_type == DType_Type_UINT32) {
-        auto aggregated_tensor = AggregateTensorAtIndex<unsigned int>(pairs, var_idx, var_num_values);
+        auto aggregated_tensor = AggregateTensorAtIndex<unsigned int>(pairs, tensor_value_resolver_, var_idx, var_num_values);
         serialized_tensor = SerializeTensor<unsigned int>(aggregated_tensor);
       } else if (var_data_type == DType_Type_UINT64) {
-        auto aggregated_tensor = AggregateTensorAtIndex<unsigned long>(pairs, var_idx, var_num_values);
+        auto aggregated_tensor = AggregateTensorAtIndex<unsigned long>(pairs, tensor_value_resolver_, var_idx, var_num_values);
         serialized_tensor = SerializeTensor<unsigned long>(aggregated_tensor);
       } else if (var_data_type == DType_Type_INT8) {
-        auto aggregated_tensor = AggregateTensorAtIndex<signed char>(pairs, var_idx, var_num_values);
+        auto aggregated_tensor = AggregateTensorAtIndex<signed char>(pairs, tensor_value_resolver_, var_idx, var_num_values);
         serialized_tensor = SerializeTensor<signed char>(aggregated_tensor);
       } else if (var_data_type == DType_Type_INT16) {
-        auto aggregated_tensor = AggregateTensorAtIndex<signed short>(pairs, var_idx, var_num_values);
+        auto aggregated_tensor = AggregateTensorAtIndex<signed short>(pairs, tensor_value_resolver_, var_idx, var_num_values);
         serialized_tensor = SerializeTensor<signed short>(aggregated_tensor);
       } else if (var_data_type == DType_Type_INT32) {
-        auto aggregated_tensor = AggregateTensorAtIndex<signed int>(pairs, var_idx, var_num_values);
+        auto aggregated_tensor = AggregateTensorAtIndex<signed int>(pairs, tensor_value_resolver_, var_idx, var_num_values);
         serialized_tensor = SerializeTensor<signed int>(aggregated_tensor);
       } else if (var_data_type == DType_Type_INT64) {
-        auto aggregated_tensor = AggregateTensorAtIndex<signed long>(pairs, var_idx, var_num_values);
+        auto aggregated_tensor = AggregateTensorAtIndex<signed long>(pairs, tensor_value_resolver_, var_idx, var_num_values);
         serialized_tensor = SerializeTensor<signed long>(aggregated_tensor);
       } else if (var_data_type == DType_Type_FLOAT32) {
-        auto aggregated_tensor = AggregateTensorAtIndex<float>(pairs, var_idx, var_num_values);
+        auto aggregated_tensor = AggregateTensorAtIndex<float>(pairs, tensor_value_resolver_, var_idx, var_num_values);
         serialized_tensor = SerializeTensor<float>(aggregated_tensor);
       } else if (var_data_type == DType_Type_FLOAT64) {
-        auto aggregated_tensor = AggregateTensorAtIndex<double>(pairs, var_idx, var_num_values);
+        auto aggregated_tensor = AggregateTensorAtIndex<double>(pairs, tensor_value_resolver_, var_idx, var_num_values);
         serialized_tensor = SerializeTensor<double>(aggregated_tensor);
       } else {
         throw std::runtime_error("Unsupported tensor data type.");
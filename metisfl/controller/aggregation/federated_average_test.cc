@@ -205,5 +205,36 @@ TEST_F(FederatedAverageTest, CorrectAverageFLOAT64) /* NOLINT */ {
 
 }
 
+TEST_F(FederatedAverageTest, CorrectAverageResolvedTensorValues) /* NOLINT */ {
+
+  auto model1 = ParseTextOrDie<Model>(kModel1_with_tensor_values_1to10_as_FLOAT32);
+
+  // The selected models only carry a reference to the tensor value, as the
+  // model store does, and the aggregator restores the value through the
+  // resolver.
+  auto value = std::make_shared<const std::string>(
+      model1.variables(0).plaintext_tensor().tensor_spec().value());
+  auto reference1 = model1;
+  auto reference2 = model1;
+  reference1.mutable_variables(0)->mutable_plaintext_tensor()->mutable_tensor_spec()->set_value("ref");
+  reference2.mutable_variables(0)->mutable_plaintext_tensor()->mutable_tensor_spec()->set_value("ref");
+
+  std::vector seq1({std::make_pair<const Model *, double>(&reference1, 0.5)});
+  std::vector seq2({std::make_pair<const Model *, double>(&reference2, 0.5)});
+  std::vector to_aggregate({seq1, seq2});
+
+  int num_resolved = 0;
+  FederatedAverage avg;
+  avg.SetTensorValueResolver([&](const TensorSpec &tensor_spec) {
+    ++num_resolved;
+    return tensor_spec.value() == "ref" ? value : nullptr;
+  });
+  FederatedModel averaged = avg.Aggregate(to_aggregate);
+
+  EXPECT_EQ(num_resolved, 2);
+  EXPECT_THAT(averaged.model(), EqualsProto(model1));
+
+}
+
 } // namespace
 } // namespace metisfl::controller
\ No newline at end of file
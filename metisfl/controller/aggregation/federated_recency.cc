@@ -31,7 +31,7 @@ FederatedModel FederatedRecency::Aggregate(std::vector<std::vector<std::pair<con
      * learner to submit a model.
      * */
     PLOG(INFO) << "Initializing Community Model.";
-    InitializeModel(new_model, new_contrib_value);
+    InitializeModel(new_model, new_contrib_value, tensor_value_resolver_);
 
   } else {
 
@@ -58,7 +58,8 @@ FederatedModel FederatedRecency::Aggregate(std::vector<std::vector<std::pair<con
       UpdateScaledModel(&dummy_old_model,
                         new_model,
                         dummy_existing_old_value,
-                        new_contrib_value);
+                        new_contrib_value,
+                        tensor_value_resolver_);
 
 
       // Update Community Model.
@@ -87,7 +88,8 @@ FederatedModel FederatedRecency::Aggregate(std::vector<std::vector<std::pair<con
       UpdateScaledModel(existing_model,
                         new_model,
                         existing_contrib_value,
-                        new_contrib_value);
+                        new_contrib_value,
+                        tensor_value_resolver_);
 
       // Update Community Model.
       UpdateCommunityModel();
@@ -18,6 +18,7 @@ enum TensorOperation {
 template<typename T>
 std::string MergeTensors(const TensorSpec &tensor_spec_left,
                        const TensorSpec &tensor_spec_right,
+                       const std::string &tensor_value_right,
                        double scaling_factor_right,
                        TensorOperation op) {
 
@@ -28,7 +29,7 @@ std::string MergeTensors(const TensorSpec &tensor_spec_left,
    * the aggregated tensor and returns its string representation.
    */
   auto t1_l = DeserializeTensor<T>(tensor_spec_left);
-  auto t2_r = DeserializeTensor<T>(tensor_spec_right);
+  auto t2_r = DeserializeTensor<T>(tensor_spec_right, tensor_value_right);
 
   // Scale the right tensor by its scaling factor.
   // Careful here: if the data type is uint or int then there are no precision
@@ -54,6 +55,7 @@ std::string MergeTensors(const TensorSpec &tensor_spec_left,
 
 std::string MergeTensors(const TensorSpec &tensor_spec_left,
                        const TensorSpec &tensor_spec_right,
+                       const std::string &tensor_value_right,
                        double scaling_factor_right,
                        TensorOperation op) {
 
@@ -72,25 +74,25 @@ std::string MergeTensors(const TensorSpec &tensor_spec_left,
 
   std::string aggregated_result;
   if (data_type_left == DType_Type_UINT8) {
-    aggregated_result = MergeTensors<unsigned char>(tensor_spec_left, tensor_spec_right, scaling_factor_right, op);
+    aggregated_result = MergeTensors<unsigned char>(tensor_spec_left, tensor_spec_right, tensor_value_right, scaling_factor_right, op);
   } else if (data_type_left == DType_Type_UINT16) {
-    aggregated_result = MergeTensors<unsigned short>(tensor_spec_left, tensor_spec_right, scaling_factor_right, op);
+    aggregated_result = MergeTensors<unsigned short>(tensor_spec_left, tensor_spec_right, tensor_value_right, scaling_factor_right, op);
   } else if (data_type_left == DType_Type_UINT32) {
-    aggregated_result = MergeTensors<unsigned int>(tensor_spec_left, tensor_spec_right, scaling_factor_right, op);
+    aggregated_result = MergeTensors<unsigned int>(tensor_spec_left, tensor_spec_right, tensor_value_right, scaling_factor_right, op);
   } else if (data_type_left == DType_Type_UINT64) {
-    aggregated_result = MergeTensors<unsigned long>(tensor_spec_left, tensor_spec_right, scaling_factor_right, op);
+    aggregated_result = MergeTensors<unsigned long>(tensor_spec_left, tensor_spec_right, tensor_value_right, scaling_factor_right, op);
   } else if (data_type_left == DType_Type_INT8) {
-    aggregated_result = MergeTensors<signed char>(tensor_spec_left, tensor_spec_right, scaling_factor_right, op);
+    aggregated_result = MergeTensors<signed char>(tensor_spec_left, tensor_spec_right, tensor_value_right, scaling_factor_right, op);
   } else if (data_type_left == DType_Type_INT16) {
-    aggregated_result = MergeTensors<signed short>(tensor_spec_left, tensor_spec_right, scaling_factor_right, op);
+    aggregated_result = MergeTensors<signed short>(tensor_spec_left, tensor_spec_right, tensor_value_right, scaling_factor_right, op);
   } else if (data_type_left == DType_Type_INT32) {
-    aggregated_result = MergeTensors<signed int>(tensor_spec_left, tensor_spec_right, scaling_factor_right, op);
+    aggregated_result = MergeTensors<signed int>(tensor_spec_left, tensor_spec_right, tensor_value_right, scaling_factor_right, op);
   } else if (data_type_left == DType_Type_INT64) {
-    aggregated_result = MergeTensors<signed long>(tensor_spec_left, tensor_spec_right, scaling_factor_right, op);
+    aggregated_result = MergeTensors<signed long>(tensor_spec_left, tensor_spec_right, tensor_value_right, scaling_factor_right, op);
   } else if (data_type_left == DType_Type_FLOAT32) {
-    aggregated_result = MergeTensors<float>(tensor_spec_left, tensor_spec_right, scaling_factor_right, op);
+    aggregated_result = MergeTensors<float>(tensor_spec_left, tensor_spec_right, tensor_value_right, scaling_factor_right, op);
   } else if (data_type_left == DType_Type_FLOAT64) {
-    aggregated_result = MergeTensors<double>(tensor_spec_left, tensor_spec_right, scaling_factor_right, op);
+    aggregated_result = MergeTensors<double>(tensor_spec_left, tensor_spec_right, tensor_value_right, scaling_factor_right, op);
   } else {
     throw std::runtime_error("Unsupported tensor data type.");
   }
@@ -100,14 +102,14 @@ std::string MergeTensors(const TensorSpec &tensor_spec_left,
 }
 
 template<typename T>
-std::string ScaleTensor(const TensorSpec &tensor_spec,
+std::string ScaleTensor(const TensorSpec &tensor_spec, const std::string &tensor_value,
                        double scaling_factor, TensorOperation op) {
 
   /**
    * The function first deserializes a tensors based on the provided data type. Then it
    * scales using its given scaling factor.
    */
-  auto ts = DeserializeTensor<T>(tensor_spec);
+  auto ts = DeserializeTensor<T>(tensor_spec, tensor_value);
   
   // Scale the tensor by its scaling factor.
   // Careful here: if the data type is uint or int then there are no precision
@@ -129,7 +131,7 @@ std::string ScaleTensor(const TensorSpec &tensor_spec,
 
 }
 
-std::string ScaleTensors(const TensorSpec &tensor_spec,
+std::string ScaleTensors(const TensorSpec &tensor_spec, const std::string &tensor_value,
                        double scaling_factor, TensorOperation op) {
 
   /**
@@ -143,25 +145,25 @@ std::string ScaleTensors(const TensorSpec &tensor_spec,
 
   std::string aggregated_result;
   if (data_type == DType_Type_UINT8) {
-    aggregated_result = ScaleTensor<unsigned char>(tensor_spec, scaling_factor, op);
+    aggregated_result = ScaleTensor<unsigned char>(tensor_spec, tensor_value, scaling_factor, op);
   } else if (data_type == DType_Type_UINT16) {
-    aggregated_result = ScaleTensor<unsigned short>(tensor_spec, scaling_factor, op);
+    aggregated_result = ScaleTensor<unsigned short>(tensor_spec, tensor_value, scaling_factor, op);
   } else if (data_type == DType_Type_UINT32) {
-    aggregated_result = ScaleTensor<unsigned int>(tensor_spec, scaling_factor, op);
+    aggregated_result = ScaleTensor<unsigned int>(tensor_spec, tensor_value, scaling_factor, op);
   } else if (data_type == DType_Type_UINT64) {
-    aggregated_result = ScaleTensor<unsigned long>(tensor_spec, scaling_factor, op);
+    aggregated_result = ScaleTensor<unsigned long>(tensor_spec, tensor_value, scaling_factor, op);
   } else if (data_type == DType_Type_INT8) {
-    aggregated_result = ScaleTensor<signed char>(tensor_spec, scaling_factor, op);
+    aggregated_result = ScaleTensor<signed char>(tensor_spec, tensor_value, scaling_factor, op);
   } else if (data_type == DType_Type_INT16) {
-    aggregated_result = ScaleTensor<signed short>(tensor_spec, scaling_factor, op);
+    aggregated_result = ScaleTensor<signed short>(tensor_spec, tensor_value, scaling_factor, op);
   } else if (data_type == DType_Type_INT32) {
-    aggregated_result = ScaleTensor<signed int>(tensor_spec, scaling_factor, op);
+    aggregated_result = ScaleTensor<signed int>(tensor_spec, tensor_value, scaling_factor, op);
   } else if (data_type == DType_Type_INT64) {
-    aggregated_result = ScaleTensor<signed long>(tensor_spec, scaling_factor, op);
+    aggregated_result = ScaleTensor<signed long>(tensor_spec, tensor_value, scaling_factor, op);
   } else if (data_type == DType_Type_FLOAT32) {
-    aggregated_result = ScaleTensor<float>(tensor_spec, scaling_factor, op);
+    aggregated_result = ScaleTensor<float>(tensor_spec, tensor_value, scaling_factor, op);
   } else if (data_type == DType_Type_FLOAT64) {
-    aggregated_result = ScaleTensor<double>(tensor_spec, scaling_factor, op);
+    aggregated_result = ScaleTensor<double>(tensor_spec, tensor_value, scaling_factor, op);
   } else {
     throw std::runtime_error("Unsupported tensor data type.");
   }
@@ -172,7 +174,8 @@ std::string ScaleTensors(const TensorSpec &tensor_spec,
 
 }
 
-void FederatedRollingAverageBase::InitializeModel(const Model *init_model, double init_contrib_value) {
+void FederatedRollingAverageBase::InitializeModel(const Model *init_model, double init_contrib_value,
+                                                  const TensorValueResolver &tensor_value_resolver) {
 
   /*
     Each Model defined in the model.proto has multiple variables. Each variable 
@@ -199,7 +202,9 @@ void FederatedRollingAverageBase::InitializeModel(const Model *init_model, doubl
    auto scaled_variable = wc_scaled_model.mutable_variables(index);
    if (init_variable.has_plaintext_tensor()) {
 
-    auto aggregated_result = ScaleTensors(init_variable.plaintext_tensor().tensor_spec(),
+    const auto &init_tensor_spec = init_variable.plaintext_tensor().tensor_spec();
+    auto aggregated_result = ScaleTensors(init_tensor_spec,
+                     *ResolveTensorValue(tensor_value_resolver, init_tensor_spec),
                      init_contrib_value, TensorOperation::MULTIPLY);
 
     *(scaled_variable->mutable_plaintext_tensor()->mutable_tensor_spec()->mutable_value()) = aggregated_result;
@@ -215,7 +220,8 @@ void FederatedRollingAverageBase::InitializeModel(const Model *init_model, doubl
 }
 
 void FederatedRollingAverageBase::UpdateScaledModel(const Model *existing_model, const Model *new_model,
-                                                    double existing_contrib_value, double new_contrib_value) {
+                                                    double existing_contrib_value, double new_contrib_value,
+                                                    const TensorValueResolver &tensor_value_resolver) {
 
   // Iterate every Model_Variable of Model
   for (int index = 0; index < wc_scaled_model.variables_size(); index++) {
@@ -235,6 +241,7 @@ void FederatedRollingAverageBase::UpdateScaledModel(const Model *existing_model,
       if (existing_model->variables_size() > 0) {
         const auto &existing_mdl_tensorSpec = existing_model->variables(index).plaintext_tensor().tensor_spec();
         aggregated_result = MergeTensors(scaled_mdl_tensorSpec, existing_mdl_tensorSpec, 
+                                        *ResolveTensorValue(tensor_value_resolver, existing_mdl_tensorSpec),
                                         existing_contrib_value,
                                         TensorOperation::SUBTRACTION);
       }
@@ -245,7 +252,9 @@ void FederatedRollingAverageBase::UpdateScaledModel(const Model *existing_model,
       // (4) Update the Scaled Model with the values of the New Model
       aggregated_result.clear();
       auto &new_mdl_tensorSpec = new_model->variables(index).plaintext_tensor().tensor_spec();
-      aggregated_result = MergeTensors(scaled_mdl_tensorSpec, new_mdl_tensorSpec, new_contrib_value, TensorOperation::ADDITION);
+      aggregated_result = MergeTensors(scaled_mdl_tensorSpec, new_mdl_tensorSpec,
+                                       *ResolveTensorValue(tensor_value_resolver, new_mdl_tensorSpec),
+                                       new_contrib_value, TensorOperation::ADDITION);
 
       *(scaled_variable->mutable_plaintext_tensor()->mutable_tensor_spec()->mutable_value()) = aggregated_result;
     
@@ -282,7 +291,8 @@ void FederatedRollingAverageBase::UpdateCommunityModel() {
      /* (3) The Model_Variables of TensorSpec are de-scaled 
         (4) The new updated scaled values are serialize back and saved in the Model_Variable tensor.
      */
-     scaled_result = ScaleTensors(scaled_mdl_variable.plaintext_tensor().tensor_spec(), community_score_z, TensorOperation::DIVIDE);
+     const auto &scaled_mdl_tensorSpec = scaled_mdl_variable.plaintext_tensor().tensor_spec();
+     scaled_result = ScaleTensors(scaled_mdl_tensorSpec, scaled_mdl_tensorSpec.value(), community_score_z, TensorOperation::DIVIDE);
      *(cm_variable->mutable_plaintext_tensor()->mutable_tensor_spec()->mutable_value()) = scaled_result;
 
     } // End If
@@ -2,6 +2,7 @@
 #ifndef METISFL_METISFL_CONTROLLER_AGGREGATION_FED_ROLL_H_
 #define METISFL_METISFL_CONTROLLER_AGGREGATION_FED_ROLL_H_
 
+#include "metisfl/controller/aggregation/aggregation_function.h"
 #include "metisfl/controller/common/proto_tensor_serde.h"
 #include "metisfl/proto/model.pb.h"
 
@@ -15,10 +16,14 @@ class FederatedRollingAverageBase {
   FederatedModel community_model; // This keeps track of the cumulative community model.
   Model wc_scaled_model; // This is the scaled (weighted) model.
 
-  void InitializeModel(const Model *init_model, double init_contrib_value);
+  // The tensor values of the given models are restored through the
+  // resolver, one variable at a time.
+  void InitializeModel(const Model *init_model, double init_contrib_value,
+                       const TensorValueResolver &tensor_value_resolver);
 
   void UpdateScaledModel(const Model *existing_model, const Model *new_model,
-                         double existing_contrib_value, double new_contrib_value);
+                         double existing_contrib_value, double new_contrib_value,
+                         const TensorValueResolver &tensor_value_resolver);
 
   void UpdateCommunityModel();
 
@@ -20,7 +20,7 @@ FederatedModel FederatedStride::Aggregate(std::vector<std::vector<std::pair<cons
     double contrib_value = pair.front().second;
 
     if (community_model.num_contributors() == 0) {
-      InitializeModel(latest_model, contrib_value);
+      InitializeModel(latest_model, contrib_value, tensor_value_resolver_);
     } else {
 
       Model dummy_model;
@@ -32,7 +32,8 @@ FederatedModel FederatedStride::Aggregate(std::vector<std::vector<std::pair<cons
       UpdateScaledModel(&dummy_model,
                         latest_model,
                         dummy_value,
-                        contrib_value);
+                        contrib_value,
+                        tensor_value_resolver_);
 
       // Update Community Model.
       UpdateCommunityModel();
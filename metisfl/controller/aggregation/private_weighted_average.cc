@@ -63,8 +63,8 @@ PWA::Aggregate(std::vector<std::vector<std::pair<const Model*, double>>>& pairs)
     std::vector<std::string> local_variable_ciphertexts;
     for (const auto &pair : pairs) {
       const auto *model = pair.front().first;
-      local_variable_ciphertexts.emplace_back(
-          model->variables(var_idx).ciphertext_tensor().tensor_spec().value());
+      local_variable_ciphertexts.emplace_back(*ResolveTensorValue(
+          tensor_value_resolver_, model->variables(var_idx).ciphertext_tensor().tensor_spec()));
     }
     // ComputeWeightedAverage assumes that each learner's contribution value,
     // scaling factor is already normalized / scaled.
@@ -0,0 +1,208 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_COMMON_BOUNDED_LINEAGE_H_
+#define METISFL_METISFL_CONTROLLER_COMMON_BOUNDED_LINEAGE_H_
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/repeated_ptr_field.h>
+
+namespace metisfl::controller {
+
+// A lineage of protobuf messages, e.g., the runtime metadata of the federation
+// rounds, in which every entry is addressed by its position (index) in the
+// lineage. Only the `capacity` most recent entries are kept in memory. If a
+// spill file is provided, the older entries are appended to it when they are
+// evicted from memory, and they can still be read from there. The lineage is
+// not thread-safe.
+template<typename T>
+class BoundedLineage {
+ public:
+  BoundedLineage(size_t capacity, std::string spill_path)
+      : capacity_(capacity == 0 ? 1 : capacity),
+        spill_path_(std::move(spill_path)), begin_index_(0), entries_(),
+        spill_(), spill_offsets_(), keep_spill_file_(false) {}
+
+  bool empty() const { return entries_.empty(); }
+
+  // Index of the oldest entry kept in memory.
+  uint64_t begin_index() const { return begin_index_; }
+
+  // Index of the next appended entry.
+  uint64_t end_index() const { return begin_index_ + entries_.size(); }
+
+  T &back() { return entries_.back(); }
+
+  // Returns the entry at `index`, or null if it is not kept in memory.
+  T *Find(uint64_t index) {
+    if (index < begin_index_ || index >= end_index()) {
+      return nullptr;
+    }
+    return &entries_[index - begin_index_];
+  }
+
+  // Appends the entry, evicts the oldest entry if the lineage is full and
+  // returns the index of the appended entry.
+  uint64_t Append(T entry) {
+    entries_.push_back(std::move(entry));
+    if (entries_.size() > capacity_) {
+      Spill(begin_index_, entries_.front());
+      entries_.pop_front();
+      ++begin_index_;
+    }
+    return end_index() - 1;
+  }
+
+  // Replaces the entries kept in memory with the given entries, the first of
+  // which is at `begin_index`. The entries that were spilled before, e.g.,
+  // by the controller whose state is restored, remain readable.
+  template<typename Iterator>
+  void Restore(uint64_t begin_index, Iterator first, Iterator last) {
+    entries_.assign(first, last);
+    begin_index_ = begin_index;
+    keep_spill_file_ = true;
+    ScanSpillFile();
+    while (entries_.size() > capacity_) {
+      Spill(begin_index_, entries_.front());
+      entries_.pop_front();
+      ++begin_index_;
+    }
+  }
+
+  // Copies up to `limit` entries, starting with the entry at `index`, into
+  // `out`, and returns the index that follows the last copied entry. Entries
+  // that are no longer kept in memory are read from the spill file; entries
+  // that are not available at all are skipped.
+  uint64_t CopyRange(uint64_t index, uint64_t limit,
+                     google::protobuf::RepeatedPtrField<T> *out) {
+    std::ifstream spill_in;
+    uint64_t copied = 0;
+    for (; index < end_index() && copied < limit; ++index) {
+      if (index >= begin_index_) {
+        *out->Add() = entries_[index - begin_index_];
+        ++copied;
+        continue;
+      }
+      if (index >= spill_offsets_.size() ||
+          spill_offsets_[index] == kNotSpilled) {
+        continue;
+      }
+      if (!spill_in.is_open()) {
+        spill_in.open(spill_path_, std::ios::binary);
+      }
+      spill_in.clear();
+      spill_in.seekg(spill_offsets_[index]);
+      google::protobuf::io::IstreamInputStream input(&spill_in);
+      google::protobuf::io::CodedInputStream coded_input(&input);
+      uint64_t spilled_index;
+      T entry;
+      if (ReadEntry(&coded_input, &spilled_index, &entry) &&
+          spilled_index == index) {
+        out->Add()->Swap(&entry);
+        ++copied;
+      }
+    }
+    return index;
+  }
+
+ private:
+  static constexpr uint64_t kNotSpilled = std::numeric_limits<uint64_t>::max();
+
+  // Every spilled entry is written as its index followed by the
+  // length-delimited entry.
+  void Spill(uint64_t index, const T &entry) {
+    if (spill_path_.empty()) {
+      return;
+    }
+    if (!spill_.is_open()) {
+      // The spill file of a previous run is only kept if the lineage
+      // has been restored from that run.
+      spill_.open(spill_path_, std::ios::binary |
+          (keep_spill_file_ ? std::ios::app : std::ios::trunc));
+      spill_.seekp(0, std::ios::end);
+      keep_spill_file_ = true;
+    }
+    auto offset = static_cast<uint64_t>(spill_.tellp());
+    {
+      google::protobuf::io::OstreamOutputStream output(&spill_);
+      google::protobuf::io::CodedOutputStream coded_output(&output);
+      coded_output.WriteVarint64(index);
+      coded_output.WriteVarint32(entry.ByteSizeLong());
+      entry.SerializeWithCachedSizes(&coded_output);
+    }
+    spill_.flush();
+    if (!spill_.good()) {
+      PLOG(WARNING) << "Cannot append lineage entry " << index
+                    << " to " << spill_path_ << ". The entry is dropped.";
+      spill_.close();
+      return;
+    }
+    if (spill_offsets_.size() <= index) {
+      spill_offsets_.resize(index + 1, kNotSpilled);
+    }
+    spill_offsets_[index] = offset;
+  }
+
+  void ScanSpillFile() {
+    if (spill_path_.empty()) {
+      return;
+    }
+    std::ifstream spill_in(spill_path_, std::ios::binary);
+    if (!spill_in.is_open()) {
+      return;
+    }
+    google::protobuf::io::IstreamInputStream input(&spill_in);
+    while (true) {
+      // A coded stream per entry, since its position is limited to 2GB.
+      auto offset = static_cast<uint64_t>(input.ByteCount());
+      google::protobuf::io::CodedInputStream coded_input(&input);
+      uint64_t index;
+      T entry;
+      if (!ReadEntry(&coded_input, &index, &entry)) {
+        break;
+      }
+      if (index < begin_index_) {
+        if (spill_offsets_.size() <= index) {
+          spill_offsets_.resize(index + 1, kNotSpilled);
+        }
+        spill_offsets_[index] = offset;
+      }
+    }
+  }
+
+  static bool ReadEntry(google::protobuf::io::CodedInputStream *coded_input,
+                        uint64_t *index, T *entry) {
+    uint32_t size;
+    if (!coded_input->ReadVarint64(index) ||
+        !coded_input->ReadVarint32(&size)) {
+      return false;
+    }
+    auto limit = coded_input->PushLimit(size);
+    bool parsed = entry->ParseFromCodedStream(coded_input) &&
+        coded_input->ConsumedEntireMessage();
+    coded_input->PopLimit(limit);
+    return parsed;
+  }
+
+  size_t capacity_;
+  std::string spill_path_;
+  uint64_t begin_index_;
+  std::deque<T> entries_;
+  std::ofstream spill_;
+  // The offset of every spilled entry in the spill file, by index.
+  std::vector<uint64_t> spill_offsets_;
+  // Whether the existing spill file is appended to, rather than truncated.
+  bool keep_spill_file_;
+};
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_COMMON_BOUNDED_LINEAGE_H_
@@ -0,0 +1,91 @@
+
+#include "metisfl/controller/common/bounded_lineage.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "metisfl/proto/metis.pb.h"
+
+namespace metisfl::controller {
+namespace {
+
+FederatedTaskRuntimeMetadata MakeMetadata(uint32_t global_iteration) {
+  FederatedTaskRuntimeMetadata metadata;
+  metadata.set_global_iteration(global_iteration);
+  return metadata;
+}
+
+std::vector<uint32_t> GlobalIterations(
+    const google::protobuf::RepeatedPtrField<FederatedTaskRuntimeMetadata> &lineage) {
+  std::vector<uint32_t> global_iterations;
+  for (const auto &metadata: lineage) {
+    global_iterations.push_back(metadata.global_iteration());
+  }
+  return global_iterations;
+}
+
+class BoundedLineageTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    spill_path_ = ::testing::TempDir() + "/bounded_lineage_test.log";
+    std::remove(spill_path_.c_str());
+  }
+
+  std::string spill_path_;
+};
+
+TEST_F(BoundedLineageTest, KeepsMostRecentEntries) /* NOLINT */ {
+  BoundedLineage<FederatedTaskRuntimeMetadata> lineage(3, "");
+  for (uint32_t i = 1; i <= 5; ++i) {
+    EXPECT_EQ(lineage.Append(MakeMetadata(i)), i - 1);
+  }
+
+  EXPECT_EQ(lineage.begin_index(), 2);
+  EXPECT_EQ(lineage.end_index(), 5);
+  EXPECT_EQ(lineage.Find(1), nullptr);
+  ASSERT_NE(lineage.Find(4), nullptr);
+  EXPECT_EQ(lineage.Find(4)->global_iteration(), 5);
+
+  google::protobuf::RepeatedPtrField<FederatedTaskRuntimeMetadata> page;
+  EXPECT_EQ(lineage.CopyRange(0, 10, &page), 5);
+  EXPECT_EQ(GlobalIterations(page), (std::vector<uint32_t>{3, 4, 5}));
+}
+
+TEST_F(BoundedLineageTest, ReadsSpilledEntries) /* NOLINT */ {
+  BoundedLineage<FederatedTaskRuntimeMetadata> lineage(2, spill_path_);
+  for (uint32_t i = 1; i <= 5; ++i) {
+    lineage.Append(MakeMetadata(i));
+  }
+
+  google::protobuf::RepeatedPtrField<FederatedTaskRuntimeMetadata> page;
+  EXPECT_EQ(lineage.CopyRange(1, 3, &page), 4);
+  EXPECT_EQ(GlobalIterations(page), (std::vector<uint32_t>{2, 3, 4}));
+
+  page.Clear();
+  EXPECT_EQ(lineage.CopyRange(4, 3, &page), 5);
+  EXPECT_EQ(GlobalIterations(page), (std::vector<uint32_t>{5}));
+}
+
+TEST_F(BoundedLineageTest, RestoreKeepsSpilledEntries) /* NOLINT */ {
+  std::vector<FederatedTaskRuntimeMetadata> retained;
+  {
+    BoundedLineage<FederatedTaskRuntimeMetadata> lineage(2, spill_path_);
+    for (uint32_t i = 1; i <= 5; ++i) {
+      lineage.Append(MakeMetadata(i));
+    }
+    retained = {*lineage.Find(3), *lineage.Find(4)};
+  }
+
+  BoundedLineage<FederatedTaskRuntimeMetadata> lineage(2, spill_path_);
+  lineage.Restore(3, retained.begin(), retained.end());
+  lineage.Append(MakeMetadata(6));
+
+  google::protobuf::RepeatedPtrField<FederatedTaskRuntimeMetadata> page;
+  EXPECT_EQ(lineage.CopyRange(0, 10, &page), 6);
+  EXPECT_EQ(GlobalIterations(page), (std::vector<uint32_t>{1, 2, 3, 4, 5, 6}));
+}
+
+} // namespace
+} // namespace metisfl::controller
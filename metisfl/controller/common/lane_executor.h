@@ -0,0 +1,181 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_COMMON_LANE_EXECUTOR_H_
+#define METISFL_METISFL_CONTROLLER_COMMON_LANE_EXECUTOR_H_
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace metisfl::controller {
+
+// The counters of an executor's lane.
+struct LaneStats {
+  // The number of tasks waiting in the lane's queue.
+  size_t queue_depth = 0;
+  uint64_t num_submitted = 0;
+  uint64_t num_completed = 0;
+  // The time the tasks of the lane waited in the queue before they started.
+  double mean_wait_ms = 0;
+  double max_wait_ms = 0;
+};
+
+// Executes tasks in lanes of decreasing priority, e.g., short control work in
+// lane 0 and long-running work in lane 1. Every lane has its own queue and
+// its own workers. The workers of a lane run the tasks of that lane and of
+// the lanes of higher priority, highest priority first; hence, the workers
+// of a low-priority lane help with the high-priority work when they are
+// idle, while the tasks of a high-priority lane never wait for a worker that
+// is busy with low-priority work. The tasks of a lane start in the order
+// they were submitted.
+class LaneExecutor {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Creates `num_workers[i]` workers for the i-th lane.
+  explicit LaneExecutor(const std::vector<size_t> &num_workers)
+      : lanes_(num_workers.size()), num_running_(0), stopped_(false),
+        mutex_(), task_available_(), tasks_done_(), workers_() {
+    for (size_t lane = 0; lane < num_workers.size(); ++lane) {
+      for (size_t i = 0; i < num_workers[lane]; ++i) {
+        workers_.emplace_back([this, lane] { Work(lane); });
+      }
+    }
+  }
+
+  LaneExecutor(const LaneExecutor &) = delete;
+  LaneExecutor &operator=(const LaneExecutor &) = delete;
+
+  // Waits for all submitted tasks to complete, then stops the workers.
+  ~LaneExecutor() {
+    WaitForTasks();
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      stopped_ = true;
+    }
+    task_available_.notify_all();
+    for (auto &worker: workers_) {
+      worker.join();
+    }
+  }
+
+  size_t num_lanes() const { return lanes_.size(); }
+
+  void Push(size_t lane, std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      auto &queue = lanes_.at(lane);
+      queue.tasks.push_back({std::move(task), Clock::now()});
+      ++queue.num_submitted;
+    }
+    // Not every worker serves every lane; hence, all of them are woken up.
+    task_available_.notify_all();
+  }
+
+  // Blocks until all submitted tasks, including the tasks they submit, have
+  // completed.
+  void WaitForTasks() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    tasks_done_.wait(lock, [this] { return num_running_ == 0 && Idle(); });
+  }
+
+  LaneStats Stats(size_t lane) const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    const auto &queue = lanes_.at(lane);
+    LaneStats stats;
+    stats.queue_depth = queue.tasks.size();
+    stats.num_submitted = queue.num_submitted;
+    stats.num_completed = queue.num_completed;
+    auto num_started = queue.num_submitted - queue.tasks.size();
+    if (num_started > 0) {
+      stats.mean_wait_ms = ToMilliseconds(queue.total_wait) / num_started;
+    }
+    stats.max_wait_ms = ToMilliseconds(queue.max_wait);
+    return stats;
+  }
+
+ private:
+  struct Task {
+    std::function<void()> run;
+    Clock::time_point submitted_at;
+  };
+
+  struct Lane {
+    std::deque<Task> tasks;
+    uint64_t num_submitted = 0;
+    uint64_t num_completed = 0;
+    Clock::duration total_wait = Clock::duration::zero();
+    Clock::duration max_wait = Clock::duration::zero();
+  };
+
+  static double ToMilliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+
+  bool Idle() const {
+    return std::all_of(lanes_.begin(), lanes_.end(),
+                       [](const Lane &lane) { return lane.tasks.empty(); });
+  }
+
+  // Returns the highest-priority lane, up to `max_lane`, with a queued task.
+  // Must be called with the mutex held.
+  Lane *NextLane(size_t max_lane) {
+    for (size_t lane = 0; lane <= max_lane; ++lane) {
+      if (!lanes_[lane].tasks.empty()) {
+        return &lanes_[lane];
+      }
+    }
+    return nullptr;
+  }
+
+  void Work(size_t max_lane) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      Lane *lane = nullptr;
+      task_available_.wait(lock, [&] {
+        lane = NextLane(max_lane);
+        return lane != nullptr || stopped_;
+      });
+      if (lane == nullptr) {
+        return;
+      }
+
+      auto task = std::move(lane->tasks.front());
+      lane->tasks.pop_front();
+      auto wait = Clock::now() - task.submitted_at;
+      lane->total_wait += wait;
+      lane->max_wait = std::max(lane->max_wait, wait);
+      ++num_running_;
+
+      lock.unlock();
+      task.run();
+      lock.lock();
+
+      ++lane->num_completed;
+      --num_running_;
+      if (num_running_ == 0 && Idle()) {
+        tasks_done_.notify_all();
+      }
+    }
+  }
+
+  // The lanes are only ever created on construction; hence, the pointers
+  // to them remain valid.
+  std::vector<Lane> lanes_;
+  size_t num_running_;
+  bool stopped_;
+  mutable std::mutex mutex_;
+  std::condition_variable task_available_;
+  std::condition_variable tasks_done_;
+  std::vector<std::thread> workers_;
+};
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_COMMON_LANE_EXECUTOR_H_
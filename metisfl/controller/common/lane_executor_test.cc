@@ -0,0 +1,113 @@
+#include "metisfl/controller/common/lane_executor.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace metisfl::controller {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr size_t kControlLane = 0;
+constexpr size_t kHeavyLane = 1;
+
+// NOLINTNEXTLINE
+TEST(LaneExecutor, ControlTasksDoNotWaitForHeavyTasks) {
+  LaneExecutor executor({/* control */ 1, /* heavy */ 1});
+
+  // Keeps the heavy worker busy until the control task has run.
+  std::promise<void> control_done;
+  auto control_done_future = control_done.get_future().share();
+  std::promise<void> heavy_started;
+  executor.Push(kHeavyLane, [&heavy_started, control_done_future] {
+    heavy_started.set_value();
+    control_done_future.wait();
+  });
+  heavy_started.get_future().wait();
+
+  executor.Push(kControlLane, [&control_done] { control_done.set_value(); });
+  EXPECT_EQ(control_done_future.wait_for(std::chrono::seconds(10)),
+            std::future_status::ready);
+  executor.WaitForTasks();
+}
+
+// NOLINTNEXTLINE
+TEST(LaneExecutor, IdleHeavyWorkersRunControlTasks) {
+  LaneExecutor executor({/* control */ 0, /* heavy */ 1});
+
+  std::promise<void> done;
+  executor.Push(kControlLane, [&done] { done.set_value(); });
+  EXPECT_EQ(done.get_future().wait_for(std::chrono::seconds(10)),
+            std::future_status::ready);
+}
+
+// NOLINTNEXTLINE
+TEST(LaneExecutor, HigherPriorityLaneRunsFirst) {
+  LaneExecutor executor({/* control */ 0, /* heavy */ 1});
+
+  // Blocks the only worker, while the tasks of both lanes get queued.
+  std::promise<void> release;
+  auto release_future = release.get_future().share();
+  executor.Push(kHeavyLane, [release_future] { release_future.wait(); });
+
+  std::mutex order_mutex;
+  std::vector<int> order;
+  auto record = [&order_mutex, &order](int i) {
+    return [&order_mutex, &order, i] {
+      std::lock_guard<std::mutex> guard(order_mutex);
+      order.push_back(i);
+    };
+  };
+  executor.Push(kHeavyLane, record(1));
+  executor.Push(kControlLane, record(2));
+  executor.Push(kHeavyLane, record(3));
+  executor.Push(kControlLane, record(4));
+  release.set_value();
+  executor.WaitForTasks();
+
+  EXPECT_THAT(order, ElementsAre(2, 4, 1, 3));
+}
+
+// NOLINTNEXTLINE
+TEST(LaneExecutor, CountsTasksPerLane) {
+  LaneExecutor executor({/* control */ 1, /* heavy */ 2});
+
+  std::atomic<int> num_run = 0;
+  for (int i = 0; i < 5; ++i) {
+    executor.Push(kControlLane, [&num_run] { ++num_run; });
+  }
+  for (int i = 0; i < 3; ++i) {
+    executor.Push(kHeavyLane, [&num_run] { ++num_run; });
+  }
+  executor.WaitForTasks();
+  EXPECT_EQ(num_run, 8);
+
+  auto control = executor.Stats(kControlLane);
+  EXPECT_EQ(control.queue_depth, 0);
+  EXPECT_EQ(control.num_submitted, 5);
+  EXPECT_EQ(control.num_completed, 5);
+  EXPECT_GE(control.max_wait_ms, control.mean_wait_ms);
+  auto heavy = executor.Stats(kHeavyLane);
+  EXPECT_EQ(heavy.num_submitted, 3);
+  EXPECT_EQ(heavy.num_completed, 3);
+}
+
+// NOLINTNEXTLINE
+TEST(LaneExecutor, WaitsForTasksSubmittedByTasks) {
+  LaneExecutor executor({/* control */ 1, /* heavy */ 1});
+
+  std::atomic<bool> control_run = false;
+  executor.Push(kHeavyLane, [&executor, &control_run] {
+    executor.Push(kControlLane, [&control_run] { control_run = true; });
+  });
+  executor.WaitForTasks();
+  EXPECT_TRUE(control_run);
+}
+
+} // namespace
+} // namespace metisfl::controller
@@ -0,0 +1,124 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_COMMON_LIVENESS_TRACKER_H_
+#define METISFL_METISFL_CONTROLLER_COMMON_LIVENESS_TRACKER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+
+namespace metisfl::controller {
+
+// Tracks the liveness of the learners from their heartbeats. Time advances
+// in ticks, one per heartbeat interval; a learner misses a beat for every
+// tick without a heartbeat. A learner becomes suspect once it misses
+// `suspect_after` consecutive beats, and dead once it misses `dead_after`
+// consecutive beats. The deadlines are kept in a hashed timer wheel, so that
+// both a heartbeat and a tick take time proportional to the learners whose
+// deadline is due, rather than to all tracked learners. Entries of the wheel
+// that were superseded by a later heartbeat are dropped lazily, when their
+// slot is visited. The tracker is not thread-safe.
+class LivenessTracker {
+ public:
+  LivenessTracker(uint32_t suspect_after, uint32_t dead_after)
+      : suspect_after_(std::max<uint32_t>(suspect_after, 1)),
+        dead_after_(std::max(dead_after, suspect_after_ + 1)),
+        tick_(0), wheel_(dead_after_ + 2), learners_() {}
+
+  size_t size() const { return learners_.size(); }
+
+  bool contains(const std::string &learner_id) const {
+    return learners_.contains(learner_id);
+  }
+
+  bool IsSuspect(const std::string &learner_id) const {
+    auto it = learners_.find(learner_id);
+    return it != learners_.end() && it->second.suspect;
+  }
+
+  // Records a heartbeat of the learner, and starts tracking the learner if it
+  // is not tracked yet. Returns true if the learner was suspect.
+  bool Beat(const std::string &learner_id) {
+    auto &learner = learners_[learner_id];
+    bool was_suspect = learner.suspect;
+    learner.last_beat = tick_;
+    learner.suspect = false;
+    Schedule(learner_id, &learner, tick_ + suspect_after_ + 1);
+    return was_suspect;
+  }
+
+  // Marks the learner as suspect before it misses enough beats, e.g., because
+  // a request to it failed. Returns true if the learner was not suspect.
+  bool Suspect(const std::string &learner_id) {
+    auto it = learners_.find(learner_id);
+    if (it == learners_.end() || it->second.suspect) {
+      return false;
+    }
+    it->second.suspect = true;
+    Schedule(learner_id, &it->second,
+             it->second.last_beat + dead_after_ + 1);
+    return true;
+  }
+
+  void Remove(const std::string &learner_id) { learners_.erase(learner_id); }
+
+  // Advances the time by one heartbeat interval. Appends the learners that
+  // have just become suspect to `suspects`, and returns the learners that
+  // have just become dead. The dead learners are no longer tracked.
+  std::vector<std::string> Tick(std::vector<std::string> *suspects) {
+    ++tick_;
+    std::vector<std::string> dead;
+    auto &slot = wheel_[tick_ % wheel_.size()];
+    auto due = std::move(slot);
+    slot.clear();
+    for (auto &learner_id: due) {
+      auto it = learners_.find(learner_id);
+      if (it == learners_.end() || it->second.deadline != tick_) {
+        continue;
+      }
+      if (!it->second.suspect) {
+        it->second.suspect = true;
+        Schedule(learner_id, &it->second,
+                 it->second.last_beat + dead_after_ + 1);
+        suspects->push_back(std::move(learner_id));
+      } else {
+        learners_.erase(it);
+        dead.push_back(std::move(learner_id));
+      }
+    }
+    return dead;
+  }
+
+ private:
+  struct Learner {
+    uint64_t last_beat = 0;
+    // The tick at which the learner becomes suspect, or dead if it is
+    // already suspect. The learner's entry in the wheel is only valid if it
+    // was scheduled for this tick.
+    uint64_t deadline = 0;
+    bool suspect = false;
+  };
+
+  // The wheel spans dead_after + 2 ticks, hence the deadline of a learner is
+  // always less than a full turn ahead of the current tick.
+  void Schedule(const std::string &learner_id, Learner *learner,
+                uint64_t deadline) {
+    if (learner->deadline == deadline) {
+      return;
+    }
+    learner->deadline = deadline;
+    wheel_[deadline % wheel_.size()].push_back(learner_id);
+  }
+
+  uint32_t suspect_after_;
+  uint32_t dead_after_;
+  uint64_t tick_;
+  std::vector<std::vector<std::string>> wheel_;
+  absl::flat_hash_map<std::string, Learner> learners_;
+};
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_COMMON_LIVENESS_TRACKER_H_
@@ -0,0 +1,116 @@
+#include "metisfl/controller/common/liveness_tracker.h"
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace metisfl::controller {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+// NOLINTNEXTLINE
+TEST(LivenessTracker, MissedBeatsMakeLearnerSuspectThenDead) {
+  LivenessTracker tracker(/* suspect_after */ 2, /* dead_after */ 4);
+  tracker.Beat("learner1");
+
+  std::vector<std::string> suspects;
+  // The first tick closes the interval of the heartbeat; the next two are
+  // missed beats.
+  EXPECT_THAT(tracker.Tick(&suspects), IsEmpty());
+  EXPECT_THAT(tracker.Tick(&suspects), IsEmpty());
+  EXPECT_THAT(suspects, IsEmpty());
+  EXPECT_THAT(tracker.Tick(&suspects), IsEmpty());
+  EXPECT_THAT(suspects, ElementsAre("learner1"));
+  EXPECT_TRUE(tracker.IsSuspect("learner1"));
+
+  suspects.clear();
+  EXPECT_THAT(tracker.Tick(&suspects), IsEmpty());
+  EXPECT_THAT(tracker.Tick(&suspects), ElementsAre("learner1"));
+  EXPECT_THAT(suspects, IsEmpty());
+  EXPECT_FALSE(tracker.contains("learner1"));
+}
+
+// NOLINTNEXTLINE
+TEST(LivenessTracker, BeatsKeepLearnerAlive) {
+  LivenessTracker tracker(/* suspect_after */ 1, /* dead_after */ 2);
+  tracker.Beat("learner1");
+  tracker.Beat("learner2");
+
+  std::vector<std::string> suspects;
+  std::vector<std::string> dead;
+  for (int i = 0; i < 10; ++i) {
+    tracker.Beat("learner1");
+    auto tick_dead = tracker.Tick(&suspects);
+    dead.insert(dead.end(), tick_dead.begin(), tick_dead.end());
+  }
+  EXPECT_THAT(suspects, ElementsAre("learner2"));
+  EXPECT_THAT(dead, ElementsAre("learner2"));
+  EXPECT_TRUE(tracker.contains("learner1"));
+  EXPECT_FALSE(tracker.IsSuspect("learner1"));
+  EXPECT_FALSE(tracker.contains("learner2"));
+}
+
+// NOLINTNEXTLINE
+TEST(LivenessTracker, SuspectRecoversWithBeat) {
+  LivenessTracker tracker(/* suspect_after */ 1, /* dead_after */ 3);
+  tracker.Beat("learner1");
+
+  std::vector<std::string> suspects;
+  tracker.Tick(&suspects);
+  tracker.Tick(&suspects);
+  ASSERT_TRUE(tracker.IsSuspect("learner1"));
+
+  EXPECT_TRUE(tracker.Beat("learner1"));
+  EXPECT_FALSE(tracker.IsSuspect("learner1"));
+  EXPECT_FALSE(tracker.Beat("learner1"));
+  // The deadline of the suspicion no longer applies.
+  for (int i = 0; i < 3; ++i) {
+    tracker.Beat("learner1");
+    EXPECT_THAT(tracker.Tick(&suspects), IsEmpty());
+  }
+  EXPECT_TRUE(tracker.contains("learner1"));
+}
+
+// NOLINTNEXTLINE
+TEST(LivenessTracker, SuspectedLearnerDiesWithoutBeats) {
+  LivenessTracker tracker(/* suspect_after */ 2, /* dead_after */ 3);
+  tracker.Beat("learner1");
+  EXPECT_TRUE(tracker.Suspect("learner1"));
+  EXPECT_FALSE(tracker.Suspect("learner1"));
+  EXPECT_FALSE(tracker.Suspect("learner2"));
+
+  std::vector<std::string> suspects;
+  std::vector<std::string> dead;
+  for (int i = 0; i < 4; ++i) {
+    auto tick_dead = tracker.Tick(&suspects);
+    dead.insert(dead.end(), tick_dead.begin(), tick_dead.end());
+  }
+  EXPECT_THAT(suspects, IsEmpty());
+  EXPECT_THAT(dead, ElementsAre("learner1"));
+}
+
+// NOLINTNEXTLINE
+TEST(LivenessTracker, RemovedLearnersAreNotReported) {
+  LivenessTracker tracker(/* suspect_after */ 1, /* dead_after */ 2);
+  tracker.Beat("learner1");
+  tracker.Beat("learner2");
+  tracker.Beat("learner3");
+  tracker.Remove("learner2");
+
+  std::vector<std::string> suspects;
+  std::vector<std::string> dead;
+  for (int i = 0; i < 5; ++i) {
+    auto tick_dead = tracker.Tick(&suspects);
+    dead.insert(dead.end(), tick_dead.begin(), tick_dead.end());
+  }
+  EXPECT_THAT(suspects, UnorderedElementsAre("learner1", "learner3"));
+  EXPECT_THAT(dead, UnorderedElementsAre("learner1", "learner3"));
+  EXPECT_EQ(tracker.size(), 0);
+}
+
+} // namespace
+} // namespace metisfl::controller
@@ -0,0 +1,94 @@
+
+#include "metisfl/controller/common/model_chunking.h"
+
+#include <algorithm>
+
+#include "metisfl/controller/common/tensor_compression.h"
+
+namespace metisfl::controller {
+namespace {
+
+const TensorSpec &GetTensorSpec(const Model_Variable &variable) {
+  return variable.has_ciphertext_tensor()
+         ? variable.ciphertext_tensor().tensor_spec()
+         : variable.plaintext_tensor().tensor_spec();
+}
+
+TensorSpec *MutableTensorSpec(bool ciphertext, Model_Variable *variable) {
+  return ciphertext
+         ? variable->mutable_ciphertext_tensor()->mutable_tensor_spec()
+         : variable->mutable_plaintext_tensor()->mutable_tensor_spec();
+}
+
+} // namespace
+
+std::vector<ModelChunk> SplitModelIntoChunks(const Model &model,
+                                             size_t max_chunk_bytes) {
+
+  std::vector<ModelChunk> chunks;
+  size_t chunk_bytes = 0;
+  auto next_chunk = [&chunks, &chunk_bytes]() -> ModelChunk & {
+    chunk_bytes = 0;
+    return chunks.emplace_back();
+  };
+
+  for (const auto &variable: model.variables()) {
+    const size_t variable_bytes = variable.ByteSizeLong();
+    if (chunks.empty() ||
+        (chunk_bytes > 0 && chunk_bytes + variable_bytes > max_chunk_bytes)) {
+      next_chunk();
+    }
+
+    if (variable_bytes <= max_chunk_bytes) {
+      *chunks.back().add_variables() = variable;
+      chunk_bytes += variable_bytes;
+      continue;
+    }
+
+    // The variable does not fit into a single chunk. The first chunk carries
+    // the variable's structure along with the first part of the value, and
+    // every continuation chunk carries only the next part of the value.
+    const bool ciphertext = variable.has_ciphertext_tensor();
+    const auto &tensor_spec = GetTensorSpec(variable);
+    const auto &value = tensor_spec.value();
+    const size_t part_bytes = std::max<size_t>(max_chunk_bytes, 1);
+
+    auto *head = chunks.back().add_variables();
+    head->set_name(variable.name());
+    head->set_trainable(variable.trainable());
+    auto *head_spec = MutableTensorSpec(ciphertext, head);
+    head_spec->set_length(tensor_spec.length());
+    *head_spec->mutable_dimensions() = tensor_spec.dimensions();
+    *head_spec->mutable_type() = tensor_spec.type();
+    head_spec->set_value(value.substr(0, part_bytes));
+
+    for (size_t offset = part_bytes; offset < value.size(); offset += part_bytes) {
+      auto &continuation = next_chunk();
+      continuation.set_continues_variable(true);
+      MutableTensorSpec(ciphertext, continuation.add_variables())
+          ->set_value(value.substr(offset, part_bytes));
+    }
+
+    // The next variable starts a new chunk.
+    chunk_bytes = max_chunk_bytes;
+  }
+
+  return chunks;
+
+}
+
+void AppendTensorValue(const Model_Variable &part, Model_Variable *variable) {
+  MutableTensorSpec(variable->has_ciphertext_tensor(), variable)
+      ->mutable_value()->append(GetTensorSpec(part).value());
+}
+
+bool IsCompleteVariable(const Model_Variable &variable) {
+  const auto &tensor_spec = GetTensorSpec(variable);
+  if (variable.has_ciphertext_tensor()) {
+    return !tensor_spec.value().empty();
+  }
+  return tensor_spec.value().size() ==
+      (size_t) tensor_spec.length() * DTypeElementWidth(tensor_spec.type());
+}
+
+} // namespace metisfl::controller
@@ -0,0 +1,30 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_COMMON_MODEL_CHUNKING_H_
+#define METISFL_METISFL_CONTROLLER_COMMON_MODEL_CHUNKING_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "metisfl/proto/model.pb.h"
+
+namespace metisfl::controller {
+
+// Splits the model into chunks, in variables order, such that the encoded
+// size of every chunk is about `max_chunk_bytes` or less. Variables are
+// kept whole whenever they fit into a chunk; a larger variable is split
+// into a first chunk and consecutive continuation chunks (see ModelChunk).
+std::vector<ModelChunk> SplitModelIntoChunks(const Model &model,
+                                             size_t max_chunk_bytes);
+
+// Appends the part of the tensor value that is carried by a continuation
+// chunk's variable to the tensor value of `variable`.
+void AppendTensorValue(const Model_Variable &part, Model_Variable *variable);
+
+// Returns whether the variable carries all the values of its tensor, i.e.,
+// no continuation chunk is missing. The size of an encrypted tensor's value
+// does not follow from its length, hence it is only required to be present.
+bool IsCompleteVariable(const Model_Variable &variable);
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_COMMON_MODEL_CHUNKING_H_
@@ -0,0 +1,99 @@
+
+#include "metisfl/controller/common/model_chunking.h"
+
+#include <gtest/gtest.h>
+
+namespace metisfl::controller {
+namespace {
+
+Model MakeModel() {
+  Model model;
+  int index = 0;
+  for (size_t value_bytes: {10, 100, 4096, 10, 1000}) {
+    auto *variable = model.add_variables();
+    variable->set_name("var_" + std::to_string(index));
+    variable->set_trainable(index % 2 == 0);
+    auto *tensor_spec = index == 2
+                        ? variable->mutable_ciphertext_tensor()->mutable_tensor_spec()
+                        : variable->mutable_plaintext_tensor()->mutable_tensor_spec();
+    tensor_spec->set_length(value_bytes);
+    tensor_spec->add_dimensions(value_bytes);
+    tensor_spec->mutable_type()->set_type(DType_Type_UINT8);
+    tensor_spec->set_value(std::string(value_bytes, (char) ('a' + index)));
+    ++index;
+  }
+  return model;
+}
+
+Model AssembleModel(const std::vector<ModelChunk> &chunks) {
+  Model model;
+  for (const auto &chunk: chunks) {
+    if (chunk.continues_variable()) {
+      EXPECT_EQ(chunk.variables_size(), 1);
+      AppendTensorValue(chunk.variables(0),
+                        model.mutable_variables(model.variables_size() - 1));
+      continue;
+    }
+    for (const auto &variable: chunk.variables()) {
+      *model.add_variables() = variable;
+    }
+  }
+  return model;
+}
+
+TEST(ModelChunkingTest, ChunksAreBoundedAndReassembleTheModel) /* NOLINT */ {
+  auto model = MakeModel();
+  const size_t max_chunk_bytes = 1024;
+
+  auto chunks = SplitModelIntoChunks(model, max_chunk_bytes);
+
+  // The variable of 4096 bytes is split into a head and 3 continuations.
+  size_t num_continuations = 0;
+  for (const auto &chunk: chunks) {
+    EXPECT_LE(chunk.ByteSizeLong(), max_chunk_bytes + 64);
+    num_continuations += chunk.continues_variable();
+  }
+  EXPECT_EQ(num_continuations, 3);
+  EXPECT_EQ(AssembleModel(chunks).SerializeAsString(), model.SerializeAsString());
+}
+
+TEST(ModelChunkingTest, SmallVariablesShareAChunk) /* NOLINT */ {
+  auto model = MakeModel();
+
+  auto chunks = SplitModelIntoChunks(model, 1 << 20);
+
+  ASSERT_EQ(chunks.size(), 1);
+  EXPECT_EQ(chunks[0].SerializeAsString().size(), model.SerializeAsString().size());
+  EXPECT_EQ(AssembleModel(chunks).SerializeAsString(), model.SerializeAsString());
+}
+
+TEST(ModelChunkingTest, VariablesMissingContinuationsAreIncomplete) /* NOLINT */ {
+  auto model = MakeModel();
+  auto *float_tensor = model.mutable_variables(0)
+      ->mutable_plaintext_tensor()->mutable_tensor_spec();
+  float_tensor->set_length(2);
+  float_tensor->mutable_type()->set_type(DType_Type_FLOAT32);
+  float_tensor->set_value(std::string(8, 'a'));
+
+  auto chunks = SplitModelIntoChunks(model, 1024);
+  auto assembled = AssembleModel(chunks);
+  for (const auto &variable: assembled.variables()) {
+    EXPECT_TRUE(IsCompleteVariable(variable)) << variable.name();
+  }
+
+  // The stream ends in the middle of a plaintext variable.
+  auto *value = model.mutable_variables(4)
+      ->mutable_plaintext_tensor()->mutable_tensor_spec()->mutable_value();
+  value->resize(value->size() / 2);
+  EXPECT_FALSE(IsCompleteVariable(model.variables(4)));
+  model.mutable_variables(2)->mutable_ciphertext_tensor()
+      ->mutable_tensor_spec()->clear_value();
+  EXPECT_FALSE(IsCompleteVariable(model.variables(2)));
+}
+
+TEST(ModelChunkingTest, EmptyModel) /* NOLINT */ {
+  EXPECT_TRUE(SplitModelIntoChunks(Model(), 1024).empty());
+}
+
+} // namespace
+} // namespace metisfl::controller
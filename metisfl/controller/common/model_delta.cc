@@ -0,0 +1,109 @@
+
+#include "metisfl/controller/common/model_delta.h"
+
+#include <string>
+
+#include "metisfl/controller/common/tensor_compression.h"
+
+namespace metisfl::controller {
+namespace {
+
+const TensorSpec &GetTensorSpec(const Model_Variable &variable) {
+  return variable.has_ciphertext_tensor()
+         ? variable.ciphertext_tensor().tensor_spec()
+         : variable.plaintext_tensor().tensor_spec();
+}
+
+TensorSpec *MutableTensorSpec(bool ciphertext, Model_Variable *variable) {
+  return ciphertext
+         ? variable->mutable_ciphertext_tensor()->mutable_tensor_spec()
+         : variable->mutable_plaintext_tensor()->mutable_tensor_spec();
+}
+
+// Copies everything but the tensor value of `variable` into `target`, and
+// returns the (empty) tensor spec whose value must still be set.
+TensorSpec *CopyVariableStructure(const Model_Variable &variable,
+                                  Model_Variable *target) {
+  target->set_name(variable.name());
+  target->set_trainable(variable.trainable());
+  const auto &tensor_spec = GetTensorSpec(variable);
+  auto *target_spec = MutableTensorSpec(variable.has_ciphertext_tensor(), target);
+  target_spec->set_length(tensor_spec.length());
+  *target_spec->mutable_dimensions() = tensor_spec.dimensions();
+  *target_spec->mutable_type() = tensor_spec.type();
+  return target_spec;
+}
+
+bool SameStructure(const Model_Variable &lhs, const Model_Variable &rhs) {
+  return lhs.name() == rhs.name() &&
+      lhs.has_ciphertext_tensor() == rhs.has_ciphertext_tensor();
+}
+
+// XORs `rhs` into `lhs`; the two values must have the same size.
+void XorInto(const std::string &rhs, std::string *lhs) {
+  auto *out = &(*lhs)[0];
+  for (size_t i = 0; i < rhs.size(); ++i) {
+    out[i] ^= rhs[i];
+  }
+}
+
+} // namespace
+
+bool EncodeModelDelta(const Model &base, const Model &model, Model *delta) {
+
+  if (base.variables_size() != model.variables_size()) {
+    return false;
+  }
+
+  TensorCompression compression;
+  compression.set_codec(TensorCompression_Codec_DEFLATE);
+
+  delta->Clear();
+  for (int i = 0; i < model.variables_size(); ++i) {
+    const auto &variable = model.variables(i);
+    const auto &base_variable = base.variables(i);
+    const auto &value = GetTensorSpec(variable).value();
+    const auto &base_value = GetTensorSpec(base_variable).value();
+    if (!SameStructure(variable, base_variable) ||
+        value.size() != base_value.size()) {
+      return false;
+    }
+
+    auto *delta_spec = CopyVariableStructure(variable, delta->add_variables());
+    std::string xor_value = value;
+    XorInto(base_value, &xor_value);
+    delta_spec->set_value(
+        CompressTensorValue(xor_value, delta_spec->type(), compression));
+  }
+  return true;
+
+}
+
+bool DecodeModelDelta(const Model &base, const Model &delta, Model *model) {
+
+  if (base.variables_size() != delta.variables_size()) {
+    return false;
+  }
+
+  model->Clear();
+  for (int i = 0; i < delta.variables_size(); ++i) {
+    const auto &delta_variable = delta.variables(i);
+    const auto &base_variable = base.variables(i);
+    if (!SameStructure(delta_variable, base_variable)) {
+      return false;
+    }
+
+    auto *spec = CopyVariableStructure(delta_variable, model->add_variables());
+    const auto &base_value = GetTensorSpec(base_variable).value();
+    if (!DecompressTensorValue(GetTensorSpec(delta_variable).value(),
+                               spec->mutable_value()) ||
+        spec->value().size() != base_value.size()) {
+      return false;
+    }
+    XorInto(base_value, spec->mutable_value());
+  }
+  return true;
+
+}
+
+} // namespace metisfl::controller
@@ -0,0 +1,24 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_COMMON_MODEL_DELTA_H_
+#define METISFL_METISFL_CONTROLLER_COMMON_MODEL_DELTA_H_
+
+#include "metisfl/proto/model.pb.h"
+
+namespace metisfl::controller {
+
+// Encodes `model` as a delta against `base`, a model with the same variables,
+// e.g., the community model of a previous round. The value of every variable
+// of `delta` is the XOR of the variable's value and the base variable's value,
+// compressed with CompressTensorValue(). Since consecutive community models
+// differ little, the sign/exponent bytes of the XOR are mostly zero, which
+// byte-shuffling and deflating compress well. Returns false, and leaves
+// `delta` in an unspecified state, if the two models differ in structure.
+bool EncodeModelDelta(const Model &base, const Model &model, Model *delta);
+
+// Restores the model that was encoded by EncodeModelDelta() against `base`.
+// Returns false if the delta is malformed or does not match `base`.
+bool DecodeModelDelta(const Model &base, const Model &delta, Model *model);
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_COMMON_MODEL_DELTA_H_
@@ -0,0 +1,68 @@
+
+#include "metisfl/controller/common/model_delta.h"
+
+#include <random>
+#include <gtest/gtest.h>
+
+#include "metisfl/controller/common/proto_tensor_serde.h"
+
+namespace metisfl::controller {
+namespace {
+
+// Creates the same model on every call, with its weights scaled by
+// (1 + update), similar to the small change of a federation round.
+Model MakeModel(float update) {
+  Model model;
+  std::mt19937 rng(7);
+  std::normal_distribution<float> dist(0.0f, 0.05f);
+  for (int v = 0; v < 3; ++v) {
+    std::vector<float> values(1000);
+    for (auto &value: values) value = dist(rng) * (1.0f + update);
+    auto serialized = ::proto::SerializeTensor<float>(values);
+
+    auto *variable = model.add_variables();
+    variable->set_name("var_" + std::to_string(v));
+    variable->set_trainable(true);
+    auto *tensor_spec = variable->mutable_plaintext_tensor()->mutable_tensor_spec();
+    tensor_spec->set_length(values.size());
+    tensor_spec->add_dimensions(values.size());
+    tensor_spec->mutable_type()->set_type(DType_Type_FLOAT32);
+    tensor_spec->set_value(std::string(serialized.begin(), serialized.end()));
+  }
+  return model;
+}
+
+TEST(ModelDeltaTest, DeltaRestoresTheModel) /* NOLINT */ {
+  auto base = MakeModel(0.0f);
+  auto model = MakeModel(1e-4f);
+
+  Model delta;
+  ASSERT_TRUE(EncodeModelDelta(base, model, &delta));
+  Model decoded;
+  ASSERT_TRUE(DecodeModelDelta(base, delta, &decoded));
+
+  EXPECT_EQ(decoded.SerializeAsString(), model.SerializeAsString());
+}
+
+TEST(ModelDeltaTest, DeltaOfSlightlyChangedModelIsSmaller) /* NOLINT */ {
+  auto base = MakeModel(0.0f);
+  auto model = MakeModel(1e-4f);
+
+  Model delta;
+  ASSERT_TRUE(EncodeModelDelta(base, model, &delta));
+
+  EXPECT_LT(delta.ByteSizeLong(), model.ByteSizeLong() / 2);
+}
+
+TEST(ModelDeltaTest, DifferentStructureIsRejected) /* NOLINT */ {
+  auto base = MakeModel(0.0f);
+  auto model = MakeModel(1e-4f);
+  model.mutable_variables()->RemoveLast();
+
+  Model delta;
+  EXPECT_FALSE(EncodeModelDelta(base, model, &delta));
+  EXPECT_FALSE(DecodeModelDelta(model, base, &delta));
+}
+
+} // namespace
+} // namespace metisfl::controller
@@ -0,0 +1,29 @@
+
+#include "metisfl/controller/common/proto_slice_serde.h"
+
+#include <grpcpp/support/proto_buffer_reader.h>
+
+namespace metisfl::controller {
+
+grpc::Slice SerializeToSlice(const google::protobuf::MessageLite &message) {
+
+  grpc::Slice slice(message.ByteSizeLong());
+  message.SerializeWithCachedSizesToArray(const_cast<uint8_t *>(slice.begin()));
+  return slice;
+
+}
+
+grpc::ByteBuffer ConcatSlices(const std::vector<grpc::Slice> &slices) {
+  return {slices.data(), slices.size()};
+}
+
+bool ParseFromByteBuffer(const grpc::ByteBuffer &buffer,
+                         google::protobuf::MessageLite *message) {
+
+  // The reader does not modify the buffer, it only reads its slices.
+  grpc::ProtoBufferReader reader(const_cast<grpc::ByteBuffer *>(&buffer));
+  return message->ParseFromZeroCopyStream(&reader);
+
+}
+
+} // namespace metisfl::controller
@@ -0,0 +1,31 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_COMMON_PROTO_SLICE_SERDE_H_
+#define METISFL_METISFL_CONTROLLER_COMMON_PROTO_SLICE_SERDE_H_
+
+#include <vector>
+
+#include <google/protobuf/message_lite.h>
+#include <grpcpp/support/byte_buffer.h>
+#include <grpcpp/support/slice.h>
+
+namespace metisfl::controller {
+
+// The protobuf wire format of a message is the concatenation of its encoded
+// fields. Hence, a request can be assembled from independently serialized
+// fields, and the fields that are common to the requests sent to many
+// learners need to be serialized only once.
+
+// Serializes the fields of `message` into a newly allocated slice.
+grpc::Slice SerializeToSlice(const google::protobuf::MessageLite &message);
+
+// Assembles a byte buffer from the given slices. The slices are referenced,
+// not copied, so the same slice can be shared by any number of buffers.
+grpc::ByteBuffer ConcatSlices(const std::vector<grpc::Slice> &slices);
+
+// Parses a byte buffer, e.g., the response of a generic call, into `message`.
+bool ParseFromByteBuffer(const grpc::ByteBuffer &buffer,
+                         google::protobuf::MessageLite *message);
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_COMMON_PROTO_SLICE_SERDE_H_
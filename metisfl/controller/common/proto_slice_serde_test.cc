@@ -0,0 +1,53 @@
+
+#include "metisfl/controller/common/proto_slice_serde.h"
+#include "metisfl/proto/learner.pb.h"
+
+#include <gtest/gtest.h>
+
+namespace metisfl::controller {
+namespace {
+
+FederatedModel MakeFederatedModel() {
+  FederatedModel model;
+  model.set_num_contributors(2);
+  model.set_global_iteration(5);
+  auto *variable = model.mutable_model()->add_variables();
+  variable->set_name("dense");
+  variable->set_trainable(true);
+  auto *tensor_spec = variable->mutable_plaintext_tensor()->mutable_tensor_spec();
+  tensor_spec->set_length(1 << 20);
+  tensor_spec->set_value(std::string(1 << 20, 'x'));
+  return model;
+}
+
+TEST(ProtoSliceSerdeTest, SharedFieldsSliceMatchesFullSerialization) /* NOLINT */ {
+  RunTaskRequest shared_fields;
+  *shared_fields.mutable_federated_model() = MakeFederatedModel();
+  shared_fields.mutable_hyperparameters()->set_batch_size(32);
+  auto shared_fields_slice = SerializeToSlice(shared_fields);
+
+  for (uint32_t num_local_updates: {1u, 300u}) {
+    RunTaskRequest expected = shared_fields;
+    expected.mutable_task()->set_num_local_updates(num_local_updates);
+
+    RunTaskRequest learner_fields;
+    learner_fields.mutable_task()->set_num_local_updates(num_local_updates);
+    auto buffer = ConcatSlices(
+        {SerializeToSlice(learner_fields), shared_fields_slice});
+
+    RunTaskRequest parsed;
+    ASSERT_TRUE(ParseFromByteBuffer(buffer, &parsed));
+    EXPECT_EQ(parsed.SerializeAsString(), expected.SerializeAsString());
+  }
+}
+
+TEST(ProtoSliceSerdeTest, EmptyMessage) /* NOLINT */ {
+  RunTaskResponse response;
+  auto buffer = ConcatSlices({SerializeToSlice(response)});
+  RunTaskResponse parsed;
+  ASSERT_TRUE(ParseFromByteBuffer(buffer, &parsed));
+  EXPECT_FALSE(parsed.has_ack());
+}
+
+} // namespace
+} // namespace metisfl::controller
@@ -5,14 +5,18 @@
 #include "metisfl/proto/model.pb.h"
 
 #include <cstring>
+#include <string>
 #include <vector>
 
 namespace proto {
 namespace {
 
+// Deserializes the given values of the tensor, e.g., the values of a tensor
+// spec that carries their digest instead.
 template<typename T>
-inline std::vector<T> DeserializeTensor(const metisfl::TensorSpec &tensor_spec) {
-  const auto tensor_bytes = tensor_spec.value().c_str();
+inline std::vector<T> DeserializeTensor(const metisfl::TensorSpec &tensor_spec,
+                                        const std::string &tensor_value) {
+  const auto tensor_bytes = tensor_value.c_str();
   const auto tensor_elements_num = tensor_spec.length();
   std::vector<T> deserialized_tensor(tensor_elements_num);
   // Memory copy (memcpy) signature: std::memcpy(dest, src, count) where count
@@ -23,6 +27,11 @@ inline std::vector<T> DeserializeTensor(const metisfl::TensorSpec &tensor_spec)
   return deserialized_tensor;
 }
 
+template<typename T>
+inline std::vector<T> DeserializeTensor(const metisfl::TensorSpec &tensor_spec) {
+  return DeserializeTensor<T>(tensor_spec, tensor_spec.value());
+}
+
 template<typename T>
 inline std::vector<char> SerializeTensor(const std::vector<T> &v) {
   auto num_elements = v.size();
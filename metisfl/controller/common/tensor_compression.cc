@@ -0,0 +1,155 @@
+
+#include "metisfl/controller/common/tensor_compression.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <glog/logging.h>
+#include <zlib.h>
+
+namespace metisfl::controller {
+namespace {
+
+// Every compressed buffer starts with a fixed-size header:
+//   [codec: 1 byte][element width: 1 byte][uncompressed size: 8 bytes]
+constexpr size_t kHeaderSize = 10;
+
+enum class StoredCodec : uint8_t {
+  kRaw = 0,
+  kShuffleDeflate = 1,
+};
+
+void ByteShuffle(const char *in, size_t len, int width, char *out) {
+  const size_t num_elements = len / width;
+  for (size_t i = 0; i < num_elements; ++i) {
+    for (int b = 0; b < width; ++b) {
+      out[b * num_elements + i] = in[i * width + b];
+    }
+  }
+  // Trailing bytes that do not form a whole element are kept in place.
+  std::memcpy(out + num_elements * width, in + num_elements * width,
+              len - num_elements * width);
+}
+
+void ByteUnshuffle(const char *in, size_t len, int width, char *out) {
+  const size_t num_elements = len / width;
+  for (size_t i = 0; i < num_elements; ++i) {
+    for (int b = 0; b < width; ++b) {
+      out[i * width + b] = in[b * num_elements + i];
+    }
+  }
+  std::memcpy(out + num_elements * width, in + num_elements * width,
+              len - num_elements * width);
+}
+
+std::string MakeHeader(StoredCodec codec, int width, uint64_t size) {
+  std::string header(kHeaderSize, '\0');
+  header[0] = static_cast<char>(codec);
+  header[1] = static_cast<char>(width);
+  std::memcpy(&header[2], &size, sizeof(size));
+  return header;
+}
+
+} // namespace
+
+int DTypeElementWidth(const DType &dtype) {
+  switch (dtype.type()) {
+    case DType_Type_INT8:
+    case DType_Type_UINT8:
+      return 1;
+    case DType_Type_INT16:
+    case DType_Type_UINT16:
+      return 2;
+    case DType_Type_INT32:
+    case DType_Type_UINT32:
+    case DType_Type_FLOAT32:
+      return 4;
+    case DType_Type_INT64:
+    case DType_Type_UINT64:
+    case DType_Type_FLOAT64:
+      return 8;
+    default:
+      return 1;
+  }
+}
+
+std::string CompressTensorValue(const std::string &value,
+                                const DType &dtype,
+                                const TensorCompression &compression) {
+
+  if (compression.codec() == TensorCompression_Codec_NONE || value.empty()) {
+    return MakeHeader(StoredCodec::kRaw, 1, value.size()) + value;
+  }
+
+  // Single-byte dtypes gain nothing from shuffling.
+  const int width = DTypeElementWidth(dtype);
+  std::string shuffled;
+  const char *input = value.data();
+  if (width > 1) {
+    shuffled.resize(value.size());
+    ByteShuffle(value.data(), value.size(), width, &shuffled[0]);
+    input = shuffled.data();
+  }
+
+  int level = compression.level() == 0
+              ? Z_BEST_SPEED
+              : (int) std::min(compression.level(), kMaxDeflateLevel);
+  uLongf compressed_size = compressBound(value.size());
+  std::string compressed = MakeHeader(StoredCodec::kShuffleDeflate, width, value.size());
+  compressed.resize(kHeaderSize + compressed_size);
+  auto ret = compress2(reinterpret_cast<Bytef *>(&compressed[kHeaderSize]), &compressed_size,
+                       reinterpret_cast<const Bytef *>(input), value.size(), level);
+
+  if (ret != Z_OK) {
+    LOG(ERROR) << "Failed to deflate tensor values (zlib error " << ret
+               << "), storing them uncompressed.";
+  }
+  if (ret != Z_OK || compressed_size >= value.size()) {
+    return MakeHeader(StoredCodec::kRaw, 1, value.size()) + value;
+  }
+  compressed.resize(kHeaderSize + compressed_size);
+  compressed.shrink_to_fit();
+  return compressed;
+}
+
+bool DecompressTensorValue(const std::string &compressed, std::string *value) {
+
+  if (compressed.size() < kHeaderSize) {
+    return false;
+  }
+
+  auto codec = static_cast<StoredCodec>(compressed[0]);
+  int width = static_cast<uint8_t>(compressed[1]);
+  uint64_t size;
+  std::memcpy(&size, &compressed[2], sizeof(size));
+
+  if (codec == StoredCodec::kRaw) {
+    value->assign(compressed, kHeaderSize, std::string::npos);
+    return value->size() == size;
+  }
+
+  if (codec != StoredCodec::kShuffleDeflate || width == 0) {
+    return false;
+  }
+
+  // Inflate into the output directly when there is nothing to unshuffle.
+  std::string shuffled;
+  std::string *inflated = width > 1 ? &shuffled : value;
+  inflated->resize(size);
+  uLongf inflated_size = size;
+  auto ret = uncompress(reinterpret_cast<Bytef *>(&(*inflated)[0]), &inflated_size,
+                        reinterpret_cast<const Bytef *>(&compressed[kHeaderSize]),
+                        compressed.size() - kHeaderSize);
+  if (ret != Z_OK || inflated_size != size) {
+    return false;
+  }
+
+  if (width > 1) {
+    value->resize(size);
+    ByteUnshuffle(shuffled.data(), size, width, &(*value)[0]);
+  }
+  return true;
+}
+
+} // namespace metisfl::controller
@@ -0,0 +1,37 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_COMMON_TENSOR_COMPRESSION_H_
+#define METISFL_METISFL_CONTROLLER_COMMON_TENSOR_COMPRESSION_H_
+
+#include <cstdint>
+#include <string>
+
+#include "metisfl/proto/metis.pb.h"
+#include "metisfl/proto/model.pb.h"
+
+namespace metisfl::controller {
+
+// The compression levels of the DEFLATE codec; level 0 (not set) is mapped
+// to the fastest level, levels above the highest one are clamped to it.
+constexpr uint32_t kMinDeflateLevel = 1;
+constexpr uint32_t kMaxDeflateLevel = 9;
+
+// Returns the width in bytes of a single element of the given dtype.
+int DTypeElementWidth(const DType &dtype);
+
+// Compresses the serialized values of a tensor. For multi-byte dtypes the
+// values are first byte-shuffled, i.e., the i-th byte of every element is
+// grouped together, which turns the slowly varying sign/exponent bytes of
+// model weights into long compressible runs. The returned buffer is
+// self-describing and must be decompressed with DecompressTensorValue().
+// If the codec does not reduce the size, the values are stored uncompressed.
+std::string CompressTensorValue(const std::string &value,
+                                const DType &dtype,
+                                const TensorCompression &compression);
+
+// Restores the tensor values of a buffer created by CompressTensorValue()
+// directly into `value`. Returns false if the buffer is malformed.
+bool DecompressTensorValue(const std::string &compressed, std::string *value);
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_COMMON_TENSOR_COMPRESSION_H_
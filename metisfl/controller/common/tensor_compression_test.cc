@@ -0,0 +1,99 @@
+
+#include "metisfl/controller/common/proto_tensor_serde.h"
+#include "metisfl/controller/common/tensor_compression.h"
+#include "metisfl/proto/model.pb.h"
+
+#include <random>
+#include <gtest/gtest.h>
+
+namespace metisfl::controller {
+namespace {
+
+template<typename T>
+std::string SerializeValues(const std::vector<T> &values) {
+  auto serialized = ::proto::SerializeTensor<T>(values);
+  return std::string(serialized.begin(), serialized.end());
+}
+
+DType MakeDType(DType_Type type) {
+  DType dtype;
+  dtype.set_type(type);
+  dtype.set_byte_order(DType_ByteOrder_LITTLE_ENDIAN_ORDER);
+  return dtype;
+}
+
+class TensorCompressionTest : public ::testing::Test {
+ public:
+  TensorCompressionTest() {
+    deflate_.set_codec(TensorCompression_Codec_DEFLATE);
+  }
+
+ protected:
+  TensorCompression deflate_;
+};
+
+TEST_F(TensorCompressionTest, RoundTripFLOAT64) /* NOLINT */ {
+  // Weights of similar magnitude share their sign/exponent bytes.
+  std::vector<double> values(10000);
+  std::mt19937 rng(7);
+  std::normal_distribution<double> dist(0.0, 0.05);
+  for (auto &value: values) value = dist(rng);
+  auto serialized = SerializeValues(values);
+
+  auto compressed = CompressTensorValue(serialized, MakeDType(DType_Type_FLOAT64), deflate_);
+  EXPECT_LT(compressed.size(), serialized.size());
+
+  std::string restored;
+  ASSERT_TRUE(DecompressTensorValue(compressed, &restored));
+  EXPECT_EQ(restored, serialized);
+}
+
+TEST_F(TensorCompressionTest, RoundTripINT8) /* NOLINT */ {
+  std::vector<signed char> values(1001);
+  for (int i = 0; i < (int) values.size(); ++i) values[i] = (signed char) (i % 7);
+  auto serialized = SerializeValues(values);
+
+  auto compressed = CompressTensorValue(serialized, MakeDType(DType_Type_INT8), deflate_);
+  EXPECT_LT(compressed.size(), serialized.size());
+
+  std::string restored;
+  ASSERT_TRUE(DecompressTensorValue(compressed, &restored));
+  EXPECT_EQ(restored, serialized);
+}
+
+TEST_F(TensorCompressionTest, IncompressibleValuesAreKeptRaw) /* NOLINT */ {
+  std::string serialized(4099, '\0');
+  std::mt19937 rng(11);
+  for (auto &byte: serialized) byte = (char) (rng() & 0xFF);
+
+  auto compressed = CompressTensorValue(serialized, MakeDType(DType_Type_FLOAT32), deflate_);
+  EXPECT_LE(compressed.size(), serialized.size() + 16);
+
+  std::string restored;
+  ASSERT_TRUE(DecompressTensorValue(compressed, &restored));
+  EXPECT_EQ(restored, serialized);
+}
+
+TEST_F(TensorCompressionTest, OutOfRangeLevelIsClamped) /* NOLINT */ {
+  std::vector<double> values(10000);
+  for (int i = 0; i < (int) values.size(); ++i) values[i] = i % 13;
+  auto serialized = SerializeValues(values);
+
+  // zlib rejects levels above 9, which must not disable the compression.
+  auto compression = deflate_;
+  compression.set_level(42);
+  auto compressed = CompressTensorValue(serialized, MakeDType(DType_Type_FLOAT64), compression);
+  EXPECT_LT(compressed.size(), serialized.size());
+
+  std::string restored;
+  ASSERT_TRUE(DecompressTensorValue(compressed, &restored));
+  EXPECT_EQ(restored, serialized);
+}
+
+TEST_F(TensorCompressionTest, MalformedBufferIsRejected) /* NOLINT */ {
+  std::string restored;
+  EXPECT_FALSE(DecompressTensorValue("abc", &restored));
+}
+
+} // namespace
+} // namespace metisfl::controller
@@ -0,0 +1,154 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_COMMON_TENSOR_DIGEST_H_
+#define METISFL_METISFL_CONTROLLER_COMMON_TENSOR_DIGEST_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace metisfl::controller {
+
+// A 128-bit content digest of a tensor's serialized values. The model store
+// uses the digest as the key of the (shared) tensor blob.
+struct TensorDigest {
+  uint64_t high = 0;
+  uint64_t low = 0;
+
+  static constexpr size_t kNumBytes = 16;
+
+  bool operator==(const TensorDigest &other) const {
+    return high == other.high && low == other.low;
+  }
+
+  bool operator!=(const TensorDigest &other) const {
+    return !(*this == other);
+  }
+
+  template<typename H>
+  friend H AbslHashValue(H h, const TensorDigest &digest) {
+    return H::combine(std::move(h), digest.high, digest.low);
+  }
+
+  // Fixed-width binary form (16 bytes), used when the digest is stored
+  // alongside a model, e.g., in place of the tensor value.
+  std::string ToBytes() const {
+    std::string bytes(kNumBytes, '\0');
+    std::memcpy(&bytes[0], &high, sizeof(high));
+    std::memcpy(&bytes[sizeof(high)], &low, sizeof(low));
+    return bytes;
+  }
+
+  static bool FromBytes(const std::string &bytes, TensorDigest *digest) {
+    if (bytes.size() != kNumBytes) return false;
+    std::memcpy(&digest->high, bytes.data(), sizeof(digest->high));
+    std::memcpy(&digest->low, bytes.data() + sizeof(digest->high), sizeof(digest->low));
+    return true;
+  }
+
+  // Hexadecimal form (32 chars), used when the digest is part of a key.
+  std::string ToHex() const {
+    static const char kHex[] = "0123456789abcdef";
+    std::string hex(2 * kNumBytes, '0');
+    for (int i = 0; i < 16; ++i) {
+      hex[15 - i] = kHex[(high >> (4 * i)) & 0xF];
+      hex[31 - i] = kHex[(low >> (4 * i)) & 0xF];
+    }
+    return hex;
+  }
+};
+
+namespace internal {
+
+inline uint64_t DigestRotl64(uint64_t x, int8_t r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t DigestFmix64(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+} // namespace internal
+
+// Computes the 128-bit digest of the given byte range (MurmurHash3 x64_128).
+// It is fast enough to run on every inserted tensor, and accidental
+// collisions are negligible. It is not a cryptographic hash, though: inputs
+// with the same digest are easy to craft, for any seed. Whoever shares data
+// by digest must therefore compare the bytes on a digest match.
+inline TensorDigest DigestBytes(const void *data, size_t len, uint64_t seed = 0) {
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  const size_t num_blocks = len / 16;
+
+  uint64_t h1 = seed;
+  uint64_t h2 = seed;
+  const uint64_t c1 = 0x87c37b91114253d5ULL;
+  const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+  for (size_t i = 0; i < num_blocks; ++i) {
+    uint64_t k1, k2;
+    std::memcpy(&k1, bytes + i * 16, sizeof(k1));
+    std::memcpy(&k2, bytes + i * 16 + 8, sizeof(k2));
+
+    k1 *= c1; k1 = internal::DigestRotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    h1 = internal::DigestRotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+    k2 *= c2; k2 = internal::DigestRotl64(k2, 33); k2 *= c1; h2 ^= k2;
+    h2 = internal::DigestRotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+  }
+
+  const uint8_t *tail = bytes + num_blocks * 16;
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  switch (len & 15) {
+    case 15: k2 ^= ((uint64_t) tail[14]) << 48;
+      [[fallthrough]];
+    case 14: k2 ^= ((uint64_t) tail[13]) << 40;
+      [[fallthrough]];
+    case 13: k2 ^= ((uint64_t) tail[12]) << 32;
+      [[fallthrough]];
+    case 12: k2 ^= ((uint64_t) tail[11]) << 24;
+      [[fallthrough]];
+    case 11: k2 ^= ((uint64_t) tail[10]) << 16;
+      [[fallthrough]];
+    case 10: k2 ^= ((uint64_t) tail[9]) << 8;
+      [[fallthrough]];
+    case 9: k2 ^= ((uint64_t) tail[8]);
+      k2 *= c2; k2 = internal::DigestRotl64(k2, 33); k2 *= c1; h2 ^= k2;
+      [[fallthrough]];
+    case 8: k1 ^= ((uint64_t) tail[7]) << 56;
+      [[fallthrough]];
+    case 7: k1 ^= ((uint64_t) tail[6]) << 48;
+      [[fallthrough]];
+    case 6: k1 ^= ((uint64_t) tail[5]) << 40;
+      [[fallthrough]];
+    case 5: k1 ^= ((uint64_t) tail[4]) << 32;
+      [[fallthrough]];
+    case 4: k1 ^= ((uint64_t) tail[3]) << 24;
+      [[fallthrough]];
+    case 3: k1 ^= ((uint64_t) tail[2]) << 16;
+      [[fallthrough]];
+    case 2: k1 ^= ((uint64_t) tail[1]) << 8;
+      [[fallthrough]];
+    case 1: k1 ^= ((uint64_t) tail[0]);
+      k1 *= c1; k1 = internal::DigestRotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    default: break;
+  }
+
+  h1 ^= len; h2 ^= len;
+  h1 += h2; h2 += h1;
+  h1 = internal::DigestFmix64(h1); h2 = internal::DigestFmix64(h2);
+  h1 += h2; h2 += h1;
+
+  return TensorDigest{h1, h2};
+}
+
+inline TensorDigest DigestBytes(const std::string &bytes) {
+  return DigestBytes(bytes.data(), bytes.size());
+}
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_COMMON_TENSOR_DIGEST_H_
@@ -0,0 +1,155 @@
+#ifndef METISFL_METISFL_CONTROLLER_CORE_AHEAD_TASKS_H_
+#define METISFL_METISFL_CONTROLLER_CORE_AHEAD_TASKS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <google/protobuf/timestamp.pb.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "metisfl/controller/store/model_store.h"
+#include "metisfl/proto/metis.pb.h"
+
+namespace metisfl::controller {
+
+// Keeps track of the tasks that the learners run, or have completed, ahead
+// of the current round, if the synchronous rounds are pipelined. The model
+// of a task that was completed ahead of its round is held back from the
+// model store, i.e., it has been ingested by a model writer that is not
+// committed yet, until the round starts. Otherwise, the current round would
+// aggregate the learner's model of a later round in place of its model of
+// the current round. The tracker is not thread-safe.
+class AheadTasks {
+ public:
+  // The task of a later round that a learner was assigned while the current
+  // round was running.
+  struct RunningTask {
+    uint32_t global_iteration;
+    google::protobuf::Timestamp submitted_at;
+  };
+
+  // A task that a learner completed ahead of its round, along with its
+  // model, which is committed to the store once the round starts.
+  struct CompletedTask {
+    std::string learner_id;
+    CompletedLearningTask task;
+    google::protobuf::Timestamp submitted_at;
+    google::protobuf::Timestamp received_at;
+    std::shared_ptr<ModelStore::ModelWriter> model;
+  };
+
+  const absl::flat_hash_map<std::string, RunningTask> &running() const {
+    return running_;
+  }
+
+  bool IsRunning(const std::string &learner_id) const {
+    return running_.contains(learner_id);
+  }
+
+  void Run(const std::string &learner_id,
+           uint32_t global_iteration,
+           google::protobuf::Timestamp submitted_at) {
+    running_[learner_id] = {global_iteration, std::move(submitted_at)};
+  }
+
+  // Stops tracking the task that the learner runs ahead, since the learner
+  // has completed it, and returns the time the task was submitted.
+  std::optional<google::protobuf::Timestamp>
+  TakeRunning(const std::string &learner_id) {
+    auto it = running_.find(learner_id);
+    if (it == running_.end()) {
+      return std::nullopt;
+    }
+    auto submitted_at = std::move(it->second.submitted_at);
+    running_.erase(it);
+    return submitted_at;
+  }
+
+  // Holds the task, and its uncommitted model, until its round starts.
+  void Hold(CompletedTask &&completed) {
+    completed_.push_back(std::move(completed));
+  }
+
+  // Returns the earliest round after `global_iteration`, i.e., the current
+  // round, whose task the learner has not completed yet.
+  uint32_t NextRound(const std::string &learner_id,
+                     uint32_t global_iteration) const {
+    auto next_round = global_iteration + 1;
+    for (const auto &completed: completed_) {
+      if (completed.learner_id == learner_id) {
+        next_round = std::max(
+            next_round,
+            completed.task.execution_metadata().global_iteration() + 1);
+      }
+    }
+    return next_round;
+  }
+
+  // Removes from the cohort of the round `global_iteration` the learners
+  // that already run ahead on the round or on a later round, or have
+  // already completed the round, and returns the tasks of the round that
+  // were completed ahead of it. The tasks of the learners that are no longer
+  // registered are dropped, along with their models.
+  std::vector<CompletedTask>
+  Take(uint32_t global_iteration,
+       const std::function<bool(const std::string &)> &is_registered,
+       std::vector<std::string> *cohort) {
+
+    // The tasks of earlier rounds were assigned to learners that have since
+    // departed; otherwise, they would have completed them.
+    for (auto it = running_.begin(); it != running_.end();) {
+      if (it->second.global_iteration < global_iteration) {
+        running_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+
+    absl::flat_hash_set<std::string> ahead;
+    std::vector<CompletedTask> taken;
+    std::vector<CompletedTask> still_ahead;
+    for (auto &completed: completed_) {
+      if (!is_registered(completed.learner_id)) {
+        continue;
+      }
+      ahead.insert(completed.learner_id);
+      if (completed.task.execution_metadata().global_iteration() == global_iteration) {
+        taken.push_back(std::move(completed));
+      } else {
+        still_ahead.push_back(std::move(completed));
+      }
+    }
+    completed_ = std::move(still_ahead);
+    for (const auto &[learner_id, running]: running_) {
+      ahead.insert(learner_id);
+    }
+
+    cohort->erase(std::remove_if(cohort->begin(), cohort->end(),
+                                 [&ahead](const std::string &learner_id) {
+                                   return ahead.contains(learner_id);
+                                 }),
+                  cohort->end());
+    return taken;
+  }
+
+  // Drops all tasks, along with the models that are held back.
+  void Clear() {
+    running_.clear();
+    completed_.clear();
+  }
+
+ private:
+  absl::flat_hash_map<std::string, RunningTask> running_;
+  std::vector<CompletedTask> completed_;
+};
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_CORE_AHEAD_TASKS_H_
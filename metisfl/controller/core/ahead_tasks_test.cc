@@ -0,0 +1,137 @@
+#include "metisfl/controller/core/ahead_tasks.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "metisfl/controller/store/store.h"
+
+namespace metisfl::controller {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+Model GenerateModel(const std::string &value) {
+  Model model;
+  auto *variable = model.add_variables();
+  variable->set_name("var1");
+  auto *tensor_spec = variable->mutable_plaintext_tensor()->mutable_tensor_spec();
+  tensor_spec->set_length(value.size());
+  tensor_spec->add_dimensions(value.size());
+  tensor_spec->set_value(value);
+  return model;
+}
+
+std::unique_ptr<ModelStore> NewModelStore() {
+  InMemoryStore in_memory_store;
+  in_memory_store.mutable_model_store_specs()
+      ->mutable_lineage_length_eviction()->set_lineage_length(1);
+  return std::make_unique<HashMapModelStore>(in_memory_store);
+}
+
+std::shared_ptr<ModelStore::ModelWriter> IngestModel(
+    ModelStore *model_store, const std::string &learner_id,
+    const Model &model) {
+  std::shared_ptr<ModelStore::ModelWriter> model_writer =
+      model_store->NewModelWriter(learner_id);
+  for (const auto &variable: model.variables()) {
+    model_writer->AppendVariable(Model_Variable(variable));
+  }
+  return model_writer;
+}
+
+AheadTasks::CompletedTask CompletedTask(
+    const std::string &learner_id, uint32_t global_iteration,
+    std::shared_ptr<ModelStore::ModelWriter> model) {
+  AheadTasks::CompletedTask completed{learner_id};
+  completed.task.mutable_execution_metadata()
+      ->set_global_iteration(global_iteration);
+  completed.model = std::move(model);
+  return completed;
+}
+
+std::string SelectedModel(ModelStore *model_store,
+                          const std::string &learner_id) {
+  auto selected = model_store->SelectModels({{learner_id, 1}});
+  if (selected[learner_id].empty()) {
+    return "";
+  }
+  return selected[learner_id][0]->variables(0)
+      .plaintext_tensor().tensor_spec().value();
+}
+
+// NOLINTNEXTLINE
+TEST(AheadTasks, ModelOfLearnerOneRoundAheadIsHeldUntilItsRound) {
+  auto model_store = NewModelStore();
+  AheadTasks ahead_tasks;
+  auto is_registered = [](const std::string &) { return true; };
+
+  // Learner "a" completes round 1, runs ahead on round 2 while "b" still
+  // runs round 1, and completes round 2 before round 1 is released.
+  IngestModel(model_store.get(), "a", GenerateModel("round-1"))->Commit();
+  ahead_tasks.Run("a", 2, {});
+  ASSERT_TRUE(ahead_tasks.TakeRunning("a").has_value());
+  ahead_tasks.Hold(CompletedTask(
+      "a", 2, IngestModel(model_store.get(), "a", GenerateModel("round-2"))));
+  EXPECT_EQ(ahead_tasks.NextRound("a", 1), 3);
+  EXPECT_EQ(ahead_tasks.NextRound("b", 1), 2);
+
+  // Round 1 aggregates the learner's model of round 1.
+  EXPECT_EQ(SelectedModel(model_store.get(), "a"), "round-1");
+
+  // Round 2 starts: "a" has already completed it and is not assigned it
+  // again; its model enters the store and counts once towards round 2.
+  std::vector<std::string> cohort = {"a", "b"};
+  auto taken = ahead_tasks.Take(2, is_registered, &cohort);
+  EXPECT_THAT(cohort, ElementsAre("b"));
+  ASSERT_EQ(taken.size(), 1);
+  EXPECT_EQ(taken[0].learner_id, "a");
+  taken[0].model->Commit();
+  EXPECT_EQ(SelectedModel(model_store.get(), "a"), "round-2");
+  EXPECT_EQ(model_store->GetLearnerLineageLength("a"), 1);
+
+  // Round 3 is not completed ahead by anyone.
+  cohort = {"a", "b"};
+  EXPECT_THAT(ahead_tasks.Take(3, is_registered, &cohort), IsEmpty());
+  EXPECT_THAT(cohort, ElementsAre("a", "b"));
+  model_store->ResetState();
+}
+
+// NOLINTNEXTLINE
+TEST(AheadTasks, LearnersRunningAheadAreRemovedFromCohort) {
+  AheadTasks ahead_tasks;
+  auto is_registered = [](const std::string &) { return true; };
+  ahead_tasks.Run("a", 2, {});
+  ahead_tasks.Run("b", 3, {});
+  // A task of an earlier round was assigned to a learner that departed.
+  ahead_tasks.Run("c", 1, {});
+
+  std::vector<std::string> cohort = {"a", "b", "c", "d"};
+  EXPECT_THAT(ahead_tasks.Take(2, is_registered, &cohort), IsEmpty());
+  EXPECT_THAT(cohort, ElementsAre("c", "d"));
+  EXPECT_TRUE(ahead_tasks.IsRunning("a"));
+  EXPECT_FALSE(ahead_tasks.IsRunning("c"));
+}
+
+// NOLINTNEXTLINE
+TEST(AheadTasks, ModelsOfDepartedLearnersAreDropped) {
+  auto model_store = NewModelStore();
+  AheadTasks ahead_tasks;
+  ahead_tasks.Hold(CompletedTask(
+      "a", 2, IngestModel(model_store.get(), "a", GenerateModel("round-2"))));
+
+  std::vector<std::string> cohort = {"b"};
+  auto taken = ahead_tasks.Take(
+      2, [](const std::string &learner_id) { return learner_id != "a"; },
+      &cohort);
+  EXPECT_THAT(taken, IsEmpty());
+  EXPECT_THAT(cohort, ElementsAre("b"));
+  EXPECT_EQ(model_store->GetLearnerLineageLength("a"), 0);
+  EXPECT_EQ(model_store->GetResidentBytes(), 0);
+}
+
+} // namespace
+} // namespace metisfl::controller
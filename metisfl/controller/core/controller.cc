@@ -1,4 +1,11 @@
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <utility>
 #include <thread>
@@ -8,13 +15,23 @@
 #include <grpcpp/impl/codegen/async_unary_call.h>
 #include <grpcpp/client_context.h>
 #include <grpcpp/completion_queue.h>
-#include <grpcpp/create_channel.h>
+#include <grpcpp/generic/generic_stub.h>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
+#include "metisfl/controller/core/ahead_tasks.h"
 #include "metisfl/controller/core/controller.h"
+#include "metisfl/controller/core/controller_checkpoint.h"
 #include "metisfl/controller/core/controller_utils.h"
+#include "metisfl/controller/core/learner_channel.h"
+#include "metisfl/controller/common/bounded_lineage.h"
 #include "metisfl/controller/common/bs_thread_pool.h"
+#include "metisfl/controller/common/lane_executor.h"
+#include "metisfl/controller/common/liveness_tracker.h"
 #include "metisfl/controller/common/macros.h"
+#include "metisfl/controller/common/model_chunking.h"
+#include "metisfl/controller/common/model_delta.h"
+#include "metisfl/controller/common/proto_slice_serde.h"
 #include "metisfl/controller/common/proto_tensor_serde.h"
 #include "metisfl/proto/learner.grpc.pb.h"
 #include "metisfl/proto/metis.pb.h"
@@ -24,6 +41,67 @@ namespace {
 
 using google::protobuf::util::TimeUtil;
 
+// The (approximate) size of the chunks in which community models are served.
+constexpr size_t kCommunityModelChunkBytes = 1 << 20;
+
+// The number of most recent community model versions that can be fetched.
+// Previous versions are kept, so that learners that were assigned a task
+// right before a new community model was computed can still fetch theirs,
+// and so that learners can fetch a new version as a delta against the
+// version they already hold, even if they missed a few rounds.
+constexpr size_t kNumCachedCommunityModels = 4;
+
+// How often the controller checks whether the current round has expired,
+// and whether the learners' liveness must be checked.
+constexpr std::chrono::seconds kTimerInterval(1);
+
+// The lanes of the scheduling executor. The control lane handles the
+// learners' joins and departures, which must not wait for the round lane,
+// which computes and dispatches the rounds. The round lane has two workers,
+// which also run control work when they are idle.
+constexpr size_t kControlLane = 0;
+constexpr size_t kRoundLane = 1;
+constexpr size_t kNumControlWorkers = 1;
+constexpr size_t kNumRoundWorkers = 2;
+
+// The default number of consecutive missed heartbeats after which a learner
+// is suspected to have failed, and after which it is evicted.
+constexpr uint32_t kDefaultSuspectAfterMissedBeats = 3;
+constexpr uint32_t kDefaultDeadAfterMissedBeats = 6;
+
+// The default number of most recent federation rounds, and most recent
+// tasks of every learner, whose metadata are kept in memory.
+constexpr size_t kDefaultMaxRetainedRounds = 1000;
+constexpr size_t kDefaultMaxRetainedLocalTasks = 100;
+
+size_t MaxRetainedRounds(const LineageSpecs &specs) {
+  return specs.max_retained_rounds() == 0
+         ? kDefaultMaxRetainedRounds : specs.max_retained_rounds();
+}
+
+size_t MaxRetainedLocalTasks(const LineageSpecs &specs) {
+  return specs.max_retained_local_tasks() == 0
+         ? kDefaultMaxRetainedLocalTasks : specs.max_retained_local_tasks();
+}
+
+uint32_t SuspectAfterMissedBeats(const LivenessSpecs &specs) {
+  return specs.suspect_after_missed_beats() == 0
+         ? kDefaultSuspectAfterMissedBeats : specs.suspect_after_missed_beats();
+}
+
+uint32_t DeadAfterMissedBeats(const LivenessSpecs &specs) {
+  return specs.dead_after_missed_beats() == 0
+         ? kDefaultDeadAfterMissedBeats : specs.dead_after_missed_beats();
+}
+
+std::string LineageSpillPath(const LineageSpecs &specs,
+                             const std::string &file_name) {
+  if (specs.spill_dir().empty()) {
+    return "";
+  }
+  return (std::filesystem::path(specs.spill_dir()) / file_name).string();
+}
+
 class ControllerDefaultImpl : public Controller {
  public:
   ControllerDefaultImpl(ControllerParams &&params,
@@ -32,53 +110,109 @@ class ControllerDefaultImpl : public Controller {
                         std::unique_ptr<Scheduler> scheduler,
                         std::unique_ptr<Selector> selector,
                         std::unique_ptr<ModelStore> model_store)
-      : params_(std::move(params)), global_iteration_(0), learners_(),
-        learners_stub_(), learners_task_template_(), learners_mutex_(),
-        scaler_(std::move(scaler)), aggregator_(std::move(aggregator)),
+      : params_(std::move(params)), global_iteration_(0),
+        metadata_(MaxRetainedRounds(params_.lineage_specs()),
+                  LineageSpillPath(params_.lineage_specs(),
+                                   "runtime_metadata.log")),
+        learners_(std::make_shared<const LearnerStates>()),
+        learners_stub_(), learners_task_template_(),
+        cohort_sampler_(params_.global_model_specs().cohort_sampling() ==
+            GlobalModelSpecs::NUM_TRAINING_EXAMPLES),
+        learners_mutex_(), scheduling_mutex_(), initial_cohort_size_(0),
+        community_evaluations_(MaxRetainedRounds(params_.lineage_specs()),
+                               LineageSpillPath(params_.lineage_specs(),
+                                                "community_evaluations.log")),
+        scaler_(std::move(scaler)), contributed_scaling_factors_(),
+        aggregator_(std::move(aggregator)),
         scheduler_(std::move(scheduler)), selector_(std::move(selector)),
-        community_model_(), scheduling_pool_(2),
-        model_store_(std::move(model_store)), model_store_mutex_(),
-        run_tasks_cq_(), eval_tasks_cq_() {
+        community_model_(std::make_shared<const FederatedModel>()),
+        community_model_version_(0), community_model_cache_(),
+        registration_mutex_(), registration_cv_(), pending_registrations_(),
+        registering_(false), joining_mutex_(), joining_learners_(),
+        scheduling_executor_({kNumControlWorkers, kNumRoundWorkers}),
+        model_store_(std::move(model_store)), ahead_tasks_(),
+        checkpoint_pool_(1),
+        checkpoint_in_flight_(false), run_tasks_cq_(), run_tasks_mutex_(),
+        run_tasks_stopped_(false), run_tasks_in_flight_(),
+        run_tasks_digest_(), timer_(),
+        timer_mutex_(), timer_cv_(), timer_stopped_(false),
+        round_timer_pending_(false),
+        liveness_(SuspectAfterMissedBeats(params_.liveness_specs()),
+                  DeadAfterMissedBeats(params_.liveness_specs())),
+        liveness_mutex_() {
+
+    // The models that the aggregation rule requires from every learner
+    // must never be evicted by the store's (byte-budget) eviction policy.
+    model_store_->SetProtectedLineageLength(
+        aggregator_->RequiredLearnerLineageLength());
+    // Selected models carry tensor digests; the aggregator restores the
+    // values from the store one variable at a time.
+    aggregator_->SetTensorValueResolver(
+        [store = model_store_.get()](const TensorSpec &tensor_spec) {
+          return store->ResolveTensorValue(tensor_spec);
+        });
 
-    // We perform the following detachment because we want to have only
+    const auto &spill_dir = params_.lineage_specs().spill_dir();
+    if (!spill_dir.empty()) {
+      std::error_code error;
+      std::filesystem::create_directories(spill_dir, error);
+      if (error) {
+        PLOG(WARNING) << "Cannot create lineage spill directory " << spill_dir
+                      << ": " << error.message();
+      }
+    }
+
+    // We run the following thread because we want to have only
     // one thread and one completion queue to handle asynchronous request
     // submission and digestion. In the previous implementation, we were
     // always spawning a new thread for every run task request and a new
     // thread for every evaluate model request. With the refactoring,
     // there is only one thread to handle all SendRunTask requests
-    // submission, one thread to handle all EvaluateModel requests
-    // submission and one thread to digest SendRunTask responses
-    // and one thread to digest EvaluateModel responses.
+    // submission and one thread to digest SendRunTask responses. The
+    // community model is evaluated by the learners as part of their
+    // training task, hence there are no separate evaluation requests.
 
     // One thread to handle learners' responses to RunTasks requests.
-    std::thread run_tasks_digest_t_(
-        &ControllerDefaultImpl::DigestRunTasksResponses, this);
-    run_tasks_digest_t_.detach();
+    run_tasks_digest_ =
+        std::thread(&ControllerDefaultImpl::DigestRunTasksResponses, this);
 
-    // One thread to handle learners' responses to EvaluateModel requests.
-    std::thread eval_tasks_digest_t_(
-        &ControllerDefaultImpl::DigestEvaluationTasksResponses, this);
-    eval_tasks_digest_t_.detach();
+    // The timer only runs if the rounds have a deadline, or if the
+    // learners' liveness is tracked.
+    if (HasRoundDeadline() || TracksLiveness()) {
+      timer_ = std::thread(&ControllerDefaultImpl::RunTimer, this);
+    }
 
   }
 
+  ~ControllerDefaultImpl() override {
+    // The timer and the digestion of the RunTasks responses reference the
+    // controller; they must not outlive it if the controller is destroyed
+    // without being shut down. They are stopped before the scheduling work
+    // is drained, since both of them push scheduling work.
+    StopTimer();
+    StopRunTasks();
+    scheduling_executor_.WaitForTasks();
+    // The snapshot being written references the controller as well.
+    checkpoint_pool_.wait_for_tasks();
+  }
+
   const ControllerParams &GetParams() const override { return params_; }
 
   std::vector<LearnerDescriptor> GetLearners() const override {
 
     // TODO(stripeli): Shall we 'hide' authentication token from exposure?
     std::vector<LearnerDescriptor> learners;
-    for (const auto &[key, learner_state]: learners_) {
+    for (const auto &[key, learner_state]: *Learners()) {
       learners.push_back(learner_state.learner());
     }
     return learners;
 
   }
 
-  uint32_t GetNumLearners() const override { return learners_.size(); }
+  uint32_t GetNumLearners() const override { return Learners()->size(); }
 
-  const FederatedModel &CommunityModel() const override {
-    return community_model_;
+  std::shared_ptr<const FederatedModel> CommunityModel() const override {
+    return std::atomic_load(&community_model_);
   }
 
   // TODO(stripeli): add admin auth token support for replacing model.
@@ -89,8 +223,10 @@ class ControllerDefaultImpl : public Controller {
     // contributed to this model and the actual model. We do not replace the
     // global iteration since it is updated exclusively by the controller.
     PLOG(INFO) << "Replacing community model.";
-    community_model_.set_num_contributors(model.num_contributors());
-    *community_model_.mutable_model() = model.model();
+    auto community_model = std::make_shared<FederatedModel>(*CommunityModel());
+    community_model->set_num_contributors(model.num_contributors());
+    *community_model->mutable_model() = model.model();
+    PublishCommunityModel(std::move(community_model));
     return absl::OkStatus();
 
   }
@@ -99,11 +235,6 @@ class ControllerDefaultImpl : public Controller {
   AddLearner(const ServerEntity &server_entity,
              const DatasetSpec &dataset_spec) override {
 
-    // Acquires a lock to avoid having multiple threads overwriting the learners'
-    // data structures. The guard releases the mutex as soon as it goes out of
-    // scope so no need to manually release it in the code.
-    std::lock_guard<std::mutex> learners_guard(learners_mutex_);
-
     // Validates non-empty hostname and non-negative port.
     if (server_entity.hostname().empty() || server_entity.port() < 0) {
       return absl::InvalidArgumentError("Hostname and port must be provided.");
@@ -118,52 +249,35 @@ class ControllerDefaultImpl : public Controller {
     // TODO(stripeli): Condition to ping the connected learner (hostname:port).
 
     // Generates learner id.
-    const std::string learner_id = GenerateLearnerId(server_entity);
-
-    if (learners_.contains(learner_id)) {
-      // Learner was already registered with the controller.
-      return absl::AlreadyExistsError("Learner has already joined.");
+    Registration registration;
+    registration.learner.set_id(GenerateLearnerId(server_entity));
+    *registration.learner.mutable_server_entity() = server_entity;
+    *registration.learner.mutable_dataset_spec() = dataset_spec;
+
+    // The learners are registered in batches, i.e., registration epochs.
+    // The first learner to arrive registers the learners that arrive along
+    // with it, while the others wait; the learners that arrive in the
+    // meantime are registered in the next epoch, by the first one of them
+    // to wake up.
+    std::unique_lock<std::mutex> registration_lock(registration_mutex_);
+    pending_registrations_.push_back(&registration);
+    registration_cv_.wait(registration_lock, [this, &registration] {
+      return registration.done || !registering_;
+    });
+    if (!registration.done) {
+      registering_ = true;
+      std::vector<Registration *> epoch;
+      epoch.swap(pending_registrations_);
+      registration_lock.unlock();
+      RegisterLearners(epoch);
+      registration_lock.lock();
+      for (auto *registered: epoch) {
+        registered->done = true;
+      }
+      registering_ = false;
+      registration_cv_.notify_all();
     }
-
-    // Generates an auth token for the learner.
-    // TODO(stripeli) We need a better authorization token generator.
-    const std::string auth_token = std::to_string(learners_.size() + 1);
-
-    // Initializes learner state with an empty model.
-    LearnerDescriptor learner;
-    learner.set_id(learner_id);
-    learner.set_auth_token(auth_token);
-    *learner.mutable_server_entity() = server_entity;
-    *learner.mutable_dataset_spec() = dataset_spec;
-
-    LearnerState learner_state;
-    *learner_state.mutable_learner() = learner;
-
-    // Creates default task template.
-    LearningTaskTemplate task_template;
-    // Make sure steps per epoch is always positive. For instance if
-    // the dataset size is less than the batch size, then the steps will
-    // be equal to 0; hence the ceiling operation and float conversion.
-    // Float conversion because ceil(x/y) with x < y and x, y integers returns 0.
-    uint32_t steps_per_epoch = std::ceil(
-        (float) dataset_spec.num_training_examples() /
-            (float) params_.model_hyperparams().batch_size());
-
-    task_template.set_num_local_updates(params_.model_hyperparams().epochs() *
-        steps_per_epoch);
-
-    // Registers learner.
-    learners_[learner_id] = learner_state;
-    learners_task_template_[learner_id] = task_template;
-
-    // Opens gRPC connection with the learner.
-    learners_stub_[learner_id] = CreateLearnerStub(learner_id);
-
-    // Triggers the initial task.
-    scheduling_pool_.push_task(
-        [this, learner_id] { ScheduleInitialTask(learner_id); });
-
-    return learner;
+    return std::move(registration.result);
 
   }
 
@@ -176,200 +290,798 @@ class ControllerDefaultImpl : public Controller {
     // Acquires a lock to avoid having multiple threads overwriting the learners
     // data structures. The guard releases the mutex as soon as it goes out of
     // scope so no need to manually release it in the code.
-    std::lock_guard<std::mutex> learners_guard(learners_mutex_);
-    std::lock_guard<std::mutex> model_store_guard(model_store_mutex_);
-
-    auto it = learners_.find(learner_id);
-    // Checks requesting learner existence inside the state map.
-    if (it != learners_.end()) {
-      if (it->second.learner().auth_token() == token) {
-        PLOG(INFO) << "Removing learner from controller: " << learner_id;
-        model_store_->EraseModels(std::vector<std::string>{learner_id});
-        learners_.erase(it);
-        learners_stub_.erase(learner_id);
-        learners_task_template_.erase(learner_id);
-        return absl::OkStatus();
-      } else {
+    {
+      std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+
+      auto learners = Learners();
+      auto it = learners->find(learner_id);
+      // Checks requesting learner existence inside the state map.
+      if (it == learners->end()) {
+        return absl::NotFoundError("Learner is not part of the federation.");
+      } else if (it->second.learner().auth_token() != token) {
         return absl::UnauthenticatedError("Learner token is wrong.");
       }
-    } else {
-      return absl::NotFoundError("Learner is not part of the federation.");
+
+      PLOG(INFO) << "Removing learner from controller: " << learner_id;
+      UnregisterLearner(learner_id);
     }
 
+    ReleaseLearner(learner_id);
+    // The current round may have only been awaiting this learner.
+    scheduling_executor_.Push(kRoundLane, [this, learner_id] {
+      ScheduleAfterDeparture({learner_id});
+    });
+    return absl::OkStatus();
+
+  }
+
+  absl::Status
+  LearnerHeartbeat(const std::string &learner_id,
+                   const std::string &token) override {
+
+    RETURN_IF_ERROR(ValidateLearner(learner_id, token));
+    if (!TracksLiveness()) {
+      return absl::OkStatus();
+    }
+
+    bool recovered;
+    {
+      std::lock_guard<std::mutex> liveness_guard(liveness_mutex_);
+      recovered = liveness_.Beat(learner_id);
+    }
+    if (recovered) {
+      // The learner can be sampled again.
+      PLOG(INFO) << "Learner: " << learner_id << " is alive again.";
+      std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+      auto learners = Learners();
+      auto it = learners->find(learner_id);
+      if (it != learners->end()) {
+        cohort_sampler_.Add(
+            learner_id,
+            it->second.learner().dataset_spec().num_training_examples());
+        selector_->AddLearner(learner_id);
+      }
+    }
+    return absl::OkStatus();
+
   }
 
   absl::Status
   LearnerCompletedTask(const std::string &learner_id, const std::string &token,
-                       const CompletedLearningTask &task) override {
+                       CompletedLearningTask task) override {
 
     RETURN_IF_ERROR(ValidateLearner(learner_id, token));
 
-    // We need to lock the model store when receiving a new local model.
-    // The reason is that there are cases where, a learner might update
-    // his previous model, but that previous model is already being used
-    // for aggregation. Such a race will lead to null pointer exception
-    // during local models aggregation.
-    std::lock_guard<std::mutex> model_store_guard(model_store_mutex_);
+    RecordTaskReceived(learner_id, task);
+
+    // Hands learner's new local model to the model store. The model is
+    // ingested (hashed and compressed) here and inserted by CompleteTask().
+    // The model store is safe to call concurrently, hence the insertion
+    // does not wait for an ongoing aggregation; the aggregation works on
+    // the models it has already selected.
+    //  (1) In the case of InMemory store, insertions of different
+    //      learners proceed in parallel (per-learner locking).
+    //  (2) In the case of Redis, insertions are serialized by the
+    //      store, since the Redis client is single-threaded.
+    // The variables are moved, hence the model is not held twice.
+    auto model_writer = model_store_->NewModelWriter(learner_id);
+    for (auto &variable: *task.mutable_model()->mutable_variables()) {
+      model_writer->AppendVariable(std::move(variable));
+    }
 
-    // Assign a non-negative value to the metadata index.
-    auto task_global_iteration = task.execution_metadata().global_iteration();
-    auto metadata_index =
-        task_global_iteration == 0 ? 0 : task_global_iteration - 1;
-    // Records the id of the learner completed the task.
-    if (not metadata_.empty() && metadata_index < metadata_.size()) {
-      *metadata_.at(metadata_index).add_completed_by_learner_id() = learner_id;
-      (*metadata_.at(metadata_index).mutable_train_task_received_at())[learner_id] =
-          TimeUtil::GetCurrentTime();
-    }
-
-    // Inserts learner's new local model. This is a blocking
-    // call and the reason is that we need learner's local
-    // model stored inside the model store before any aggregation
-    // operation can happen.
-    // Future thoughts on multi-threading insertions.
-    //  (1) In the case of InMemory store, we can perform multi-threading,
-    //      since we are using a vector to insert learners models.
-    //  (2) In the case of Redis, we cannot perform multi-threading,
-    //      since Redis is single-thread.
-    PLOG(INFO) << "Insert learner\'s " << learner_id << " model.";
-    model_store_->InsertModel(
-        std::vector<std::pair<std::string, Model>> {
-            std::pair<std::string, Model>(learner_id, task.model())
-        });
+    CompleteTask(learner_id, task, std::move(model_writer));
+    return absl::OkStatus();
 
-    // Update learner collection with metrics from last completed training task.
-    if (!local_tasks_metadata_.contains(learner_id)) {
-      local_tasks_metadata_[learner_id] = std::list<TaskExecutionMetadata>();
+  }
+
+  absl::StatusOr<std::unique_ptr<CompletedTaskReceiver>>
+  LearnerCompletedTaskStream(const std::string &learner_id,
+                             const std::string &token,
+                             const CompletedLearningTask &task) override {
+
+    // The learner is validated before its model is received; hence, the
+    // model of an unknown learner is never read.
+    RETURN_IF_ERROR(ValidateLearner(learner_id, token));
+
+    PLOG(INFO) << "Receive learner\'s " << learner_id << " model.";
+    return std::make_unique<StreamedTaskReceiver>(this, learner_id, task);
+
+  }
+
+  absl::StatusOr<std::shared_ptr<const CommunityModelChunks>>
+  GetCommunityModelChunks(const std::string &learner_id,
+                          const std::string &token,
+                          uint32_t version,
+                          uint32_t base_version) override {
+
+    RETURN_IF_ERROR(ValidateLearner(learner_id, token));
+
+    std::shared_ptr<const FederatedModel> model;
+    std::shared_ptr<const FederatedModel> base_model;
+    {
+      std::lock_guard<std::mutex> cache_guard(community_model_cache_mutex_);
+      auto itr = community_model_cache_.find(version);
+      if (itr == community_model_cache_.end()) {
+        return absl::NotFoundError(absl::StrCat(
+            "Community model version ", version, " is not available."));
+      }
+      auto &cached = itr->second;
+      auto base_itr = community_model_cache_.find(base_version);
+      if (base_version == 0 || base_version == version ||
+          base_itr == community_model_cache_.end()) {
+        return cached.chunks;
+      }
+      auto delta_itr = cached.delta_chunks.find(base_version);
+      if (delta_itr != cached.delta_chunks.end()) {
+        return delta_itr->second;
+      }
+      model = cached.model;
+      base_model = base_itr->second.model;
     }
-    local_tasks_metadata_[learner_id].push_front(task.execution_metadata());
 
-    // Schedules next tasks if necessary. We call ScheduleTasks() asynchronously
-    // because during synchronous execution, the learner who completed its local
-    // training task the last within a federation round will have to wait for
-    // all the rest of training tasks to be scheduled before it can receive an
-    // acknowledgement by the controller for its completed task. Put it simply,
-    // the learner who completed its task the last within a round will have to
-    // keep a connection open with the controller, till the controller schedules
-    // all necessary training tasks for the next federation round.
-    scheduling_pool_.push_task(
-        [this, learner_id, task] { ScheduleTasks(learner_id, task); });
+    // The delta is computed outside the lock, since it touches every tensor.
+    // Concurrent requests for the same delta may compute it more than once,
+    // but only the first result is cached.
+    std::shared_ptr<const CommunityModelChunks> chunks;
+    Model delta;
+    if (EncodeModelDelta(base_model->model(), model->model(), &delta)) {
+      chunks = SplitCommunityModel(*model, delta, base_version);
+    }
 
-    return absl::OkStatus();
+    std::lock_guard<std::mutex> cache_guard(community_model_cache_mutex_);
+    auto itr = community_model_cache_.find(version);
+    if (itr == community_model_cache_.end()) {
+      return absl::NotFoundError(absl::StrCat(
+          "Community model version ", version, " is not available."));
+    }
+    auto &cached = itr->second;
+    // If the two versions differ in structure, the full model is served.
+    return cached.delta_chunks.emplace(
+        base_version, chunks ? chunks : cached.chunks).first->second;
+
+  }
+
+  void
+  GetRuntimeMetadataLineage(const GetRuntimeMetadataLineageRequest &request,
+                            GetRuntimeMetadataLineageResponse *response) override {
+
+    std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+    response->set_next_cursor(CopyLineage(
+        &metadata_, request.num_backtracks(), request.page_size(),
+        request.cursor(), response->mutable_metadata()));
 
   }
 
-  std::vector<FederatedTaskRuntimeMetadata>
-  GetRuntimeMetadataLineage(uint32_t num_steps) override {
+  void
+  GetEvaluationLineage(const GetCommunityModelEvaluationLineageRequest &request,
+                       GetCommunityModelEvaluationLineageResponse *response) override {
 
-    if (metadata_.empty()) {
-      return {};
+    std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+    response->set_next_cursor(CopyLineage(
+        &community_evaluations_, request.num_backtracks(), request.page_size(),
+        request.cursor(), response->mutable_community_evaluation()));
+
+  }
+
+  void
+  GetLocalTaskLineage(const GetLocalTaskLineageRequest &request,
+                      GetLocalTaskLineageResponse *response) override {
+
+    std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+    auto cursor = request.cursor();
+    auto next_cursor = cursor;
+    for (const auto &learner_id: request.learner_ids()) {
+      auto *out = (*response->mutable_learner_task())[learner_id]
+          .mutable_task_metadata();
+      auto itr = local_tasks_metadata_.find(learner_id);
+      if (itr == local_tasks_metadata_.end()) {
+        continue;
+      }
+      const auto &lineage = itr->second;
+
+      // The most recent num_backtracks tasks, most recent first.
+      if (request.page_size() == 0) {
+        auto num_steps = request.num_backtracks();
+        for (auto task = lineage.begin(); task != lineage.end() &&
+            (num_steps <= 0 || out->size() < num_steps); ++task) {
+          *out->Add() = *task;
+        }
+        continue;
+      }
+
+      // The page, in lineage order. The lineage is kept most recent first,
+      // and its oldest task is at position end_index - size.
+      auto end_index = LocalTasksEndIndex(learner_id);
+      auto page_end = std::min<uint64_t>(end_index, cursor + request.page_size());
+      next_cursor = std::max(next_cursor, page_end);
+      auto index = end_index - lineage.size();
+      for (auto task = lineage.rbegin(); task != lineage.rend() &&
+          index < page_end; ++task, ++index) {
+        if (index >= cursor) {
+          *out->Add() = *task;
+        }
+      }
     }
+    response->set_next_cursor(next_cursor);
 
-    const auto &lineage = metadata_;
+  }
+
+  void Shutdown() override {
 
-    if (num_steps <= 0) {
-      return {lineage.begin(), lineage.end()};
+    // Proper shutdown of the controller process.
+    // Send shutdown signal to the completion queues and
+    // gracefully close the scheduling pool.
+    // The timer and the digestion of the RunTasks responses push scheduling
+    // work, hence they are stopped before the scheduling work is drained.
+    // The queued scheduling work does not dispatch any task once the
+    // completion queue is shut down.
+    StopTimer();
+    StopRunTasks();
+    scheduling_executor_.WaitForTasks();
+    checkpoint_pool_.wait_for_tasks();
+    LogExecutorStats();
+    {
+      // The models held back by the pipelined rounds reference the store.
+      std::lock_guard<std::mutex> scheduling_guard(scheduling_mutex_);
+      ahead_tasks_.Clear();
     }
+    model_store_->Shutdown();
 
-    std::vector<FederatedTaskRuntimeMetadata> lineage_head;
-    auto iter = lineage.begin();
-    while (lineage_head.size() < num_steps && iter != lineage.end()) {
-      lineage_head.push_back(*iter);
-      ++iter;
+  }
+
+  // Restores the controller state from a snapshot and resumes the federation
+  // round that was in progress when the snapshot was taken. The learners'
+  // local models are not part of the snapshot; they are repopulated by the
+  // learners once they complete the resumed round. Must be called before
+  // any learner joins the federation.
+  void RestoreFromCheckpoint(FederatedModel &&community_model,
+                             const ControllerCheckpoint &checkpoint) {
+
+    std::lock_guard<std::mutex> scheduling_guard(scheduling_mutex_);
+    std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+
+    {
+      // The versions continue from the snapshot, since the learners may
+      // still cache the models published before the restart.
+      std::lock_guard<std::mutex> cache_guard(community_model_cache_mutex_);
+      community_model_version_ = checkpoint.community_model_version();
+    }
+    PublishCommunityModel(
+        std::make_shared<const FederatedModel>(std::move(community_model)));
+    global_iteration_ = checkpoint.global_iteration();
+
+    auto learners = std::make_shared<LearnerStates>();
+    for (const auto &learner_state: checkpoint.learners()) {
+      const auto &learner_id = learner_state.learner().id();
+      (*learners)[learner_id] = learner_state;
+      cohort_sampler_.Add(
+          learner_id,
+          learner_state.learner().dataset_spec().num_training_examples());
+      selector_->AddLearner(learner_id);
+      // The learners that do not come back are evicted once they miss
+      // enough heartbeats.
+      RecordHeartbeat(learner_id);
+    }
+    std::atomic_store(&learners_,
+                      std::shared_ptr<const LearnerStates>(std::move(learners)));
+    for (const auto &[learner_id, task_template]:
+        checkpoint.learners_task_template()) {
+      learners_task_template_[learner_id] = task_template;
     }
 
-    return lineage_head;
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      metadata_.Restore(checkpoint.runtime_metadata_begin(),
+                        checkpoint.runtime_metadata().begin(),
+                        checkpoint.runtime_metadata().end());
+      community_evaluations_.Restore(
+          checkpoint.community_evaluations_begin(),
+          checkpoint.community_evaluations().begin(),
+          checkpoint.community_evaluations().end());
+      auto max_local_tasks = MaxRetainedLocalTasks(params_.lineage_specs());
+      for (const auto &[learner_id, lineage]:
+          checkpoint.local_tasks_metadata()) {
+        auto &local_lineage = local_tasks_metadata_[learner_id];
+        local_lineage.assign(lineage.task_execution_metadata().begin(),
+                             lineage.task_execution_metadata().end());
+        local_tasks_end_index_[learner_id] = std::max<uint64_t>(
+            lineage.end_index(), local_lineage.size());
+        if (local_lineage.size() > max_local_tasks) {
+          local_lineage.resize(max_local_tasks);
+        }
+      }
+    }
+
+    PLOG(INFO) << "Restored controller from checkpoint at FedIteration: "
+               << unsigned(global_iteration_) << " with "
+               << Learners()->size() << " learners.";
+
+    scheduling_executor_.Push(kRoundLane, [this] { ResumeFromCheckpoint(); });
 
   }
 
-  std::vector<CommunityModelEvaluation>
-  GetEvaluationLineage(uint32_t num_steps) override {
+ private:
+  typedef absl::flat_hash_map<std::string, LearnerState> LearnerStates;
+  // Shared, so that a request can be dispatched to a learner outside the
+  // registry lock while the learner is concurrently removed.
+  typedef std::shared_ptr<grpc::GenericStub> LearnerStub;
+
+  // A learner's request to join the federation, which is completed once the
+  // learner is registered.
+  struct Registration {
+    LearnerDescriptor learner;
+    absl::StatusOr<LearnerDescriptor> result;
+    bool done = false;
+  };
+
+  // Receives the model of a completed task chunk by chunk. Every variable is
+  // handed to the model store as soon as it has been received in full, so
+  // the store ingests (hashes and compresses) the model while the rest of
+  // it is still being transferred. The last variable of a chunk is held
+  // back, since the next chunk may continue it.
+  class StreamedTaskReceiver : public CompletedTaskReceiver {
+   public:
+    StreamedTaskReceiver(ControllerDefaultImpl *controller,
+                         std::string learner_id,
+                         const CompletedLearningTask &task)
+        : controller_(controller), learner_id_(std::move(learner_id)),
+          task_(task),
+          model_writer_(controller->model_store_->NewModelWriter(learner_id_)) {}
+
+    absl::Status ReceiveChunk(ModelChunk *chunk) override {
+      if (chunk->continues_variable()) {
+        if (!has_variable_ || chunk->variables_size() != 1) {
+          return absl::InvalidArgumentError(
+              "Model chunk does not continue a single variable.");
+        }
+        AppendTensorValue(chunk->variables(0), &variable_);
+        return absl::OkStatus();
+      }
+      for (auto &next_variable: *chunk->mutable_variables()) {
+        if (has_variable_) {
+          RETURN_IF_ERROR(AppendVariable());
+        }
+        variable_ = std::move(next_variable);
+        has_variable_ = true;
+      }
+      return absl::OkStatus();
+    }
+
+    absl::Status Finish() override {
+      if (has_variable_) {
+        RETURN_IF_ERROR(AppendVariable());
+        has_variable_ = false;
+      }
+      // A model that was not received whole is discarded along with the
+      // uncommitted writer.
+      if (num_variables_ == 0) {
+        return absl::InvalidArgumentError("Model stream carries no variables.");
+      }
+
+      controller_->RecordTaskReceived(learner_id_, task_);
+      controller_->CompleteTask(learner_id_, task_, std::move(model_writer_));
+      return absl::OkStatus();
+    }
 
-    if (community_evaluations_.empty()) {
-      return {};
+   private:
+    // Hands the current variable, which must be complete, to the writer.
+    absl::Status AppendVariable() {
+      if (!IsCompleteVariable(variable_)) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Model variable ", variable_.name(), " is incomplete."));
+      }
+      model_writer_->AppendVariable(std::move(variable_));
+      ++num_variables_;
+      return absl::OkStatus();
     }
 
-    const auto &lineage = community_evaluations_;
+    ControllerDefaultImpl *controller_;
+    std::string learner_id_;
+    CompletedLearningTask task_;
+    std::unique_ptr<ModelStore::ModelWriter> model_writer_;
+    Model_Variable variable_;
+    bool has_variable_ = false;
+    size_t num_variables_ = 0;
+  };
 
-    if (num_steps <= 0) {
-      return {lineage.begin(), lineage.end()};
+  // Holds the scheduling lock. The learners that joined the federation while
+  // the lock was held are assigned their initial task once it is released.
+  class SchedulingGuard {
+   public:
+    explicit SchedulingGuard(ControllerDefaultImpl *controller)
+        : controller_(controller) {
+      controller_->scheduling_mutex_.lock();
     }
 
-    std::vector<CommunityModelEvaluation> lineage_head;
-    auto iter = lineage.begin();
-    while (lineage_head.size() < num_steps && iter != lineage.end()) {
-      lineage_head.push_back(*iter);
-      ++iter;
+    ~SchedulingGuard() {
+      controller_->scheduling_mutex_.unlock();
+      if (controller_->HasJoiningLearners()) {
+        controller_->scheduling_executor_.Push(
+            kControlLane,
+            [controller = controller_] { controller->ScheduleJoiningLearners(); });
+      }
     }
 
-    return lineage_head;
+   private:
+    ControllerDefaultImpl *controller_;
+  };
+
+  // Returns a snapshot of the learners' registry. The snapshot is immutable
+  // and remains valid after learners join or leave the federation.
+  std::shared_ptr<const LearnerStates> Learners() const {
+    return std::atomic_load(&learners_);
+  }
+
+  // Returns the learners that the scheduler awaits, i.e., all learners but
+  // the ones that are suspected to have failed.
+  std::vector<LearnerDescriptor> ActiveLearners() const {
+    auto learners = GetLearners();
+    if (!TracksLiveness()) {
+      return learners;
+    }
+    std::lock_guard<std::mutex> liveness_guard(liveness_mutex_);
+    learners.erase(
+        std::remove_if(learners.begin(), learners.end(),
+                       [this](const LearnerDescriptor &learner) {
+                         return liveness_.IsSuspect(learner.id());
+                       }),
+        learners.end());
+    return learners;
+  }
+
+  void LogExecutorStats() const {
+    const char *lane_names[] = {"control", "round"};
+    for (size_t lane = 0; lane < scheduling_executor_.num_lanes(); ++lane) {
+      auto stats = scheduling_executor_.Stats(lane);
+      PLOG(INFO) << "Scheduling " << lane_names[lane] << " lane: "
+                 << stats.num_completed << " task(s) completed, "
+                 << stats.queue_depth << " queued, waited "
+                 << stats.mean_wait_ms << " ms on average and "
+                 << stats.max_wait_ms << " ms at most.";
+    }
+  }
 
+  bool HasRoundDeadline() const {
+    return params_.communication_specs().protocol_specs()
+        .sync_round_deadline_secs() > 0;
   }
 
-  std::vector<TaskExecutionMetadata>
-  GetLocalTaskLineage(const std::string &learner_id,
-                      uint32_t num_steps) override {
+  bool TracksLiveness() const {
+    return params_.liveness_specs().heartbeat_interval_secs() > 0;
+  }
 
-    if (!local_tasks_metadata_.contains(learner_id)) {
-      return {};
+  void RecordHeartbeat(const std::string &learner_id) {
+    if (TracksLiveness()) {
+      std::lock_guard<std::mutex> liveness_guard(liveness_mutex_);
+      liveness_.Beat(learner_id);
     }
+  }
 
-    const auto &lineage = local_tasks_metadata_[learner_id];
+  // Registers the learners of a registration epoch. The registry is copied
+  // once per epoch, rather than modified in place, so that the readers
+  // holding the previous snapshot are unaffected. The learners' connections
+  // are created once they are first assigned a task (see SendRunTaskAsync()),
+  // and the learners that joined are assigned their initial task together.
+  void RegisterLearners(const std::vector<Registration *> &epoch) {
+
+    std::vector<std::string> registered;
+    {
+      // Acquires a lock to avoid having multiple threads overwriting the
+      // learners' data structures.
+      std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+      auto new_learners = std::make_shared<LearnerStates>(*Learners());
+      for (auto *registration: epoch) {
+        auto &learner = registration->learner;
+        const auto &learner_id = learner.id();
+        if (new_learners->contains(learner_id)) {
+          // Learner was already registered with the controller.
+          registration->result =
+              absl::AlreadyExistsError("Learner has already joined.");
+          continue;
+        }
 
-    if (num_steps <= 0) {
-      return {lineage.begin(), lineage.end()};
+        // Generates an auth token for the learner.
+        // TODO(stripeli) We need a better authorization token generator.
+        learner.set_auth_token(std::to_string(new_learners->size() + 1));
+
+        // Initializes learner state with an empty model.
+        LearnerState learner_state;
+        *learner_state.mutable_learner() = learner;
+        (*new_learners)[learner_id] = std::move(learner_state);
+
+        // Creates default task template.
+        LearningTaskTemplate task_template;
+        task_template.set_num_local_updates(
+            DefaultNumLocalUpdates(learner.dataset_spec()));
+        learners_task_template_[learner_id] = task_template;
+        cohort_sampler_.Add(learner_id,
+                            learner.dataset_spec().num_training_examples());
+        selector_->AddLearner(learner_id);
+        // Joining counts as the learner's first heartbeat.
+        RecordHeartbeat(learner_id);
+
+        registration->result = learner;
+        registered.push_back(learner_id);
+      }
+      std::atomic_store(&learners_,
+                        std::shared_ptr<const LearnerStates>(std::move(new_learners)));
     }
 
-    std::vector<TaskExecutionMetadata> lineage_head;
-    auto iter = lineage.begin();
-    while (lineage_head.size() < num_steps && iter != lineage.end()) {
-      lineage_head.push_back(*iter);
-      ++iter;
+    // Triggers the initial tasks.
+    if (registered.empty() || !CommunityModel()->IsInitialized()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> joining_guard(joining_mutex_);
+      joining_learners_.insert(joining_learners_.end(),
+                               registered.begin(), registered.end());
     }
+    scheduling_executor_.Push(kControlLane,
+                              [this] { ScheduleJoiningLearners(); });
 
-    return lineage_head;
+  }
 
+  // Erases the learner from the registry. Must be called with the registry
+  // lock held.
+  void UnregisterLearner(const std::string &learner_id) {
+    auto new_learners = std::make_shared<LearnerStates>(*Learners());
+    new_learners->erase(learner_id);
+    std::atomic_store(&learners_,
+                      std::shared_ptr<const LearnerStates>(std::move(new_learners)));
+    learners_stub_.erase(learner_id);
+    learners_task_template_.erase(learner_id);
+    cohort_sampler_.Remove(learner_id);
+    selector_->RemoveLearner(learner_id);
+    std::lock_guard<std::mutex> liveness_guard(liveness_mutex_);
+    liveness_.Remove(learner_id);
   }
 
-  void Shutdown() override {
+  // Releases the state that the controller keeps for an unregistered
+  // learner, except for its models, which an ongoing aggregation may be
+  // reading; these are erased by ScheduleAfterDeparture().
+  void ReleaseLearner(const std::string &learner_id) {
+    std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+    learners_throughput_.erase(learner_id);
+  }
 
-    // Proper shutdown of the controller process.
-    // Send shutdown signal to the completion queues and
-    // gracefully close the scheduling pool.
-    run_tasks_cq_.Shutdown();
-    eval_tasks_cq_.Shutdown();
-    scheduling_pool_.wait_for_tasks();
-    model_store_->Shutdown();
+  // Erases the models of the departed learners, along with the scaling
+  // factors they were aggregated with. Must be called with the scheduling
+  // lock held, hence never while the community model is being computed
+  // from them.
+  void EraseDepartedModels(const std::vector<std::string> &departed) {
+    std::vector<std::string> to_erase;
+    for (const auto &learner_id: departed) {
+      // The learner may have joined the federation again meanwhile.
+      if (!Learners()->contains(learner_id)) {
+        contributed_scaling_factors_.erase(learner_id);
+        to_erase.push_back(learner_id);
+      }
+    }
+    if (!to_erase.empty()) {
+      model_store_->EraseModels(to_erase);
+    }
+  }
 
+  // Copies the requested entries of the lineage into `out` and returns the
+  // cursor of the next page. If `page_size` is positive, the entries start
+  // at `cursor`; otherwise, these are the `num_steps` most recent entries
+  // kept in memory, or all of them if `num_steps` is non-positive.
+  template<typename T>
+  static uint64_t CopyLineage(BoundedLineage<T> *lineage,
+                              int32_t num_steps,
+                              uint32_t page_size,
+                              uint64_t cursor,
+                              google::protobuf::RepeatedPtrField<T> *out) {
+    if (page_size > 0) {
+      return lineage->CopyRange(cursor, page_size, out);
+    }
+    auto begin = lineage->begin_index();
+    auto end = lineage->end_index();
+    if (num_steps > 0 && end - begin > static_cast<uint64_t>(num_steps)) {
+      begin = end - num_steps;
+    }
+    return lineage->CopyRange(begin, end - begin, out);
   }
 
- private:
-  typedef std::unique_ptr<LearnerService::Stub> LearnerStub;
-
-  LearnerStub CreateLearnerStub(const std::string &learner_id) {
-
-    auto server_entity = learners_[learner_id].learner().server_entity();
-    auto target =
-        absl::StrCat(server_entity.hostname(), ":", server_entity.port());
-
-    auto creds = grpc::InsecureChannelCredentials();
-    if (server_entity.has_ssl_config()) {
-        grpc::SslCredentialsOptions ssl_opts;
-        if (server_entity.ssl_config().enable_ssl()) {
-          if (server_entity.ssl_config().has_ssl_config_stream()) {
-            ssl_opts.pem_root_certs =
-                server_entity.ssl_config().ssl_config_stream().public_certificate_stream();
-            creds = grpc::SslCredentials(ssl_opts);
-          } else {
-            PLOG(WARNING) << "Even though learner: " << learner_id <<
-            "has requested TLS/SSL connection, it has not sent a public "
-            "certificate stream to establish connection.";
-          }
+  // Whether every (semi-)synchronous round is assigned to a cohort sampled
+  // from the learners, rather than to the learners that completed the
+  // previous round.
+  bool SamplesCohorts() const {
+    auto ratio = params_.global_model_specs().learners_participation_ratio();
+    return ratio > 0 && ratio < 1 && params_.communication_specs().protocol() !=
+        CommunicationSpecs::ASYNCHRONOUS;
+  }
+
+  // Whether the cohort of every round consists of the fastest learners,
+  // which are selected by the (speed-aware) selector.
+  bool SelectsFastest() const {
+    return SamplesCohorts() && params_.global_model_specs().cohort_sampling() ==
+        GlobalModelSpecs::FASTEST;
+  }
+
+  uint32_t StepsPerEpoch(const DatasetSpec &dataset_spec) const {
+    // Make sure steps per epoch is always positive. For instance if
+    // the dataset size is less than the batch size, then the steps will
+    // be equal to 0; hence the ceiling operation and float conversion.
+    // Float conversion because ceil(x/y) with x < y and x, y integers returns 0.
+    return std::ceil(
+        (float) dataset_spec.num_training_examples() /
+            (float) params_.model_hyperparams().batch_size());
+  }
+
+  // The number of local updates of the learner's task, before its
+  // throughput is known.
+  uint32_t DefaultNumLocalUpdates(const DatasetSpec &dataset_spec) const {
+    return params_.model_hyperparams().epochs() * StepsPerEpoch(dataset_spec);
+  }
+
+  // Whether the learners run under the asynchronous protocol, i.e., every
+  // completed task releases a round of its own.
+  bool IsAsynchronous() const {
+    return params_.communication_specs().protocol() ==
+        CommunicationSpecs::ASYNCHRONOUS;
+  }
+
+  // Whether the learners' updates are buffered and aggregated in batches,
+  // under the asynchronous protocol.
+  bool BuffersUpdates() const {
+    const auto &communication_specs = params_.communication_specs();
+    return communication_specs.protocol() == CommunicationSpecs::ASYNCHRONOUS &&
+        communication_specs.protocol_specs().async_buffer_size() > 1;
+  }
+
+  // Whether the synchronous rounds are pipelined, i.e., the learners that
+  // complete their task run ahead on the next rounds. The rounds of sampled
+  // cohorts are not pipelined, since the cohort of the next round is only
+  // known once the current round is released.
+  bool PipelinesRounds() const {
+    const auto &communication_specs = params_.communication_specs();
+    return communication_specs.protocol() == CommunicationSpecs::SYNCHRONOUS &&
+        communication_specs.protocol_specs().sync_max_staleness() > 0 &&
+        !SamplesCohorts();
+  }
+
+  // The number of learners that participate in a round.
+  size_t CohortSize(size_t num_learners) const {
+    auto ratio = params_.global_model_specs().learners_participation_ratio();
+    // The epsilon guards against rounding up, e.g., 0.1 * 10 to 2.
+    auto cohort_size = static_cast<size_t>(
+        std::ceil(ratio * static_cast<double>(num_learners) - 1e-6));
+    return std::max<size_t>(cohort_size, 1);
+  }
+
+  LearnerStub CreateLearnerStub(const ServerEntity &server_entity) {
+
+    // Every learner gets its own long-lived channel, which is reused by all
+    // the requests sent to the learner. The channel connects (and performs
+    // the TLS handshake) on the first request.
+    auto channel = CreateLearnerChannel(server_entity);
+    return std::make_shared<grpc::GenericStub>(channel);
+
+  }
+
+  // Returns the learner's connection, along with its task template, or null
+  // if the learner is no longer registered. The connection is created when
+  // the learner is first assigned a task, rather than when it joins, and
+  // outside the registry lock, so that a storm of joins stays cheap.
+  LearnerStub GetLearnerStub(const std::string &learner_id,
+                             LearningTaskTemplate *task_template) {
+
+    ServerEntity server_entity;
+    {
+      std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+      auto learners = Learners();
+      auto learner = learners->find(learner_id);
+      if (learner == learners->end()) {
+        return nullptr;
+      }
+      *task_template = learners_task_template_[learner_id];
+      auto stub_it = learners_stub_.find(learner_id);
+      if (stub_it != learners_stub_.end()) {
+        return stub_it->second;
+      }
+      server_entity = learner->second.learner().server_entity();
+    }
+
+    auto learner_stub = CreateLearnerStub(server_entity);
+    std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+    if (!Learners()->contains(learner_id)) {
+      return nullptr;
+    }
+    // Another dispatch may have created the connection in the meantime.
+    return learners_stub_.try_emplace(learner_id, std::move(learner_stub))
+        .first->second;
+
+  }
+
+  void RecordTaskReceived(const std::string &learner_id,
+                          const CompletedLearningTask &task) {
+
+    // Assign a non-negative value to the metadata index.
+    auto task_global_iteration = task.execution_metadata().global_iteration();
+    auto metadata_index =
+        task_global_iteration == 0 ? 0 : task_global_iteration - 1;
+    double round_trip_ms = 0;
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      // Records the id of the learner completed the task.
+      if (auto *meta = metadata_.Find(metadata_index)) {
+        auto received_at = TimeUtil::GetCurrentTime();
+        *meta->add_completed_by_learner_id() = learner_id;
+        (*meta->mutable_train_task_received_at())[learner_id] = received_at;
+        auto submitted_at = meta->train_task_submitted_at().find(learner_id);
+        if (submitted_at != meta->train_task_submitted_at().end()) {
+          round_trip_ms = TimeUtil::DurationToMilliseconds(
+              received_at - submitted_at->second);
         }
+      }
+    }
+
+    if (round_trip_ms > 0) {
+      std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+      selector_->RecordRoundTrip(learner_id, round_trip_ms);
+    }
+
+  }
+
+  // Completes the learner's task, whose local model has been ingested by
+  // `model_writer` but is not committed to the model store yet.
+  void CompleteTask(const std::string &learner_id,
+                    const CompletedLearningTask &task,
+                    std::unique_ptr<ModelStore::ModelWriter> model_writer) {
+
+    // A completed task also proves that the learner is alive.
+    RecordHeartbeat(learner_id);
+
+    // Update learner collection with metrics from last completed training task.
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      auto &local_lineage = local_tasks_metadata_[learner_id];
+      local_lineage.push_front(task.execution_metadata());
+      ++local_tasks_end_index_[learner_id];
+      if (local_lineage.size() > MaxRetainedLocalTasks(params_.lineage_specs())) {
+        local_lineage.pop_back();
+      }
+      learners_throughput_[learner_id].Observe(
+          task.execution_metadata().processing_ms_per_batch());
+    }
+
+    // Inserts learner's new local model. This is a blocking call, since the
+    // model must be in the model store before any aggregation can happen.
+    // If the rounds are pipelined, the task may have been completed ahead of
+    // its round, hence the scheduler decides when the model is inserted.
+    std::shared_ptr<ModelStore::ModelWriter> model;
+    if (PipelinesRounds()) {
+      model = std::move(model_writer);
+    } else {
+      PLOG(INFO) << "Insert learner\'s " << learner_id << " model.";
+      model_writer->Commit();
     }
-    auto channel = grpc::CreateChannel(target, creds);
-    return LearnerService::NewStub(channel);
 
+    // The scheduler only needs the task's metadata, hence the model is not
+    // copied into the scheduling task.
+    CompletedLearningTask task_metadata;
+    *task_metadata.mutable_execution_metadata() = task.execution_metadata();
+    task_metadata.set_aux_metadata(task.aux_metadata());
+    *task_metadata.mutable_federated_model_evaluations() =
+        task.federated_model_evaluations();
+
+    // Schedules next tasks if necessary. We call ScheduleTasks() asynchronously
+    // because during synchronous execution, the learner who completed its local
+    // training task the last within a federation round will have to wait for
+    // all the rest of training tasks to be scheduled before it can receive an
+    // acknowledgement by the controller for its completed task. Put it simply,
+    // the learner who completed its task the last within a round will have to
+    // keep a connection open with the controller, till the controller schedules
+    // all necessary training tasks for the next federation round.
+    scheduling_executor_.Push(kRoundLane, [this, learner_id, task_metadata, model] {
+      ScheduleTasks(learner_id, task_metadata, model);
+    });
+
+  }
+
+  static std::string LearnerMethod(const char *method_name) {
+    return absl::StrCat("/", LearnerService::service_full_name(), "/", method_name);
   }
 
   absl::Status ValidateLearner(const std::string &learner_id,
@@ -380,8 +1092,9 @@ class ControllerDefaultImpl : public Controller {
       return absl::InvalidArgumentError("Learner id and token cannot be empty");
     }
 
-    const auto &learner = learners_.find(learner_id);
-    if (learner == learners_.end()) {
+    auto learners = Learners();
+    const auto &learner = learners->find(learner_id);
+    if (learner == learners->end()) {
       return absl::NotFoundError("Learner does not exist.");
     } else if (learner->second.learner().auth_token() != token) {
       return absl::PermissionDeniedError("Invalid token provided.");
@@ -391,365 +1104,946 @@ class ControllerDefaultImpl : public Controller {
 
   }
 
-  void ScheduleInitialTask(const std::string &learner_id) {
+  // Assigns the learners that have joined the federation their initial
+  // task. If the scheduling lock is held, e.g., while a round is being
+  // computed, the joins do not wait for it: the holder of the lock assigns
+  // the joining learners their initial task once it releases the lock (see
+  // SchedulingGuard). All the learners that are waiting are assigned their
+  // task with a single dispatch.
+  void ScheduleJoiningLearners() {
+
+    do {
+      std::unique_lock<std::mutex> scheduling_lock(scheduling_mutex_,
+                                                   std::try_to_lock);
+      if (!scheduling_lock.owns_lock()) {
+        return;
+      }
+      std::vector<std::string> joining_learners;
+      {
+        std::lock_guard<std::mutex> joining_guard(joining_mutex_);
+        joining_learners.swap(joining_learners_);
+      }
+      AssignInitialTasks(joining_learners);
+      // A learner may join after the lock is released, but before the
+      // joining learners are checked again; it is then assigned right away.
+    } while (HasJoiningLearners());
+
+  }
+
+  bool HasJoiningLearners() {
+    std::lock_guard<std::mutex> joining_guard(joining_mutex_);
+    return !joining_learners_.empty();
+  }
+
+  // Assigns the joining learners the task of the current round, on the
+  // current community model. Must be called with the scheduling lock held.
+  void AssignInitialTasks(const std::vector<std::string> &learner_ids) {
 
-    if (!community_model_.IsInitialized()) {
+    auto learners = Learners();
+    std::vector<std::string> to_schedule;
+    to_schedule.reserve(learner_ids.size());
+    for (const auto &learner_id: learner_ids) {
+      if (!learners->contains(learner_id)) {
+        continue;
+      }
+      if (SamplesCohorts()) {
+        // The first round is assigned to the first learners that join, up to
+        // the cohort size of the learners that have joined so far. The
+        // learners that join later wait until they are sampled.
+        if (global_iteration_ > 1 ||
+            initial_cohort_size_ >= CohortSize(learners->size())) {
+          continue;
+        }
+        ++initial_cohort_size_;
+        scheduler_->AddToCohort(learner_id);
+      }
+      to_schedule.push_back(learner_id);
+    }
+    if (to_schedule.empty()) {
       return;
     }
 
-    std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+    uint64_t metadata_index;
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      if (metadata_.empty()) {
+        // When the very first local training task is scheduled, we need to
+        // increase the global iteration counter and create the first
+        // federation runtime metadata object.
+        FederatedTaskRuntimeMetadata meta = FederatedTaskRuntimeMetadata();
+        ++global_iteration_;
+        PLOG(INFO) << "FedIteration: " << unsigned(global_iteration_);
+        meta.set_global_iteration(global_iteration_);
+        *meta.mutable_started_at() = TimeUtil::GetCurrentTime();
+        metadata_.Append(std::move(meta));
+      }
 
-    if (metadata_.empty()) {
-      // When the very first local training task is scheduled, we need to
-      // increase the global iteration counter and create the first
-      // federation runtime metadata object.
-      FederatedTaskRuntimeMetadata meta = FederatedTaskRuntimeMetadata();
-      ++global_iteration_;
-      PLOG(INFO) << "FedIteration: " << unsigned(global_iteration_);
-      meta.set_global_iteration(global_iteration_);
-      *meta.mutable_started_at() = TimeUtil::GetCurrentTime();
-      metadata_.emplace_back(meta);
+      // When new learners join/train on the initial task, we record
+      // all runtime related metadata to the last item in the metadata collection.
+      metadata_index = metadata_.end_index() - 1;
+      // Records the learner ids to which the controller delegates the latest task.
+      for (const auto &learner_id: to_schedule) {
+        *metadata_.back().add_assigned_to_learner_id() = learner_id;
+      }
     }
 
-    // When a new learner joins/trains on the initial task, we record
-    // all runtime related metadata to the last item in the metadata collection.
-    auto &meta = metadata_.back();
-    // Records the learner id to which the controller delegates the latest task.
-    *meta.add_assigned_to_learner_id() = learner_id;
-    auto &community_model = community_model_;
-
-    // Send initial training task.
-    std::vector<std::string> learner_to_list_ = {learner_id};
-    // We also need to pass the metadata object to record submission time.
-    SendRunTasks(learner_to_list_, community_model, meta);
+    // Send initial training tasks. We also need to pass the metadata index to
+    // record submission time.
+    SendRunTasks(to_schedule, CommunityModelVersion(), metadata_index,
+                 global_iteration_, /* evaluate_model */ false);
 
   }
 
   void ScheduleTasks(const std::string &learner_id,
-                     const CompletedLearningTask &task) {
+                     const CompletedLearningTask &task,
+                     const std::shared_ptr<ModelStore::ModelWriter> &model) {
 
-    // Acquires a lock to avoid having multiple threads overwriting the learners
-    // data structures. The guard releases the mutex as soon as it goes out of
-    // scope so no need to manually release it in the code.
-    std::lock_guard<std::mutex> learners_guard(learners_mutex_);
-    // TODO(stripeli): Maybe for global_iteration_ as well?
+    // Acquires a lock to avoid having multiple threads scheduling rounds
+    // concurrently. The learners' registry is not locked; the round works on
+    // a snapshot of it, hence learners can join or leave the federation
+    // while the community model is being computed.
+    SchedulingGuard scheduling_guard(this);
+
+    if (task.has_federated_model_evaluations()) {
+      RecordCommunityModelEvaluation(learner_id, task);
+    }
+
+    if (PipelinesRounds()) {
+      AheadTasks::CompletedTask completed{learner_id, task};
+      if (auto submitted_at = ahead_tasks_.TakeRunning(learner_id)) {
+        completed.submitted_at = std::move(*submitted_at);
+      }
+      if (task.execution_metadata().global_iteration() > global_iteration_) {
+        // The learner has completed the task of a round that has not started
+        // yet. The task, along with its model, counts towards its round once
+        // the round starts; until then, the model stays out of the store.
+        completed.received_at = TimeUtil::GetCurrentTime();
+        completed.model = model;
+        ahead_tasks_.Hold(std::move(completed));
+        ScheduleAheadTask(learner_id);
+        return;
+      }
+      PLOG(INFO) << "Insert learner\'s " << learner_id << " model.";
+      model->Commit();
+    }
+
+    ScheduleCompletedTask(learner_id, task);
+
+  }
+
+  // Schedules the next tasks, given that the learner has completed its task
+  // of the current (or of an earlier) round. Must be called with the
+  // scheduling lock held.
+  void ScheduleCompletedTask(const std::string &learner_id,
+                             const CompletedLearningTask &task) {
 
     auto to_schedule =
-        scheduler_->ScheduleNext(learner_id, task, GetLearners());
+        scheduler_->ScheduleNext(learner_id, task, ActiveLearners());
+    if (BuffersUpdates()) {
+      // The learner is assigned its next task right away, while its update
+      // waits in the buffer. The buffered updates are aggregated in the
+      // current round, which ends once the buffer is released.
+      ScheduleBufferedTask(learner_id, task);
+      if (!to_schedule.empty()) {
+        StartNextRound(to_schedule, global_iteration_);
+      }
+    } else if (!to_schedule.empty()) {
+      // A (semi-)synchronous round may be released by a learner that was
+      // carried over from the previous round, hence the released round is
+      // the current one rather than the round of the learner's task.
+      StartNextRound(to_schedule, IsAsynchronous()
+                                  ? task.execution_metadata().global_iteration()
+                                  : global_iteration_);
+    } else if (PipelinesRounds()) {
+      // The learner does not sit idle until the round is released.
+      ScheduleAheadTask(learner_id);
+    }
+
+  }
+
+  // Assigns the learner, which has completed its task while the current
+  // round is still running, its task of the next round it has not completed
+  // yet, on the latest community model. The learner runs at most
+  // `sync_max_staleness` rounds ahead of the current round; beyond that, it
+  // waits for the current round to be released. Must be called with the
+  // scheduling lock held.
+  void ScheduleAheadTask(const std::string &learner_id) {
+
+    if (ahead_tasks_.IsRunning(learner_id)) {
+      return;
+    }
+    auto global_iteration = ahead_tasks_.NextRound(learner_id, global_iteration_);
+    if (global_iteration - global_iteration_ > params_.communication_specs()
+        .protocol_specs().sync_max_staleness()) {
+      return;
+    }
+
+    uint64_t metadata_index;
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      metadata_index = metadata_.end_index() - 1;
+    }
+
+    ahead_tasks_.Run(learner_id, global_iteration, TimeUtil::GetCurrentTime());
+    UpdateLearnersTaskTemplates({learner_id});
+    // The learner has already evaluated the latest community model along
+    // with the task it has just completed.
+    SendRunTasks({learner_id}, CommunityModelVersion(), metadata_index,
+                 global_iteration, /* evaluate_model */ false);
+
+  }
+
+  // Assigns the learner its next task on the current community model. The
+  // learner evaluates the community model only along with the first task it
+  // runs on that model.
+  void ScheduleBufferedTask(const std::string &learner_id,
+                            const CompletedLearningTask &task) {
+
+    uint64_t metadata_index;
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      metadata_index = metadata_.end_index() - 1;
+      *metadata_.back().add_assigned_to_learner_id() = learner_id;
+    }
+
+    UpdateLearnersTaskTemplates({learner_id});
+    bool evaluate_model =
+        task.execution_metadata().global_iteration() < global_iteration_;
+    SendRunTasks({learner_id}, CommunityModelVersion(), metadata_index,
+                 global_iteration_, evaluate_model);
+
+  }
+
+  // Releases the current round if it has expired, i.e., its deadline has
+  // passed before all learners completed their task. The community model is
+  // computed from the learners that have completed their task; the remaining
+  // learners are carried over to the next round once they complete theirs.
+  void ScheduleExpiredRound() {
+
+    SchedulingGuard scheduling_guard(this);
+    round_timer_pending_ = false;
+
+    auto to_schedule = scheduler_->ScheduleExpired(ActiveLearners());
     if (!to_schedule.empty()) {
-      // Updates completion time of the just completed scheduled task.
-      auto task_global_iteration = task.execution_metadata().global_iteration();
-      // Assign a non-negative value to the metadata index.
-      auto metadata_index =
-          (task_global_iteration == 0) ? 0 : task_global_iteration - 1;
-
-      if (not metadata_.empty() && metadata_index < metadata_.size()) {
-        *metadata_.at(metadata_index).mutable_completed_at() =
-            TimeUtil::GetCurrentTime();
+      PLOG(INFO) << "FedIteration: " << unsigned(global_iteration_)
+                 << " expired with " << to_schedule.size()
+                 << " completed learning task(s).";
+      StartNextRound(to_schedule, global_iteration_);
+    }
+
+  }
+
+  // Releases the current round if the learners that have departed, i.e.,
+  // left the federation, were evicted or are suspected to have failed, were
+  // the ones it was awaiting. The models of the learners that left the
+  // federation, or were evicted, are erased first.
+  void ScheduleAfterDeparture(const std::vector<std::string> &departed) {
+
+    SchedulingGuard scheduling_guard(this);
+    EraseDepartedModels(departed);
+
+    auto to_schedule = scheduler_->ScheduleAfterDeparture(ActiveLearners());
+    if (!to_schedule.empty()) {
+      PLOG(INFO) << "FedIteration: " << unsigned(global_iteration_)
+                 << " no longer awaits departed learners.";
+      StartNextRound(to_schedule, global_iteration_);
+    }
+
+  }
+
+  // Marks the learner as suspect, e.g., because a request to it failed.
+  void SuspectLearner(const std::string &learner_id) {
+
+    if (!TracksLiveness()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> liveness_guard(liveness_mutex_);
+      if (!liveness_.Suspect(learner_id)) {
+        return;
+      }
+    }
+    scheduling_executor_.Push(kControlLane, [this, learner_id] {
+      HandleDepartures({learner_id}, /* dead */ {});
+    });
+
+  }
+
+  // Stops sampling the suspect learners and evicts the dead learners from
+  // the federation, along with their models. The round is re-checked in the
+  // round lane, since it may have to be computed.
+  void HandleDepartures(const std::vector<std::string> &suspects,
+                        const std::vector<std::string> &dead) {
+
+    for (const auto &learner_id: suspects) {
+      std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+      {
+        // The learner may have sent a heartbeat in the meantime.
+        std::lock_guard<std::mutex> liveness_guard(liveness_mutex_);
+        if (!liveness_.IsSuspect(learner_id)) {
+          continue;
+        }
       }
+      PLOG(WARNING) << "Learner: " << learner_id
+                    << " is suspected to have failed.";
+      cohort_sampler_.Remove(learner_id);
+      selector_->RemoveLearner(learner_id);
+    }
 
-      // Select models that will participate in the community model.
-      auto selected_for_aggregation =
-          selector_->Select(to_schedule, GetLearners());
-
-      // Computes the community model using models that have
-      // been selected by the model selector.
-      auto community_model =
-          ComputeCommunityModel(selected_for_aggregation, metadata_index);
-
-      // Record the number of zeros and non-zeros values for
-      // each model layer/variable in the metadata collection.
-      RecordCommunityModelSize(community_model, metadata_index);
-
-      community_model.set_global_iteration(task_global_iteration);
-      // Updates the community model.
-      community_model_ = community_model;
-
-      // Creates an evaluation hash map container for the new community model.
-      CommunityModelEvaluation community_eval;
-      // Records the evaluation of the community model that was
-      // computed at the previously completed global iteration.
-      community_eval.set_global_iteration(task_global_iteration);
-      community_evaluations_.push_back(community_eval);
-
-      // Evaluate the community model across all scheduled learners. Send
-      // community model evaluation tasks to all scheduled learners. Each
-      // learner holds a different training, validation and test dataset
-      // and hence we need to evaluate the community model over each dataset.
-      // All evaluation tasks are submitted asynchronously, therefore, to
-      // make sure that all metrics are properly collected when an EvaluateModel
-      // response is received, we pass the index of the `community_evaluations_`
-      // vector of the position to which the current community model refers to.
-      // We also pass the index to the `metadata_` vector to which the current
-      // evaluation task corresponds and needs to store the associated meta data.
-      SendEvaluationTasks(to_schedule,
-                          community_model,
-                          community_evaluations_.size() - 1,
-                          metadata_index);
-
-      // Increase global iteration counter to reflect the new scheduling round.
-      ++global_iteration_;
-      PLOG(INFO) << "FedIteration: " << unsigned(global_iteration_);
-
-      // Set the specifications of the next training task.
-      UpdateLearnersTaskTemplates(to_schedule);
-
-      // Set the specifications of the next training task.
-      UpdateLearnersTaskTemplates(to_schedule);
-
-      // Creates a new federation runtime metadata
-      // object for the new scheduling round.
-      FederatedTaskRuntimeMetadata new_meta = FederatedTaskRuntimeMetadata();
-      new_meta.set_global_iteration(global_iteration_);
-      *new_meta.mutable_started_at() = TimeUtil::GetCurrentTime();
-      // Records the id of the learners to which
-      // the controller delegates the training task.
-      for (const auto &to_schedule_id: to_schedule) {
-        *new_meta.add_assigned_to_learner_id() = to_schedule_id;
+    std::vector<std::string> evicted;
+    for (const auto &learner_id: dead) {
+      {
+        std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+        if (!Learners()->contains(learner_id)) {
+          continue;
+        }
+        PLOG(WARNING) << "Evicting learner: " << learner_id
+                      << " after missing its heartbeats.";
+        UnregisterLearner(learner_id);
       }
+      ReleaseLearner(learner_id);
+      evicted.push_back(learner_id);
+    }
+
+    scheduling_executor_.Push(kRoundLane, [this, evicted = std::move(evicted)] {
+      ScheduleAfterDeparture(evicted);
+    });
 
-      // Send training task to all scheduled learners.
-      SendRunTasks(to_schedule, community_model, new_meta);
+  }
 
-      // Save federated task runtime metadata.
-      metadata_.emplace_back(new_meta);
+  // Periodically checks whether the current round has expired, and advances
+  // the learners' liveness by one tick every heartbeat interval, until the
+  // controller shuts down. The expiration check runs in the round lane and
+  // at most one check is pending at any time.
+  void RunTimer() {
+
+    auto heartbeat_interval = std::chrono::seconds(
+        params_.liveness_specs().heartbeat_interval_secs());
+    auto next_liveness_tick = std::chrono::steady_clock::now() + heartbeat_interval;
+
+    std::unique_lock<std::mutex> timer_lock(timer_mutex_);
+    while (!timer_cv_.wait_for(timer_lock, kTimerInterval,
+                               [this] { return timer_stopped_; })) {
+      if (HasRoundDeadline() && !round_timer_pending_.exchange(true)) {
+        scheduling_executor_.Push(kRoundLane, [this] { ScheduleExpiredRound(); });
+      }
+      if (!TracksLiveness() ||
+          std::chrono::steady_clock::now() < next_liveness_tick) {
+        continue;
+      }
+      next_liveness_tick += heartbeat_interval;
+      std::vector<std::string> suspects;
+      std::vector<std::string> dead;
+      {
+        std::lock_guard<std::mutex> liveness_guard(liveness_mutex_);
+        dead = liveness_.Tick(&suspects);
+      }
+      if (!suspects.empty() || !dead.empty()) {
+        scheduling_executor_.Push(
+            kControlLane,
+            [this, suspects = std::move(suspects), dead = std::move(dead)] {
+              HandleDepartures(suspects, dead);
+            });
+      }
     }
 
   }
 
-  void UpdateLearnersTaskTemplates(std::vector<std::string> &learners) {
+  // The position that follows the most recent task in the learner's local
+  // task lineage. If the end of the lineage is not tracked, the lineage is
+  // assumed to start at position 0. Must be called with the metadata lock
+  // held.
+  uint64_t LocalTasksEndIndex(const std::string &learner_id) const {
+    auto itr = local_tasks_end_index_.find(learner_id);
+    if (itr != local_tasks_end_index_.end()) {
+      return itr->second;
+    }
+    auto lineage = local_tasks_metadata_.find(learner_id);
+    return lineage == local_tasks_metadata_.end() ? 0 : lineage->second.size();
+  }
 
-    // If we are running in a semi-synchronous setting, we need to update the
-    // task templates based on the execution times of the previous global
-    // iteration.
-    const auto &communication_specs = params_.communication_specs();
-    const auto &protocol_specs = communication_specs.protocol_specs();
-    // We check if it is the 2nd global_iteration_, because the 1st
-    // global_iteration_ refers to the very first initially scheduled task.
-    if (communication_specs.protocol() ==
-        CommunicationSpecs::SEMI_SYNCHRONOUS &&
-        (global_iteration_ == 2 ||
-            protocol_specs.semi_sync_recompute_num_updates())) {
-
-      // Finds the slowest learner.
-      // float ms_per_batch_slowest = std::numeric_limits<float>::min();
-      float ms_per_epoch_slowest = std::numeric_limits<float>::min();
-      for (const auto &learner_id: learners) {
-        const auto &metadata = local_tasks_metadata_[learner_id].front();
-        // if (metadata.processing_ms_per_batch() > ms_per_batch_slowest) {
-        //   ms_per_batch_slowest = metadata.processing_ms_per_batch();
-        // }
-        if (metadata.processing_ms_per_epoch() > ms_per_epoch_slowest) {
-          ms_per_epoch_slowest = metadata.processing_ms_per_epoch();
+  // Stops the timer and waits for it to exit. Safe to call more than once.
+  void StopTimer() {
+    {
+      std::lock_guard<std::mutex> timer_guard(timer_mutex_);
+      timer_stopped_ = true;
+    }
+    timer_cv_.notify_all();
+    if (timer_.joinable()) {
+      timer_.join();
+    }
+  }
+
+  // Stops dispatching tasks and waits for the responses of the dispatched
+  // ones to be digested. The requests that are still in flight are
+  // cancelled, since the learners may never respond. Safe to call more than
+  // once.
+  void StopRunTasks() {
+    {
+      std::lock_guard<std::mutex> run_tasks_guard(run_tasks_mutex_);
+      if (!run_tasks_stopped_) {
+        run_tasks_stopped_ = true;
+        for (auto *call: run_tasks_in_flight_) {
+          call->context.TryCancel();
         }
+        run_tasks_cq_.Shutdown();
       }
+    }
+    if (run_tasks_digest_.joinable()) {
+      run_tasks_digest_.join();
+    }
+  }
+
+  // Computes the community model from the models of the learners that have
+  // just completed the round `task_global_iteration`, and schedules the next
+  // round on these learners, or on a sampled cohort of the learners if only
+  // a fraction of them participates in every round. Must be called with the
+  // scheduling lock held.
+  void StartNextRound(const std::vector<std::string> &to_schedule,
+                      uint32_t task_global_iteration) {
+
+    // Assign a non-negative value to the metadata index.
+    auto metadata_index =
+        (task_global_iteration == 0) ? 0 : task_global_iteration - 1;
+
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      if (auto *meta = metadata_.Find(metadata_index)) {
+        *meta->mutable_completed_at() = TimeUtil::GetCurrentTime();
+      }
+    }
 
-      // Calculates the allowed time for training.
-      float t_max = static_cast<float>(
-          protocol_specs.semi_sync_lambda()) *
-          ms_per_epoch_slowest;
+    // Select models that will participate in the community model. If the
+    // rounds are assigned to sampled cohorts, or if the updates are buffered,
+    // only the models of the learners that completed the round are
+    // aggregated, since the models of the other learners are stale, if they
+    // exist at all.
+    auto selected_for_aggregation = SamplesCohorts() || BuffersUpdates()
+        ? to_schedule : selector_->Select(to_schedule, GetLearners());
+
+    // Computes the community model using models that have
+    // been selected by the model selector. The aggregation metadata are
+    // collected apart and recorded once the aggregation is complete, so
+    // that the metadata collection is not locked during the aggregation.
+    FederatedTaskRuntimeMetadata aggregation_meta;
+    auto community_model = std::make_shared<FederatedModel>(
+        ComputeCommunityModel(selected_for_aggregation, &aggregation_meta));
+
+    // Record the number of zeros and non-zeros values for
+    // each model layer/variable in the metadata collection.
+    RecordCommunityModelSize(*community_model, &aggregation_meta);
+
+    community_model->set_global_iteration(task_global_iteration);
+    // Updates the community model, and makes it available to the learners.
+    auto community_model_version =
+        PublishCommunityModel(std::move(community_model));
+
+    // The learners that run the next round. If the updates are buffered, the
+    // learners were assigned their next task when they completed this one.
+    std::vector<std::string> cohort = to_schedule;
+    if (BuffersUpdates()) {
+      cohort.clear();
+    } else if (SamplesCohorts()) {
+      {
+        std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+        // The speed-aware selector tracks the learners itself; hence, it
+        // is not handed the active learners.
+        cohort = SelectsFastest()
+                 ? selector_->Select(to_schedule, /* active_learners */ {})
+                 : cohort_sampler_.Sample(CohortSize(cohort_sampler_.size()));
+      }
+      scheduler_->SetCohort(cohort);
+    }
 
-      // Updates the task templates based on the slowest learner.
-      for (const auto &learner_id: learners) {
-        const auto &metadata = local_tasks_metadata_[learner_id].front();
+    // If the rounds are pipelined, the learners that run ahead on the next
+    // round, or have completed it, are not assigned its task again. The
+    // models of the tasks completed ahead of the next round enter the store
+    // now that the community model of this round has been computed.
+    std::vector<AheadTasks::CompletedTask> completed_ahead;
+    if (PipelinesRounds()) {
+      auto learners = Learners();
+      completed_ahead = ahead_tasks_.Take(
+          global_iteration_ + 1,
+          [&learners](const std::string &learner_id) {
+            return learners->contains(learner_id);
+          },
+          &cohort);
+      for (auto &completed: completed_ahead) {
+        PLOG(INFO) << "Insert learner\'s " << completed.learner_id << " model.";
+        completed.model->Commit();
+        completed.model.reset();
+      }
+    }
 
-        auto processing_ms_per_batch = metadata.processing_ms_per_batch();
-        if (processing_ms_per_batch == 0) {
-          PLOG(ERROR) << "Processing ms per batch is zero. Setting to 1.";
-          processing_ms_per_batch = 1;
+    // Creates an evaluation hash map container for the new community model.
+    CommunityModelEvaluation community_eval;
+    // Records the evaluation of the community model that was
+    // computed at the previously completed global iteration.
+    community_eval.set_global_iteration(task_global_iteration);
+
+    // Each learner holds a different training, validation and test dataset
+    // and hence we need to evaluate the community model over each dataset.
+    // The scheduled learners evaluate the community model along with their
+    // next training task, so that they receive the model only once, and
+    // report the evaluations with the completed task (see
+    // RecordCommunityModelEvaluation()).
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      community_evaluations_.Append(std::move(community_eval));
+      if (auto *meta = metadata_.Find(metadata_index)) {
+        meta->MergeFrom(aggregation_meta);
+        for (const auto &cohort_id: cohort) {
+          (*meta->mutable_eval_task_submitted_at())[cohort_id] =
+              TimeUtil::GetCurrentTime();
         }
-        int num_local_updates = std::ceil(t_max / processing_ms_per_batch);
+      }
+    }
 
-        auto &task_template = learners_task_template_[learner_id];
-        task_template.set_num_local_updates(num_local_updates);
+    // Increase global iteration counter to reflect the new scheduling round.
+    ++global_iteration_;
+    PLOG(INFO) << "FedIteration: " << unsigned(global_iteration_);
+
+    // Set the specifications of the next training task.
+    UpdateLearnersTaskTemplates(cohort);
+
+    // Creates a new federation runtime metadata
+    // object for the new scheduling round.
+    FederatedTaskRuntimeMetadata new_meta = FederatedTaskRuntimeMetadata();
+    new_meta.set_global_iteration(global_iteration_);
+    *new_meta.mutable_started_at() = TimeUtil::GetCurrentTime();
+    // Records the id of the learners to which
+    // the controller delegates the training task.
+    for (const auto &cohort_id: cohort) {
+      *new_meta.add_assigned_to_learner_id() = cohort_id;
+    }
+    // The tasks of the round that started while the previous round was
+    // running are recorded along with their original submission time.
+    for (const auto &[learner_id, ahead]: ahead_tasks_.running()) {
+      if (ahead.global_iteration == global_iteration_) {
+        *new_meta.add_assigned_to_learner_id() = learner_id;
+        (*new_meta.mutable_train_task_submitted_at())[learner_id] =
+            ahead.submitted_at;
       }
+    }
+    for (const auto &completed: completed_ahead) {
+      const auto &learner_id = completed.learner_id;
+      *new_meta.add_assigned_to_learner_id() = learner_id;
+      *new_meta.add_completed_by_learner_id() = learner_id;
+      (*new_meta.mutable_train_task_submitted_at())[learner_id] =
+          completed.submitted_at;
+      (*new_meta.mutable_train_task_received_at())[learner_id] =
+          completed.received_at;
+    }
+
+    // Save federated task runtime metadata.
+    uint64_t new_metadata_index;
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      new_metadata_index = metadata_.Append(std::move(new_meta));
+    }
+
+    // Send training task, along with the evaluation of the
+    // community model, to all scheduled learners.
+    SendRunTasks(cohort, community_model_version, new_metadata_index,
+                 global_iteration_, /* evaluate_model */ true);
 
-    } // end-if.
+    // Snapshot the state of the newly started round.
+    CheckpointAsync();
+
+    // The tasks that were completed ahead of the round count towards it now;
+    // they may even complete the round.
+    for (const auto &completed: completed_ahead) {
+      ScheduleCompletedTask(completed.learner_id, completed.task);
+    }
 
   }
 
-  void SendEvaluationTasks(std::vector<std::string> &learners,
-                           const FederatedModel &model,
-                           const uint32_t &comm_eval_ref_idx,
-                           const uint32_t &metadata_ref_idx) {
+  // Records the evaluations of the community model that the learner trained
+  // on, i.e., the community model computed at the end of the previous round.
+  void RecordCommunityModelEvaluation(const std::string &learner_id,
+                                      const CompletedLearningTask &task) {
 
-    // Our goal is to send the EvaluateModel request to each learner in parallel.
-    // We use a single thread to asynchronously send all evaluate model requests
-    // and add every submitted EvaluateModel request inside a grpc::CompletionQueue.
-    // The implementation follows the (recommended) async grpc client:
-    // https://github.com/grpc/grpc/blob/master/examples/cpp/helloworld/greeter_async_client2.cc
-    for (const auto &learner_id: learners) {
-      (*metadata_.at(metadata_ref_idx)
-          .mutable_eval_task_submitted_at())[learner_id] = TimeUtil::GetCurrentTime();
-      SendEvaluationTaskAsync(
-          learner_id, model, comm_eval_ref_idx, metadata_ref_idx);
-    }
-  }
-
-  void SendEvaluationTaskAsync(const std::string &learner_id,
-                               const FederatedModel &model,
-                               const uint32_t &comm_eval_ref_idx,
-                               const uint32_t &metadata_ref_idx) {
-
-    // FIXME(stripeli,canastas): This needs to be reimplemented by using
-    //  a single channel or stub. We tried to implement this that way, but when
-    //  we run either of the two approaches either through the (reused) channel
-    //  or stub, the requests were delayed substantially and not received
-    //  immediately by the learners. For instance, under normal conditions
-    //  sending the tasks should take around 10-20secs but by reusing the
-    //  grpc Stub/Channel sending all requests would take around 100-120secs.
-    //  This behavior did not occur when testing with small model proto
-    //  messages, e.g., DenseNet FashionMNIST with 120k params but it is clearly
-    //  evident when working with very large model proto messages, e.g.,
-    //  CIFAR-10 with 1.6M params and encryption using FHE ~ 100MBs per model.
-    auto learner_stub = CreateLearnerStub(learner_id);
-
-    auto &cq = eval_tasks_cq_;
-    auto &params = params_;
-    EvaluateModelRequest request;
-    *request.mutable_model() = model.model();
-    request.set_batch_size(params.model_hyperparams().batch_size());
-    request.add_evaluation_dataset(EvaluateModelRequest::TRAINING);
-    request.add_evaluation_dataset(EvaluateModelRequest::VALIDATION);
-    request.add_evaluation_dataset(EvaluateModelRequest::TEST);
+    auto task_global_iteration = task.execution_metadata().global_iteration();
+    if (task_global_iteration < 2) {
+      return;
+    }
+    auto evaluated_global_iteration = task_global_iteration - 1;
+
+    // The evaluations of the most recent community models are at the back.
+    std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+    auto index = community_evaluations_.end_index();
+    while (index-- > community_evaluations_.begin_index()) {
+      auto *community_eval = community_evaluations_.Find(index);
+      if (community_eval->global_iteration() != evaluated_global_iteration) {
+        continue;
+      }
+      (*community_eval->mutable_evaluations())[learner_id] =
+          task.federated_model_evaluations();
+      if (auto *meta = metadata_.Find(evaluated_global_iteration - 1)) {
+        (*meta->mutable_eval_task_received_at())[learner_id] =
+            TimeUtil::GetCurrentTime();
+      }
+      return;
+    }
 
-    // Call object to store rpc data.
-    auto *call = new AsyncLearnerEvalCall;
+  }
 
-    // Set the learner id this call will be submitted to.
-    call->learner_id = learner_id;
+  void ResumeFromCheckpoint() {
+
+    SchedulingGuard scheduling_guard(this);
 
-    // Set the index of the community model evaluation vector evaluation
-    // metrics and values will be stored when response is received.
-    call->comm_eval_ref_idx = comm_eval_ref_idx;
+    if (!CommunityModel()->IsInitialized()) {
+      return;
+    }
 
-    // Set the index of the global model iteration to access the metadata_
-    // vector collection and store additional metadata related to the
-    // evaluation request, such as reception time of the evaluation task.
-    call->metadata_ref_idx = metadata_ref_idx;
+    // The learners' replies to the interrupted round are lost; hence,
+    // the round is dispatched again to all the learners assigned to it.
+    auto learners = Learners();
+    uint64_t metadata_index;
+    std::vector<std::string> to_schedule;
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      if (metadata_.empty()) {
+        return;
+      }
+      metadata_index = metadata_.end_index() - 1;
+      for (const auto &learner_id: metadata_.back().assigned_to_learner_id()) {
+        if (learners->contains(learner_id)) {
+          to_schedule.push_back(learner_id);
+        }
+      }
+    }
 
-    // stub->PrepareAsyncEvaluateModel() creates an RPC object, returning
-    // an instance to store in "call" but does not actually start the RPC
-    // Because we are using the asynchronous API, we need to hold on to
-    // the "call" instance in order to get updates on the ongoing RPC.
-    // Opens gRPC channel with learner.
-    call->response_reader = learner_stub->
-        PrepareAsyncEvaluateModel(&call->context, request, &cq);
+    if (SamplesCohorts()) {
+      scheduler_->SetCohort(to_schedule);
+    }
 
-    // Initiate the RPC call.
-    call->response_reader->StartCall();
+    PLOG(INFO) << "Resuming FedIteration: " << unsigned(global_iteration_)
+               << " on " << to_schedule.size() << " learners.";
+    SendRunTasks(to_schedule, CommunityModelVersion(), metadata_index,
+                 global_iteration_, /* evaluate_model */ false);
 
-    // Request that, upon completion of the RPC, "reply" be updated with the
-    // server's response; "status" with the indication of whether the operation
-    // was successful. Tag the request with the memory address of the call object.
-    call->response_reader->Finish(&call->reply, &call->status, (void *) call);
+  }
+
+  // Splits the community model into the chunks that are served to the
+  // learners, assigns a new version to it and makes it the current
+  // community model. The model is serialized once, independently of the
+  // number of learners that fetch it, and is never modified afterwards;
+  // readers keep using the snapshot they hold while a newer one is published.
+  uint32_t
+  PublishCommunityModel(std::shared_ptr<const FederatedModel> community_model) {
+
+    CachedCommunityModel cached;
+    cached.chunks = SplitCommunityModel(
+        *community_model, community_model->model(), /* delta_base_version */ 0);
+    cached.model = community_model;
+
+    std::lock_guard<std::mutex> cache_guard(community_model_cache_mutex_);
+    auto version = ++community_model_version_;
+    community_model_cache_[version] = std::move(cached);
+    while (community_model_cache_.size() > kNumCachedCommunityModels) {
+      community_model_cache_.erase(community_model_cache_.begin());
+    }
+    // Swapped while the cache lock is held, so that the current snapshot
+    // and the most recent version always refer to the same model.
+    std::atomic_store(&community_model_, std::move(community_model));
+    return version;
 
   }
 
-  void DigestEvaluationTasksResponses() {
+  // Creates the messages through which `model`, which is either the model
+  // of the community model or its delta against `delta_base_version`, is
+  // served to the learners.
+  static std::shared_ptr<const CommunityModelChunks>
+  SplitCommunityModel(const FederatedModel &community_model,
+                      const Model &model,
+                      uint32_t delta_base_version) {
+
+    auto chunks = std::make_shared<CommunityModelChunks>();
+    auto &header = chunks->emplace_back();
+    header.set_delta_base_version(delta_base_version);
+    auto &metadata = *header.mutable_federated_model();
+    metadata.set_num_contributors(community_model.num_contributors());
+    metadata.set_global_iteration(community_model.global_iteration());
+    for (auto &model_chunk: SplitModelIntoChunks(model, kCommunityModelChunkBytes)) {
+      chunks->emplace_back().mutable_model_chunk()->Swap(&model_chunk);
+    }
+    return chunks;
 
-    // This function loops indefinitely over the `eval_task_q` completion queue.
-    // It stops when it receives a shutdown signal. Specifically, `cq._Next()`
-    // will not return false until `cq_.Shutdown()` is called and all pending
-    // tags have been digested.
-    void *got_tag;
-    bool ok = false;
+  }
 
-    auto &cq_ = eval_tasks_cq_;
-    // Block until the next result is available in the completion queue "cq".
-    while (cq_.Next(&got_tag, &ok)) {
+  uint32_t CommunityModelVersion() {
+    std::lock_guard<std::mutex> cache_guard(community_model_cache_mutex_);
+    return community_model_version_;
+  }
 
-      // The tag is the memory location of the call object.
-      auto *call = static_cast<AsyncLearnerEvalCall *>(got_tag);
+  void CheckpointAsync() {
 
-      // Verify that the request was completed successfully. Note that "ok"
-      // corresponds solely to the request for updates introduced by Finish().
-      GPR_ASSERT(ok);
+    const auto &checkpoint_specs = params_.checkpoint_specs();
+    if (checkpoint_specs.checkpoint_dir().empty()) {
+      return;
+    }
+    uint32_t interval = checkpoint_specs.checkpoint_interval() == 0 ?
+                        1 : checkpoint_specs.checkpoint_interval();
+    if (global_iteration_ % interval != 0) {
+      return;
+    }
 
-      if (call) {
-        // If either a failed or successful response is received
-        // then handle the content of the received response.
-        if (call->status.ok()) {
-          (*metadata_.at(call->metadata_ref_idx)
-              .mutable_eval_task_received_at())[call->learner_id] = TimeUtil::GetCurrentTime();
-          ModelEvaluations model_evaluations;
-          *model_evaluations.mutable_training_evaluation() =
-              call->reply.evaluations().training_evaluation();
-          *model_evaluations.mutable_validation_evaluation() =
-              call->reply.evaluations().validation_evaluation();
-          *model_evaluations.mutable_test_evaluation() =
-              call->reply.evaluations().test_evaluation();
-          (*community_evaluations_.at(call->comm_eval_ref_idx)
-              .mutable_evaluations())[call->learner_id] = model_evaluations;
-        } else {
-          PLOG(ERROR) << "EvaluateModel RPC request to learner: " << call->learner_id
-                      << " failed with error: " << call->status.error_message();
+    // Only one snapshot is written at a time. If the previous snapshot is
+    // still being written, the current one is skipped rather than queued,
+    // since it would be immediately superseded by the next one anyway.
+    if (checkpoint_in_flight_.exchange(true)) {
+      PLOG(WARNING) << "Previous checkpoint still in progress. Skipping "
+                       "checkpoint of FedIteration: " << unsigned(global_iteration_);
+      return;
+    }
+
+    // The state is copied while the scheduling lock is held (called
+    // from ScheduleTasks()), while the serialization and the disk I/O
+    // happen in the background, outside of the scheduling path.
+    std::shared_ptr<const FederatedModel> community_model;
+    auto checkpoint = std::make_shared<ControllerCheckpoint>();
+    {
+      // The model and its version are swapped together under this lock.
+      std::lock_guard<std::mutex> cache_guard(community_model_cache_mutex_);
+      community_model = CommunityModel();
+      checkpoint->set_community_model_version(community_model_version_);
+    }
+    checkpoint->set_global_iteration(global_iteration_);
+    for (const auto &[learner_id, learner_state]: *Learners()) {
+      *checkpoint->add_learners() = learner_state;
+    }
+    {
+      std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+      checkpoint->mutable_learners_task_template()->insert(
+          learners_task_template_.begin(), learners_task_template_.end());
+    }
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      // Only the lineages kept in memory are part of the snapshot.
+      checkpoint->set_community_evaluations_begin(
+          community_evaluations_.begin_index());
+      community_evaluations_.CopyRange(
+          community_evaluations_.begin_index(),
+          community_evaluations_.end_index() - community_evaluations_.begin_index(),
+          checkpoint->mutable_community_evaluations());
+      checkpoint->set_runtime_metadata_begin(metadata_.begin_index());
+      metadata_.CopyRange(metadata_.begin_index(),
+                          metadata_.end_index() - metadata_.begin_index(),
+                          checkpoint->mutable_runtime_metadata());
+      auto &local_tasks_metadata = *checkpoint->mutable_local_tasks_metadata();
+      for (const auto &[learner_id, lineage]: local_tasks_metadata_) {
+        auto &checkpoint_lineage = local_tasks_metadata[learner_id];
+        checkpoint_lineage.mutable_task_execution_metadata()->Add(
+            lineage.begin(), lineage.end());
+        checkpoint_lineage.set_end_index(LocalTasksEndIndex(learner_id));
+      }
+    }
+
+    checkpoint_pool_.push_task(
+        [this, community_model, checkpoint,
+            checkpoint_dir = checkpoint_specs.checkpoint_dir()] {
+          auto start_time = std::chrono::high_resolution_clock::now();
+          auto status = SaveControllerCheckpoint(
+              checkpoint_dir, *community_model, *checkpoint);
+          std::chrono::duration<double, std::milli> elapsed_time =
+              std::chrono::high_resolution_clock::now() - start_time;
+          if (status.ok()) {
+            PLOG(INFO) << "Checkpoint of FedIteration: "
+                       << checkpoint->global_iteration() << " saved in "
+                       << elapsed_time.count() << "ms.";
+          } else {
+            PLOG(ERROR) << "Checkpoint of FedIteration: "
+                        << checkpoint->global_iteration()
+                        << " failed: " << status.message();
+          }
+          checkpoint_in_flight_ = false;
+        });
+
+  }
+
+  // Assigns the learners' local updates based on their estimated throughput,
+  // so that their tasks take a target amount of time:
+  //  (1) Semi-synchronous: lambda times the epoch time of the slowest learner.
+  //  (2) Synchronous, if the local updates are aligned: the time the slowest
+  //      learner takes to complete its default number of updates, so that
+  //      all learners are predicted to finish along with it.
+  //  (3) Asynchronous, if there is a task budget: the budget.
+  // The target time is computed over all active learners, even if only the
+  // templates of some learners are updated (e.g., of a learner that runs
+  // ahead of the round), so that they stay aligned with the rest.
+  // Learners that have not completed any task yet keep their task template.
+  void UpdateLearnersTaskTemplates(const std::vector<std::string> &learners) {
+
+    const auto &communication_specs = params_.communication_specs();
+    const auto &protocol_specs = communication_specs.protocol_specs();
+    // We check if it is the 2nd global_iteration_, because the 1st
+    // global_iteration_ refers to the very first initially scheduled task.
+    bool semi_synchronous =
+        communication_specs.protocol() == CommunicationSpecs::SEMI_SYNCHRONOUS &&
+        (global_iteration_ == 2 ||
+            protocol_specs.semi_sync_recompute_num_updates());
+    bool synchronous =
+        communication_specs.protocol() == CommunicationSpecs::SYNCHRONOUS &&
+        protocol_specs.sync_align_local_updates();
+    bool asynchronous =
+        communication_specs.protocol() == CommunicationSpecs::ASYNCHRONOUS &&
+        protocol_specs.async_task_budget_ms() > 0;
+    if (!semi_synchronous && !synchronous && !asynchronous) {
+      return;
+    }
+
+    std::vector<std::string> reference_learners(learners);
+    if (!asynchronous) {
+      for (const auto &learner: ActiveLearners()) {
+        reference_learners.push_back(learner.id());
+      }
+    }
+
+    // The predicted processing time per batch of every learner.
+    absl::flat_hash_map<std::string, double> ms_per_batch;
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      for (const auto &learner_id: reference_learners) {
+        auto throughput = learners_throughput_.find(learner_id);
+        if (throughput != learners_throughput_.end() &&
+            !throughput->second.empty()) {
+          ms_per_batch[learner_id] = throughput->second.PredictedMsPerBatch();
         }
-      } //end if call
+      }
+    }
 
-      delete call;
+    // Calculates the allowed time for training.
+    double t_max = 0;
+    if (asynchronous) {
+      t_max = protocol_specs.async_task_budget_ms();
+    } else {
+      auto learners_states = Learners();
+      for (const auto &[learner_id, learner_ms_per_batch]: ms_per_batch) {
+        auto learner_state = learners_states->find(learner_id);
+        if (learner_state == learners_states->end()) {
+          continue;
+        }
+        const auto &dataset_spec = learner_state->second.learner().dataset_spec();
+        auto num_batches = semi_synchronous ? StepsPerEpoch(dataset_spec)
+                                            : DefaultNumLocalUpdates(dataset_spec);
+        t_max = std::max(t_max, num_batches * learner_ms_per_batch);
+      }
+      if (semi_synchronous) {
+        t_max *= protocol_specs.semi_sync_lambda();
+      }
+    }
 
-    } // end of loop
+    std::lock_guard<std::mutex> learners_guard(learners_mutex_);
+    for (const auto &learner_id: learners) {
+      auto learner_ms_per_batch = ms_per_batch.find(learner_id);
+      if (learner_ms_per_batch == ms_per_batch.end()) {
+        continue;
+      }
+      auto task_template = learners_task_template_.find(learner_id);
+      if (task_template == learners_task_template_.end()) {
+        // The learner left the federation.
+        continue;
+      }
+      auto num_local_updates = std::max<long>(
+          std::lround(t_max / learner_ms_per_batch->second), 1);
+      task_template->second.set_num_local_updates(num_local_updates);
+    }
 
   }
 
-  void SendRunTasks(std::vector<std::string> &learners,
-                    const FederatedModel &model,
-                    FederatedTaskRuntimeMetadata &meta) {
+  void SendRunTasks(const std::vector<std::string> &learners,
+                    uint32_t model_version,
+                    uint64_t metadata_index,
+                    uint32_t global_iteration,
+                    bool evaluate_model) {
 
     // Our goal is to send the RunTask request to each learner in parallel.
     // We use a single thread to asynchronously send all run task requests
     // and add every submitted RunTask request inside a grpc::CompletionQueue.
     // The implementation follows the (recommended) async grpc client:
     // https://github.com/grpc/grpc/blob/master/examples/cpp/helloworld/greeter_async_client2.cc
+    //
+    // The request only references the community model by its version; the
+    // learners fetch the model itself from the controller. The model version
+    // and the hyperparameters are the same for all learners. Therefore, they
+    // are serialized once, and only the learning task, which is specific to
+    // each learner, is serialized per request.
+    const auto &model_params = params_.model_hyperparams();
+    RunTaskRequest shared_fields;
+    shared_fields.set_federated_model_version(model_version);
+    shared_fields.set_evaluate_federated_model(evaluate_model);
+    auto *hyperparams = shared_fields.mutable_hyperparameters();
+    hyperparams->set_batch_size(model_params.batch_size());
+    *hyperparams->mutable_optimizer() = model_params.optimizer();
+    const auto shared_fields_slice = SerializeToSlice(shared_fields);
+
+    // The submission times are recorded once all requests are submitted,
+    // so that the metadata collection is not locked during the submission.
+    // The tasks of a later round are recorded as overlapping the current one.
+    FederatedTaskRuntimeMetadata submitted;
+    auto *submitted_at = global_iteration > global_iteration_
+                         ? submitted.mutable_train_task_submitted_ahead_at()
+                         : submitted.mutable_train_task_submitted_at();
     for (const auto &learner_id: learners) {
-      (*meta.mutable_train_task_submitted_at())[learner_id] =
-          TimeUtil::GetCurrentTime();
-      SendRunTaskAsync(learner_id, model);
+      (*submitted_at)[learner_id] = TimeUtil::GetCurrentTime();
+      SendRunTaskAsync(learner_id, global_iteration, shared_fields_slice);
+    }
+
+    std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+    if (auto *meta = metadata_.Find(metadata_index)) {
+      meta->MergeFrom(submitted);
     }
 
   }
 
   void SendRunTaskAsync(const std::string &learner_id,
-                        const FederatedModel &model) {
+                        uint32_t global_iteration,
+                        const grpc::Slice &shared_fields_slice) {
 
-    auto learner_stub = CreateLearnerStub(learner_id);
+    // The registry lock is only held to look up the learner's connection
+    // and task template; the request is prepared and sent outside of it.
+    LearningTaskTemplate task_template;
+    auto learner_stub = GetLearnerStub(learner_id, &task_template);
+    if (!learner_stub) {
+      PLOG(WARNING) << "Learner: " << learner_id << " is no longer registered.";
+      return;
+    }
 
     auto &cq = run_tasks_cq_;
-    auto &params = params_;
-    auto global_iteration = global_iteration_;
-    const auto &task_template = learners_task_template_[learner_id];
 
-    RunTaskRequest request;
-    *request.mutable_federated_model() = model;
-    auto *next_task = request.mutable_task();
+    RunTaskRequest learner_fields;
+    auto *next_task = learner_fields.mutable_task();
     next_task->set_global_iteration(global_iteration);
-    const auto &model_params = params.model_hyperparams();
     next_task->set_num_local_updates(
         task_template.num_local_updates()); // get from task template.
     next_task->set_training_dataset_percentage_for_stratified_validation(
-        model_params.percent_validation());
+        params_.model_hyperparams().percent_validation());
     // TODO(stripeli): Add evaluation metrics for the learning task.
 
-    auto *hyperparams = request.mutable_hyperparameters();
-    hyperparams->set_batch_size(model_params.batch_size());
-    *hyperparams->mutable_optimizer() =
-        params.model_hyperparams().optimizer();
+    // The shared slice is referenced by the request, not copied.
+    auto request = ConcatSlices(
+        {SerializeToSlice(learner_fields), shared_fields_slice});
+
+    std::lock_guard<std::mutex> run_tasks_guard(run_tasks_mutex_);
+    if (run_tasks_stopped_) {
+      return;
+    }
 
     // Call object to store rpc data.
     auto *call = new AsyncLearnerRunTaskCall;
 
     call->learner_id = learner_id;
-    // stub->PrepareAsyncRunTask() creates an RPC object, returning
+    // stub.PrepareUnaryCall() creates an RPC object, returning
     // an instance to store in "call" but does not actually start the RPC
     // Because we are using the asynchronous API, we need to hold on to
     // the "call" instance in order to get updates on the ongoing RPC.
-    // Opens gRPC channel with learner.
-    call->response_reader = learner_stub->
-        PrepareAsyncRunTask(&call->context, request, &cq);
+    call->response_reader = learner_stub->PrepareUnaryCall(
+        &call->context, LearnerMethod("RunTask"), request, &cq);
 
     // Initiate the RPC call.
     call->response_reader->StartCall();
+    run_tasks_in_flight_.insert(call);
 
     // Request that, upon completion of the RPC, "reply" be updated with the
     // server's response; "status" with the indication of whether the operation
@@ -780,12 +2074,29 @@ class ControllerDefaultImpl : public Controller {
       if (call) {
         // If either a failed or successful response is received
         // then handle the content of the received response.
-        if (!call->status.ok()) {
+        // The requests cancelled by the controller's shutdown are not failures.
+        RunTaskResponse response;
+        if (!call->status.ok() &&
+            call->status.error_code() != grpc::StatusCode::CANCELLED) {
           PLOG(ERROR) << "RunTask RPC request to learner: " << call->learner_id
                       << " failed with error: " << call->status.error_message();
+          // The learner will not complete the task; the round stops
+          // awaiting it until it proves to be alive.
+          SuspectLearner(call->learner_id);
+        } else if (call->status.ok() &&
+            (!ParseFromByteBuffer(call->reply, &response) ||
+                !response.ack().status())) {
+          PLOG(ERROR) << "Learner: " << call->learner_id
+                      << " did not accept its RunTask request.";
+          // Likewise, the learner will not complete the task.
+          SuspectLearner(call->learner_id);
         }
       } //end if call
 
+      {
+        std::lock_guard<std::mutex> run_tasks_guard(run_tasks_mutex_);
+        run_tasks_in_flight_.erase(call);
+      }
       delete call;
 
     } // end of loop
@@ -795,45 +2106,61 @@ class ControllerDefaultImpl : public Controller {
   FederatedModel
   ComputeCommunityModel(
       const std::vector<std::string> &learners_ids,
-      const uint32_t &metadata_ref_idx) {
+      FederatedTaskRuntimeMetadata *aggregation_meta) {
 
     // Handles the case where the community model is requested for the
     // first time and has the original (random) initialization state.
-    if (global_iteration_ < 1 && community_model_.IsInitialized()) {
-      return community_model_;
+    auto community_model = CommunityModel();
+    if (global_iteration_ < 1 && community_model->IsInitialized()) {
+      return *community_model;
     }
 
-    // We need to lock the model store to avoid reading stale models.
-    // Basically, we need to make sure that all local models used
-    // for aggregation are valid pointers, if we do not lock then
-    // unexpected behaviors occur and the controller crashes.
-    std::lock_guard<std::mutex> model_store_guard(model_store_mutex_);
+    // There is no need to lock the model store. The models returned by
+    // the store remain valid pointers until its state is reset, even if
+    // learners insert new models while the aggregation is running.
 
-    *metadata_.at(metadata_ref_idx).mutable_model_aggregation_started_at() =
+    *aggregation_meta->mutable_model_aggregation_started_at() =
         TimeUtil::GetCurrentTime();
     auto start_time_aggregation = std::chrono::high_resolution_clock::now();
 
     FederatedModel new_community_model; // return variable.
 
     // Select a sub-set of learners who are participating in the experiment.
-    // The selection needs to be a reference to learnerState to avoid copy.
     // The LearnerState does not contain any models.
     // All required models are retrieved from the model store.
+    // The learners' states and task metadata are copied (snapshot), because
+    // learners keep joining and completing tasks while the aggregation is
+    // running.
+    auto learners = Learners();
+    absl::flat_hash_map<std::string, LearnerState> states_snapshot;
     absl::flat_hash_map<std::string, LearnerState *> participating_states;
+    absl::flat_hash_map<std::string, TaskExecutionMetadata> metadata_snapshot;
     absl::flat_hash_map<std::string, TaskExecutionMetadata *> participating_metadata;
-    for (const auto &id: learners_ids) {
-      if (learners_.contains(id)) {
-        participating_states[id] = &learners_.at(id);
-        participating_metadata[id] = &local_tasks_metadata_.at(id).back();
+    {
+      std::lock_guard<std::mutex> metadata_guard(metadata_mutex_);
+      for (const auto &id: learners_ids) {
+        if (learners->contains(id) && local_tasks_metadata_.contains(id)) {
+          states_snapshot[id] = learners->at(id);
+          metadata_snapshot[id] = local_tasks_metadata_.at(id).front();
+        }
       }
     }
+    for (auto &[id, state]: states_snapshot) {
+      participating_states[id] = &state;
+    }
+    for (auto &[id, metadata]: metadata_snapshot) {
+      participating_metadata[id] = &metadata;
+    }
 
     // Before performing any aggregation, we need first to compute the
     // normalized scaling factor or contribution value of each model in
     // the community/global/aggregated model.
+    // The staleness of the models, if discounted, is measured against the
+    // current global iteration.
+    scaler_->SetGlobalIteration(global_iteration_);
     auto scaling_factors =
         scaler_->ComputeScalingFactors(
-            community_model_, learners_, participating_states, participating_metadata);
+            *community_model, *learners, participating_states, participating_metadata);
 
     // Defines the length of the aggregation stride, i.e., how many models
     // to fetch from the model store and feed to the aggregation function.
@@ -877,7 +2204,7 @@ class ControllerDefaultImpl : public Controller {
       if (block_size == aggregation_stride_length || itr == last_elem_itr) {
 
         PLOG(INFO) << "Computing for block size: " << block_size;
-        *metadata_.at(metadata_ref_idx).mutable_model_aggregation_block_size()->Add() = block_size;
+        *aggregation_meta->mutable_model_aggregation_block_size()->Add() = block_size;
 
         /*! --- SELECT MODELS ---
          * Here, we retrieve models from the back-end model store.
@@ -898,16 +2225,27 @@ class ControllerDefaultImpl : public Controller {
             end_time_selection - start_time_selection;
         auto avg_time_selection_per_model = elapsed_time_selection.count() / block_size;
         for (auto const &[selected_learner_id, selected_learner_models]: selected_models) {
-          (*metadata_.at(metadata_ref_idx).mutable_model_selection_duration_ms())[selected_learner_id] =
+          (*aggregation_meta->mutable_model_selection_duration_ms())[selected_learner_id] =
               avg_time_selection_per_model;
         }
 
         /* --- CONSTRUCT MODELS TO AGGREGATE --- */
         for (auto const &[selected_learner_id, selected_learner_models]: selected_models) {
           auto scaling_factor = scaling_factors[selected_learner_id];
-          for (auto it: selected_learner_models) {
-            to_aggregate_learner_models_tmp.emplace_back(it, scaling_factor);
+          // The models are ordered from the oldest to the most recent. The
+          // rolling aggregation rules replace the learner's previous model
+          // with its most recent one, hence the previous model is given the
+          // scaling factor that it was aggregated with, which differs from
+          // the current one if, e.g., the models are discounted by staleness.
+          auto previous = contributed_scaling_factors_.find(selected_learner_id);
+          for (size_t i = 0; i < selected_learner_models.size(); ++i) {
+            auto is_previous = i + 1 < selected_learner_models.size() &&
+                previous != contributed_scaling_factors_.end();
+            to_aggregate_learner_models_tmp.emplace_back(
+                selected_learner_models[i],
+                is_previous ? previous->second : scaling_factor);
           }
+          contributed_scaling_factors_[selected_learner_id] = scaling_factor;
           to_aggregate_block.push_back(to_aggregate_learner_models_tmp);
           to_aggregate_learner_models_tmp.clear();
         }
@@ -918,12 +2256,12 @@ class ControllerDefaultImpl : public Controller {
         auto end_time_block_aggregation = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double, std::milli> elapsed_time_block_aggregation =
             end_time_block_aggregation - start_time_block_aggregation;
-        *metadata_.at(metadata_ref_idx).mutable_model_aggregation_block_duration_ms()->Add() =
+        *aggregation_meta->mutable_model_aggregation_block_duration_ms()->Add() =
             elapsed_time_block_aggregation.count();
 
         long block_memory = GetTotalMemory();
         PLOG(INFO) << "Aggregate block memory usage (kb): " << block_memory;
-        *metadata_.at(metadata_ref_idx).mutable_model_aggregation_block_memory_kb()->Add() = (double) block_memory;
+        *aggregation_meta->mutable_model_aggregation_block_memory_kb()->Add() = (double) block_memory;
 
         // Cleanup. Clear sentinel block variables and reset
         // model_store's state to reclaim unused memory.
@@ -942,15 +2280,15 @@ class ControllerDefaultImpl : public Controller {
     auto end_time_aggregation = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double, std::milli> elapsed_time_aggregation =
         end_time_aggregation - start_time_aggregation;
-    metadata_.at(metadata_ref_idx).set_model_aggregation_total_duration_ms(elapsed_time_aggregation.count());
-    *metadata_.at(metadata_ref_idx).mutable_model_aggregation_completed_at() = TimeUtil::GetCurrentTime();
+    aggregation_meta->set_model_aggregation_total_duration_ms(elapsed_time_aggregation.count());
+    *aggregation_meta->mutable_model_aggregation_completed_at() = TimeUtil::GetCurrentTime();
 
     return new_community_model;
 
   }
 
   void RecordCommunityModelSize(const FederatedModel &model,
-                                const uint32_t &metadata_ref_idx) {
+                                FederatedTaskRuntimeMetadata *aggregation_meta) {
     /*
      * Here, we record all tensor metadat associated with its size, non-zero and zero values.
      */
@@ -984,7 +2322,7 @@ class ControllerDefaultImpl : public Controller {
         } // end if
 
         // Record the computed tensor measurements.
-        *metadata_.at(metadata_ref_idx).mutable_model_tensor_quantifiers()->Add()
+        *aggregation_meta->mutable_model_tensor_quantifiers()->Add()
             = tensor_quantifier;
 
       } else if (variable.has_ciphertext_tensor()) {
@@ -993,7 +2331,7 @@ class ControllerDefaultImpl : public Controller {
         // it does not have access to the plaintext model and therefore we cannot
         // find the number of zero and non-zero elements.
         tensor_quantifier.set_tensor_size_bytes(variable.ciphertext_tensor().tensor_spec().ByteSizeLong());
-        *metadata_.at(metadata_ref_idx).mutable_model_tensor_quantifiers()->Add() =
+        *aggregation_meta->mutable_model_tensor_quantifiers()->Add() =
             tensor_quantifier;
       } else {
         throw std::runtime_error("Unsupported variable tensor type.");
@@ -1008,52 +2346,137 @@ class ControllerDefaultImpl : public Controller {
   uint32_t global_iteration_;
   // We store a collection of federated training metadata as training
   // progresses related to the federation runtime environment. All
-  // insertions take place at the end of the structure, and we want to
-  // randomly access positions in the structure. Hence, the vector container.
-  std::vector<FederatedTaskRuntimeMetadata> metadata_;
-  // Stores learners' execution state inside a lookup map.
-  absl::flat_hash_map<std::string, LearnerState> learners_;
-  // Stores learners' connection stub.
+  // insertions take place at the end of the structure, and the metadata of
+  // global iteration k are at position k-1. Only the most recent rounds are
+  // kept in memory (see LineageSpecs).
+  BoundedLineage<FederatedTaskRuntimeMetadata> metadata_;
+  // Snapshot of the learners' execution state, stored inside a lookup map.
+  // It is only replaced, never modified, while holding learners_mutex_.
+  std::shared_ptr<const LearnerStates> learners_;
+  // Stores learners' connection stub. Each stub owns a long-lived channel,
+  // which is created when the learner is first assigned a task.
   absl::flat_hash_map<std::string, LearnerStub> learners_stub_;
   absl::flat_hash_map<std::string, LearningTaskTemplate>
       learners_task_template_;
-  // Stores local models evaluation lineages.
+  // Indexed registry of the learners, from which the cohort of every round
+  // is sampled if only a fraction of the learners participates in a round.
+  CohortSampler cohort_sampler_;
+  // Stores local models evaluation lineages, most recent first. Only the
+  // most recent tasks of every learner are kept (see LineageSpecs).
   absl::flat_hash_map<std::string, std::list<TaskExecutionMetadata>>
       local_tasks_metadata_;
+  // The lineage position that follows the most recent task of every
+  // learner, i.e., the number of tasks the learner has completed.
+  absl::flat_hash_map<std::string, uint64_t> local_tasks_end_index_;
+  // The estimated throughput of every learner, based on its completed tasks.
+  absl::flat_hash_map<std::string, ThroughputEstimator> learners_throughput_;
+  // Guards the learners' registry: the registry snapshot, the stubs, the
+  // cohort sampler, the selector's ranking and the task templates. It is
+  // only held for short lookups and updates, never while computing or
+  // dispatching a round.
   std::mutex learners_mutex_;
+  // Serializes the scheduling of the federation rounds, i.e., the global
+  // iteration, the community evaluations and the runtime metadata rounds.
+  std::mutex scheduling_mutex_;
+  // The number of learners that were assigned the initial task, if the
+  // learners participate in sampled cohorts.
+  size_t initial_cohort_size_;
   // Stores community models evaluation lineages. A community model might not
   // get evaluated across all learners depending on the participation ratio and
   // therefore we store sequentially the evaluations on every other learner.
-  // Insertions occur at the head of the structure, hence the use of list.
-  std::vector<CommunityModelEvaluation> community_evaluations_;
+  // Insertions occur at the end of the structure and, similar to the
+  // runtime metadata, only the most recent evaluations are kept in memory.
+  BoundedLineage<CommunityModelEvaluation> community_evaluations_;
   // Scaling function for computing the scaling factor of each learner.
   std::unique_ptr<ScalingFunction> scaler_;
+  // The scaling factor that the most recent model of every learner was
+  // aggregated with. Guarded by the scheduling lock.
+  absl::flat_hash_map<std::string, double> contributed_scaling_factors_;
   // Aggregation function to use for computing the community model.
   std::unique_ptr<AggregationFunction> aggregator_;
   // Federated task scheduler.
   std::unique_ptr<Scheduler> scheduler_;
   // Federated model selector.
   std::unique_ptr<Selector> selector_;
-  // Community model.
-  FederatedModel community_model_;
-  // Thread pool for scheduling tasks.
-  BS::thread_pool scheduling_pool_;
+  // Snapshot of the current community model. It is only replaced, never
+  // modified, through PublishCommunityModel() and read via std::atomic_load.
+  std::shared_ptr<const FederatedModel> community_model_;
+  // A published community model along with the chunks it is served with.
+  struct CachedCommunityModel {
+    std::shared_ptr<const FederatedModel> model;
+    std::shared_ptr<const CommunityModelChunks> chunks;
+    // The chunks of the model's delta against a previous version, keyed by
+    // that version. Created on the first request for each previous version.
+    std::map<uint32_t, std::shared_ptr<const CommunityModelChunks>> delta_chunks;
+  };
+  // Guards the community model versions and the cached models.
+  std::mutex community_model_cache_mutex_;
+  // Version of the most recently published community model.
+  uint32_t community_model_version_;
+  // The most recent community model versions, keyed by version.
+  std::map<uint32_t, CachedCommunityModel> community_model_cache_;
+  // The learners that await their registration, and whether a registration
+  // epoch is in progress.
+  std::mutex registration_mutex_;
+  std::condition_variable registration_cv_;
+  std::vector<Registration *> pending_registrations_;
+  bool registering_;
+  // The learners that joined the federation while the scheduling lock was
+  // held, and still await their initial task.
+  std::mutex joining_mutex_;
+  std::vector<std::string> joining_learners_;
+  // Executes the scheduling work in a control lane and a round lane.
+  LaneExecutor scheduling_executor_;
   // Caching function to use for storing learner model(s).
   std::unique_ptr<ModelStore> model_store_;
-  std::mutex model_store_mutex_;
+  // The tasks of later rounds that the learners run, or have completed,
+  // ahead of the current round, if the rounds are pipelined. Declared after
+  // the model store, since the models it holds back reference the store.
+  // Guarded by the scheduling lock.
+  AheadTasks ahead_tasks_;
+  // Single thread pool for writing the controller snapshots to disk.
+  BS::thread_pool checkpoint_pool_;
+  // Whether a snapshot is currently being written.
+  std::atomic<bool> checkpoint_in_flight_;
+  // Guards the runtime metadata, the local tasks metadata, the learners'
+  // throughput and the community evaluations collections, which are updated
+  // both by the scheduling thread and the RPC handlers.
+  std::mutex metadata_mutex_;
   // GRPC completion queue to process submitted learners' RunTasks requests.
   grpc::CompletionQueue run_tasks_cq_;
-  // GRPC completion queue to process submitted learners' EvaluateModel requests.
-  grpc::CompletionQueue eval_tasks_cq_;
+  // Guards the submission of RunTasks requests against the shutdown of the
+  // completion queue.
+  std::mutex run_tasks_mutex_;
+  bool run_tasks_stopped_;
+  // The RunTasks requests whose response has not been digested yet.
+  struct AsyncLearnerRunTaskCall;
+  absl::flat_hash_set<AsyncLearnerRunTaskCall *> run_tasks_in_flight_;
+  // Thread that digests the learners' responses to RunTasks requests.
+  std::thread run_tasks_digest_;
+  // Thread that periodically checks whether the current round has expired
+  // and tracks the learners' liveness.
+  std::thread timer_;
+  // Guards the stop signal of the timer.
+  std::mutex timer_mutex_;
+  std::condition_variable timer_cv_;
+  bool timer_stopped_;
+  // Whether an expiration check is queued in the scheduling pool.
+  std::atomic<bool> round_timer_pending_;
+  // Tracks the learners' heartbeats, if their liveness is tracked.
+  LivenessTracker liveness_;
+  // Guards the liveness tracker. It can be acquired while holding the
+  // registry lock, but not the other way around.
+  mutable std::mutex liveness_mutex_;
 
   // Templated struct for keeping state and data information
-  // from requests submitted to learners services.
+  // from requests submitted to learners services. Requests are submitted
+  // through a generic stub, hence the reply is the serialized response.
   template<typename T>
   struct AsyncLearnerCall {
 
     std::string learner_id;
 
-    // Container for the data we expect from the server.
+    // Container for the (serialized) data we expect from the server.
     T reply;
 
     // Context for the client. It could be used to convey extra information to
@@ -1068,19 +2491,7 @@ class ControllerDefaultImpl : public Controller {
   };
 
   // Implementation of generic AsyncLearnerCall type to handle RunTask responses.
-  struct AsyncLearnerRunTaskCall : AsyncLearnerCall<RunTaskResponse> {};
-
-  // Implementation of generic AsyncLearnerCall type to handle EvaluateModel responses.
-  struct AsyncLearnerEvalCall : AsyncLearnerCall<EvaluateModelResponse> {
-    // Index to the community/global model evaluation metrics vector.
-    uint32_t comm_eval_ref_idx;
-    // Index to the metadata collection vector.
-    uint32_t metadata_ref_idx;
-    AsyncLearnerEvalCall() {
-      comm_eval_ref_idx = 0;
-      metadata_ref_idx = 0;
-    }
-  };
+  struct AsyncLearnerRunTaskCall : AsyncLearnerCall<grpc::ByteBuffer> {};
 
 };
 
@@ -1096,13 +2507,34 @@ std::unique_ptr<Controller> Controller::New(const ControllerParams &params) {
     throw std::runtime_error("Batch size and epochs cannot be zero.");
   }
 
-  return absl::make_unique<ControllerDefaultImpl>(
+  auto controller = absl::make_unique<ControllerDefaultImpl>(
       ControllerParams(params),
-      CreateScaler(params.global_model_specs().aggregation_rule().aggregation_rule_specs()),
+      CreateScaler(params.global_model_specs().aggregation_rule(),
+                   params.communication_specs()),
       CreateAggregator(params.global_model_specs().aggregation_rule()),
       CreateScheduler(params.communication_specs()),
-      CreateSelector(),
+      CreateSelector(params.global_model_specs(), params.communication_specs()),
       CreateModelStore(params.model_store_config()));
+
+  // Warm restart from the latest snapshot, if any.
+  const auto &checkpoint_dir = params.checkpoint_specs().checkpoint_dir();
+  if (!checkpoint_dir.empty()) {
+    FederatedModel community_model;
+    ControllerCheckpoint checkpoint;
+    auto status = LoadControllerCheckpoint(
+        checkpoint_dir, &community_model, &checkpoint);
+    if (status.ok()) {
+      controller->RestoreFromCheckpoint(std::move(community_model), checkpoint);
+    } else if (absl::IsNotFound(status)) {
+      PLOG(INFO) << "No checkpoint found in " << checkpoint_dir
+                 << ". Starting a new federation.";
+    } else {
+      PLOG(ERROR) << "Cannot restore checkpoint from " << checkpoint_dir
+                  << ": " << status.message();
+    }
+  }
+
+  return controller;
 }
 
 } // namespace metisfl::controller
@@ -2,6 +2,7 @@
 #ifndef METISFL_METISFL_CONTROLLER_CORE_CONTROLLER_H_
 #define METISFL_METISFL_CONTROLLER_CORE_CONTROLLER_H_
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -48,9 +49,10 @@ class Controller {
   ABSL_MUST_USE_RESULT
   virtual uint32_t GetNumLearners() const = 0;
 
-  // Returns the current community model;
+  // Returns a snapshot of the current community model. The snapshot is
+  // immutable and remains valid after a new community model is published.
   ABSL_MUST_USE_RESULT
-  virtual const FederatedModel& CommunityModel() const = 0;
+  virtual std::shared_ptr<const FederatedModel> CommunityModel() const = 0;
 
   // Overwrites/replaces the community model with the provided.
   virtual absl::Status ReplaceCommunityModel(const FederatedModel& model) = 0;
@@ -66,19 +68,75 @@ class Controller {
   virtual absl::Status
   RemoveLearner(const std::string &learner_id, const std::string &token) = 0;
 
+  // Records a heartbeat of the learner. If the learner's liveness is tracked
+  // (see LivenessSpecs), learners that miss consecutive heartbeats are first
+  // suspected and then evicted from the federation.
+  virtual absl::Status
+  LearnerHeartbeat(const std::string &learner_id, const std::string &token) = 0;
+
+  // The model of the task is moved into the model store, not copied.
   virtual absl::Status
   LearnerCompletedTask(const std::string &learner_id,
                        const std::string &token,
-                       const CompletedLearningTask &task) = 0;
-
-  virtual std::vector<FederatedTaskRuntimeMetadata>
-  GetRuntimeMetadataLineage(uint32_t num_steps) = 0;
-
-  virtual std::vector<CommunityModelEvaluation>
-  GetEvaluationLineage(uint32_t num_steps) = 0;
-
-  virtual std::vector<TaskExecutionMetadata>
-  GetLocalTaskLineage(const std::string &learner_id, uint32_t num_steps) = 0;
+                       CompletedLearningTask task) = 0;
+
+  // Receives the model of a completed task that arrives as a stream of
+  // chunks. The chunks are pushed to the receiver as they arrive, hence no
+  // thread waits for the next chunk while the model is being transferred.
+  class CompletedTaskReceiver {
+   public:
+    virtual ~CompletedTaskReceiver() = default;
+
+    // Ingests the next chunk of the learner's model; every variable is
+    // handed to the model store as soon as it is complete.
+    virtual absl::Status ReceiveChunk(ModelChunk *chunk) = 0;
+
+    // Inserts the received model and completes the task, once the stream
+    // has ended. The model is discarded, and an error is returned, if it was
+    // not received whole. A receiver that is destroyed before it is
+    // finished, e.g., because the stream was cancelled, discards the model.
+    virtual absl::Status Finish() = 0;
+  };
+
+  // Same as LearnerCompletedTask(), but the learner's model is received
+  // through the returned receiver. The model of the given task, if any,
+  // is ignored.
+  virtual absl::StatusOr<std::unique_ptr<CompletedTaskReceiver>>
+  LearnerCompletedTaskStream(const std::string &learner_id,
+                             const std::string &token,
+                             const CompletedLearningTask &task) = 0;
+
+  // The messages through which a community model is served to the learners,
+  // i.e., the model's metadata followed by the model's chunks.
+  typedef std::vector<FetchCommunityModelChunk> CommunityModelChunks;
+
+  // Returns the chunks of the community model with the given version. If the
+  // learner holds the community model with `base_version` (non-zero), and it
+  // is still cached, the model is encoded as a delta against it. The chunks
+  // are created once per (version, base version) and shared by all learners.
+  virtual absl::StatusOr<std::shared_ptr<const CommunityModelChunks>>
+  GetCommunityModelChunks(const std::string &learner_id,
+                          const std::string &token,
+                          uint32_t version,
+                          uint32_t base_version) = 0;
+
+  // Copies the runtime metadata selected by the request (see
+  // GetRuntimeMetadataLineageRequest) into the response.
+  virtual void
+  GetRuntimeMetadataLineage(const GetRuntimeMetadataLineageRequest &request,
+                            GetRuntimeMetadataLineageResponse *response) = 0;
+
+  // Copies the community model evaluations selected by the request (see
+  // GetCommunityModelEvaluationLineageRequest) into the response.
+  virtual void
+  GetEvaluationLineage(const GetCommunityModelEvaluationLineageRequest &request,
+                       GetCommunityModelEvaluationLineageResponse *response) = 0;
+
+  // Copies the local tasks of the learners selected by the request (see
+  // GetLocalTaskLineageRequest) into the response.
+  virtual void
+  GetLocalTaskLineage(const GetLocalTaskLineageRequest &request,
+                      GetLocalTaskLineageResponse *response) = 0;
 
   virtual void Shutdown() = 0;
 
@@ -0,0 +1,233 @@
+
+#include "metisfl/controller/core/controller_checkpoint.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include "absl/strings/str_cat.h"
+
+namespace metisfl::controller {
+namespace {
+
+constexpr char kLatestFile[] = "LATEST";
+constexpr char kCommunityModelPrefix[] = "community_model.";
+constexpr char kControllerStatePrefix[] = "controller_state.";
+constexpr char kSnapshotSuffix[] = ".pb";
+
+std::string JoinPath(const std::string &dir, const std::string &file) {
+  return (std::filesystem::path(dir) / file).string();
+}
+
+absl::Status ErrnoToStatus(const std::string &what, const std::string &path) {
+  return absl::InternalError(
+      absl::StrCat(what, " ", path, ": ", std::strerror(errno)));
+}
+
+// Writes the file through a temporary file followed by a rename, so that
+// readers never observe a partially written file. The temporary file is
+// removed if the write fails.
+absl::Status WriteFileAtomically(const std::string &path,
+                                 const std::string &content) {
+  const auto tmp_path = absl::StrCat(path, ".tmp");
+  int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return ErrnoToStatus("Cannot open", tmp_path);
+  }
+
+  absl::Status status;
+  const char *data = content.data();
+  size_t remaining = content.size();
+  while (remaining > 0) {
+    auto written = ::write(fd, data, remaining);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      status = ErrnoToStatus("Cannot write", tmp_path);
+      break;
+    }
+    data += written;
+    remaining -= written;
+  }
+
+  // The file is closed even if it cannot be flushed; the first error wins.
+  if (status.ok() && ::fsync(fd) != 0) {
+    status = ErrnoToStatus("Cannot flush", tmp_path);
+  }
+  if (::close(fd) != 0 && status.ok()) {
+    status = ErrnoToStatus("Cannot close", tmp_path);
+  }
+  if (status.ok() && ::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    status = ErrnoToStatus("Cannot rename", tmp_path);
+  }
+  if (!status.ok()) {
+    ::unlink(tmp_path.c_str());
+  }
+  return status;
+}
+
+// Flushes the entries of the directory, e.g., the files renamed into it,
+// since fsync() on a file does not persist its directory entry.
+absl::Status SyncDirectory(const std::string &dir) {
+  int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    return ErrnoToStatus("Cannot open", dir);
+  }
+  if (::fsync(fd) != 0) {
+    auto status = ErrnoToStatus("Cannot flush", dir);
+    ::close(fd);
+    return status;
+  }
+  ::close(fd);
+  return absl::OkStatus();
+}
+
+absl::Status ParseMappedFile(const std::string &path,
+                             google::protobuf::MessageLite *message) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return ErrnoToStatus("Cannot open", path);
+  }
+
+  struct stat st{};
+  if (::fstat(fd, &st) != 0) {
+    auto status = ErrnoToStatus("Cannot stat", path);
+    ::close(fd);
+    return status;
+  }
+  if (st.st_size > INT_MAX) {
+    ::close(fd);
+    return absl::OutOfRangeError(
+        absl::StrCat("Checkpoint file exceeds 2GB: ", path));
+  }
+  if (st.st_size == 0) {
+    ::close(fd);
+    message->Clear();
+    return absl::OkStatus();
+  }
+
+  void *mapped = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    return ErrnoToStatus("Cannot mmap", path);
+  }
+  ::madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+
+  bool parsed;
+  {
+    google::protobuf::io::ArrayInputStream input(mapped, (int) st.st_size);
+    google::protobuf::io::CodedInputStream coded_input(&input);
+    // Large models exceed the default 64MB parsing limit.
+    coded_input.SetTotalBytesLimit(INT_MAX);
+    parsed = message->ParseFromCodedStream(&coded_input) &&
+        coded_input.ConsumedEntireMessage();
+  }
+  ::munmap(mapped, st.st_size);
+
+  if (!parsed) {
+    return absl::DataLossError(absl::StrCat("Cannot parse ", path));
+  }
+  return absl::OkStatus();
+}
+
+void RemoveStaleSnapshots(const std::string &checkpoint_dir,
+                          const std::string &latest_tag) {
+  const auto latest_model = absl::StrCat(kCommunityModelPrefix, latest_tag, kSnapshotSuffix);
+  const auto latest_state = absl::StrCat(kControllerStatePrefix, latest_tag, kSnapshotSuffix);
+  std::error_code ec;
+  for (const auto &entry: std::filesystem::directory_iterator(checkpoint_dir, ec)) {
+    const auto name = entry.path().filename().string();
+    bool is_snapshot = name.rfind(kCommunityModelPrefix, 0) == 0 ||
+        name.rfind(kControllerStatePrefix, 0) == 0;
+    if (is_snapshot && name != latest_model && name != latest_state) {
+      std::filesystem::remove(entry.path(), ec);
+    }
+  }
+}
+
+} // namespace
+
+absl::Status SaveControllerCheckpoint(const std::string &checkpoint_dir,
+                                      const FederatedModel &community_model,
+                                      const ControllerCheckpoint &checkpoint) {
+
+  std::error_code ec;
+  std::filesystem::create_directories(checkpoint_dir, ec);
+  if (ec) {
+    return absl::InternalError(
+        absl::StrCat("Cannot create ", checkpoint_dir, ": ", ec.message()));
+  }
+
+  const auto tag = std::to_string(checkpoint.global_iteration());
+
+  std::string serialized;
+  if (!community_model.SerializeToString(&serialized)) {
+    return absl::InternalError("Cannot serialize community model.");
+  }
+  auto status = WriteFileAtomically(
+      JoinPath(checkpoint_dir, absl::StrCat(kCommunityModelPrefix, tag, kSnapshotSuffix)),
+      serialized);
+  if (!status.ok()) return status;
+
+  serialized.clear();
+  if (!checkpoint.SerializeToString(&serialized)) {
+    return absl::InternalError("Cannot serialize controller state.");
+  }
+  status = WriteFileAtomically(
+      JoinPath(checkpoint_dir, absl::StrCat(kControllerStatePrefix, tag, kSnapshotSuffix)),
+      serialized);
+  if (!status.ok()) return status;
+
+  // The snapshot is published only once both of its files, including their
+  // directory entries, are on disk.
+  status = SyncDirectory(checkpoint_dir);
+  if (!status.ok()) return status;
+  status = WriteFileAtomically(JoinPath(checkpoint_dir, kLatestFile), tag);
+  if (!status.ok()) return status;
+  status = SyncDirectory(checkpoint_dir);
+  if (!status.ok()) return status;
+
+  RemoveStaleSnapshots(checkpoint_dir, tag);
+  return absl::OkStatus();
+
+}
+
+absl::Status LoadControllerCheckpoint(const std::string &checkpoint_dir,
+                                      FederatedModel *community_model,
+                                      ControllerCheckpoint *checkpoint) {
+
+  std::ifstream latest_file(JoinPath(checkpoint_dir, kLatestFile));
+  if (!latest_file.is_open()) {
+    return absl::NotFoundError(
+        absl::StrCat("No checkpoint found in ", checkpoint_dir));
+  }
+  std::stringstream buffer;
+  buffer << latest_file.rdbuf();
+  const auto tag = buffer.str();
+  if (tag.empty()) {
+    return absl::DataLossError(
+        absl::StrCat("Empty checkpoint pointer in ", checkpoint_dir));
+  }
+
+  auto status = ParseMappedFile(
+      JoinPath(checkpoint_dir, absl::StrCat(kControllerStatePrefix, tag, kSnapshotSuffix)),
+      checkpoint);
+  if (!status.ok()) return status;
+
+  return ParseMappedFile(
+      JoinPath(checkpoint_dir, absl::StrCat(kCommunityModelPrefix, tag, kSnapshotSuffix)),
+      community_model);
+
+}
+
+} // namespace metisfl::controller
@@ -0,0 +1,32 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_CORE_CONTROLLER_CHECKPOINT_H_
+#define METISFL_METISFL_CONTROLLER_CORE_CONTROLLER_CHECKPOINT_H_
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "metisfl/proto/metis.pb.h"
+
+namespace metisfl::controller {
+
+// Persists a snapshot of the controller inside `checkpoint_dir`. The community
+// model and the controller state are written to two files tagged with the
+// global iteration of the snapshot. The snapshot becomes visible only after
+// both files are fully written, by atomically replacing the `LATEST` pointer
+// file; a crash in the middle of a save leaves the previous snapshot intact.
+// Files of older snapshots are removed once the new snapshot is visible.
+absl::Status SaveControllerCheckpoint(const std::string &checkpoint_dir,
+                                      const FederatedModel &community_model,
+                                      const ControllerCheckpoint &checkpoint);
+
+// Loads the latest snapshot found inside `checkpoint_dir`. The community model
+// file is memory-mapped and parsed in place, so that large models are not
+// copied through an intermediate buffer. Returns NotFound if the directory
+// does not contain any snapshot.
+absl::Status LoadControllerCheckpoint(const std::string &checkpoint_dir,
+                                      FederatedModel *community_model,
+                                      ControllerCheckpoint *checkpoint);
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_CORE_CONTROLLER_CHECKPOINT_H_
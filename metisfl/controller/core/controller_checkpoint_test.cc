@@ -0,0 +1,121 @@
+
+#include "metisfl/controller/core/controller_checkpoint.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace metisfl::controller {
+namespace {
+
+class ControllerCheckpointTest : public ::testing::Test {
+ public:
+  ControllerCheckpointTest() {
+    checkpoint_dir_ = (std::filesystem::temp_directory_path() /
+        ("metisfl_checkpoint_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) +
+            "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name())).string();
+    std::filesystem::remove_all(checkpoint_dir_);
+  }
+
+  ~ControllerCheckpointTest() override {
+    std::filesystem::remove_all(checkpoint_dir_);
+  }
+
+ protected:
+  static FederatedModel MakeCommunityModel(uint32_t global_iteration, size_t num_bytes) {
+    FederatedModel model;
+    model.set_num_contributors(3);
+    model.set_global_iteration(global_iteration);
+    auto *variable = model.mutable_model()->add_variables();
+    variable->set_name("dense");
+    variable->set_trainable(true);
+    auto *tensor_spec = variable->mutable_plaintext_tensor()->mutable_tensor_spec();
+    tensor_spec->set_length(num_bytes);
+    tensor_spec->set_value(std::string(num_bytes, static_cast<char>(global_iteration)));
+    return model;
+  }
+
+  static ControllerCheckpoint MakeCheckpoint(uint32_t global_iteration) {
+    ControllerCheckpoint checkpoint;
+    checkpoint.set_global_iteration(global_iteration);
+    checkpoint.set_community_model_version(global_iteration + 1);
+    auto *learner = checkpoint.add_learners()->mutable_learner();
+    learner->set_id("localhost:50052");
+    learner->set_auth_token("1");
+    (*checkpoint.mutable_learners_task_template())["localhost:50052"]
+        .set_num_local_updates(10);
+    for (uint32_t i = 1; i <= global_iteration; ++i) {
+      checkpoint.add_runtime_metadata()->set_global_iteration(i);
+    }
+    auto &lineage = (*checkpoint.mutable_local_tasks_metadata())["localhost:50052"];
+    lineage.add_task_execution_metadata()->set_global_iteration(global_iteration);
+    lineage.add_task_execution_metadata()->set_global_iteration(global_iteration - 1);
+    return checkpoint;
+  }
+
+  std::string checkpoint_dir_;
+};
+
+TEST_F(ControllerCheckpointTest, LoadWithoutCheckpointIsNotFound) /* NOLINT */ {
+  FederatedModel model;
+  ControllerCheckpoint checkpoint;
+  auto status = LoadControllerCheckpoint(checkpoint_dir_, &model, &checkpoint);
+  EXPECT_TRUE(absl::IsNotFound(status));
+}
+
+TEST_F(ControllerCheckpointTest, SaveAndLoadRoundTrip) /* NOLINT */ {
+  // Larger than protobuf's default parsing limit of 64MB.
+  auto model = MakeCommunityModel(2, 65 << 20);
+  auto checkpoint = MakeCheckpoint(2);
+  ASSERT_TRUE(SaveControllerCheckpoint(checkpoint_dir_, model, checkpoint).ok());
+
+  FederatedModel restored_model;
+  ControllerCheckpoint restored_checkpoint;
+  ASSERT_TRUE(LoadControllerCheckpoint(
+      checkpoint_dir_, &restored_model, &restored_checkpoint).ok());
+  EXPECT_EQ(restored_model.SerializeAsString(), model.SerializeAsString());
+  EXPECT_EQ(restored_checkpoint.SerializeAsString(), checkpoint.SerializeAsString());
+}
+
+TEST_F(ControllerCheckpointTest, LatestSnapshotWinsAndOlderAreRemoved) /* NOLINT */ {
+  for (uint32_t iteration = 1; iteration <= 3; ++iteration) {
+    ASSERT_TRUE(SaveControllerCheckpoint(
+        checkpoint_dir_, MakeCommunityModel(iteration, 16),
+        MakeCheckpoint(iteration)).ok());
+  }
+
+  FederatedModel restored_model;
+  ControllerCheckpoint restored_checkpoint;
+  ASSERT_TRUE(LoadControllerCheckpoint(
+      checkpoint_dir_, &restored_model, &restored_checkpoint).ok());
+  EXPECT_EQ(restored_model.global_iteration(), 3);
+  EXPECT_EQ(restored_checkpoint.global_iteration(), 3);
+  EXPECT_EQ(restored_checkpoint.runtime_metadata_size(), 3);
+
+  // LATEST plus the two files of the last snapshot.
+  int num_files = 0;
+  for (const auto &entry: std::filesystem::directory_iterator(checkpoint_dir_)) {
+    (void) entry;
+    ++num_files;
+  }
+  EXPECT_EQ(num_files, 3);
+}
+
+TEST_F(ControllerCheckpointTest, FailedSaveLeavesNoTemporaryFiles) /* NOLINT */ {
+  // The LATEST pointer cannot be replaced by a file if it is a non-empty
+  // directory, hence the save fails at the rename.
+  const auto latest_dir = std::filesystem::path(checkpoint_dir_) / "LATEST";
+  std::filesystem::create_directories(latest_dir);
+  std::ofstream(latest_dir / "blocker") << "x";
+
+  EXPECT_FALSE(SaveControllerCheckpoint(
+      checkpoint_dir_, MakeCommunityModel(1, 16), MakeCheckpoint(1)).ok());
+  for (const auto &entry: std::filesystem::directory_iterator(checkpoint_dir_)) {
+    EXPECT_NE(entry.path().extension(), ".tmp") << entry.path();
+  }
+}
+
+} // namespace
+} // namespace metisfl::controller
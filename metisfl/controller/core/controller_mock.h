@@ -10,7 +10,7 @@ namespace metisfl::controller {
 
 class MockController : public Controller {
  public:
-  MOCK_METHOD(ControllerParams &, GetParams, (), (const, override));
+  MOCK_METHOD(const ControllerParams &, GetParams, (), (const, override));
   MOCK_METHOD(std::vector<LearnerDescriptor>,
               GetLearners,
               (),
@@ -24,32 +24,57 @@ class MockController : public Controller {
               RemoveLearner,
               (const std::string &learner_id, const std::string &token),
               (override));
+  MOCK_METHOD(absl::Status,
+              LearnerHeartbeat,
+              (const std::string &learner_id, const std::string &token),
+              (override));
   MOCK_METHOD(absl::Status,
               LearnerCompletedTask,
+              (const std::string &learner_id, const std::string &token, CompletedLearningTask task),
+              (override));
+  MOCK_METHOD((absl::StatusOr<std::unique_ptr<CompletedTaskReceiver>>),
+              LearnerCompletedTaskStream,
               (const std::string &learner_id, const std::string &token, const CompletedLearningTask &task),
               (override));
-  MOCK_METHOD(std::vector<ModelEvaluation>,
-              GetEvaluationLineage,
-              (const std::string &learner_id, uint32_t num_steps),
+  MOCK_METHOD(absl::StatusOr<std::shared_ptr<const CommunityModelChunks>>,
+              GetCommunityModelChunks,
+              (const std::string &learner_id, const std::string &token, uint32_t version,
+                  uint32_t base_version),
+              (override));
+  MOCK_METHOD(void,
+              GetRuntimeMetadataLineage,
+              (const GetRuntimeMetadataLineageRequest &request,
+                  GetRuntimeMetadataLineageResponse *response),
               (override));
-  MOCK_METHOD(std::vector<ModelEvaluation>,
+  MOCK_METHOD(void,
               GetEvaluationLineage,
-              (uint32_t num_steps),
+              (const GetCommunityModelEvaluationLineageRequest &request,
+                  GetCommunityModelEvaluationLineageResponse *response),
               (override));
-  MOCK_METHOD(FedRuntimeMetadata&,
-              RuntimeMetadata,
-              (),
-              (const, override));
+  MOCK_METHOD(void,
+              GetLocalTaskLineage,
+              (const GetLocalTaskLineageRequest &request,
+                  GetLocalTaskLineageResponse *response),
+              (override));
+  MOCK_METHOD(void, Shutdown, (), (override));
   MOCK_METHOD(absl::Status,
               ReplaceCommunityModel,
               (const FederatedModel& model),
               (override));
-  MOCK_METHOD(FederatedModel&,
+  MOCK_METHOD(std::shared_ptr<const FederatedModel>,
               CommunityModel,
               (),
               (const, override));
 };
 
+class MockCompletedTaskReceiver : public Controller::CompletedTaskReceiver {
+ public:
+  ~MockCompletedTaskReceiver() override { Destroyed(); }
+  MOCK_METHOD(absl::Status, ReceiveChunk, (ModelChunk *chunk), (override));
+  MOCK_METHOD(absl::Status, Finish, (), (override));
+  MOCK_METHOD(void, Destroyed, ());
+};
+
 } // namespace metisfl::controller
 
 #endif //METISFL_METISFL_CONTROLLER_CONTROLLER_MOCK_H_
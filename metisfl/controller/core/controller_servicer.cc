@@ -1,4 +1,5 @@
 
+#include <atomic>
 #include <csignal>
 #include <future>
 #include <memory>
@@ -17,12 +18,18 @@
 
 namespace metisfl::controller {
 namespace {
+using ::grpc::CallbackServerContext;
 using ::grpc::Server;
 using ::grpc::ServerBuilder;
-using ::grpc::ServerContext;
+using ::grpc::ServerReadReactor;
+using ::grpc::ServerUnaryReactor;
+using ::grpc::ServerWriteReactor;
 using ::grpc::Status;
 using ::grpc::StatusCode;
 
+// The number of threads serving the control requests, if not configured.
+constexpr unsigned kNumControlWorkers = 2;
+
 class ServicerBase {
  public:
   template<class Service>
@@ -77,7 +84,7 @@ class ServicerBase {
     builder.AddListeningPort(server_address, creds);
 
     // Registers "service" as the instance through which we'll communicate with
-    // clients. In this case it corresponds to an *synchronous* service.
+    // clients. In this case it corresponds to a *callback* service.
     builder.RegisterService(service);
 
     // Override default grpc max received message size.
@@ -107,10 +114,155 @@ class ServicerBase {
   std::unique_ptr<Server> server_;
 };
 
+// Streams the chunks of a community model to a learner. The chunks are
+// shared with all other learners fetching the same model; holding the
+// pointer keeps them alive while streaming.
+class CommunityModelWriter
+    : public ServerWriteReactor<FetchCommunityModelChunk> {
+ public:
+  // Starts streaming the chunks, or finishes the call if the chunks
+  // could not be retrieved.
+  void Start(const Status &status,
+             std::shared_ptr<const Controller::CommunityModelChunks> chunks) {
+    if (!status.ok()) {
+      Finish(status);
+      return;
+    }
+    chunks_ = std::move(chunks);
+    WriteNextChunk();
+  }
+
+  void OnWriteDone(bool ok) override {
+    if (!ok) {
+      Finish({StatusCode::CANCELLED, "Community model stream was closed."});
+      return;
+    }
+    WriteNextChunk();
+  }
+
+  void OnDone() override { delete this; }
+
+ private:
+  void WriteNextChunk() {
+    if (next_chunk_ == chunks_->size()) {
+      Finish(Status::OK);
+      return;
+    }
+    StartWrite(&(*chunks_)[next_chunk_++]);
+  }
+
+  std::shared_ptr<const Controller::CommunityModelChunks> chunks_;
+  size_t next_chunk_ = 0;
+};
+
+// Converts the status of a completed task to the status of the request.
+Status MarkTaskCompletedStatus(const absl::Status &status,
+                               MarkTaskCompletedResponse *response) {
+  if (!status.ok()) {
+    switch (status.code()) {
+      case absl::StatusCode::kInvalidArgument:response->mutable_ack()->set_status(false);
+        return {StatusCode::INVALID_ARGUMENT, std::string(status.message())};
+      case absl::StatusCode::kPermissionDenied:response->mutable_ack()->set_status(false);
+        return {StatusCode::PERMISSION_DENIED, std::string(status.message())};
+      case absl::StatusCode::kNotFound:response->mutable_ack()->set_status(false);
+        return {StatusCode::NOT_FOUND, std::string(status.message())};
+      default:response->mutable_ack()->set_status(false);
+        return {StatusCode::INTERNAL, std::string(status.message())};
+    }
+  }
+  response->mutable_ack()->set_status(true);
+  return Status::OK;
+}
+
+// Receives a completed task whose model is uploaded in chunks. The first
+// message carries the learner's credentials and the task's metadata, every
+// following message a chunk of the learner's model. Every received chunk is
+// handed to a worker, which ingests it and only then requests the next one;
+// hence, only one chunk is buffered at a time and no worker waits for a
+// chunk to arrive, however slow the upload. The task is completed only if
+// the learner closes the stream; the model of a cancelled upload is
+// discarded.
+class CompletedTaskReader : public ServerReadReactor<MarkTaskCompletedChunk> {
+ public:
+  CompletedTaskReader(CallbackServerContext *context,
+                      Controller *controller,
+                      BS::thread_pool *workers,
+                      MarkTaskCompletedResponse *response)
+      : context_(context), controller_(controller), workers_(workers),
+        response_(response) {
+    StartRead(&chunk_);
+  }
+
+  void OnReadDone(bool ok) override {
+    if (!ok && context_->IsCancelled()) {
+      workers_->push_task([this] {
+        receiver_.reset();
+        response_->mutable_ack()->set_status(false);
+        Finish({StatusCode::CANCELLED, "Completed task upload was cancelled."});
+      });
+      return;
+    }
+
+    if (!task_started_) {
+      task_started_ = true;
+      if (!ok || !chunk_.has_request()) {
+        response_->mutable_ack()->set_status(false);
+        Finish({StatusCode::INVALID_ARGUMENT,
+                "The stream must start with the completed task's request."});
+        return;
+      }
+      workers_->push_task([this] { StartTask(); });
+      return;
+    }
+
+    // The learner has closed the stream, i.e., the whole model was sent.
+    if (!ok) {
+      workers_->push_task([this] {
+        Finish(MarkTaskCompletedStatus(receiver_->Finish(), response_));
+      });
+      return;
+    }
+
+    workers_->push_task([this] {
+      auto status = receiver_->ReceiveChunk(chunk_.mutable_model_chunk());
+      if (!status.ok()) {
+        Finish(MarkTaskCompletedStatus(status, response_));
+        return;
+      }
+      StartRead(&chunk_);
+    });
+  }
+
+  void OnDone() override { delete this; }
+
+ private:
+  void StartTask() {
+    const auto &request = chunk_.request();
+    PLOG(INFO) << "Receiving Completed Task By " << request.learner_id();
+    auto receiver = controller_->LearnerCompletedTaskStream(
+        request.learner_id(), request.auth_token(), request.task());
+    if (!receiver.ok()) {
+      Finish(MarkTaskCompletedStatus(receiver.status(), response_));
+      return;
+    }
+    receiver_ = std::move(*receiver);
+    StartRead(&chunk_);
+  }
+
+  CallbackServerContext *context_;
+  Controller *controller_;
+  BS::thread_pool *workers_;
+  MarkTaskCompletedResponse *response_;
+  MarkTaskCompletedChunk chunk_;
+  std::unique_ptr<Controller::CompletedTaskReceiver> receiver_;
+  bool task_started_ = false;
+};
+
 class ControllerServicerImpl : public ControllerServicer, private ServicerBase {
  public:
   explicit ControllerServicerImpl(Controller *controller)
-      : pool_(1), controller_(controller) {
+      : pool_(1), control_workers_(kNumControlWorkers), model_workers_(),
+        controller_(controller) {
     GOOGLE_CHECK_NOTNULL(controller_);
   }
 
@@ -119,6 +271,11 @@ class ControllerServicerImpl : public ControllerServicer, private ServicerBase {
 
   void StartService() override {
     const auto &params = controller_->GetParams();
+    const auto &servicer_specs = params.servicer_specs();
+    control_workers_.reset(servicer_specs.num_control_workers() > 0
+                           ? servicer_specs.num_control_workers()
+                           : kNumControlWorkers);
+    model_workers_.reset(servicer_specs.num_model_workers());
     Start(params.server_entity(), this);
     PLOG(INFO) << "Started Controller Servicer.";
   }
@@ -136,74 +293,199 @@ class ControllerServicerImpl : public ControllerServicer, private ServicerBase {
     return shutdown_;
   }
 
-  Status GetCommunityModelEvaluationLineage(
-      ServerContext *context,
+  // The gRPC runtime invokes the methods below and must never be blocked.
+  // Every request is served by one of two worker pools, so that the large
+  // and slow requests carrying models cannot delay the control requests.
+
+  ServerWriteReactor<FetchCommunityModelChunk> *FetchCommunityModel(
+      CallbackServerContext *context,
+      const FetchCommunityModelRequest *request) override {
+    auto *writer = new CommunityModelWriter;
+    model_workers_.push_task([this, request, writer] {
+      std::shared_ptr<const Controller::CommunityModelChunks> chunks;
+      const auto status = FetchCommunityModel(request, &chunks);
+      writer->Start(status, std::move(chunks));
+    });
+    return writer;
+  }
+
+  ServerUnaryReactor *GetCommunityModelEvaluationLineage(
+      CallbackServerContext *context,
       const GetCommunityModelEvaluationLineageRequest *request,
       GetCommunityModelEvaluationLineageResponse *response) override {
+    return Serve(context, &model_workers_, [this, request, response] {
+      return GetCommunityModelEvaluationLineage(request, response);
+    });
+  }
+
+  ServerUnaryReactor *GetLocalTaskLineage(
+      CallbackServerContext *context,
+      const GetLocalTaskLineageRequest *request,
+      GetLocalTaskLineageResponse *response) override {
+    return Serve(context, &model_workers_, [this, request, response] {
+      return GetLocalTaskLineage(request, response);
+    });
+  }
+
+  ServerUnaryReactor *GetRuntimeMetadataLineage(
+      CallbackServerContext *context,
+      const GetRuntimeMetadataLineageRequest *request,
+      GetRuntimeMetadataLineageResponse *response) override {
+    return Serve(context, &model_workers_, [this, request, response] {
+      return GetRuntimeMetadataLineage(request, response);
+    });
+  }
+
+  ServerUnaryReactor *GetParticipatingLearners(
+      CallbackServerContext *context,
+      const GetParticipatingLearnersRequest *request,
+      GetParticipatingLearnersResponse *response) override {
+    return Serve(context, &control_workers_, [this, request, response] {
+      return GetParticipatingLearners(request, response);
+    });
+  }
+
+  ServerUnaryReactor *GetServicesHealthStatus(
+      CallbackServerContext *context,
+      const GetServicesHealthStatusRequest *request,
+      GetServicesHealthStatusResponse *response) override {
+    return Serve(context, &control_workers_, [this, request, response] {
+      return GetServicesHealthStatus(request, response);
+    });
+  }
+
+  ServerUnaryReactor *JoinFederation(
+      CallbackServerContext *context,
+      const JoinFederationRequest *request,
+      JoinFederationResponse *response) override {
+    return Serve(context, &control_workers_, [this, request, response] {
+      return JoinFederation(request, response);
+    });
+  }
+
+  ServerUnaryReactor *LearnerHeartbeat(
+      CallbackServerContext *context,
+      const LearnerHeartbeatRequest *request,
+      LearnerHeartbeatResponse *response) override {
+    return Serve(context, &control_workers_, [this, request, response] {
+      return LearnerHeartbeat(request, response);
+    });
+  }
+
+  ServerUnaryReactor *LeaveFederation(
+      CallbackServerContext *context,
+      const LeaveFederationRequest *request,
+      LeaveFederationResponse *response) override {
+    return Serve(context, &control_workers_, [this, request, response] {
+      return LeaveFederation(request, response);
+    });
+  }
+
+  ServerUnaryReactor *MarkTaskCompleted(
+      CallbackServerContext *context,
+      const MarkTaskCompletedRequest *request,
+      MarkTaskCompletedResponse *response) override {
+    return Serve(context, &model_workers_, [this, request, response] {
+      return MarkTaskCompleted(request, response);
+    });
+  }
+
+  ServerReadReactor<MarkTaskCompletedChunk> *MarkTaskCompletedStream(
+      CallbackServerContext *context,
+      MarkTaskCompletedResponse *response) override {
+    return new CompletedTaskReader(context, controller_, &model_workers_,
+                                   response);
+  }
+
+  ServerUnaryReactor *ReplaceCommunityModel(
+      CallbackServerContext *context,
+      const ReplaceCommunityModelRequest *request,
+      ReplaceCommunityModelResponse *response) override {
+    return Serve(context, &model_workers_, [this, request, response] {
+      return ReplaceCommunityModel(request, response);
+    });
+  }
 
+  ServerUnaryReactor *ShutDown(CallbackServerContext *context,
+                               const ShutDownRequest *request,
+                               ShutDownResponse *response) override {
+    return Serve(context, &control_workers_, [this, request, response] {
+      return ShutDown(request, response);
+    });
+  }
+
+ private:
+  Status FetchCommunityModel(
+      const FetchCommunityModelRequest *request,
+      std::shared_ptr<const Controller::CommunityModelChunks> *chunks) {
     // Captures unexpected behavior.
-    if (request == nullptr || response == nullptr) {
+    if (request == nullptr || chunks == nullptr) {
       return {StatusCode::INVALID_ARGUMENT,
               "Request and response cannot be empty."};
     }
 
-    const auto lineage = controller_->GetEvaluationLineage(
-        request->num_backtracks());
-
-    for (const auto &evaluation: lineage) {
-      *response->add_community_evaluation() = evaluation;
+    auto chunks_or = controller_->GetCommunityModelChunks(
+        request->learner_id(), request->auth_token(), request->version(),
+        request->base_version());
+    if (!chunks_or.ok()) {
+      switch (chunks_or.status().code()) {
+        case absl::StatusCode::kInvalidArgument:
+          return {StatusCode::INVALID_ARGUMENT, std::string(chunks_or.status().message())};
+        case absl::StatusCode::kPermissionDenied:
+          return {StatusCode::PERMISSION_DENIED, std::string(chunks_or.status().message())};
+        case absl::StatusCode::kNotFound:
+          return {StatusCode::NOT_FOUND, std::string(chunks_or.status().message())};
+        default:
+          return {StatusCode::INTERNAL, std::string(chunks_or.status().message())};
+      }
     }
-
+    *chunks = std::move(chunks_or).value();
     return Status::OK;
   }
 
-  Status GetLocalTaskLineage(
-      ServerContext *context,
-      const GetLocalTaskLineageRequest *request,
-      GetLocalTaskLineageResponse *response) override {
+  Status GetCommunityModelEvaluationLineage(
+      const GetCommunityModelEvaluationLineageRequest *request,
+      GetCommunityModelEvaluationLineageResponse *response) {
+
     // Captures unexpected behavior.
     if (request == nullptr || response == nullptr) {
       return {StatusCode::INVALID_ARGUMENT,
               "Request and response cannot be empty."};
     }
 
-    for (const auto &learner_id: request->learner_ids()) {
-      const auto lineage = controller_->GetLocalTaskLineage(
-          learner_id, request->num_backtracks());
-
-      LocalTasksMetadata learner_tasks_metadata;
-      for (const auto &task_meta: lineage) {
-        *learner_tasks_metadata.add_task_metadata() = task_meta;
-      }
-      (*response->mutable_learner_task())[learner_id] = learner_tasks_metadata;
-    }
+    controller_->GetEvaluationLineage(*request, response);
 
     return Status::OK;
   }
 
-  Status GetRuntimeMetadataLineage(
-      ServerContext *context,
-      const GetRuntimeMetadataLineageRequest *request,
-      GetRuntimeMetadataLineageResponse *response) override {
+  Status GetLocalTaskLineage(const GetLocalTaskLineageRequest *request,
+                             GetLocalTaskLineageResponse *response) {
     // Captures unexpected behavior.
     if (request == nullptr || response == nullptr) {
       return {StatusCode::INVALID_ARGUMENT,
               "Request and response cannot be empty."};
     }
 
-    const auto lineage = controller_->GetRuntimeMetadataLineage(
-        request->num_backtracks());
+    controller_->GetLocalTaskLineage(*request, response);
 
-    for (const auto &metadata: lineage) {
-      *response->add_metadata() = metadata;
+    return Status::OK;
+  }
+
+  Status GetRuntimeMetadataLineage(const GetRuntimeMetadataLineageRequest *request,
+                                   GetRuntimeMetadataLineageResponse *response) {
+    // Captures unexpected behavior.
+    if (request == nullptr || response == nullptr) {
+      return {StatusCode::INVALID_ARGUMENT,
+              "Request and response cannot be empty."};
     }
 
+    controller_->GetRuntimeMetadataLineage(*request, response);
+
     return Status::OK;
   }
 
-  Status GetParticipatingLearners(
-      ServerContext *context, const GetParticipatingLearnersRequest *request,
-      GetParticipatingLearnersResponse *response) override {
+  Status GetParticipatingLearners(const GetParticipatingLearnersRequest *request,
+                                  GetParticipatingLearnersResponse *response) {
     // Captures unexpected behavior.
     if (request == nullptr || response == nullptr) {
       return {StatusCode::INVALID_ARGUMENT,
@@ -222,9 +504,8 @@ class ControllerServicerImpl : public ControllerServicer, private ServicerBase {
     return Status::OK;
   }
 
-  Status GetServicesHealthStatus(
-      ServerContext *context, const GetServicesHealthStatusRequest *request,
-      GetServicesHealthStatusResponse *response) override {
+  Status GetServicesHealthStatus(const GetServicesHealthStatusRequest *request,
+                                 GetServicesHealthStatusResponse *response) {
     // Captures unexpected behavior.
     if (request == nullptr || response == nullptr) {
       return {StatusCode::INVALID_ARGUMENT,
@@ -242,9 +523,8 @@ class ControllerServicerImpl : public ControllerServicer, private ServicerBase {
     return Status::OK;
   }
 
-  Status JoinFederation(ServerContext *context,
-                        const JoinFederationRequest *request,
-                        JoinFederationResponse *response) override {
+  Status JoinFederation(const JoinFederationRequest *request,
+                        JoinFederationResponse *response) {
     // Captures unexpected behavior.
     if (request == nullptr || response == nullptr) {
       return {StatusCode::INVALID_ARGUMENT,
@@ -283,9 +563,37 @@ class ControllerServicerImpl : public ControllerServicer, private ServicerBase {
     return Status::OK;
   }
 
-  Status LeaveFederation(ServerContext *context,
-                         const LeaveFederationRequest *request,
-                         LeaveFederationResponse *response) override {
+  Status LearnerHeartbeat(const LearnerHeartbeatRequest *request,
+                          LearnerHeartbeatResponse *response) {
+    // Captures unexpected behavior.
+    if (request == nullptr || response == nullptr) {
+      return {StatusCode::INVALID_ARGUMENT,
+              "Request and response cannot be empty."};
+    }
+
+    const auto status = controller_->LearnerHeartbeat(request->learner_id(),
+                                                      request->auth_token());
+    if (!status.ok()) {
+      response->mutable_ack()->set_status(false);
+      // An evicted learner is told so, in order to join the federation again.
+      switch (status.code()) {
+        case absl::StatusCode::kNotFound:
+          return {StatusCode::NOT_FOUND, std::string(status.message())};
+        case absl::StatusCode::kPermissionDenied:
+          return {StatusCode::PERMISSION_DENIED, std::string(status.message())};
+        default:
+          return {StatusCode::INVALID_ARGUMENT, std::string(status.message())};
+      }
+    }
+
+    response->mutable_ack()->set_status(true);
+    response->set_heartbeat_interval_secs(
+        controller_->GetParams().liveness_specs().heartbeat_interval_secs());
+    return Status::OK;
+  }
+
+  Status LeaveFederation(const LeaveFederationRequest *request,
+                         LeaveFederationResponse *response) {
     // Captures unexpected behavior.
     if (request == nullptr || response == nullptr) {
       return {StatusCode::INVALID_ARGUMENT,
@@ -313,9 +621,8 @@ class ControllerServicerImpl : public ControllerServicer, private ServicerBase {
     }
   }
 
-  Status MarkTaskCompleted(ServerContext *context,
-                           const MarkTaskCompletedRequest *request,
-                           MarkTaskCompletedResponse *response) override {
+  Status MarkTaskCompleted(const MarkTaskCompletedRequest *request,
+                           MarkTaskCompletedResponse *response) {
     // Captures unexpected behavior.
     if (request == nullptr || response == nullptr) {
       return {StatusCode::INVALID_ARGUMENT,
@@ -323,28 +630,17 @@ class ControllerServicerImpl : public ControllerServicer, private ServicerBase {
     }
 
     PLOG(INFO) << "Received Completed Task By " << request->learner_id();
+    // The request is owned by the call and is not read once the controller
+    // takes over the task, hence the (large) model of the task is moved to
+    // the controller rather than copied.
+    auto *task = const_cast<MarkTaskCompletedRequest *>(request)->mutable_task();
     const auto status = controller_->LearnerCompletedTask(
-        request->learner_id(), request->auth_token(), request->task());
-    if (!status.ok()) {
-      switch (status.code()) {
-        case absl::StatusCode::kInvalidArgument:response->mutable_ack()->set_status(false);
-          return {StatusCode::INVALID_ARGUMENT, std::string(status.message())};
-        case absl::StatusCode::kPermissionDenied:response->mutable_ack()->set_status(false);
-          return {StatusCode::PERMISSION_DENIED, std::string(status.message())};
-        case absl::StatusCode::kNotFound:response->mutable_ack()->set_status(false);
-          return {StatusCode::NOT_FOUND, std::string(status.message())};
-        default:response->mutable_ack()->set_status(false);
-          return {StatusCode::INTERNAL, std::string(status.message())};
-      }
-    }
-    response->mutable_ack()->set_status(true);
-    return Status::OK;
+        request->learner_id(), request->auth_token(), std::move(*task));
+    return MarkTaskCompletedStatus(status, response);
   }
 
-  Status
-  ReplaceCommunityModel(ServerContext *context,
-                        const ReplaceCommunityModelRequest *request,
-                        ReplaceCommunityModelResponse *response) override {
+  Status ReplaceCommunityModel(const ReplaceCommunityModelRequest *request,
+                               ReplaceCommunityModelResponse *response) {
     // Captures unexpected behavior.
     if (request == nullptr || response == nullptr) {
       return {StatusCode::INVALID_ARGUMENT,
@@ -361,8 +657,8 @@ class ControllerServicerImpl : public ControllerServicer, private ServicerBase {
     return {StatusCode::UNAUTHENTICATED, std::string(status.message())};
   }
 
-  Status ShutDown(ServerContext *context, const ShutDownRequest *request,
-                  ShutDownResponse *response) override {
+  Status ShutDown(const ShutDownRequest *request,
+                  ShutDownResponse *response) {
     // Captures unexpected behavior.
     if (request == nullptr || response == nullptr) {
       return {StatusCode::INVALID_ARGUMENT,
@@ -374,11 +670,24 @@ class ControllerServicerImpl : public ControllerServicer, private ServicerBase {
     return Status::OK;
   }
 
- private:
+  // Finishes the request with the status of the handler, once a worker
+  // has served the request.
+  template<class Handler>
+  static ServerUnaryReactor *Serve(CallbackServerContext *context,
+                                   BS::thread_pool *workers,
+                                   Handler handler) {
+    auto *reactor = context->DefaultReactor();
+    workers->push_task([reactor, handler] { reactor->Finish(handler()); });
+    return reactor;
+  }
+
   // Thread pool for async tasks.
   BS::thread_pool pool_;
+  // Thread pools serving the control requests and the requests carrying models.
+  BS::thread_pool control_workers_;
+  BS::thread_pool model_workers_;
   Controller *controller_;
-  bool shutdown_ = false;
+  std::atomic<bool> shutdown_ = false;
 };
 } // namespace
 
@@ -12,7 +12,9 @@
 
 namespace metisfl::controller {
 
-class ControllerServicer : public ControllerService::Service {
+// The controller's gRPC service. It follows the callback API, i.e., the
+// requests are served by the servicer's workers and not by gRPC threads.
+class ControllerServicer : public ControllerService::CallbackService {
 public:
   ABSL_MUST_USE_RESULT
   virtual const Controller *GetController() const = 0;
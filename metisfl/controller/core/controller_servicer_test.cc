@@ -1,20 +1,25 @@
 
+#include <future>
 #include <vector>
 
 #include <gmock/gmock.h>
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/test/default_reactor_test_peer.h>
 #include <gtest/gtest.h>
 
 #include "metisfl/controller/core/controller_mock.h"
 #include "metisfl/controller/core/controller_servicer.h"
-#include "metisfl/controller/core/macros.h"
-#include "metisfl/controller/core/proto_matchers.h"
+#include "metisfl/controller/common/macros.h"
+#include "metisfl/controller/common/proto_matchers.h"
 #include "metisfl/proto/controller.grpc.pb.h"
 #include "metisfl/proto/metis.pb.h"
 
 namespace metisfl::controller {
 namespace {
-using ::grpc::ServerContext;
+using ::grpc::CallbackServerContext;
+using ::grpc::testing::DefaultReactorTestPeer;
 using ::proto::ParseTextOrDie;
+using ::testing::ByMove;
 using ::testing::Exactly;
 using ::testing::Return;
 using ::testing::proto::EqualsProto;
@@ -24,7 +29,7 @@ const char kLearnerState[] = R"pb(
   learner {
     id: "localhost:1991"
     auth_token: "token"
-    service_spec {
+    server_entity {
       hostname: "localhost"
       port: 1991
     }
@@ -38,11 +43,54 @@ const char kLearnerState[] = R"pb(
 
 class ControllerServicerImplTest : public ::testing::Test {
  protected:
-  ServerContext ctx_;
+  // Invokes a unary method of the servicer and waits for the status the
+  // request finishes with, since requests are served by worker threads.
+  template<class Method, class Request, class Response>
+  grpc::Status Call(Method method, const Request *request, Response *response) {
+    CallbackServerContext ctx;
+    std::promise<grpc::Status> status;
+    DefaultReactorTestPeer peer(&ctx, [&status](grpc::Status finish_status) {
+      status.set_value(std::move(finish_status));
+    });
+    (service_.get()->*method)(&ctx, request, response);
+    return status.get_future().get();
+  }
+
+  // Serves the servicer in process and returns a stub to it, for the
+  // streaming methods, which cannot be invoked directly.
+  std::unique_ptr<ControllerService::Stub> StartInProcessService() {
+    grpc::ServerBuilder builder;
+    builder.RegisterService(service_.get());
+    server_ = builder.BuildAndStart();
+    return ControllerService::NewStub(
+        server_->InProcessChannel(grpc::ChannelArguments()));
+  }
+
+  // Returns a receiver that the controller hands to the servicer for the
+  // next streamed completed task.
+  MockCompletedTaskReceiver *ExpectCompletedTaskStream() {
+    auto *receiver = new MockCompletedTaskReceiver;
+    EXPECT_CALL(controller_, LearnerCompletedTaskStream("localhost:1991", "token", _))
+        .WillOnce(Return(ByMove(
+            absl::StatusOr<std::unique_ptr<Controller::CompletedTaskReceiver>>(
+                std::unique_ptr<Controller::CompletedTaskReceiver>(receiver)))));
+    return receiver;
+  }
+
+  // Sends the completed task's request and a chunk of its model.
+  static void WriteCompletedTask(grpc::ClientWriter<MarkTaskCompletedChunk> *writer) {
+    MarkTaskCompletedChunk chunk;
+    chunk.mutable_request()->set_learner_id("localhost:1991");
+    chunk.mutable_request()->set_auth_token("token");
+    ASSERT_TRUE(writer->Write(chunk));
+    chunk.mutable_model_chunk()->add_variables()->set_name("var1");
+    ASSERT_TRUE(writer->Write(chunk));
+  }
 
   MockController controller_;
   std::unique_ptr<ControllerServicer> service_ =
       ControllerServicer::New(&controller_);
+  std::unique_ptr<grpc::Server> server_;
 };
 
 // NOLINTNEXTLINE
@@ -54,7 +102,7 @@ TEST_F(ControllerServicerImplTest, GetParticipatingLearnersEmptyRequest) {
         .Times(Exactly(1))
         .WillOnce(Return(std::vector<LearnerDescriptor>()));
 
-  auto status = service_->GetParticipatingLearners(&ctx_, &req_, &res_);
+  auto status = Call(&ControllerServicer::GetParticipatingLearners, &req_, &res_);
 
   EXPECT_TRUE(status.ok());
 }
@@ -67,10 +115,10 @@ TEST_F(ControllerServicerImplTest, GetParticipatingLearnersEmptyVector) {
 
   GetParticipatingLearnersRequest req_;
   GetParticipatingLearnersResponse res_;
-  auto status = service_->GetParticipatingLearners(&ctx_, &req_, &res_);
+  auto status = Call(&ControllerServicer::GetParticipatingLearners, &req_, &res_);
 
   EXPECT_TRUE(status.ok());
-  EXPECT_TRUE(res_.server_entity().empty());
+  EXPECT_TRUE(res_.learner().empty());
 }
 
 // NOLINTNEXTLINE
@@ -84,19 +132,20 @@ TEST_F(ControllerServicerImplTest, GetParticipatingLearnersNotEmptyVector) {
 
   GetParticipatingLearnersRequest req_;
   GetParticipatingLearnersResponse res_;
-  auto status = service_->GetParticipatingLearners(&ctx_, &req_, &res_);
+  auto status = Call(&ControllerServicer::GetParticipatingLearners, &req_, &res_);
 
   EXPECT_TRUE(status.ok());
-  EXPECT_EQ(res_.server_entity_size(), 1);
-  EXPECT_EQ(res_.server_entity(0).hostname(), "localhost");
-  EXPECT_EQ(res_.server_entity(0).port(), 1991);
+  EXPECT_EQ(res_.learner_size(), 1);
+  EXPECT_EQ(res_.learner(0).id(), "localhost:1991");
+  EXPECT_TRUE(res_.learner(0).auth_token().empty());
+  EXPECT_FALSE(res_.learner(0).has_server_entity());
 }
 
 // NOLINTNEXTLINE
 TEST_F(ControllerServicerImplTest, JoinFederationEmptyRequest) {
   JoinFederationRequest req_;
   JoinFederationResponse res_;
-  auto status = service_->JoinFederation(&ctx_, &req_, &res_);
+  auto status = Call(&ControllerServicer::JoinFederation, &req_, &res_);
 
   EXPECT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
 }
@@ -107,17 +156,17 @@ TEST_F(ControllerServicerImplTest, JoinFederationNewLearner) {
   const auto& learner = learner_state.learner();
 
   EXPECT_CALL(controller_,
-              AddLearner(EqualsProto(learner_state.learner().service_spec()),
+              AddLearner(EqualsProto(learner_state.learner().server_entity()),
                          EqualsProto(learner_state.learner().dataset_spec())))
       .Times(Exactly(1))
       .WillOnce(Return(learner));
 
   JoinFederationRequest req_;
   JoinFederationResponse res_;
-  *req_.mutable_server_entity() = learner_state.learner().service_spec();
+  *req_.mutable_server_entity() = learner_state.learner().server_entity();
   *req_.mutable_local_dataset_spec() = learner_state.learner().dataset_spec();
 
-  auto status = service_->JoinFederation(&ctx_, &req_, &res_);
+  auto status = Call(&ControllerServicer::JoinFederation, &req_, &res_);
 
   EXPECT_TRUE(status.ok());
   EXPECT_FALSE(res_.learner_id().empty());
@@ -137,7 +186,7 @@ TEST_F(ControllerServicerImplTest, JoinFederationLearnerCollision) {
   const auto& learner = learner_state.learner();
 
   EXPECT_CALL(controller_,
-              AddLearner(EqualsProto(learner.service_spec()),
+              AddLearner(EqualsProto(learner.server_entity()),
                          EqualsProto(learner.dataset_spec())))
       .Times(Exactly(2))
       .WillOnce(Return(learner))
@@ -145,14 +194,14 @@ TEST_F(ControllerServicerImplTest, JoinFederationLearnerCollision) {
 
   JoinFederationRequest req_;
   JoinFederationResponse res_;
-  *req_.mutable_server_entity() = learner.service_spec();
+  *req_.mutable_server_entity() = learner.server_entity();
   *req_.mutable_local_dataset_spec() = learner.dataset_spec();
 
   // First time, learner joins successfully.
-  service_->JoinFederation(&ctx_, &req_, &res_);
+  Call(&ControllerServicer::JoinFederation, &req_, &res_);
 
   // Second time, must return and AlreadyExists error.
-  auto status = service_->JoinFederation(&ctx_, &req_, &res_);
+  auto status = Call(&ControllerServicer::JoinFederation, &req_, &res_);
   EXPECT_FALSE(status.ok());
   EXPECT_EQ(status.error_code(), grpc::StatusCode::ALREADY_EXISTS);
 }
@@ -161,7 +210,7 @@ TEST_F(ControllerServicerImplTest, JoinFederationLearnerCollision) {
 TEST_F(ControllerServicerImplTest, LeaveFederationEmptyRequest) {
   LeaveFederationRequest req_;
   LeaveFederationResponse res_;
-  auto status = service_->LeaveFederation(&ctx_, &req_, &res_);
+  auto status = Call(&ControllerServicer::LeaveFederation, &req_, &res_);
 
   EXPECT_FALSE(status.ok());
 }
@@ -180,7 +229,7 @@ TEST_F(ControllerServicerImplTest, LeaveFederationLearnerExists) {
   req.set_learner_id(learner.id());
   LeaveFederationResponse res;
 
-  auto status = service_->LeaveFederation(&ctx_, &req, &res);
+  auto status = Call(&ControllerServicer::LeaveFederation, &req, &res);
   EXPECT_TRUE(status.ok());
   EXPECT_TRUE(res.ack().status());
 }
@@ -199,7 +248,7 @@ TEST_F(ControllerServicerImplTest, LeaveFederationLearnerNotExists) {
   req.set_learner_id(learner.id());
   LeaveFederationResponse res;
 
-  auto status = service_->LeaveFederation(&ctx_, &req, &res);
+  auto status = Call(&ControllerServicer::LeaveFederation, &req, &res);
   EXPECT_FALSE(status.ok());
   EXPECT_FALSE(res.ack().status());
 }
@@ -218,39 +267,94 @@ TEST_F(ControllerServicerImplTest, LeaveFederationLearnerInvalidCredentials) {
   req.set_learner_id(learner.id());
   LeaveFederationResponse res;
 
-  auto status = service_->LeaveFederation(&ctx_, &req, &res);
+  auto status = Call(&ControllerServicer::LeaveFederation, &req, &res);
   EXPECT_FALSE(status.ok());
   EXPECT_FALSE(res.ack().status());
 }
 
 // NOLINTNEXTLINE
-TEST_F(ControllerServicerImplTest, GetEvaluationLineageRequestIsNullptr){
+TEST_F(ControllerServicerImplTest, LearnerHeartbeatReturnsInterval) {
+  auto learner_state = ParseTextOrDie<LearnerState>(kLearnerState);
+  const auto& learner = learner_state.learner();
+
+  ControllerParams params;
+  params.mutable_liveness_specs()->set_heartbeat_interval_secs(5);
+  EXPECT_CALL(controller_, GetParams)
+      .WillRepeatedly(::testing::ReturnRef(params));
+  EXPECT_CALL(controller_, LearnerHeartbeat(learner.id(), learner.auth_token()))
+      .Times(Exactly(1))
+      .WillOnce(Return(absl::OkStatus()));
+
+  LearnerHeartbeatRequest req;
+  req.set_auth_token(learner.auth_token());
+  req.set_learner_id(learner.id());
+  LearnerHeartbeatResponse res;
+
+  auto status = Call(&ControllerServicer::LearnerHeartbeat, &req, &res);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(res.ack().status());
+  EXPECT_EQ(res.heartbeat_interval_secs(), 5);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ControllerServicerImplTest, LearnerHeartbeatLearnerEvicted) {
+  auto learner_state = ParseTextOrDie<LearnerState>(kLearnerState);
+  const auto& learner = learner_state.learner();
+
+  EXPECT_CALL(controller_, LearnerHeartbeat(learner.id(), learner.auth_token()))
+      .Times(Exactly(1))
+      .WillOnce(Return(absl::NotFoundError("Learner does not exist.")));
+
+  LearnerHeartbeatRequest req;
+  req.set_auth_token(learner.auth_token());
+  req.set_learner_id(learner.id());
+  LearnerHeartbeatResponse res;
+
+  auto status = Call(&ControllerServicer::LearnerHeartbeat, &req, &res);
+  EXPECT_EQ(status.error_code(), grpc::StatusCode::NOT_FOUND);
+  EXPECT_FALSE(res.ack().status());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ControllerServicerImplTest, GetLocalTaskLineageRequestIsNullptr){
 
-  GetLocalModelEvaluationLineageRequest request;
-  GetLocalModelEvaluationLineageResponse response;
+  GetLocalTaskLineageResponse response;
 
-  auto status = service_->GetLocalModelEvaluationLineage(&ctx_, nullptr, &response);
+  auto status = Call(&ControllerServicer::GetLocalTaskLineage,
+                     static_cast<const GetLocalTaskLineageRequest *>(nullptr),
+                     &response);
 
   EXPECT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
 }
 
-// TODO(stripeli): Need to make the tests more robust with respect to ModelEvaluation values.
-TEST_F(ControllerServicerImplTest, GetEvaluationLineageEvaluationLineage) {
+// NOLINTNEXTLINE
+TEST_F(ControllerServicerImplTest, GetLocalTaskLineageTaskLineage) {
 
   LearnerState learnerState = ParseTextOrDie<LearnerState>(kLearnerState);
   const LearnerDescriptor &learnerDescriptor = learnerState.learner();
   std::string learner_id = learnerDescriptor.id();
-  GetLocalModelEvaluationLineageRequest request;
-  GetLocalModelEvaluationLineageResponse response;
+  GetLocalTaskLineageRequest request;
+  GetLocalTaskLineageResponse response;
+  request.add_learner_ids(learner_id);
+  request.set_num_backtracks(1);
 
-  // We are testing without initializing the request object with wildcard values defined by ::testing::_
-  ON_CALL(controller_, GetEvaluationLineage(learner_id, ::testing::_))
-    .WillByDefault(Return(std::vector<ModelEvaluation>()));
+  TaskExecutionMetadata task_metadata;
+  task_metadata.set_global_iteration(3);
+  EXPECT_CALL(controller_, GetLocalTaskLineage(::testing::_, ::testing::_))
+      .Times(Exactly(1))
+      .WillOnce([&](const GetLocalTaskLineageRequest &controller_request,
+                    GetLocalTaskLineageResponse *controller_response) {
+        EXPECT_THAT(controller_request, EqualsProto(request));
+        *(*controller_response->mutable_learner_task())[learner_id]
+            .add_task_metadata() = task_metadata;
+      });
 
-  auto status = service_->GetLocalModelEvaluationLineage(&ctx_, &request, &response);
+  auto status = Call(&ControllerServicer::GetLocalTaskLineage, &request, &response);
 
   EXPECT_EQ(status.error_code(),grpc::StatusCode::OK);
-  EXPECT_TRUE((*response.mutable_learner_evaluations()).empty());
+  ASSERT_EQ(response.learner_task().count(learner_id), 1);
+  EXPECT_THAT(response.learner_task().at(learner_id).task_metadata(0),
+              EqualsProto(task_metadata));
 }
 
 // TODO(stripeli): Could make the tests more robust with respect to ModelEvaluation values.
@@ -261,14 +365,13 @@ TEST_F(ControllerServicerImplTest, GetCommunityEvaluationLineageEvaluationLineag
 
   request.set_num_backtracks(1);
   // We are testing without initializing the request object. Passing wildcard values defined by ::testing::_
-  EXPECT_CALL(controller_, GetEvaluationLineage(::testing::_))
-        .Times(Exactly(1))
-        .WillOnce(Return(std::vector<ModelEvaluation>()));
+  EXPECT_CALL(controller_, GetEvaluationLineage(::testing::_, ::testing::_))
+        .Times(Exactly(1));
 
-  auto status = service_->GetCommunityModelEvaluationLineage(&ctx_, &request, &response);
+  auto status = Call(&ControllerServicer::GetCommunityModelEvaluationLineage, &request, &response);
 
   EXPECT_EQ(status.error_code(),grpc::StatusCode::OK);
-  ASSERT_TRUE((*response.mutable_evaluations()).IsInitialized());
+  EXPECT_TRUE(response.community_evaluation().empty());
 }
 
 // TODO(stripeli): Can make the test more useful by initializing the request object.
@@ -281,7 +384,7 @@ TEST_F(ControllerServicerImplTest, MarkTaskCompletedReturnOk){
   ON_CALL(controller_, LearnerCompletedTask(::testing::_, ::testing::_, ::testing::_))
             .WillByDefault(Return(absl::OkStatus()));
 
-  auto status = service_->MarkTaskCompleted(&ctx_, &request, &response);
+  auto status = Call(&ControllerServicer::MarkTaskCompleted, &request, &response);
 
   EXPECT_TRUE(status.ok());
 
@@ -297,26 +400,74 @@ TEST_F(ControllerServicerImplTest, MarkTaskCompletedReturnError){
   ON_CALL(controller_, LearnerCompletedTask(::testing::_, ::testing::_, ::testing::_))
             .WillByDefault(Return(absl::NotFoundError("Learner does not exist.")));
 
-  auto status = service_->MarkTaskCompleted(&ctx_, &request, &response);
+  auto status = Call(&ControllerServicer::MarkTaskCompleted, &request, &response);
 
   EXPECT_FALSE(status.ok());
 
 }
 
+// NOLINTNEXTLINE
+TEST_F(ControllerServicerImplTest, MarkTaskCompletedStreamCompletesTask) {
+  auto *receiver = ExpectCompletedTaskStream();
+  EXPECT_CALL(*receiver, ReceiveChunk(_)).WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(*receiver, Finish()).WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(*receiver, Destroyed());
+
+  auto stub = StartInProcessService();
+  grpc::ClientContext context;
+  MarkTaskCompletedResponse response;
+  auto writer = stub->MarkTaskCompletedStream(&context, &response);
+  WriteCompletedTask(writer.get());
+  writer->WritesDone();
+
+  EXPECT_TRUE(writer->Finish().ok());
+  EXPECT_TRUE(response.ack().status());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ControllerServicerImplTest, MarkTaskCompletedStreamCancelledDiscardsModel) {
+  std::promise<void> chunk_received;
+  std::promise<void> receiver_destroyed;
+  auto *receiver = ExpectCompletedTaskStream();
+  EXPECT_CALL(*receiver, ReceiveChunk(_))
+      .WillOnce([&chunk_received](ModelChunk *) {
+        chunk_received.set_value();
+        return absl::OkStatus();
+      });
+  // The task of a cancelled upload is never completed.
+  EXPECT_CALL(*receiver, Finish()).Times(0);
+  EXPECT_CALL(*receiver, Destroyed())
+      .WillOnce([&receiver_destroyed] { receiver_destroyed.set_value(); });
+
+  auto stub = StartInProcessService();
+  grpc::ClientContext context;
+  MarkTaskCompletedResponse response;
+  auto writer = stub->MarkTaskCompletedStream(&context, &response);
+  WriteCompletedTask(writer.get());
+  chunk_received.get_future().wait();
+  context.TryCancel();
+
+  EXPECT_EQ(writer->Finish().error_code(), grpc::StatusCode::CANCELLED);
+  receiver_destroyed.get_future().wait();
+}
+
 TEST_F(ControllerServicerImplTest, StartServiceWithSSL){
 
   metisfl::ControllerParams params = ParseTextOrDie<metisfl::ControllerParams>(R"pb2(
     server_entity {
       hostname: "0.0.0.0"
-      port: 50051
+      port: 0
       ssl_config {
-            server_key: "/resources/ssl/server-key.pem"
-            server_cert: "/resources/ssl/server-cert.pem"
+        enable_ssl: true
+        ssl_config_files {
+          public_certificate_file: "metisfl/resources/ssl_config/default/server-cert.pem"
+          private_key_file: "metisfl/resources/ssl_config/default/server-key.pem"
         }
+      }
     }
     global_model_specs {
       learners_participation_ratio: 1
-      aggregation_rule: FED_AVG
+      aggregation_rule { fed_avg {} }
     }
     communication_specs {
       protocol: SYNCHRONOUS
@@ -339,7 +490,7 @@ TEST_F(ControllerServicerImplTest, StartServiceWithSSL){
             .WillRepeatedly(::testing::ReturnRef(params));
 
   service_->StartService();
-  bool is_enabled = service_->GetController()->GetParams().server_entity().has_ssl_config();
+  bool is_enabled = service_->GetController()->GetParams().server_entity().ssl_config().enable_ssl();
 
   ASSERT_TRUE(is_enabled);
 }
@@ -349,11 +500,11 @@ TEST_F(ControllerServicerImplTest, StartServiceWithoutSSL){
   metisfl::ControllerParams params = ParseTextOrDie<metisfl::ControllerParams>(R"pb2(
     server_entity {
       hostname: "0.0.0.0"
-      port: 50051
+      port: 0
     }
     global_model_specs {
       learners_participation_ratio: 1
-      aggregation_rule: FED_AVG
+      aggregation_rule { fed_avg {} }
     }
     communication_specs {
       protocol: SYNCHRONOUS
@@ -376,7 +527,7 @@ TEST_F(ControllerServicerImplTest, StartServiceWithoutSSL){
             .WillRepeatedly(::testing::ReturnRef(params));
 
   service_->StartService();
-  bool is_enabled = service_->GetController()->GetParams().server_entity().has_ssl_config();
+  bool is_enabled = service_->GetController()->GetParams().server_entity().ssl_config().enable_ssl();
 
   ASSERT_FALSE(is_enabled);
 }
@@ -1,14 +1,104 @@
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "metisfl/controller/common/proto_tensor_serde.h"
 #include "metisfl/controller/core/controller.h"
+#include "metisfl/proto/learner.grpc.pb.h"
 #include "metisfl/proto/metis.pb.h"
 
 namespace metisfl::controller {
 namespace {
 
+using ::proto::DeserializeTensor;
+using ::proto::SerializeTensor;
+using ::testing::Contains;
+
+// An in-process learner that acknowledges every task it is assigned and
+// records it, so that a test can wait for the tasks of a round.
+class FakeLearner {
+ public:
+  FakeLearner() {
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(),
+                             &port_);
+    builder.RegisterService(&service_);
+    server_ = builder.BuildAndStart();
+  }
+
+  ~FakeLearner() {
+    server_->Shutdown();
+  }
+
+  ServerEntity server_entity() const {
+    ServerEntity server_entity;
+    server_entity.set_hostname("localhost");
+    server_entity.set_port(port_);
+    return server_entity;
+  }
+
+  // Waits until the learner is assigned the task of the given round.
+  std::optional<RunTaskRequest> WaitForTask(uint32_t global_iteration) {
+    return service_.WaitForTask(global_iteration);
+  }
+
+  // Whether the learner acknowledges the tasks it is assigned.
+  void set_accepts_tasks(bool accepts_tasks) {
+    service_.accepts_tasks = accepts_tasks;
+  }
+
+ private:
+  class Service final : public LearnerService::Service {
+   public:
+    grpc::Status RunTask(grpc::ServerContext *context,
+                         const RunTaskRequest *request,
+                         RunTaskResponse *response) override {
+      {
+        std::lock_guard<std::mutex> tasks_guard(tasks_mutex_);
+        tasks_.push_back(*request);
+      }
+      tasks_cv_.notify_all();
+      response->mutable_ack()->set_status(accepts_tasks);
+      return grpc::Status::OK;
+    }
+
+    std::optional<RunTaskRequest> WaitForTask(uint32_t global_iteration) {
+      std::unique_lock<std::mutex> tasks_lock(tasks_mutex_);
+      std::optional<RunTaskRequest> task;
+      tasks_cv_.wait_for(tasks_lock, std::chrono::seconds(10), [&] {
+        for (const auto &assigned: tasks_) {
+          if (assigned.task().global_iteration() == global_iteration) {
+            task = assigned;
+          }
+        }
+        return task.has_value();
+      });
+      return task;
+    }
+
+    std::atomic<bool> accepts_tasks = true;
+
+   private:
+    std::mutex tasks_mutex_;
+    std::condition_variable tasks_cv_;
+    std::vector<RunTaskRequest> tasks_;
+  };
+
+  Service service_;
+  int port_ = 0;
+  std::unique_ptr<grpc::Server> server_;
+};
+
 class ControllerTest : public ::testing::Test {
  public:
 
@@ -23,14 +113,14 @@ class ControllerTest : public ::testing::Test {
     // Set federated training protocol specifications.
     params.mutable_global_model_specs()
         ->set_learners_participation_ratio(1);
-    params.mutable_global_model_specs()->set_aggregation_rule(
-        GlobalModelSpecs::FED_AVG);
+    auto *aggregation_rule =
+        params.mutable_global_model_specs()->mutable_aggregation_rule();
+    aggregation_rule->mutable_fed_avg();
+    aggregation_rule->mutable_aggregation_rule_specs()->set_scaling_factor(
+        AggregationRuleSpecs::NUM_TRAINING_EXAMPLES);
     params.mutable_communication_specs()->set_protocol(
         CommunicationSpecs::SYNCHRONOUS);
 
-    // Set Fully Homomorphic Encryption specifications.
-    *params.mutable_fhe_scheme() = FHEScheme();
-
     // Set model store specifications.
     ModelStoreConfig model_store_config;
     *model_store_config.mutable_in_memory_store() = InMemoryStore();
@@ -68,6 +158,56 @@ class ControllerTest : public ::testing::Test {
 
     return controller;
   }
+
+  static LearnerDescriptor JoinFederation(Controller &controller,
+                                          const FakeLearner &learner) {
+    auto dataset = DatasetSpec();
+    dataset.set_num_training_examples(1);
+    dataset.set_num_validation_examples(1);
+    dataset.set_num_test_examples(1);
+
+    auto descriptor = controller.AddLearner(learner.server_entity(), dataset);
+    EXPECT_TRUE(descriptor.ok());
+    return *descriptor;
+  }
+
+  // A completed task of the given round, whose model holds a single value.
+  static CompletedLearningTask CreateCompletedTask(uint32_t global_iteration,
+                                                   double value) {
+    CompletedLearningTask task;
+    auto *variable = task.mutable_model()->add_variables();
+    variable->set_name("var1");
+    variable->set_trainable(true);
+    auto *tensor_spec =
+        variable->mutable_plaintext_tensor()->mutable_tensor_spec();
+    tensor_spec->set_length(1);
+    tensor_spec->add_dimensions(1);
+    tensor_spec->mutable_type()->set_type(DType::FLOAT64);
+    tensor_spec->mutable_type()->set_byte_order(DType::LITTLE_ENDIAN_ORDER);
+    auto serialized_tensor = SerializeTensor<double>({value});
+    tensor_spec->set_value(serialized_tensor.data(), serialized_tensor.size());
+    task.mutable_execution_metadata()->set_global_iteration(global_iteration);
+    return task;
+  }
+
+  static double CommunityModelValue(const Controller &controller) {
+    const auto &tensor_spec = controller.CommunityModel()->model()
+        .variables(0).plaintext_tensor().tensor_spec();
+    return DeserializeTensor<double>(tensor_spec)[0];
+  }
+
+  static std::optional<FederatedTaskRuntimeMetadata>
+  FindRuntimeMetadata(Controller &controller, uint32_t global_iteration) {
+    GetRuntimeMetadataLineageResponse lineage;
+    controller.GetRuntimeMetadataLineage(GetRuntimeMetadataLineageRequest(),
+                                         &lineage);
+    for (const auto &meta: lineage.metadata()) {
+      if (meta.global_iteration() == global_iteration) {
+        return meta;
+      }
+    }
+    return std::nullopt;
+  }
 };
 
 TEST_F(ControllerTest, GetParamsNotEmpty) /* NOLINT */ {
@@ -91,6 +231,120 @@ TEST_F(ControllerTest, GetLearnersNotEmpty) /* NOLINT */ {
   controller->Shutdown();
 }
 
+// A learner that completes its task after its round was released by the
+// quorum counts towards the current round, and releases the current round.
+TEST_F(ControllerTest, CarriedOverLearnerReleasesCurrentRound) /* NOLINT */ {
+  FakeLearner learner_1, learner_2;
+  auto params = CreateDefaultParams();
+  params.mutable_communication_specs()->mutable_protocol_specs()
+      ->set_sync_quorum_ratio(0.5);
+  auto controller = Controller::New(params);
+
+  auto descriptor_1 = JoinFederation(*controller, learner_1);
+  auto descriptor_2 = JoinFederation(*controller, learner_2);
+  ASSERT_TRUE(learner_1.WaitForTask(1));
+  ASSERT_TRUE(learner_2.WaitForTask(1));
+
+  // The first learner reaches the quorum of the first round on its own.
+  ASSERT_TRUE(controller->LearnerCompletedTask(
+      descriptor_1.id(), descriptor_1.auth_token(),
+      CreateCompletedTask(1, 1.0)).ok());
+  ASSERT_TRUE(learner_1.WaitForTask(2));
+  EXPECT_EQ(controller->CommunityModel()->global_iteration(), 1);
+
+  // The second learner completes the task of the first round while the
+  // second round is running.
+  ASSERT_TRUE(controller->LearnerCompletedTask(
+      descriptor_2.id(), descriptor_2.auth_token(),
+      CreateCompletedTask(1, 3.0)).ok());
+  ASSERT_TRUE(learner_2.WaitForTask(3));
+
+  EXPECT_EQ(controller->CommunityModel()->global_iteration(), 2);
+  EXPECT_DOUBLE_EQ(CommunityModelValue(*controller), 2.0);
+  auto second_round = FindRuntimeMetadata(*controller, 2);
+  ASSERT_TRUE(second_round);
+  EXPECT_TRUE(second_round->has_completed_at());
+
+  controller->Shutdown();
+}
+
+// With pipelined rounds, the model of a task completed ahead of its round is
+// not aggregated in the current round, and the task counts towards its round
+// once the round starts.
+TEST_F(ControllerTest, AheadTaskCountsTowardsItsRound) /* NOLINT */ {
+  FakeLearner learner_1, learner_2;
+  auto params = CreateDefaultParams();
+  params.mutable_communication_specs()->mutable_protocol_specs()
+      ->set_sync_max_staleness(2);
+  auto controller = Controller::New(params);
+
+  auto descriptor_1 = JoinFederation(*controller, learner_1);
+  auto descriptor_2 = JoinFederation(*controller, learner_2);
+  ASSERT_TRUE(learner_1.WaitForTask(1));
+  ASSERT_TRUE(learner_2.WaitForTask(1));
+
+  // The first learner runs ahead on the second and the third round, while
+  // the first round awaits the second learner.
+  ASSERT_TRUE(controller->LearnerCompletedTask(
+      descriptor_1.id(), descriptor_1.auth_token(),
+      CreateCompletedTask(1, 1.0)).ok());
+  ASSERT_TRUE(learner_1.WaitForTask(2));
+  ASSERT_TRUE(controller->LearnerCompletedTask(
+      descriptor_1.id(), descriptor_1.auth_token(),
+      CreateCompletedTask(2, 100.0)).ok());
+  ASSERT_TRUE(learner_1.WaitForTask(3));
+  EXPECT_EQ(controller->CommunityModel()->global_iteration(), 0);
+
+  // The first round aggregates the models of the first round only.
+  ASSERT_TRUE(controller->LearnerCompletedTask(
+      descriptor_2.id(), descriptor_2.auth_token(),
+      CreateCompletedTask(1, 3.0)).ok());
+  ASSERT_TRUE(learner_2.WaitForTask(2));
+  EXPECT_EQ(controller->CommunityModel()->global_iteration(), 1);
+  EXPECT_DOUBLE_EQ(CommunityModelValue(*controller), 2.0);
+
+  // The second round only awaits the second learner.
+  ASSERT_TRUE(controller->LearnerCompletedTask(
+      descriptor_2.id(), descriptor_2.auth_token(),
+      CreateCompletedTask(2, 5.0)).ok());
+  ASSERT_TRUE(learner_2.WaitForTask(3));
+  EXPECT_EQ(controller->CommunityModel()->global_iteration(), 2);
+  EXPECT_DOUBLE_EQ(CommunityModelValue(*controller), 52.5);
+  auto first_round = FindRuntimeMetadata(*controller, 1);
+  ASSERT_TRUE(first_round);
+  EXPECT_TRUE(first_round->train_task_submitted_ahead_at()
+                  .contains(descriptor_1.id()));
+  auto second_round = FindRuntimeMetadata(*controller, 2);
+  ASSERT_TRUE(second_round);
+  EXPECT_TRUE(second_round->has_completed_at());
+  EXPECT_THAT(second_round->completed_by_learner_id(),
+              Contains(descriptor_1.id()));
+
+  controller->Shutdown();
+}
+
+// A learner that does not accept its task is not awaited by the round.
+TEST_F(ControllerTest, RejectedTaskIsNotAwaited) /* NOLINT */ {
+  FakeLearner learner_1, learner_2;
+  learner_2.set_accepts_tasks(false);
+  auto params = CreateDefaultParams();
+  params.mutable_liveness_specs()->set_heartbeat_interval_secs(60);
+  auto controller = Controller::New(params);
+
+  auto descriptor_1 = JoinFederation(*controller, learner_1);
+  JoinFederation(*controller, learner_2);
+  ASSERT_TRUE(learner_1.WaitForTask(1));
+  ASSERT_TRUE(learner_2.WaitForTask(1));
+
+  ASSERT_TRUE(controller->LearnerCompletedTask(
+      descriptor_1.id(), descriptor_1.auth_token(),
+      CreateCompletedTask(1, 1.0)).ok());
+  ASSERT_TRUE(learner_1.WaitForTask(2));
+  EXPECT_EQ(controller->CommunityModel()->global_iteration(), 1);
+
+  controller->Shutdown();
+}
+
 //TEST_F(ControllerTest, AddLearnerNewEntity) /* NOLINT */ {
 //  auto controller = CreateEmptyController();
 //
@@ -41,18 +41,37 @@ CreateModelStore(const ModelStoreConfig &config) {
 }
 
 std::unique_ptr<ScalingFunction>
-CreateScaler(const AggregationRuleSpecs &aggregation_rule_specs) {
+CreateScaler(const AggregationRule &aggregation_rule,
+             const CommunicationSpecs &communication_specs) {
 
+  const auto &aggregation_rule_specs = aggregation_rule.aggregation_rule_specs();
+  std::unique_ptr<ScalingFunction> scaler;
   if (aggregation_rule_specs.scaling_factor() == AggregationRuleSpecs::NUM_COMPLETED_BATCHES) {
-    return absl::make_unique<BatchesScaler>();
+    scaler = absl::make_unique<BatchesScaler>();
   } else if (aggregation_rule_specs.scaling_factor() == AggregationRuleSpecs::NUM_PARTICIPANTS) {
-    return absl::make_unique<ParticipantsScaler>();
+    scaler = absl::make_unique<ParticipantsScaler>();
   } else if (aggregation_rule_specs.scaling_factor() == AggregationRuleSpecs::NUM_TRAINING_EXAMPLES) {
-    return absl::make_unique<TrainDatasetSizeScaler>();
+    scaler = absl::make_unique<TrainDatasetSizeScaler>();
   } else {
     throw std::runtime_error("Unsupported scaler.");
   }
 
+  // By default, only the buffered asynchronous updates are discounted.
+  auto discount = aggregation_rule_specs.staleness_discount();
+  if (discount.function() == StalenessDiscount::DEFAULT) {
+    auto buffers_updates =
+        communication_specs.protocol() == CommunicationSpecs::ASYNCHRONOUS &&
+            communication_specs.protocol_specs().async_buffer_size() > 1;
+    discount.set_function(buffers_updates ? StalenessDiscount::POLYNOMIAL
+                                          : StalenessDiscount::NONE);
+  }
+  if (discount.function() == StalenessDiscount::NONE) {
+    return scaler;
+  }
+  return absl::make_unique<StalenessScaler>(
+      std::move(scaler), discount,
+      /* renormalize */ !aggregation_rule.has_fed_rec());
+
 }
 
 std::unique_ptr<Scheduler>
@@ -60,7 +79,14 @@ CreateScheduler(const CommunicationSpecs &specs) {
 
   if (specs.protocol() == CommunicationSpecs::SYNCHRONOUS ||
       specs.protocol() == CommunicationSpecs::SEMI_SYNCHRONOUS) {
-    return absl::make_unique<SynchronousScheduler>();
+    const auto &protocol_specs = specs.protocol_specs();
+    return absl::make_unique<SynchronousScheduler>(
+        protocol_specs.sync_quorum_ratio(),
+        std::chrono::seconds(protocol_specs.sync_round_deadline_secs()));
+  } else if (specs.protocol() == CommunicationSpecs::ASYNCHRONOUS &&
+      specs.protocol_specs().async_buffer_size() > 1) {
+    return absl::make_unique<BufferedAsynchronousScheduler>(
+        specs.protocol_specs().async_buffer_size());
   } else if (specs.protocol() == CommunicationSpecs::ASYNCHRONOUS) {
     return absl::make_unique<AsynchronousScheduler>();
   } else {
@@ -70,8 +96,20 @@ CreateScheduler(const CommunicationSpecs &specs) {
 }
 
 std::unique_ptr<Selector>
-CreateSelector() {
+CreateSelector(const GlobalModelSpecs &global_model_specs,
+               const CommunicationSpecs &communication_specs) {
+
+  // The fastest learners are only selected if every (semi-)synchronous round
+  // is assigned to a cohort of the learners.
+  auto ratio = global_model_specs.learners_participation_ratio();
+  if (global_model_specs.cohort_sampling() == GlobalModelSpecs::FASTEST &&
+      ratio > 0 && ratio < 1 &&
+      communication_specs.protocol() != CommunicationSpecs::ASYNCHRONOUS) {
+    return absl::make_unique<SpeedAwareSelector>(
+        ratio, global_model_specs.min_participation_rate());
+  }
   return absl::make_unique<ScheduledCardinality>();
+
 }
 
 long GetTotalMemory() {
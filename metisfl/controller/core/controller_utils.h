@@ -24,13 +24,15 @@ std::unique_ptr<ModelStore>
 CreateModelStore(const ModelStoreConfig &config);
 
 std::unique_ptr<ScalingFunction>
-CreateScaler(const AggregationRuleSpecs &aggregation_rule_specs);
+CreateScaler(const AggregationRule &aggregation_rule,
+             const CommunicationSpecs &communication_specs);
 
 std::unique_ptr<Scheduler>
 CreateScheduler(const CommunicationSpecs &specs);
 
 std::unique_ptr<Selector>
-CreateSelector();
+CreateSelector(const GlobalModelSpecs &global_model_specs,
+               const CommunicationSpecs &communication_specs);
 
 long GetTotalMemory();
 
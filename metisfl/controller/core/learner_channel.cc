@@ -0,0 +1,67 @@
+
+#include "metisfl/controller/core/learner_channel.h"
+
+#include <glog/logging.h>
+#include <grpc/grpc.h>
+#include <grpcpp/create_channel.h>
+#include <grpcpp/security/credentials.h>
+
+#include "absl/strings/str_cat.h"
+
+namespace metisfl::controller {
+namespace {
+
+// Initial per-stream and per-connection receive window. BDP probing grows
+// the window further if the link allows it.
+constexpr int kInitialWindowBytes = 8 * 1024 * 1024;
+constexpr int kKeepaliveTimeMs = 60 * 1000;
+constexpr int kKeepaliveTimeoutMs = 20 * 1000;
+constexpr int kMaxReconnectBackoffMs = 5 * 1000;
+
+} // namespace
+
+grpc::ChannelArguments LearnerChannelArguments() {
+
+  grpc::ChannelArguments args;
+  args.SetMaxSendMessageSize(-1);
+  args.SetMaxReceiveMessageSize(-1);
+  args.SetInt(GRPC_ARG_HTTP2_BDP_PROBE, 1);
+  args.SetInt(GRPC_ARG_HTTP2_STREAM_LOOKAHEAD_BYTES, kInitialWindowBytes);
+  args.SetInt(GRPC_ARG_HTTP2_WRITE_BUFFER_SIZE, kInitialWindowBytes);
+  // Pings are only sent while calls are active. Learners' servers use the
+  // default ping policy, which rejects pings on idle connections.
+  args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS, kKeepaliveTimeMs);
+  args.SetInt(GRPC_ARG_KEEPALIVE_TIMEOUT_MS, kKeepaliveTimeoutMs);
+  args.SetInt(GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS, 0);
+  args.SetInt(GRPC_ARG_MAX_RECONNECT_BACKOFF_MS, kMaxReconnectBackoffMs);
+  return args;
+
+}
+
+std::shared_ptr<grpc::Channel>
+CreateLearnerChannel(const ServerEntity &server_entity,
+                     const grpc::ChannelArguments &args) {
+
+  auto target =
+      absl::StrCat(server_entity.hostname(), ":", server_entity.port());
+
+  auto creds = grpc::InsecureChannelCredentials();
+  if (server_entity.has_ssl_config()) {
+    grpc::SslCredentialsOptions ssl_opts;
+    if (server_entity.ssl_config().enable_ssl()) {
+      if (server_entity.ssl_config().has_ssl_config_stream()) {
+        ssl_opts.pem_root_certs =
+            server_entity.ssl_config().ssl_config_stream().public_certificate_stream();
+        creds = grpc::SslCredentials(ssl_opts);
+      } else {
+        PLOG(WARNING) << "Even though learner: " << target <<
+                      "has requested TLS/SSL connection, it has not sent a public "
+                      "certificate stream to establish connection.";
+      }
+    }
+  }
+  return grpc::CreateCustomChannel(target, creds, args);
+
+}
+
+} // namespace metisfl::controller
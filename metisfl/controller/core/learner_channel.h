@@ -0,0 +1,34 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_CORE_LEARNER_CHANNEL_H_
+#define METISFL_METISFL_CONTROLLER_CORE_LEARNER_CHANNEL_H_
+
+#include <memory>
+
+#include <grpcpp/channel.h>
+#include <grpcpp/support/channel_arguments.h>
+
+#include "metisfl/proto/metis.pb.h"
+
+namespace metisfl::controller {
+
+// Returns the arguments of the long-lived channels the controller keeps open
+// with every learner. The channels carry a few very large messages (the
+// community model) rather than many small ones, hence:
+//  - message sizes are not capped,
+//  - the initial HTTP/2 flow-control window is large and the window is
+//    resized dynamically through bandwidth-delay-product (BDP) probing, so
+//    that a large message does not stall on window updates,
+//  - keepalive pings detect broken connections while requests are in flight,
+//  - reconnection backoff is bounded, so that a restarted learner is
+//    reachable again within a few seconds.
+grpc::ChannelArguments LearnerChannelArguments();
+
+// Creates a channel with the learner served at the given server entity.
+// TLS is used if the learner has shared its public certificate.
+std::shared_ptr<grpc::Channel>
+CreateLearnerChannel(const ServerEntity &server_entity,
+                     const grpc::ChannelArguments &args = LearnerChannelArguments());
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_CORE_LEARNER_CHANNEL_H_
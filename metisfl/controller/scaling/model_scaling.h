@@ -5,6 +5,7 @@
 #include "metisfl/controller/scaling/batches_scaler.h"
 #include "metisfl/controller/scaling/participants_scaler.h"
 #include "metisfl/controller/scaling/scaling_function.h"
+#include "metisfl/controller/scaling/staleness_scaler.h"
 #include "metisfl/controller/scaling/train_dataset_size_scaler.h"
 
 #endif //METISFL_METISFL_CONTROLLER_SCALING_MODEL_SCALING_H_
@@ -2,6 +2,7 @@
 #ifndef METISFL_METISFL_CONTROLLER_SCALING_SCALING_FUNCTION_H_
 #define METISFL_METISFL_CONTROLLER_SCALING_SCALING_FUNCTION_H_
 
+#include <cstdint>
 #include <vector>
 #include <utility>
 
@@ -27,6 +28,12 @@ class ScalingFunction {
       const absl::flat_hash_map<std::string, LearnerState*> &participating_states,
       const absl::flat_hash_map<std::string, TaskExecutionMetadata*> &participating_metadata) = 0;
 
+  // Sets the current global iteration, i.e., the number of community models
+  // computed so far, against which the staleness of the learners' models is
+  // measured. It is ignored by the scaling functions that do not discount
+  // stale models.
+  virtual void SetGlobalIteration(uint32_t /* global_iteration */) {}
+
   virtual std::string Name() = 0;
 };
 
@@ -0,0 +1,93 @@
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "metisfl/controller/scaling/staleness_scaler.h"
+
+namespace metisfl::controller {
+namespace {
+
+// The exponent and slope of the discount, if not given.
+constexpr double kDefaultDiscountRate = 0.5;
+
+double DiscountRate(bool has_rate, float rate) {
+  if (!has_rate) {
+    return kDefaultDiscountRate;
+  }
+  if (rate < 0) {
+    throw std::runtime_error("Staleness discount rate cannot be negative.");
+  }
+  return rate;
+}
+
+} // namespace
+
+StalenessScaler::StalenessScaler(std::unique_ptr<ScalingFunction> scaler,
+                                 const StalenessDiscount &discount,
+                                 bool renormalize)
+    : scaler_(std::move(scaler)), function_(discount.function()),
+      polynomial_exponent_(DiscountRate(discount.has_polynomial_exponent(),
+                                        discount.polynomial_exponent())),
+      hinge_slope_(DiscountRate(discount.has_hinge_slope(),
+                                discount.hinge_slope())),
+      hinge_threshold_(discount.hinge_threshold()),
+      renormalize_(renormalize), global_iteration_(0) {}
+
+void StalenessScaler::SetGlobalIteration(uint32_t global_iteration) {
+  global_iteration_ = global_iteration;
+  scaler_->SetGlobalIteration(global_iteration);
+}
+
+double StalenessScaler::Discount(uint32_t staleness) const {
+
+  if (function_ == StalenessDiscount::HINGE) {
+    if (staleness <= hinge_threshold_) {
+      return 1;
+    }
+    return 1 / (1 + hinge_slope_ * (staleness - hinge_threshold_));
+  } else if (function_ == StalenessDiscount::POLYNOMIAL) {
+    return std::pow(1.0 + staleness, -polynomial_exponent_);
+  }
+  return 1;
+
+}
+
+absl::flat_hash_map<std::string, double>
+StalenessScaler::ComputeScalingFactors(
+    const FederatedModel &community_model,
+    const absl::flat_hash_map<std::string, LearnerState> &all_states,
+    const absl::flat_hash_map<std::string, LearnerState*> &participating_states,
+    const absl::flat_hash_map<std::string, TaskExecutionMetadata*> &participating_metadata) {
+
+  auto scaling_factors = scaler_->ComputeScalingFactors(
+      community_model, all_states, participating_states, participating_metadata);
+
+  double total = 0;
+  double discounted_total = 0;
+  for (auto &[learner_id, scaling_factor]: scaling_factors) {
+    auto it = participating_metadata.find(learner_id);
+    if (it == participating_metadata.end()) {
+      continue;
+    }
+    auto task_global_iteration = it->second->global_iteration();
+    auto staleness = global_iteration_ > task_global_iteration
+                     ? global_iteration_ - task_global_iteration : 0;
+    total += scaling_factor;
+    scaling_factor *= Discount(staleness);
+    discounted_total += scaling_factor;
+  }
+
+  if (renormalize_ && discounted_total > 0) {
+    for (auto &[learner_id, scaling_factor]: scaling_factors) {
+      if (participating_metadata.contains(learner_id)) {
+        scaling_factor *= total / discounted_total;
+      }
+    }
+  }
+
+  return scaling_factors;
+
+}
+
+} // namespace metisfl::controller
@@ -0,0 +1,52 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_SCALING_STALENESS_SCALER_H_
+#define METISFL_METISFL_CONTROLLER_SCALING_STALENESS_SCALER_H_
+
+#include <memory>
+
+#include "metisfl/controller/scaling/scaling_function.h"
+#include "metisfl/proto/metis.pb.h"
+
+namespace metisfl::controller {
+
+// Discounts the scaling factors of another scaling function by the staleness
+// of the learners' models, i.e., the number of community models computed
+// since the models' tasks were assigned (see StalenessDiscount), so that
+// stale models contribute less to the community model. Every factor is
+// discounted on its own, hence the cost grows with the participating
+// learners only. If renormalized, the discounted factors sum up to the same
+// total as the original ones, as the averaging aggregation rules expect;
+// the rolling aggregation rules (FedRec) normalize the factors themselves.
+class StalenessScaler : public ScalingFunction {
+ public:
+  StalenessScaler(std::unique_ptr<ScalingFunction> scaler,
+                  const StalenessDiscount &discount, bool renormalize);
+
+  absl::flat_hash_map<std::string, double> ComputeScalingFactors(
+      const FederatedModel &community_model,
+      const absl::flat_hash_map<std::string, LearnerState> &all_states,
+      const absl::flat_hash_map<std::string, LearnerState*> &participating_states,
+      const absl::flat_hash_map<std::string, TaskExecutionMetadata*> &participating_metadata) override;
+
+  void SetGlobalIteration(uint32_t global_iteration) override;
+
+  // The factor by which a model of the given staleness is scaled.
+  double Discount(uint32_t staleness) const;
+
+  inline std::string Name() override {
+    return "StalenessScaler";
+  }
+
+ private:
+  std::unique_ptr<ScalingFunction> scaler_;
+  StalenessDiscount::Function function_;
+  double polynomial_exponent_;
+  double hinge_slope_;
+  uint32_t hinge_threshold_;
+  bool renormalize_;
+  uint32_t global_iteration_;
+};
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_SCALING_STALENESS_SCALER_H_
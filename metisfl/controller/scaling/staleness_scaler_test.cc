@@ -0,0 +1,130 @@
+
+#include <memory>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "absl/memory/memory.h"
+#include "metisfl/controller/scaling/participants_scaler.h"
+#include "metisfl/controller/scaling/staleness_scaler.h"
+
+namespace metisfl::controller {
+namespace {
+
+StalenessDiscount Discount(StalenessDiscount::Function function) {
+  StalenessDiscount discount;
+  discount.set_function(function);
+  return discount;
+}
+
+// Two learners participate: learner1 with a fresh and learner2 with a
+// stale model, whose tasks were assigned at the given global iterations.
+class StalenessScalerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    metadata_["learner1"].set_global_iteration(10);
+    metadata_["learner2"].set_global_iteration(7);
+    for (auto &[learner_id, metadata]: metadata_) {
+      states_[learner_id].mutable_learner()->set_id(learner_id);
+    }
+    for (auto &[learner_id, state]: states_) {
+      participating_states_[learner_id] = &state;
+      participating_metadata_[learner_id] = &metadata_[learner_id];
+    }
+  }
+
+  absl::flat_hash_map<std::string, double> ComputeScalingFactors(
+      StalenessScaler *scaler) {
+    scaler->SetGlobalIteration(10);
+    return scaler->ComputeScalingFactors(FederatedModel(), states_,
+                                         participating_states_,
+                                         participating_metadata_);
+  }
+
+  absl::flat_hash_map<std::string, TaskExecutionMetadata> metadata_;
+  absl::flat_hash_map<std::string, LearnerState> states_;
+  absl::flat_hash_map<std::string, LearnerState *> participating_states_;
+  absl::flat_hash_map<std::string, TaskExecutionMetadata *> participating_metadata_;
+};
+
+// NOLINTNEXTLINE
+TEST(StalenessScaler, PolynomialDiscount) {
+  auto discount = Discount(StalenessDiscount::POLYNOMIAL);
+  discount.set_polynomial_exponent(1);
+  StalenessScaler scaler(absl::make_unique<ParticipantsScaler>(), discount,
+                         /* renormalize */ false);
+
+  EXPECT_DOUBLE_EQ(scaler.Discount(0), 1);
+  EXPECT_DOUBLE_EQ(scaler.Discount(1), 0.5);
+  EXPECT_DOUBLE_EQ(scaler.Discount(3), 0.25);
+}
+
+// NOLINTNEXTLINE
+TEST(StalenessScaler, HingeDiscount) {
+  auto discount = Discount(StalenessDiscount::HINGE);
+  discount.set_hinge_slope(0.5);
+  discount.set_hinge_threshold(2);
+  StalenessScaler scaler(absl::make_unique<ParticipantsScaler>(), discount,
+                         /* renormalize */ false);
+
+  EXPECT_DOUBLE_EQ(scaler.Discount(0), 1);
+  EXPECT_DOUBLE_EQ(scaler.Discount(2), 1);
+  EXPECT_DOUBLE_EQ(scaler.Discount(4), 0.5);
+  EXPECT_DOUBLE_EQ(scaler.Discount(8), 0.25);
+}
+
+// NOLINTNEXTLINE
+TEST(StalenessScaler, DefaultsToSquareRootDiscount) {
+  StalenessScaler scaler(absl::make_unique<ParticipantsScaler>(),
+                         Discount(StalenessDiscount::POLYNOMIAL),
+                         /* renormalize */ false);
+
+  EXPECT_DOUBLE_EQ(scaler.Discount(3), 0.5);
+}
+
+// NOLINTNEXTLINE
+TEST(StalenessScaler, ZeroRateDoesNotDiscount) {
+  auto discount = Discount(StalenessDiscount::POLYNOMIAL);
+  discount.set_polynomial_exponent(0);
+  StalenessScaler scaler(absl::make_unique<ParticipantsScaler>(), discount,
+                         /* renormalize */ false);
+
+  EXPECT_DOUBLE_EQ(scaler.Discount(3), 1);
+}
+
+// NOLINTNEXTLINE
+TEST(StalenessScaler, RejectsNegativeRate) {
+  auto discount = Discount(StalenessDiscount::HINGE);
+  discount.set_hinge_slope(-1);
+
+  EXPECT_THROW(StalenessScaler(absl::make_unique<ParticipantsScaler>(),
+                               discount, /* renormalize */ false),
+               std::runtime_error);
+}
+
+// NOLINTNEXTLINE
+TEST_F(StalenessScalerTest, DiscountsStaleModels) {
+  auto discount = Discount(StalenessDiscount::POLYNOMIAL);
+  discount.set_polynomial_exponent(1);
+  StalenessScaler scaler(absl::make_unique<ParticipantsScaler>(), discount,
+                         /* renormalize */ false);
+
+  auto scaling_factors = ComputeScalingFactors(&scaler);
+  EXPECT_DOUBLE_EQ(scaling_factors["learner1"], 0.5);
+  EXPECT_DOUBLE_EQ(scaling_factors["learner2"], 0.5 / 4);
+}
+
+// NOLINTNEXTLINE
+TEST_F(StalenessScalerTest, RenormalizesDiscountedFactors) {
+  auto discount = Discount(StalenessDiscount::POLYNOMIAL);
+  discount.set_polynomial_exponent(1);
+  StalenessScaler scaler(absl::make_unique<ParticipantsScaler>(), discount,
+                         /* renormalize */ true);
+
+  auto scaling_factors = ComputeScalingFactors(&scaler);
+  EXPECT_DOUBLE_EQ(scaling_factors["learner1"], 0.8);
+  EXPECT_DOUBLE_EQ(scaling_factors["learner2"], 0.2);
+}
+
+} // namespace
+} // namespace metisfl::controller
@@ -0,0 +1,150 @@
+
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <grpcpp/create_channel.h>
+#include <grpcpp/generic/generic_stub.h>
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+
+#include "absl/strings/str_cat.h"
+#include "metisfl/controller/common/proto_slice_serde.h"
+#include "metisfl/controller/core/learner_channel.h"
+#include "metisfl/proto/learner.grpc.pb.h"
+
+using namespace metisfl;
+using namespace metisfl::controller;
+
+/*
+ * Measures the time to dispatch a large RunTask request (e.g., a model
+ * encrypted with FHE) multiple times to a learner, using:
+ *  (1) a new channel per request (what the controller used to do),
+ *  (2) a single reused channel with the default channel arguments,
+ *  (3) a single reused channel with the arguments the controller uses.
+ * The learner is an in-process service that acknowledges every task.
+ */
+
+class AckLearnerService final : public LearnerService::Service {
+  grpc::Status RunTask(grpc::ServerContext *context,
+                       const RunTaskRequest *request,
+                       RunTaskResponse *response) override {
+    response->mutable_ack()->set_status(true);
+    return grpc::Status::OK;
+  }
+};
+
+double DispatchRequests(
+    const std::function<std::shared_ptr<grpc::Channel>()> &get_channel,
+    const grpc::ByteBuffer &request, int num_requests) {
+
+  const auto method =
+      absl::StrCat("/", LearnerService::service_full_name(), "/RunTask");
+
+  struct Call {
+    grpc::ClientContext context;
+    grpc::ByteBuffer reply;
+    grpc::Status status;
+    std::unique_ptr<grpc::GenericClientAsyncResponseReader> response_reader;
+  };
+
+  grpc::CompletionQueue cq;
+  std::vector<std::unique_ptr<Call>> calls;
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < num_requests; ++i) {
+    grpc::GenericStub stub(get_channel());
+    auto call = std::make_unique<Call>();
+    call->response_reader =
+        stub.PrepareUnaryCall(&call->context, method, request, &cq);
+    call->response_reader->StartCall();
+    call->response_reader->Finish(&call->reply, &call->status, call.get());
+    calls.push_back(std::move(call));
+  }
+
+  void *got_tag;
+  bool ok = false;
+  for (int i = 0; i < num_requests && cq.Next(&got_tag, &ok); ++i) {
+    auto *call = static_cast<Call *>(got_tag);
+    if (!call->status.ok()) {
+      LOG(ERROR) << "RunTask failed: " << call->status.error_message();
+    }
+  }
+  auto end_time = std::chrono::high_resolution_clock::now();
+  cq.Shutdown();
+  while (cq.Next(&got_tag, &ok)) {}
+
+  std::chrono::duration<double, std::milli> elapsed_time = end_time - start_time;
+  return elapsed_time.count();
+
+}
+
+int main(int argc, char *argv[]) {
+
+  // Verify Input Parameters
+  if (argc < 3) {
+    throw std::runtime_error("Insufficient input arguments. Need to provide values for:\n"
+                             "Number-of-Requests, Model-Size-MB, [Number-of-Rounds]");
+  }
+
+  // Set flags picked up by glog before initialization.
+  FLAGS_log_dir = "/tmp";
+  FLAGS_alsologtostderr = true;
+  google::InitGoogleLogging(argv[0]);
+
+  int num_requests = std::stoi(argv[1], nullptr, 10);
+  int model_size_mb = std::stoi(argv[2], nullptr, 10);
+  int num_rounds = argc > 3 ? std::stoi(argv[3], nullptr, 10) : 3;
+
+  LOG(INFO) << "Number of requests: " << num_requests;
+  LOG(INFO) << "Model size (MB): " << model_size_mb;
+  LOG(INFO) << "Number of rounds: " << num_rounds;
+
+  AckLearnerService service;
+  int port = 0;
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(), &port);
+  builder.RegisterService(&service);
+  builder.SetMaxReceiveMessageSize(INT_MAX);
+  auto server = builder.BuildAndStart();
+
+  ServerEntity server_entity;
+  server_entity.set_hostname("localhost");
+  server_entity.set_port(port);
+
+  // The request is serialized once, as the controller does.
+  RunTaskRequest task_fields;
+  auto *tensor_spec = task_fields.mutable_federated_model()->mutable_model()
+      ->add_variables()->mutable_plaintext_tensor()->mutable_tensor_spec();
+  tensor_spec->set_value(std::string((size_t) model_size_mb << 20, 'x'));
+  task_fields.mutable_task()->set_num_local_updates(1);
+  auto request = ConcatSlices({SerializeToSlice(task_fields)});
+
+  grpc::ChannelArguments default_args;
+  default_args.SetMaxSendMessageSize(-1);
+  auto default_channel = CreateLearnerChannel(server_entity, default_args);
+  auto tuned_channel = CreateLearnerChannel(server_entity);
+
+  std::vector<std::pair<std::string, std::function<std::shared_ptr<grpc::Channel>()>>> modes = {
+      {"New channel per request", [&] { return CreateLearnerChannel(server_entity, default_args); }},
+      {"Reused channel, default arguments", [&] { return default_channel; }},
+      {"Reused channel, tuned arguments", [&] { return tuned_channel; }},
+  };
+
+  for (const auto &[name, get_channel]: modes) {
+    // Warm-up round to establish the reused connections.
+    DispatchRequests(get_channel, request, 1);
+    double total_ms = 0;
+    for (int round = 0; round < num_rounds; ++round) {
+      total_ms += DispatchRequests(get_channel, request, num_requests);
+    }
+    LOG(INFO) << name << ": " << total_ms / num_rounds << "ms per round.";
+  }
+
+  server->Shutdown();
+  return 0;
+
+}
@@ -139,9 +139,14 @@ ScenariosCommon::ScenariosCommon(const ControllerParams &params) {
   params_ = params;
   aggregation_function_ = CreateAggregator(params.global_model_specs().aggregation_rule());
   model_store_ = CreateModelStore(params.model_store_config());
-  scaler_ = CreateScaler(params.global_model_specs().aggregation_rule().aggregation_rule_specs());
+  aggregation_function_->SetTensorValueResolver(
+      [store = model_store_.get()](const TensorSpec &tensor_spec) {
+        return store->ResolveTensorValue(tensor_spec);
+      });
+  scaler_ = CreateScaler(params.global_model_specs().aggregation_rule(),
+                         params.communication_specs());
   scheduler_ = CreateScheduler(params.communication_specs());
-  selector_ = CreateSelector();
+  selector_ = CreateSelector(params.global_model_specs(), params.communication_specs());
 }
 
 void ScenariosCommon::AssignLearnerState(
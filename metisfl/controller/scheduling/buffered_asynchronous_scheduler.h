@@ -0,0 +1,66 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_SCHEDULING_BUFFERED_ASYNCHRONOUS_SCHEDULER_H_
+#define METISFL_METISFL_CONTROLLER_SCHEDULING_BUFFERED_ASYNCHRONOUS_SCHEDULER_H_
+
+#include <algorithm>
+
+#include "absl/container/flat_hash_set.h"
+#include "metisfl/controller/scheduling/scheduler.h"
+
+namespace metisfl::controller {
+
+// Implements the buffered asynchronous task scheduling policy. The learners
+// are assigned their next task as soon as they complete their current one
+// (by the controller), while their updates are buffered. The buffered
+// learners are released for aggregation once the buffer holds the updates of
+// `buffer_size` learners, or of all active learners if there are fewer.
+class BufferedAsynchronousScheduler : public Scheduler {
+ public:
+  explicit BufferedAsynchronousScheduler(size_t buffer_size)
+      : buffer_size_(buffer_size), learner_ids_() {}
+
+  std::vector<std::string> ScheduleNext(const std::string &learner_id,
+                                        const CompletedLearningTask &task,
+                                        const std::vector<LearnerDescriptor> &active_learners) override {
+
+    // A learner that completes another task while its previous update is
+    // buffered is only counted once; the store holds its latest model.
+    learner_ids_.insert(learner_id);
+    return ReleaseIfFull(active_learners);
+
+  }
+
+  std::vector<std::string> ScheduleAfterDeparture(
+      const std::vector<LearnerDescriptor> &active_learners) override {
+    // With fewer active learners, the buffer may already be full.
+    if (learner_ids_.empty()) {
+      return {};
+    }
+    return ReleaseIfFull(active_learners);
+  }
+
+  inline std::string name() override {
+    return "BufferedAsynchronousScheduler";
+  }
+
+ private:
+  std::vector<std::string> ReleaseIfFull(
+      const std::vector<LearnerDescriptor> &active_learners) {
+    if (learner_ids_.size() < std::min(buffer_size_, active_learners.size())) {
+      return {};
+    }
+
+    std::vector<std::string> to_aggregate(learner_ids_.begin(),
+                                          learner_ids_.end());
+    learner_ids_.clear();
+    return to_aggregate;
+  }
+
+  size_t buffer_size_;
+  // Keeps track of the learners whose updates are buffered.
+  ::absl::flat_hash_set<std::string> learner_ids_;
+};
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_SCHEDULING_BUFFERED_ASYNCHRONOUS_SCHEDULER_H_
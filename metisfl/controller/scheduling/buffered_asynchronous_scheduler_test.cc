@@ -0,0 +1,84 @@
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "absl/strings/str_cat.h"
+#include "metisfl/controller/scheduling/buffered_asynchronous_scheduler.h"
+
+namespace metisfl::controller {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+std::vector<LearnerDescriptor> CreateLearners(int n) {
+  std::vector<LearnerDescriptor> learners;
+  for (int i = 0; i < n; ++i) {
+    LearnerDescriptor learner;
+    learner.set_id(absl::StrCat("learner", i + 1));
+    learners.push_back(learner);
+  }
+  return learners;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferedAsynchronousScheduler, ReleasesFullBuffer) {
+  BufferedAsynchronousScheduler scheduler(2);
+  auto learners = CreateLearners(5);
+
+  auto res1 =
+      scheduler.ScheduleNext("learner1", CompletedLearningTask(), learners);
+  EXPECT_TRUE(res1.empty());
+  auto res2 =
+      scheduler.ScheduleNext("learner2", CompletedLearningTask(), learners);
+  EXPECT_THAT(res2, UnorderedElementsAre("learner1", "learner2"));
+
+  auto res3 =
+      scheduler.ScheduleNext("learner3", CompletedLearningTask(), learners);
+  EXPECT_TRUE(res3.empty());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferedAsynchronousScheduler, CountsEveryLearnerOnce) {
+  BufferedAsynchronousScheduler scheduler(2);
+  auto learners = CreateLearners(5);
+
+  scheduler.ScheduleNext("learner1", CompletedLearningTask(), learners);
+  auto res1 =
+      scheduler.ScheduleNext("learner1", CompletedLearningTask(), learners);
+  EXPECT_TRUE(res1.empty());
+  auto res2 =
+      scheduler.ScheduleNext("learner2", CompletedLearningTask(), learners);
+  EXPECT_THAT(res2, UnorderedElementsAre("learner1", "learner2"));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferedAsynchronousScheduler, BufferIsCappedAtActiveLearners) {
+  BufferedAsynchronousScheduler scheduler(10);
+  auto learners = CreateLearners(2);
+
+  auto res1 =
+      scheduler.ScheduleNext("learner1", CompletedLearningTask(), learners);
+  EXPECT_TRUE(res1.empty());
+  auto res2 =
+      scheduler.ScheduleNext("learner2", CompletedLearningTask(), learners);
+  EXPECT_THAT(res2, UnorderedElementsAre("learner1", "learner2"));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferedAsynchronousScheduler, DepartureReleasesBuffer) {
+  BufferedAsynchronousScheduler scheduler(3);
+  auto learners = CreateLearners(3);
+
+  scheduler.ScheduleNext("learner1", CompletedLearningTask(), learners);
+  scheduler.ScheduleNext("learner2", CompletedLearningTask(), learners);
+  EXPECT_TRUE(scheduler.ScheduleAfterDeparture(learners).empty());
+
+  auto res = scheduler.ScheduleAfterDeparture(CreateLearners(2));
+  EXPECT_THAT(res, UnorderedElementsAre("learner1", "learner2"));
+  EXPECT_TRUE(scheduler.ScheduleAfterDeparture(CreateLearners(1)).empty());
+}
+
+} // namespace
+} // namespace metisfl::controller
@@ -0,0 +1,168 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_SCHEDULING_COHORT_SAMPLER_H_
+#define METISFL_METISFL_CONTROLLER_SCHEDULING_COHORT_SAMPLER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+
+namespace metisfl::controller {
+
+// Samples the cohort of learners that participate in a federation round.
+// The learners are kept in an indexed registry, which is updated as learners
+// join and leave the federation, so that a cohort of k learners is sampled
+// without visiting all registered learners: in O(k) time if the learners are
+// sampled uniformly, and in O(k log n) time if they are sampled proportionally
+// to their weight, e.g., their dataset size. The sampler is not thread-safe.
+class CohortSampler {
+ public:
+  explicit CohortSampler(bool weighted,
+                         uint64_t seed = std::random_device()())
+      : weighted_(weighted), ids_(), weights_(), tree_(1, 0), positions_(),
+        rng_(seed) {}
+
+  size_t size() const { return ids_.size(); }
+
+  // Adds the learner, or updates its weight. Weights are at least 1.
+  void Add(const std::string &learner_id, uint64_t weight) {
+    weight = weight == 0 ? 1 : weight;
+    auto position = positions_.find(learner_id);
+    if (position != positions_.end()) {
+      Update(position->second, weight - weights_[position->second]);
+      weights_[position->second] = weight;
+      return;
+    }
+    positions_[learner_id] = ids_.size();
+    ids_.push_back(learner_id);
+    weights_.push_back(weight);
+    if (weighted_) {
+      // The new node covers the range (i - lowbit(i), i] of the registry.
+      auto i = tree_.size();
+      tree_.push_back(weight + Prefix(i - 1) - Prefix(i - (i & -i)));
+    }
+  }
+
+  // Removes the learner, by moving the last learner of the registry into
+  // its position.
+  void Remove(const std::string &learner_id) {
+    auto position = positions_.find(learner_id);
+    if (position == positions_.end()) {
+      return;
+    }
+    auto index = position->second;
+    auto last = ids_.size() - 1;
+    positions_.erase(position);
+    if (index != last) {
+      Update(index, weights_[last] - weights_[index]);
+      ids_[index] = std::move(ids_[last]);
+      weights_[index] = weights_[last];
+      positions_[ids_[index]] = index;
+    }
+    ids_.pop_back();
+    weights_.pop_back();
+    if (weighted_) {
+      // No other node covers the last position of the registry.
+      tree_.pop_back();
+    }
+  }
+
+  // Returns min(k, size()) distinct learners.
+  std::vector<std::string> Sample(size_t k) {
+    k = std::min(k, ids_.size());
+    return weighted_ ? SampleWeighted(k) : SampleUniform(k);
+  }
+
+ private:
+  // A partial Fisher-Yates shuffle of the registry, in which only the
+  // swapped positions are recorded.
+  std::vector<std::string> SampleUniform(size_t k) {
+    std::vector<std::string> cohort;
+    cohort.reserve(k);
+    absl::flat_hash_map<size_t, size_t> swapped;
+    auto at = [&swapped](size_t i) {
+      auto it = swapped.find(i);
+      return it == swapped.end() ? i : it->second;
+    };
+    for (size_t i = 0; i < k; ++i) {
+      auto j = std::uniform_int_distribution<size_t>(i, ids_.size() - 1)(rng_);
+      auto sampled = at(j);
+      swapped[j] = at(i);
+      cohort.push_back(ids_[sampled]);
+    }
+    return cohort;
+  }
+
+  // Every sampled learner is excluded from the subsequent draws by zeroing
+  // its weight, which is restored once the cohort is sampled.
+  std::vector<std::string> SampleWeighted(size_t k) {
+    std::vector<std::string> cohort;
+    cohort.reserve(k);
+    std::vector<size_t> sampled;
+    sampled.reserve(k);
+    for (size_t i = 0; i < k; ++i) {
+      auto total = Prefix(ids_.size());
+      auto target = std::uniform_int_distribution<uint64_t>(0, total - 1)(rng_);
+      auto index = Find(target);
+      sampled.push_back(index);
+      cohort.push_back(ids_[index]);
+      Update(index, -weights_[index]);
+    }
+    for (auto index: sampled) {
+      Update(index, weights_[index]);
+    }
+    return cohort;
+  }
+
+  // The weights are kept in a Fenwick tree (1-based), whose arithmetic is
+  // modulo 2^64 and hence exact for negative deltas.
+  void Update(size_t index, uint64_t delta) {
+    if (!weighted_) {
+      return;
+    }
+    for (auto i = index + 1; i < tree_.size(); i += i & -i) {
+      tree_[i] += delta;
+    }
+  }
+
+  // The total weight of the first `n` learners of the registry.
+  uint64_t Prefix(size_t n) const {
+    uint64_t sum = 0;
+    for (auto i = n; i > 0; i -= i & -i) {
+      sum += tree_[i];
+    }
+    return sum;
+  }
+
+  // The position of the learner whose cumulative weight range contains
+  // `target`, i.e., the smallest position with Prefix(position + 1) > target.
+  size_t Find(uint64_t target) const {
+    size_t position = 0;
+    size_t step = 1;
+    while (step * 2 < tree_.size()) {
+      step *= 2;
+    }
+    for (; step > 0; step /= 2) {
+      if (position + step < tree_.size() && tree_[position + step] <= target) {
+        position += step;
+        target -= tree_[position];
+      }
+    }
+    return position;
+  }
+
+  bool weighted_;
+  std::vector<std::string> ids_;
+  std::vector<uint64_t> weights_;
+  std::vector<uint64_t> tree_;
+  // The position of every learner in the registry.
+  absl::flat_hash_map<std::string, size_t> positions_;
+  std::mt19937_64 rng_;
+};
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_SCHEDULING_COHORT_SAMPLER_H_
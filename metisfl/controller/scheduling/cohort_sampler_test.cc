@@ -0,0 +1,78 @@
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "metisfl/controller/scheduling/cohort_sampler.h"
+
+namespace metisfl::controller {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+// NOLINTNEXTLINE
+TEST(CohortSampler, SamplesDistinctLearners) {
+  for (bool weighted: {false, true}) {
+    CohortSampler sampler(weighted, /* seed */ 1);
+    for (int i = 0; i < 100; ++i) {
+      sampler.Add(absl::StrCat("learner", i + 1), i + 1);
+    }
+
+    for (int round = 0; round < 50; ++round) {
+      auto cohort = sampler.Sample(10);
+      ASSERT_EQ(cohort.size(), 10);
+      absl::flat_hash_set<std::string> distinct(cohort.begin(), cohort.end());
+      EXPECT_EQ(distinct.size(), 10);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(CohortSampler, CohortIsCappedAtRegistrySize) {
+  CohortSampler sampler(/* weighted */ true, /* seed */ 1);
+  sampler.Add("learner1", 5);
+  sampler.Add("learner2", 1);
+
+  EXPECT_THAT(sampler.Sample(5), UnorderedElementsAre("learner1", "learner2"));
+}
+
+// NOLINTNEXTLINE
+TEST(CohortSampler, RemovedLearnersAreNotSampled) {
+  for (bool weighted: {false, true}) {
+    CohortSampler sampler(weighted, /* seed */ 1);
+    for (int i = 0; i < 5; ++i) {
+      sampler.Add(absl::StrCat("learner", i + 1), 10);
+    }
+    sampler.Remove("learner1");
+    sampler.Remove("learner4");
+    sampler.Remove("learner6");
+
+    EXPECT_EQ(sampler.size(), 3);
+    EXPECT_THAT(sampler.Sample(5),
+                UnorderedElementsAre("learner2", "learner3", "learner5"));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(CohortSampler, WeightedSamplingFollowsWeights) {
+  CohortSampler sampler(/* weighted */ true, /* seed */ 1);
+  sampler.Add("learner1", 1);
+  sampler.Add("learner2", 1);
+  sampler.Add("learner3", 98);
+  sampler.Remove("learner1");
+  sampler.Add("learner1", 1);
+
+  absl::flat_hash_map<std::string, int> counts;
+  for (int round = 0; round < 1000; ++round) {
+    ++counts[sampler.Sample(1)[0]];
+  }
+  EXPECT_GT(counts["learner3"], 900);
+  EXPECT_GT(counts["learner1"] + counts["learner2"], 0);
+}
+
+} // namespace
+} // namespace metisfl::controller
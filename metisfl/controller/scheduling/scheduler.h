@@ -21,6 +21,30 @@ class Scheduler {
       const CompletedLearningTask &task,
       const std::vector<LearnerDescriptor> &active_learners) = 0;
 
+  // Returns the ids of all learners that need to be scheduled because the
+  // current round has expired. It is called periodically by the controller
+  // for schedulers that enforce a round deadline.
+  virtual std::vector<std::string> ScheduleExpired(
+      const std::vector<LearnerDescriptor> &active_learners) {
+    return {};
+  }
+
+  // Returns the ids of all learners that need to be scheduled because the
+  // set of active learners has shrunk, e.g., a learner left the federation or
+  // stopped responding, and the current round no longer awaits it.
+  virtual std::vector<std::string> ScheduleAfterDeparture(
+      const std::vector<LearnerDescriptor> &active_learners) {
+    return {};
+  }
+
+  // Restricts the learners whose tasks complete the current round to the
+  // given cohort, e.g., a sample of the active learners. Without a cohort,
+  // a round awaits all active learners.
+  virtual void SetCohort(const std::vector<std::string> &learner_ids) {}
+
+  // Adds the learner to the cohort of the current round.
+  virtual void AddToCohort(const std::string &learner_id) {}
+
   virtual std::string name() = 0;
 };
 
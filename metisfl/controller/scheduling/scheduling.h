@@ -3,6 +3,9 @@
 #define METISFL_METISFL_CONTROLLER_SCHEDULING_SCHEDULING_H_
 
 #include "metisfl/controller/scheduling/asynchronous_scheduler.h"
+#include "metisfl/controller/scheduling/buffered_asynchronous_scheduler.h"
+#include "metisfl/controller/scheduling/cohort_sampler.h"
 #include "metisfl/controller/scheduling/synchronous_scheduler.h"
+#include "metisfl/controller/scheduling/throughput_estimator.h"
 
 #endif //METISFL_METISFL_CONTROLLER_SCHEDULING_SCHEDULING_H_
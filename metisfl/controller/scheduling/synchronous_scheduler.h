@@ -2,35 +2,88 @@
 #ifndef METISFL_METISFL_CONTROLLER_SCHEDULING_SYNCHRONOUS_SCHEDULER_H_
 #define METISFL_METISFL_CONTROLLER_SCHEDULING_SYNCHRONOUS_SCHEDULER_H_
 
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <optional>
+
 #include "absl/container/flat_hash_set.h"
 #include "metisfl/controller/scheduling/scheduler.h"
 
 namespace metisfl::controller {
 
-// Implements the synchronous task scheduling policy.
+// Implements the synchronous task scheduling policy. By default, a round is
+// released once all active learners, or all active learners of the round's
+// cohort if one is set, have completed their task. Optionally,
+// a round is released as soon as a quorum of the active learners have
+// completed their task, or once the round deadline has passed, whichever
+// comes first; the learners that completed their task are scheduled for the
+// next round. The clock of a round starts when the previous round is
+// released (or, for the first round, when the first learner completes its
+// task). A learner that completes its task after its round was released is
+// carried over to the current round.
 class SynchronousScheduler : public Scheduler {
  public:
+  using Clock = std::chrono::steady_clock;
+
+  SynchronousScheduler() : SynchronousScheduler(1.0, Clock::duration::zero()) {}
+
+  // A non-positive `round_deadline` disables the deadline.
+  SynchronousScheduler(double quorum_ratio, Clock::duration round_deadline,
+                       std::function<Clock::time_point()> now = Clock::now)
+      : quorum_ratio_(quorum_ratio <= 0 || quorum_ratio > 1 ? 1 : quorum_ratio),
+        round_deadline_(round_deadline), now_(std::move(now)),
+        round_started_at_(), cohort_(), learner_ids_() {}
+
   std::vector<std::string> ScheduleNext(const std::string &learner_id,
                                         const CompletedLearningTask &task,
                                         const std::vector<LearnerDescriptor> &active_learners) override {
+    if (!round_started_at_) {
+      round_started_at_ = now_();
+    }
+
     // First, it adds the learner id to the set.
     learner_ids_.insert(learner_id);
 
-    // Second, it checks if the number of learners in the set is the same as
-    // `total_num_learners_`.
-    if (learner_ids_.size() != active_learners.size()) {
+    // Second, it checks if the number of awaited learners in the set reached
+    // the quorum.
+    if (!QuorumReached(active_learners) && !RoundExpired()) {
       // If not, then return an empty list. No need to schedule any task.
       return {};
     }
 
     // Otherwise, schedule all learners for the next task.
-    std::vector<std::string>
-        to_schedule(learner_ids_.begin(), learner_ids_.end());
+    return ReleaseRound();
+  }
 
-    // Clean the state.
-    learner_ids_.clear();
+  std::vector<std::string> ScheduleAfterDeparture(
+      const std::vector<LearnerDescriptor> &active_learners) override {
+    // The departed learner may have been the last one the round awaited.
+    if (learner_ids_.empty() || !QuorumReached(active_learners)) {
+      return {};
+    }
+    return ReleaseRound();
+  }
 
-    return to_schedule;
+  std::vector<std::string> ScheduleExpired(
+      const std::vector<LearnerDescriptor> &active_learners) override {
+    // A round without any completed task is not released, since there is
+    // nothing to aggregate.
+    if (learner_ids_.empty() || !RoundExpired()) {
+      return {};
+    }
+    return ReleaseRound();
+  }
+
+  void SetCohort(const std::vector<std::string> &learner_ids) override {
+    cohort_.emplace(learner_ids.begin(), learner_ids.end());
+  }
+
+  void AddToCohort(const std::string &learner_id) override {
+    if (!cohort_) {
+      cohort_.emplace();
+    }
+    cohort_->insert(learner_id);
   }
 
   inline std::string name() override {
@@ -38,6 +91,49 @@ class SynchronousScheduler : public Scheduler {
   }
 
  private:
+  // Learners that are no longer active are not counted.
+  bool QuorumReached(const std::vector<LearnerDescriptor> &active_learners) const {
+    size_t num_awaited = 0;
+    size_t num_completed = 0;
+    for (const auto &learner: active_learners) {
+      if (cohort_ && !cohort_->contains(learner.id())) {
+        continue;
+      }
+      ++num_awaited;
+      num_completed += learner_ids_.contains(learner.id());
+    }
+    return num_completed >= Quorum(num_awaited);
+  }
+
+  size_t Quorum(size_t num_learners) const {
+    // The epsilon guards against rounding up, e.g., 0.1 * 10 to 2. If none
+    // of the awaited learners is active, the round is released right away.
+    return static_cast<size_t>(
+        std::ceil(quorum_ratio_ * static_cast<double>(num_learners) - 1e-6));
+  }
+
+  bool RoundExpired() const {
+    return round_deadline_ > Clock::duration::zero() && round_started_at_ &&
+        now_() - *round_started_at_ >= round_deadline_;
+  }
+
+  std::vector<std::string> ReleaseRound() {
+    std::vector<std::string>
+        to_schedule(learner_ids_.begin(), learner_ids_.end());
+
+    // Clean the state and start the clock of the next round.
+    learner_ids_.clear();
+    round_started_at_ = now_();
+
+    return to_schedule;
+  }
+
+  double quorum_ratio_;
+  Clock::duration round_deadline_;
+  std::function<Clock::time_point()> now_;
+  std::optional<Clock::time_point> round_started_at_;
+  // The learners awaited in the current round, if not all active learners.
+  std::optional<::absl::flat_hash_set<std::string>> cohort_;
   // Keeps track of the learners.
   ::absl::flat_hash_set<std::string> learner_ids_;
 };
@@ -82,5 +82,100 @@ TEST(SynchronousScheduler, NoDoubleSchedule) {
   EXPECT_TRUE(res.empty());
 }
 
+// NOLINTNEXTLINE
+TEST(SynchronousScheduler, QuorumReleasesRound) {
+  SynchronousScheduler scheduler(0.5, SynchronousScheduler::Clock::duration::zero());
+  auto learners = CreateLearners(4);
+
+  auto res1 =
+      scheduler.ScheduleNext("learner1", CompletedLearningTask(), learners);
+  EXPECT_TRUE(res1.empty());
+
+  auto res2 =
+      scheduler.ScheduleNext("learner2", CompletedLearningTask(), learners);
+  EXPECT_THAT(res2, UnorderedElementsAre("learner1", "learner2"));
+
+  // The learners of the previous round are carried over to the next round.
+  auto res3 =
+      scheduler.ScheduleNext("learner3", CompletedLearningTask(), learners);
+  EXPECT_TRUE(res3.empty());
+
+  auto res4 =
+      scheduler.ScheduleNext("learner4", CompletedLearningTask(), learners);
+  EXPECT_THAT(res4, UnorderedElementsAre("learner3", "learner4"));
+}
+
+// NOLINTNEXTLINE
+TEST(SynchronousScheduler, DeadlineReleasesRound) {
+  auto now = SynchronousScheduler::Clock::time_point();
+  SynchronousScheduler scheduler(1.0, std::chrono::seconds(10),
+                                 [&now] { return now; });
+  auto learners = CreateLearners(3);
+
+  auto res1 =
+      scheduler.ScheduleNext("learner1", CompletedLearningTask(), learners);
+  EXPECT_TRUE(res1.empty());
+
+  now += std::chrono::seconds(5);
+  EXPECT_TRUE(scheduler.ScheduleExpired(learners).empty());
+
+  now += std::chrono::seconds(5);
+  EXPECT_THAT(scheduler.ScheduleExpired(learners),
+              UnorderedElementsAre("learner1"));
+
+  // A round in which no learner has completed its task is not released.
+  now += std::chrono::seconds(10);
+  EXPECT_TRUE(scheduler.ScheduleExpired(learners).empty());
+
+  // A learner completing its task after the deadline releases the round.
+  auto res2 =
+      scheduler.ScheduleNext("learner2", CompletedLearningTask(), learners);
+  EXPECT_THAT(res2, UnorderedElementsAre("learner2"));
+}
+
+// NOLINTNEXTLINE
+TEST(SynchronousScheduler, CohortReleasesRound) {
+  SynchronousScheduler scheduler;
+  auto learners = CreateLearners(5);
+
+  scheduler.AddToCohort("learner1");
+  scheduler.AddToCohort("learner2");
+  auto res1 =
+      scheduler.ScheduleNext("learner1", CompletedLearningTask(), learners);
+  EXPECT_TRUE(res1.empty());
+  auto res2 =
+      scheduler.ScheduleNext("learner2", CompletedLearningTask(), learners);
+  EXPECT_THAT(res2, UnorderedElementsAre("learner1", "learner2"));
+
+  // Learners that are not part of the cohort are carried over.
+  scheduler.SetCohort({"learner3", "learner4"});
+  auto res3 =
+      scheduler.ScheduleNext("learner5", CompletedLearningTask(), learners);
+  EXPECT_TRUE(res3.empty());
+  auto res4 =
+      scheduler.ScheduleNext("learner3", CompletedLearningTask(), learners);
+  EXPECT_TRUE(res4.empty());
+  auto res5 =
+      scheduler.ScheduleNext("learner4", CompletedLearningTask(), learners);
+  EXPECT_THAT(res5, UnorderedElementsAre("learner3", "learner4", "learner5"));
+}
+
+// NOLINTNEXTLINE
+TEST(SynchronousScheduler, DepartureReleasesRound) {
+  SynchronousScheduler scheduler;
+  auto learners = CreateLearners(3);
+
+  // Nothing is released while no task has completed.
+  EXPECT_TRUE(scheduler.ScheduleAfterDeparture(CreateLearners(2)).empty());
+
+  scheduler.ScheduleNext("learner1", CompletedLearningTask(), learners);
+  scheduler.ScheduleNext("learner2", CompletedLearningTask(), learners);
+  EXPECT_TRUE(scheduler.ScheduleAfterDeparture(learners).empty());
+
+  // learner3 departs; the round no longer awaits it.
+  auto res = scheduler.ScheduleAfterDeparture(CreateLearners(2));
+  EXPECT_THAT(res, UnorderedElementsAre("learner1", "learner2"));
+}
+
 } // namespace
 } // namespace metisfl::controller
@@ -0,0 +1,59 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_SCHEDULING_THROUGHPUT_ESTIMATOR_H_
+#define METISFL_METISFL_CONTROLLER_SCHEDULING_THROUGHPUT_ESTIMATOR_H_
+
+#include <cmath>
+
+namespace metisfl::controller {
+
+// Estimates the processing time per batch of a learner, as the exponentially
+// weighted moving average and variance of the times reported with the
+// learner's completed tasks. Recent tasks weigh more, so that the estimate
+// follows the learner if its throughput changes, e.g., due to contention.
+class ThroughputEstimator {
+ public:
+  // The weight of every new observation; the higher, the faster the
+  // estimate follows the most recent observations.
+  static constexpr double kDefaultSmoothing = 0.3;
+
+  explicit ThroughputEstimator(double smoothing = kDefaultSmoothing)
+      : smoothing_(smoothing), num_observations_(0), mean_(0), variance_(0) {}
+
+  bool empty() const { return num_observations_ == 0; }
+
+  double mean() const { return mean_; }
+
+  double stddev() const { return std::sqrt(variance_); }
+
+  // Records the processing time per batch of a completed task. Non-positive
+  // times, e.g., of a task that did not report its processing time, are
+  // ignored.
+  void Observe(double ms_per_batch) {
+    if (!(ms_per_batch > 0)) {
+      return;
+    }
+    if (num_observations_++ == 0) {
+      mean_ = ms_per_batch;
+      return;
+    }
+    auto diff = ms_per_batch - mean_;
+    auto increment = smoothing_ * diff;
+    mean_ += increment;
+    variance_ = (1 - smoothing_) * (variance_ + diff * increment);
+  }
+
+  // A conservative prediction of the processing time per batch, one standard
+  // deviation above the mean, so that the learners whose throughput varies
+  // are not assigned more work than they can complete in time.
+  double PredictedMsPerBatch() const { return mean_ + stddev(); }
+
+ private:
+  double smoothing_;
+  unsigned long num_observations_;
+  double mean_;
+  double variance_;
+};
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_SCHEDULING_THROUGHPUT_ESTIMATOR_H_
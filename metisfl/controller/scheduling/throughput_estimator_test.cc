@@ -0,0 +1,61 @@
+
+#include <gtest/gtest.h>
+
+#include "metisfl/controller/scheduling/throughput_estimator.h"
+
+namespace metisfl::controller {
+namespace {
+
+// NOLINTNEXTLINE
+TEST(ThroughputEstimator, FirstObservationIsTheEstimate) {
+  ThroughputEstimator estimator;
+  EXPECT_TRUE(estimator.empty());
+
+  estimator.Observe(10);
+  EXPECT_FALSE(estimator.empty());
+  EXPECT_DOUBLE_EQ(estimator.mean(), 10);
+  EXPECT_DOUBLE_EQ(estimator.stddev(), 0);
+  EXPECT_DOUBLE_EQ(estimator.PredictedMsPerBatch(), 10);
+}
+
+// NOLINTNEXTLINE
+TEST(ThroughputEstimator, ConstantThroughputHasNoVariance) {
+  ThroughputEstimator estimator;
+  for (int i = 0; i < 10; ++i) {
+    estimator.Observe(25);
+  }
+
+  EXPECT_DOUBLE_EQ(estimator.mean(), 25);
+  EXPECT_DOUBLE_EQ(estimator.stddev(), 0);
+}
+
+// NOLINTNEXTLINE
+TEST(ThroughputEstimator, FollowsThroughputChanges) {
+  ThroughputEstimator estimator(0.5);
+  estimator.Observe(10);
+  estimator.Observe(20);
+
+  EXPECT_DOUBLE_EQ(estimator.mean(), 15);
+  EXPECT_DOUBLE_EQ(estimator.stddev(), 5);
+  EXPECT_DOUBLE_EQ(estimator.PredictedMsPerBatch(), 20);
+
+  for (int i = 0; i < 50; ++i) {
+    estimator.Observe(20);
+  }
+  EXPECT_NEAR(estimator.mean(), 20, 1e-6);
+  EXPECT_NEAR(estimator.stddev(), 0, 1e-6);
+}
+
+// NOLINTNEXTLINE
+TEST(ThroughputEstimator, IgnoresMissingTimes) {
+  ThroughputEstimator estimator;
+  estimator.Observe(0);
+  EXPECT_TRUE(estimator.empty());
+
+  estimator.Observe(10);
+  estimator.Observe(-1);
+  EXPECT_DOUBLE_EQ(estimator.mean(), 10);
+}
+
+} // namespace
+} // namespace metisfl::controller
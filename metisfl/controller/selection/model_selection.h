@@ -3,5 +3,6 @@
 #define METISFL_METISFL_CONTROLLER_SELECTION_MODEL_SELECTION_H_
 
 #include "metisfl/controller/selection/scheduled_cardinality.h"
+#include "metisfl/controller/selection/speed_aware_selector.h"
 
 #endif //METISFL_METISFL_CONTROLLER_SELECTION_MODEL_SELECTION_H_
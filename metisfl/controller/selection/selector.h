@@ -19,6 +19,16 @@ class Selector {
       const std::vector<std::string> &scheduled_learners,
       const std::vector<LearnerDescriptor> &active_learners) = 0;
 
+  // Notifies the selector of the learners that join (or return to) and leave
+  // the federation, and of the round-trip time of every task they complete,
+  // i.e., the time from the task's submission until its completion is
+  // received. Selectors that rank the learners keep track of them through
+  // these notifications, rather than visiting all learners on every round.
+  virtual void AddLearner(const std::string &learner_id) {}
+  virtual void RemoveLearner(const std::string &learner_id) {}
+  virtual void RecordRoundTrip(const std::string &learner_id,
+                               double round_trip_ms) {}
+
   virtual std::string name() = 0;
 };
 
@@ -0,0 +1,160 @@
+
+#ifndef METISFL_METISFL_CONTROLLER_SELECTION_SPEED_AWARE_SELECTOR_H_
+#define METISFL_METISFL_CONTROLLER_SELECTION_SPEED_AWARE_SELECTOR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "metisfl/controller/selection/selector.h"
+
+namespace metisfl::controller {
+
+// A selector that picks the cohort of every round: the learners with the
+// lowest (smoothed) round-trip time, so that rounds do not wait for the
+// slowest learners. To not bias the community model towards the fastest
+// learners, every learner participates in at least `min_participation_rate`
+// of the rounds since it joined; the learners that fall behind that rate are
+// selected first, the most overdue first.
+//
+// The learners are kept in two ordered indices, one by round-trip time and
+// one by the round at which they become overdue, which are updated as the
+// learners join, leave, complete tasks and get selected. Hence, a cohort of
+// k learners is selected in O(k log n) time, without sorting all n learners
+// on every round. Learners whose round-trip time is unknown rank first, so
+// that their time gets measured. The selector is not thread-safe.
+class SpeedAwareSelector : public Selector {
+ public:
+  // The weight of every new round-trip time of a learner.
+  static constexpr double kRoundTripSmoothing = 0.3;
+
+  SpeedAwareSelector(double participation_ratio, double min_participation_rate)
+      : participation_ratio_(participation_ratio <= 0 || participation_ratio > 1
+                             ? 1 : participation_ratio),
+        min_participation_rate_(std::clamp(min_participation_rate, 0.0, 1.0)),
+        round_(0), learners_(), by_round_trip_(), by_due_round_() {}
+
+  // Returns the cohort of the next round. The scheduled and active learners
+  // are not considered, since the selector tracks the learners itself.
+  std::vector<std::string> Select(
+      const std::vector<std::string> &scheduled_learners,
+      const std::vector<LearnerDescriptor> &active_learners) override {
+
+    ++round_;
+    auto cohort_size = CohortSize(learners_.size());
+    std::vector<std::string> cohort;
+    cohort.reserve(cohort_size);
+    absl::flat_hash_set<std::string> selected;
+
+    for (auto it = by_due_round_.begin(); it != by_due_round_.end() &&
+        it->first <= round_ && cohort.size() < cohort_size; ++it) {
+      cohort.push_back(it->second);
+      selected.insert(it->second);
+    }
+    for (auto it = by_round_trip_.begin();
+         it != by_round_trip_.end() && cohort.size() < cohort_size; ++it) {
+      if (!selected.contains(it->second)) {
+        cohort.push_back(it->second);
+      }
+    }
+
+    for (const auto &learner_id: cohort) {
+      auto &learner = learners_[learner_id];
+      ++learner.participations;
+      Reindex(learner_id, &learner);
+    }
+    return cohort;
+
+  }
+
+  void AddLearner(const std::string &learner_id) override {
+    if (learners_.contains(learner_id)) {
+      return;
+    }
+    auto &learner = learners_[learner_id];
+    learner.joined_round = round_;
+    by_round_trip_.emplace(learner.round_trip_ms, learner_id);
+    learner.due_round = DueRound(learner);
+    by_due_round_.emplace(learner.due_round, learner_id);
+  }
+
+  void RemoveLearner(const std::string &learner_id) override {
+    auto it = learners_.find(learner_id);
+    if (it == learners_.end()) {
+      return;
+    }
+    by_round_trip_.erase({it->second.round_trip_ms, learner_id});
+    by_due_round_.erase({it->second.due_round, learner_id});
+    learners_.erase(it);
+  }
+
+  void RecordRoundTrip(const std::string &learner_id,
+                       double round_trip_ms) override {
+    auto it = learners_.find(learner_id);
+    if (it == learners_.end() || !(round_trip_ms > 0)) {
+      return;
+    }
+    auto &learner = it->second;
+    by_round_trip_.erase({learner.round_trip_ms, learner_id});
+    learner.round_trip_ms = learner.round_trip_ms == 0
+        ? round_trip_ms
+        : learner.round_trip_ms +
+            kRoundTripSmoothing * (round_trip_ms - learner.round_trip_ms);
+    by_round_trip_.emplace(learner.round_trip_ms, learner_id);
+  }
+
+  std::string name() override {
+    return "SpeedAwareSelector";
+  }
+
+ private:
+  struct Learner {
+    // Zero, while the round-trip time of the learner is unknown.
+    double round_trip_ms = 0;
+    uint64_t joined_round = 0;
+    uint64_t participations = 0;
+    uint64_t due_round = 0;
+  };
+
+  size_t CohortSize(size_t num_learners) const {
+    // The epsilon guards against rounding up, e.g., 0.1 * 10 to 2.
+    auto cohort_size = static_cast<size_t>(std::ceil(
+        participation_ratio_ * static_cast<double>(num_learners) - 1e-6));
+    return std::min(std::max<size_t>(cohort_size, 1), num_learners);
+  }
+
+  // The first round r in which the learner falls behind the minimum
+  // participation rate, i.e., participations < rate * (r - joined_round).
+  uint64_t DueRound(const Learner &learner) const {
+    if (min_participation_rate_ <= 0) {
+      return UINT64_MAX;
+    }
+    return learner.joined_round + 1 + static_cast<uint64_t>(std::floor(
+        static_cast<double>(learner.participations) / min_participation_rate_
+            + 1e-6));
+  }
+
+  void Reindex(const std::string &learner_id, Learner *learner) {
+    by_due_round_.erase({learner->due_round, learner_id});
+    learner->due_round = DueRound(*learner);
+    by_due_round_.emplace(learner->due_round, learner_id);
+  }
+
+  double participation_ratio_;
+  double min_participation_rate_;
+  // The number of cohorts selected so far.
+  uint64_t round_;
+  absl::flat_hash_map<std::string, Learner> learners_;
+  std::set<std::pair<double, std::string>> by_round_trip_;
+  std::set<std::pair<uint64_t, std::string>> by_due_round_;
+};
+
+} // namespace metisfl::controller
+
+#endif //METISFL_METISFL_CONTROLLER_SELECTION_SPEED_AWARE_SELECTOR_H_
@@ -0,0 +1,101 @@
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "metisfl/controller/selection/speed_aware_selector.h"
+
+namespace metisfl::controller {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+// Adds n learners, whose round-trip time increases with their index, and
+// runs the initial round on all of them.
+void AddLearners(SpeedAwareSelector *selector, int n) {
+  for (int i = 0; i < n; ++i) {
+    selector->AddLearner(absl::StrCat("learner", i + 1));
+  }
+  for (int i = 0; i < n; ++i) {
+    selector->RecordRoundTrip(absl::StrCat("learner", i + 1), 100 * (i + 1));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(SpeedAwareSelector, SelectsFastestLearners) {
+  SpeedAwareSelector selector(/* participation_ratio */ 0.4,
+                              /* min_participation_rate */ 0);
+  AddLearners(&selector, 5);
+
+  for (int round = 0; round < 5; ++round) {
+    EXPECT_THAT(selector.Select({}, {}),
+                UnorderedElementsAre("learner1", "learner2"));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(SpeedAwareSelector, FollowsRoundTripChanges) {
+  SpeedAwareSelector selector(/* participation_ratio */ 0.2,
+                              /* min_participation_rate */ 0);
+  AddLearners(&selector, 5);
+  EXPECT_THAT(selector.Select({}, {}), UnorderedElementsAre("learner1"));
+
+  for (int i = 0; i < 10; ++i) {
+    selector.RecordRoundTrip("learner1", 1000);
+  }
+  EXPECT_THAT(selector.Select({}, {}), UnorderedElementsAre("learner2"));
+}
+
+// NOLINTNEXTLINE
+TEST(SpeedAwareSelector, NewLearnersAreSelectedFirst) {
+  SpeedAwareSelector selector(/* participation_ratio */ 0.5,
+                              /* min_participation_rate */ 0);
+  AddLearners(&selector, 3);
+  selector.AddLearner("learner4");
+
+  EXPECT_THAT(selector.Select({}, {}),
+              UnorderedElementsAre("learner4", "learner1"));
+}
+
+// NOLINTNEXTLINE
+TEST(SpeedAwareSelector, EnforcesMinimumParticipationRate) {
+  SpeedAwareSelector selector(/* participation_ratio */ 0.2,
+                              /* min_participation_rate */ 0.1);
+  AddLearners(&selector, 5);
+
+  absl::flat_hash_map<std::string, int> participations;
+  const int num_rounds = 100;
+  for (int round = 0; round < num_rounds; ++round) {
+    for (const auto &learner_id: selector.Select({}, {})) {
+      ++participations[learner_id];
+    }
+  }
+  for (int i = 0; i < 5; ++i) {
+    auto learner_id = absl::StrCat("learner", i + 1);
+    EXPECT_GE(participations[learner_id], num_rounds / 10) << learner_id;
+  }
+  // The rounds left by the participation guarantees go to the fastest.
+  EXPECT_GT(participations["learner1"], participations["learner5"]);
+}
+
+// NOLINTNEXTLINE
+TEST(SpeedAwareSelector, RemovedLearnersAreNotSelected) {
+  SpeedAwareSelector selector(/* participation_ratio */ 1,
+                              /* min_participation_rate */ 0.5);
+  AddLearners(&selector, 3);
+  selector.RemoveLearner("learner2");
+  selector.RemoveLearner("learner4");
+
+  EXPECT_THAT(selector.Select({}, {}),
+              UnorderedElementsAre("learner1", "learner3"));
+  selector.RemoveLearner("learner1");
+  selector.RemoveLearner("learner3");
+  EXPECT_THAT(selector.Select({}, {}), IsEmpty());
+}
+
+} // namespace
+} // namespace metisfl::controller
@@ -3,6 +3,8 @@
 #include "metisfl/proto/metis.pb.h"
 #include "metisfl/proto/model.pb.h"
 
+#include <algorithm>
+
 namespace metisfl::controller {
 
 HashMapModelStore::HashMapModelStore(const InMemoryStore &config) : ModelStore(config.model_store_specs()) {
@@ -11,13 +13,43 @@ HashMapModelStore::HashMapModelStore(const InMemoryStore &config) : ModelStore(c
 
 void HashMapModelStore::Expunge() {
   // This will clear all
-  m_model_store_cache.clear();
+  std::unique_lock<std::shared_mutex> shards_guard(m_learner_shards_mutex);
+  for (auto &[learner_id, shard]: m_learner_shards) {
+    std::lock_guard<std::mutex> shard_guard(shard->mutex);
+    shard->erased = true;
+  }
+  m_learner_shards.clear();
+  for (auto &stripe: m_tensor_blob_stripes) {
+    std::lock_guard<std::mutex> stripe_guard(stripe.mutex);
+    stripe.blobs.clear();
+  }
+  m_resident_bytes = 0;
+  ReleaseSelectedModels();
 }
 
 void HashMapModelStore::EraseModels(const std::vector<std::string> &learner_ids) {
 
   for (auto &learner_id: learner_ids) {
-    m_model_store_cache[learner_id].clear();
+    // The shard is removed along with the models, so that the learners
+    // which left the federation do not leave an empty shard behind.
+    std::shared_ptr<LearnerShard> shard;
+    {
+      std::unique_lock<std::shared_mutex> shards_guard(m_learner_shards_mutex);
+      auto itr = m_learner_shards.find(learner_id);
+      if (itr == m_learner_shards.end()) continue;
+      shard = std::move(itr->second);
+      m_learner_shards.erase(itr);
+    }
+    std::vector<StoredModel> erased_lineage;
+    {
+      std::lock_guard<std::mutex> shard_guard(shard->mutex);
+      shard->erased = true;
+      erased_lineage.swap(shard->lineage);
+    }
+    for (const auto &stored_model: erased_lineage) {
+      ReleaseTensorBlobs(stored_model.model);
+    }
+    // The models restored by SelectModels() are released on ResetState().
   }
 }
 
@@ -30,7 +62,10 @@ int HashMapModelStore::GetConfiguredLineageLength() {
 }
 
 int HashMapModelStore::GetLearnerLineageLength(std::string learner_id) {
-  return (int) m_model_store_cache[learner_id].size();
+  auto shard = FindLearnerShard(learner_id);
+  if (!shard) return 0;
+  std::lock_guard<std::mutex> shard_guard(shard->mutex);
+  return (int) shard->lineage.size();
 }
 
 void HashMapModelStore::InsertModel(std::vector<std::pair<std::string, Model>> learner_pairs) {
@@ -47,32 +82,100 @@ void HashMapModelStore::InsertModel(std::vector<std::pair<std::string, Model>> l
   for (auto &learner_pair: learner_pairs) {
 
     std::string learner_id = learner_pair.first;
-    auto model = learner_pair.second;
+    auto model = std::move(learner_pair.second);
+
+    // Hashing (and compressing) the tensor values is the expensive part
+    // of the insertion and does not need the learner's shard lock.
+    AcquireTensorBlobs(&model);
+    CommitModel(learner_id, std::move(model));
+
+  }
+
+}
+
+class HashMapModelStore::StreamingModelWriter : public ModelStore::ModelWriter {
+ public:
+  StreamingModelWriter(HashMapModelStore *model_store, std::string learner_id)
+      : model_store_(model_store), learner_id_(std::move(learner_id)) {}
+
+  ~StreamingModelWriter() override {
+    if (committed_) return;
+    for (const auto &variable: model_.variables()) {
+      model_store_->ReleaseTensorBlob(GetTensorDigest(variable));
+    }
+  }
+
+  void AppendVariable(Model_Variable &&variable) override {
+    auto *appended = model_.add_variables();
+    *appended = std::move(variable);
+    auto detached = DetachTensorValue(appended);
+    model_store_->AcquireTensorBlob(&detached);
+    MutableTensorSpec(appended)->set_value(detached.digest.ToBytes());
+  }
+
+  void Commit() override {
+    committed_ = true;
+    // The model structure (names, specs and digests) is resident as well.
+    model_store_->m_resident_bytes += (int64_t) model_.ByteSizeLong();
+    model_store_->CommitModel(learner_id_, std::move(model_));
+  }
+
+ private:
+  HashMapModelStore *model_store_;
+  std::string learner_id_;
+  Model model_;
+  bool committed_ = false;
+};
+
+std::unique_ptr<ModelStore::ModelWriter>
+HashMapModelStore::NewModelWriter(const std::string &learner_id) {
+  return std::make_unique<StreamingModelWriter>(this, learner_id);
+}
+
+void HashMapModelStore::CommitModel(const std::string &learner_id, Model &&model) {
+
+  StoredModel stored_model;
+  stored_model.inserted_at = stored_model.accessed_at = ++m_clock;
+  stored_model.model = std::move(model);
+
+  std::vector<StoredModel> evicted_models;
+  for (;;) {
+    auto shard = GetLearnerShard(learner_id);
+    std::lock_guard<std::mutex> shard_guard(shard->mutex);
+    // The learner was erased after its shard was looked up; the model
+    // starts the lineage of a new shard instead.
+    if (shard->erased) continue;
 
     // This is only applicable on the k-Recent-Models policy.
-    if (m_model_store_specs.has_lineage_length_eviction()) {
-      // Check to see is learner_id is present in collection
-      if ((m_model_store_cache.find(learner_id) != m_model_store_cache.end())) {
-        // Yes, learner_id is present in collection.
-        // Check if the model being inserted is greater than max length.
-        if (m_model_store_cache[learner_id].size() >=
-              m_model_store_specs.lineage_length_eviction().lineage_length()) {
-          auto itr_first_elem = m_model_store_cache[learner_id].begin();
-          PLOG(INFO) << "Reached max limit. Erasing oldest model.";
-          m_model_store_cache[learner_id].erase(itr_first_elem);
-        }
-      }
+    // Check if the model being inserted is greater than max length.
+    if (m_model_store_specs.has_lineage_length_eviction() &&
+        shard->lineage.size() >=
+            m_model_store_specs.lineage_length_eviction().lineage_length()) {
+      auto itr_first_elem = shard->lineage.begin();
+      PLOG(INFO) << "Reached max limit. Erasing oldest model.";
+      evicted_models.push_back(std::move(*itr_first_elem));
+      shard->lineage.erase(itr_first_elem);
     }
-    
+
     PLOG(INFO) << "Inserting model in learner_id: " << learner_id;
-    m_model_store_cache[learner_id].push_back(model);
+    shard->lineage.push_back(std::move(stored_model));
+    break;
+  }
+
+  for (const auto &evicted_model: evicted_models) {
+    ReleaseTensorBlobs(evicted_model.model);
+  }
 
+  if (ExceedsByteBudget(GetResidentBytes())) {
+    EvictToByteBudget();
   }
 
 }
 
 void HashMapModelStore::ResetState() {
-  // Do nothing. We do not need to clear the In-Memory store of its state.
+  // The stored lineage is kept; only the models that were selected by
+  // SelectModels(), and the tensor blobs they pin, are released.
+  ReleaseSelectedModels();
 }
 
 std::map<std::string, std::vector<const Model*>>
@@ -88,28 +191,53 @@ HashMapModelStore::SelectModels(std::vector<std::pair<std::string, int>> learner
 
     std::string learner_id = learner_pair.first;
     int index = learner_pair.second; // The number of models to select from store.
-    int history_size = GetLearnerLineageLength(learner_id);
 
     PLOG(INFO) << "Select models for learner_id: " << learner_id << " index: " << index;
 
-    // Check if index is less than size of lineage
-    // return empty models.
-    if (index > m_model_store_cache[learner_id].size()) {
-      PLOG(WARNING) << "Index larger than lineage size";
-      reply_models[learner_id].clear();
-      continue;
-    }
+    // Copy the selected models, whose tensor values are replaced by their
+    // digests, and take a reference to their tensor blobs while holding the
+    // learner's shard, so that neither the models nor their blobs can be
+    // evicted meanwhile. Inserts of all other learners proceed concurrently.
+    std::vector<std::pair<Model, std::vector<std::shared_ptr<const std::string>>>> selected_models;
+    {
+      auto shard = FindLearnerShard(learner_id);
+      std::unique_lock<std::mutex> shard_guard;
+      if (shard) {
+        shard_guard = std::unique_lock<std::mutex>(shard->mutex);
+      }
+      int history_size = shard ? (int) shard->lineage.size() : 0;
 
-    // If non-positive (x <= 0): reply all models
-    if (index <= 0) {
-      // This will return pointer to all the models stored against learner_id.
-      index = history_size;
+      // Check if index is less than size of lineage
+      // return empty models.
+      if (index > history_size) {
+        PLOG(WARNING) << "Index larger than lineage size";
+        reply_models[learner_id].clear();
+        continue;
+      }
+
+      // If non-positive (x <= 0): reply all models
+      if (index <= 0) {
+        // This will return pointer to all the models stored against learner_id.
+        index = history_size;
+      }
+
+      // If (x>0) reply current and num-1 latest runtime metadata.
+      selected_models.reserve(index);
+      auto accessed_at = ++m_clock;
+      for (auto hidx = index; hidx > 0; hidx--) {
+        auto &stored_model = shard->lineage[history_size - hidx];
+        stored_model.accessed_at = accessed_at;
+        selected_models.emplace_back(stored_model.model, GetTensorBlobs(stored_model.model));
+      }
     }
 
-    // If (x>0) reply current and num-1 latest runtime metadata.
-    for (auto hidx = index; hidx > 0; hidx--) {
-      const Model *ptr_latest_model = &m_model_store_cache[learner_id][history_size - hidx];
-      reply_models[learner_id].push_back(ptr_latest_model);
+    // Keep the selected models in the ephemeral cache; the returned
+    // pointers remain valid until ResetState() is called. The models of a
+    // previous selection of the same learner are appended to, never
+    // replaced, since they might still be aggregated.
+    for (auto &[selected_model, blobs]: selected_models) {
+      reply_models[learner_id].push_back(
+          KeepSelectedModel(learner_id, std::move(selected_model), std::move(blobs)));
     }
 
   }
@@ -120,4 +248,202 @@ HashMapModelStore::SelectModels(std::vector<std::pair<std::string, int>> learner
 
 void HashMapModelStore::Shutdown() {}
 
+size_t HashMapModelStore::GetResidentBytes() {
+  auto resident_bytes = m_resident_bytes.load();
+  return resident_bytes > 0 ? (size_t) resident_bytes : 0;
+}
+
+size_t HashMapModelStore::GetNumTensorBlobs() {
+  size_t num_blobs = 0;
+  for (auto &stripe: m_tensor_blob_stripes) {
+    std::lock_guard<std::mutex> stripe_guard(stripe.mutex);
+    num_blobs += stripe.blobs.size();
+  }
+  return num_blobs;
+}
+
+size_t HashMapModelStore::GetNumLearnerLineages() {
+  std::shared_lock<std::shared_mutex> shards_guard(m_learner_shards_mutex);
+  return m_learner_shards.size();
+}
+
+std::shared_ptr<HashMapModelStore::LearnerShard>
+HashMapModelStore::GetLearnerShard(const std::string &learner_id) {
+  if (auto shard = FindLearnerShard(learner_id)) {
+    return shard;
+  }
+  std::unique_lock<std::shared_mutex> shards_guard(m_learner_shards_mutex);
+  auto &shard = m_learner_shards[learner_id];
+  if (!shard) {
+    shard = std::make_shared<LearnerShard>();
+  }
+  return shard;
+}
+
+std::shared_ptr<HashMapModelStore::LearnerShard>
+HashMapModelStore::FindLearnerShard(const std::string &learner_id) {
+  std::shared_lock<std::shared_mutex> shards_guard(m_learner_shards_mutex);
+  auto itr = m_learner_shards.find(learner_id);
+  return itr != m_learner_shards.end() ? itr->second : nullptr;
+}
+
+HashMapModelStore::TensorBlobStripe &
+HashMapModelStore::GetTensorBlobStripe(const TensorDigest &digest) {
+  return m_tensor_blob_stripes[digest.low % kNumTensorBlobStripes];
+}
+
+void HashMapModelStore::AcquireTensorBlobs(Model *model) {
+  auto detached_values = DetachTensorValues(model);
+  // The model structure (names, specs and digests) is resident as well.
+  m_resident_bytes += (int64_t) model->ByteSizeLong();
+  for (int index = 0; index < (int) detached_values.size(); ++index) {
+    auto &detached = detached_values[index];
+    AcquireTensorBlob(&detached);
+    MutableTensorSpec(model->mutable_variables(index))->set_value(detached.digest.ToBytes());
+  }
+}
+
+void HashMapModelStore::AcquireTensorBlob(DetachedTensorValue *detached) {
+  // A blob is shared only if it holds the same value, and a different value
+  // with the same digest is stored under a probe of the digest. The probes
+  // keep the low half of the digest, hence they fall in the same stripe.
+  // Both the comparison and the encoding of a new value take place outside
+  // of the stripe lock, therefore the blob is looked up again afterwards.
+  // Once encoded, the value is compared in its encoded form, which is
+  // deterministic.
+  auto &stripe = GetTensorBlobStripe(detached->digest);
+  std::shared_ptr<const std::string> value;
+  std::shared_ptr<const std::string> matched;
+  while (true) {
+    std::shared_ptr<const std::string> candidate;
+    {
+      std::lock_guard<std::mutex> stripe_guard(stripe.mutex);
+      auto itr = stripe.blobs.find(detached->digest);
+      if (itr == stripe.blobs.end()) {
+        if (value) {
+          auto &blob = stripe.blobs[detached->digest];
+          m_resident_bytes += (int64_t) value->size();
+          blob.value = std::move(value);
+          blob.ref_count = 1;
+          return;
+        }
+      } else if (itr->second.value == matched) {
+        ++itr->second.ref_count;
+        return;
+      } else {
+        candidate = itr->second.value;
+      }
+    }
+    if (!candidate) {
+      value = std::make_shared<const std::string>(EncodeTensorBlob(detached));
+    } else if (value ? *candidate == *value
+                     : MatchesTensorBlob(*candidate, detached->value)) {
+      matched = std::move(candidate);
+    } else {
+      detached->digest = ProbeTensorDigest(detached->digest);
+    }
+  }
+}
+
+void HashMapModelStore::ReleaseTensorBlobs(const Model &model) {
+  m_resident_bytes -= (int64_t) model.ByteSizeLong();
+  for (const auto &variable: model.variables()) {
+    ReleaseTensorBlob(GetTensorDigest(variable));
+  }
+}
+
+void HashMapModelStore::ReleaseTensorBlob(const TensorDigest &digest) {
+  auto &stripe = GetTensorBlobStripe(digest);
+  std::lock_guard<std::mutex> stripe_guard(stripe.mutex);
+  auto itr = stripe.blobs.find(digest);
+  if (itr != stripe.blobs.end() && --itr->second.ref_count == 0) {
+    m_resident_bytes -= (int64_t) itr->second.value->size();
+    stripe.blobs.erase(itr);
+  }
+}
+
+std::vector<std::shared_ptr<const std::string>>
+HashMapModelStore::GetTensorBlobs(const Model &model) {
+  std::vector<std::shared_ptr<const std::string>> blobs;
+  blobs.reserve(model.variables_size());
+  for (const auto &variable: model.variables()) {
+    auto digest = GetTensorDigest(variable);
+    auto &stripe = GetTensorBlobStripe(digest);
+    std::lock_guard<std::mutex> stripe_guard(stripe.mutex);
+    auto itr = stripe.blobs.find(digest);
+    blobs.push_back(itr != stripe.blobs.end() ? itr->second.value : nullptr);
+  }
+  return blobs;
+}
+
+void HashMapModelStore::EvictToByteBudget() {
+
+  std::lock_guard<std::mutex> eviction_guard(m_eviction_mutex);
+  if (!ExceedsByteBudget(GetResidentBytes())) {
+    return;
+  }
+
+  // Collect the models that can be evicted, i.e., all but the protected
+  // most recent models of every learner, and order them by eviction order.
+  struct EvictionCandidate {
+    uint64_t order_tick;
+    uint64_t inserted_at;
+    std::shared_ptr<LearnerShard> shard;
+  };
+  bool lru_order = m_model_store_specs.byte_budget_eviction().order() ==
+      ByteBudgetEviction_Order_LEAST_RECENTLY_USED;
+  size_t protected_length = m_protected_lineage_length;
+
+  std::vector<EvictionCandidate> candidates;
+  {
+    std::shared_lock<std::shared_mutex> shards_guard(m_learner_shards_mutex);
+    for (auto &[learner_id, shard]: m_learner_shards) {
+      std::lock_guard<std::mutex> shard_guard(shard->mutex);
+      if (shard->lineage.size() <= protected_length) continue;
+      auto num_evictable = shard->lineage.size() - protected_length;
+      for (size_t idx = 0; idx < num_evictable; ++idx) {
+        const auto &stored_model = shard->lineage[idx];
+        candidates.push_back(
+            {lru_order ? stored_model.accessed_at : stored_model.inserted_at,
+             stored_model.inserted_at, shard});
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const auto &a, const auto &b) { return a.order_tick < b.order_tick; });
+
+  // Evict one model at a time, since deduplicated tensors are freed only
+  // once their last reference is gone. A candidate is re-validated under
+  // its shard lock, because learners might have inserted models meanwhile.
+  // The candidates keep their shards alive; the lineage of a shard that
+  // was erased meanwhile is empty, hence its candidates are skipped.
+  int num_evicted = 0;
+  for (const auto &candidate: candidates) {
+    if (!ExceedsByteBudget(GetResidentBytes())) break;
+    StoredModel evicted_model;
+    {
+      std::lock_guard<std::mutex> shard_guard(candidate.shard->mutex);
+      auto &lineage = candidate.shard->lineage;
+      auto itr = std::find_if(lineage.begin(), lineage.end(), [&](const auto &stored_model) {
+        return stored_model.inserted_at == candidate.inserted_at;
+      });
+      if (itr == lineage.end() ||
+          (size_t) std::distance(itr, lineage.end()) <= protected_length) {
+        continue;
+      }
+      evicted_model = std::move(*itr);
+      lineage.erase(itr);
+    }
+    ReleaseTensorBlobs(evicted_model.model);
+    ++num_evicted;
+  }
+
+  PLOG(INFO) << "Evicted " << num_evicted << " models to fit the byte budget.";
+  if (ExceedsByteBudget(GetResidentBytes())) {
+    PLOG(WARNING) << "The models required for aggregation (" << GetResidentBytes()
+                  << " bytes) exceed the byte budget.";
+  }
+
+}
+
 }
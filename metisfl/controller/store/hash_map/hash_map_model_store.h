@@ -2,11 +2,25 @@
 #ifndef METISFL_METISFL_CONTROLLER_STORE_HASH_MAP_HASH_MAP_MODEL_STORE_H_
 #define METISFL_METISFL_CONTROLLER_STORE_HASH_MAP_HASH_MAP_MODEL_STORE_H_
 
+#include <array>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+#include "absl/container/flat_hash_map.h"
+#include "metisfl/controller/common/tensor_digest.h"
 #include "metisfl/controller/store/model_store.h"
 #include "metisfl/proto/model.pb.h"
 
 namespace metisfl::controller {
 
+// The in-memory store is safe to use concurrently. The lineage of every
+// learner is guarded by its own lock (shard), and the shared tensor blobs
+// by a fixed number of lock stripes, so models of different learners are
+// inserted in parallel. SelectModels() copies the structure of the selected
+// models and references their tensor blobs, which are immutable, hence
+// aggregation over the returned models is not affected by models that are
+// inserted or evicted in the meantime.
 class HashMapModelStore : public ModelStore {
  public:
   // Cannot be initialized without an external store referenced by ref_learners. 
@@ -17,6 +31,7 @@ class HashMapModelStore : public ModelStore {
   int GetConfiguredLineageLength() override;
   int GetLearnerLineageLength(std::string learner_id) override;
   void InsertModel(std::vector<std::pair<std::string, Model>> learner_pairs) override;
+  std::unique_ptr<ModelWriter> NewModelWriter(const std::string &learner_id) override;
   void ResetState() override;
   
   std::map<std::string, std::vector<const Model*>>
@@ -27,6 +42,87 @@ class HashMapModelStore : public ModelStore {
     return "HashMapModelStore";
   }
 
+  size_t GetResidentBytes() override;
+
+  // Number of distinct tensor values currently held by the store.
+  size_t GetNumTensorBlobs();
+  // Number of learners whose lineage is held by the store.
+  size_t GetNumLearnerLineages();
+
+ private:
+  // A tensor value shared by all the stored variables with the same digest.
+  // The value is kept compressed if tensor compression is enabled.
+  struct TensorBlob {
+    std::shared_ptr<const std::string> value;
+    uint32_t ref_count = 0;
+  };
+
+  struct TensorBlobStripe {
+    std::mutex mutex;
+    absl::flat_hash_map<TensorDigest, TensorBlob> blobs;
+  };
+
+  // A model with every tensor value replaced by its digest. The values
+  // themselves live in the blob stripes. The insertion tick identifies
+  // the model; the access tick is updated whenever the model is selected.
+  struct StoredModel {
+    Model model;
+    uint64_t inserted_at = 0;
+    uint64_t accessed_at = 0;
+  };
+
+  // Models of a learner in committed order. A shard that is erased is
+  // no longer reachable from the store, but can still be held by callers
+  // that looked it up before; they must not commit models to it.
+  struct LearnerShard {
+    std::mutex mutex;
+    std::vector<StoredModel> lineage;
+    bool erased = false;
+  };
+
+  // Acquires the tensor blob of every variable as soon as it is appended,
+  // hence the raw tensor values are not kept until the model is committed.
+  class StreamingModelWriter;
+
+  static constexpr size_t kNumTensorBlobStripes = 32;
+
+  // Returns the shard of the learner, creating it if it does not exist.
+  std::shared_ptr<LearnerShard> GetLearnerShard(const std::string &learner_id);
+  // Returns the shard of the learner, or nullptr if it does not exist.
+  std::shared_ptr<LearnerShard> FindLearnerShard(const std::string &learner_id);
+  TensorBlobStripe &GetTensorBlobStripe(const TensorDigest &digest);
+
+  void AcquireTensorBlobs(Model *model);
+  // References the blob that holds the detached value, storing the value if
+  // there is none. The digest is updated to the key of the blob, which
+  // differs from the value's digest if another value has the same digest.
+  void AcquireTensorBlob(DetachedTensorValue *detached);
+  void ReleaseTensorBlobs(const Model &model);
+  void ReleaseTensorBlob(const TensorDigest &digest);
+
+  // Appends a model, whose tensor blobs are already acquired, to the
+  // lineage of the learner and applies the eviction policies.
+  void CommitModel(const std::string &learner_id, Model &&model);
+  // Returns the tensor blob of every variable of a stored model.
+  std::vector<std::shared_ptr<const std::string>> GetTensorBlobs(const Model &model);
+
+  // Evicts models across all learners, in the configured order, until the
+  // resident bytes are within the byte budget. The most recent (protected)
+  // models of every learner are never evicted.
+  void EvictToByteBudget();
+
+  // Guards the learner to shard mapping, not the shards themselves.
+  std::shared_mutex m_learner_shards_mutex;
+  std::map<std::string, std::shared_ptr<LearnerShard>> m_learner_shards;
+
+  std::array<TensorBlobStripe, kNumTensorBlobStripes> m_tensor_blob_stripes;
+
+  // Logical clock for the insertion and access order of the models.
+  std::atomic<uint64_t> m_clock{0};
+  std::atomic<int64_t> m_resident_bytes{0};
+  // Only one thread evicts at a time.
+  std::mutex m_eviction_mutex;
+
 };
 
 }
@@ -1,8 +1,11 @@
 
 #include "metisfl/controller/store/model_store.h"
+#include "metisfl/controller/common/tensor_compression.h"
 #include "metisfl/proto/metis.pb.h"
 #include "metisfl/proto/model.pb.h"
 
+#include <algorithm>
+
 namespace metisfl::controller {
 
 ModelStore::ModelStore(const metisfl::ModelStoreSpecs &specs) {
@@ -21,9 +24,188 @@ ModelStore::ModelStore(const metisfl::ModelStoreSpecs &specs) {
       PLOG(WARNING) << "The model_cache_size field is not defined, using size of 1.";
       m_model_store_specs.mutable_lineage_length_eviction()->set_lineage_length(1);
     }
+  } else if (specs.has_byte_budget_eviction()) {
+    PLOG(INFO) << "The BYTE_BUDGET policy is set with a budget of "
+               << specs.byte_budget_eviction().max_resident_bytes() << " bytes and "
+               << ByteBudgetEviction_Order_Name(specs.byte_budget_eviction().order())
+               << " eviction order.";
+    *m_model_store_specs.mutable_byte_budget_eviction() = specs.byte_budget_eviction();
+    if (specs.byte_budget_eviction().max_resident_bytes() == 0) {
+      PLOG(WARNING) << "The max_resident_bytes field is not defined, only the models "
+                       "required for aggregation will be kept.";
+    }
   } else {
     PLOG(ERROR) << "Unknown model eviction policy.";
   }
+
+  *m_model_store_specs.mutable_tensor_compression() = specs.tensor_compression();
+  if (specs.tensor_compression().codec() != TensorCompression_Codec_NONE) {
+    auto level = specs.tensor_compression().level();
+    if (level > kMaxDeflateLevel) {
+      PLOG(WARNING) << "The tensor compression level " << level << " is outside of ["
+                    << kMinDeflateLevel << ", " << kMaxDeflateLevel << "], using level "
+                    << kMaxDeflateLevel << ".";
+      m_model_store_specs.mutable_tensor_compression()->set_level(kMaxDeflateLevel);
+    }
+    PLOG(INFO) << "Tensor compression is enabled: "
+               << TensorCompression_Codec_Name(specs.tensor_compression().codec())
+               << " at level " << std::max(m_model_store_specs.tensor_compression().level(),
+                                           kMinDeflateLevel) << ".";
+  }
+}
+
+namespace {
+
+// Buffers the appended variables and inserts the model on commit.
+class BufferedModelWriter : public ModelStore::ModelWriter {
+ public:
+  BufferedModelWriter(ModelStore *model_store, std::string learner_id)
+      : model_store_(model_store), learner_id_(std::move(learner_id)) {}
+
+  void AppendVariable(Model_Variable &&variable) override {
+    *model_.add_variables() = std::move(variable);
+  }
+
+  void Commit() override {
+    model_store_->InsertModel(std::vector<std::pair<std::string, Model>>{
+        {learner_id_, std::move(model_)}});
+  }
+
+ private:
+  ModelStore *model_store_;
+  std::string learner_id_;
+  Model model_;
+};
+
+}
+
+std::unique_ptr<ModelStore::ModelWriter>
+ModelStore::NewModelWriter(const std::string &learner_id) {
+  return std::make_unique<BufferedModelWriter>(this, learner_id);
+}
+
+std::vector<ModelStore::DetachedTensorValue>
+ModelStore::DetachTensorValues(Model *model) {
+  std::vector<DetachedTensorValue> values;
+  values.reserve(model->variables_size());
+  for (auto &variable: *model->mutable_variables()) {
+    values.push_back(DetachTensorValue(&variable));
+  }
+  return values;
+}
+
+ModelStore::DetachedTensorValue
+ModelStore::DetachTensorValue(Model_Variable *variable) {
+  auto *tensor_spec = MutableTensorSpec(variable);
+  DetachedTensorValue detached;
+  detached.value.swap(*tensor_spec->mutable_value());
+  detached.digest = DigestBytes(detached.value);
+  detached.dtype = tensor_spec->type();
+  tensor_spec->set_value(detached.digest.ToBytes());
+  return detached;
+}
+
+std::string ModelStore::EncodeTensorBlob(DetachedTensorValue *detached) const {
+  if (m_model_store_specs.tensor_compression().codec() == TensorCompression_Codec_NONE) {
+    return std::move(detached->value);
+  }
+  return CompressTensorValue(detached->value, detached->dtype,
+                             m_model_store_specs.tensor_compression());
+}
+
+bool ModelStore::DecodeTensorBlob(const std::string &blob, std::string *value) const {
+  if (m_model_store_specs.tensor_compression().codec() == TensorCompression_Codec_NONE) {
+    *value = blob;
+    return true;
+  }
+  return DecompressTensorValue(blob, value);
+}
+
+bool ModelStore::MatchesTensorBlob(const std::string &blob, const std::string &value) const {
+  if (m_model_store_specs.tensor_compression().codec() == TensorCompression_Codec_NONE) {
+    return blob == value;
+  }
+  std::string decoded;
+  return DecompressTensorValue(blob, &decoded) && decoded == value;
+}
+
+TensorDigest ModelStore::ProbeTensorDigest(const TensorDigest &digest) {
+  return TensorDigest{digest.high + 0x9e3779b97f4a7c15ULL, digest.low};
+}
+
+TensorDigest ModelStore::GetTensorDigest(const Model_Variable &variable) {
+  const auto &tensor_spec = variable.has_ciphertext_tensor()
+                            ? variable.ciphertext_tensor().tensor_spec()
+                            : variable.plaintext_tensor().tensor_spec();
+  TensorDigest digest;
+  if (!TensorDigest::FromBytes(tensor_spec.value(), &digest)) {
+    PLOG(ERROR) << "Variable " << variable.name() << " does not carry a tensor digest.";
+  }
+  return digest;
+}
+
+TensorSpec *ModelStore::MutableTensorSpec(Model_Variable *variable) {
+  if (variable->has_ciphertext_tensor()) {
+    return variable->mutable_ciphertext_tensor()->mutable_tensor_spec();
+  }
+  return variable->mutable_plaintext_tensor()->mutable_tensor_spec();
+}
+
+const Model *ModelStore::KeepSelectedModel(const std::string &learner_id, Model &&model,
+                                           std::vector<std::shared_ptr<const std::string>> &&blobs) {
+  std::unique_lock<std::shared_mutex> cache_guard(m_model_store_cache_mutex);
+  for (int index = 0; index < model.variables_size() && index < (int) blobs.size(); ++index) {
+    if (!blobs[index]) {
+      PLOG(ERROR) << "Missing tensor blob for variable: " << model.variables(index).name();
+      continue;
+    }
+    auto &selected_blob = m_selected_tensor_blobs[GetTensorDigest(model.variables(index))];
+    if (!selected_blob) {
+      m_selected_bytes += blobs[index]->size();
+      selected_blob = std::move(blobs[index]);
+    }
+  }
+  m_selected_bytes += model.ByteSizeLong();
+  auto &cached_models = m_model_store_cache[learner_id];
+  cached_models.push_back(std::move(model));
+  return &cached_models.back();
+}
+
+void ModelStore::ReleaseSelectedModels() {
+  std::unique_lock<std::shared_mutex> cache_guard(m_model_store_cache_mutex);
+  m_model_store_cache.clear();
+  m_selected_tensor_blobs.clear();
+  m_selected_bytes = 0;
+}
+
+std::shared_ptr<const std::string> ModelStore::ResolveTensorValue(const TensorSpec &tensor_spec) {
+  TensorDigest digest;
+  std::shared_ptr<const std::string> blob;
+  if (TensorDigest::FromBytes(tensor_spec.value(), &digest)) {
+    std::shared_lock<std::shared_mutex> cache_guard(m_model_store_cache_mutex);
+    auto itr = m_selected_tensor_blobs.find(digest);
+    if (itr != m_selected_tensor_blobs.end()) {
+      blob = itr->second;
+    }
+  }
+  if (!blob) {
+    PLOG(ERROR) << "The tensor value is not part of a selected model.";
+    return nullptr;
+  }
+  if (m_model_store_specs.tensor_compression().codec() == TensorCompression_Codec_NONE) {
+    return blob;
+  }
+  auto value = std::make_shared<std::string>();
+  if (!DecodeTensorBlob(*blob, value.get())) {
+    PLOG(ERROR) << "Corrupted tensor blob.";
+    return nullptr;
+  }
+  return value;
+}
+
+size_t ModelStore::GetSelectedBytes() {
+  std::shared_lock<std::shared_mutex> cache_guard(m_model_store_cache_mutex);
+  return m_selected_bytes;
 }
 
 }
@@ -3,14 +3,26 @@
 #define METISFL_METISFL_CONTROLLER_STORE_MODEL_STORE_H_
 
 #include <glog/logging.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <shared_mutex>
 #include <vector>
 #include <map>
 
+#include "absl/container/flat_hash_map.h"
+#include "metisfl/controller/common/tensor_digest.h"
 #include "metisfl/proto/metis.pb.h"
 #include "metisfl/proto/model.pb.h"
 
 namespace metisfl::controller {
 
+// Model stores are safe to call concurrently: models can be inserted (or
+// erased) while an aggregation is selecting models from the store. The
+// models returned by SelectModels(), and their tensor values, are owned by
+// the store and stay valid until ResetState(), independently of any later
+// insertion or eviction. Expunge() and Shutdown() must not race with any
+// other operation.
 class ModelStore {
 
  public:
@@ -31,14 +43,38 @@ class ModelStore {
   // The convention is that multiple learners can insert a single model.
   virtual void InsertModel(std::vector<std::pair<std::string, Model>> learner_pairs) = 0;
 
+  // Inserts a single model of a learner whose variables become available
+  // over time, e.g., while the model is being received from the learner.
+  // The model is inserted once Commit() is called; a writer that is
+  // destroyed without committing discards the model.
+  class ModelWriter {
+   public:
+    virtual ~ModelWriter() = default;
+
+    // Appends the next (complete) variable of the model.
+    virtual void AppendVariable(Model_Variable &&variable) = 0;
+
+    // Inserts the model in the store, as InsertModel() does.
+    virtual void Commit() = 0;
+  };
+
+  // By default, the variables are buffered and the model is inserted in the
+  // store on commit. Stores can override it to ingest every variable (i.e.,
+  // hash and compress its tensor value) as soon as it is appended.
+  virtual std::unique_ptr<ModelWriter> NewModelWriter(const std::string &learner_id);
+
   // Remove the models from ephermal state of the model store only. 
   virtual void ResetState() = 0;
 
   // Select a number of models (int value) for each learner and return a map
   // where key is the learner id and value the learner's model collection.
-  // We return pointers to avoid duplicating the returned models. SelectModels()
-  // function brings the models inside the controller's allocated memory, and
-  // therefore we want to avoid redundant copying because of reference.
+  // Since tensor values are stored deduplicated (and possibly compressed),
+  // the selected models carry the digest of every tensor value in place of
+  // the value, and the values are restored on demand, one variable at a
+  // time, through ResolveTensorValue(). Hence, selecting models does not
+  // copy their tensor values, and models that share a tensor value share
+  // it during aggregation as well. The models are kept by the store until
+  // ResetState(), hence the returned pointers.
   // *** CAUTION ***
   // The convention we follow in the select model function is to
   // return models in the ascending committed (time) order:
@@ -46,6 +82,18 @@ class ModelStore {
   virtual std::map<std::string, std::vector<const Model*>>
   SelectModels(std::vector<std::pair<std::string, int>> learner_pairs) = 0;
 
+  // Returns the value of a tensor of a model returned by SelectModels(). An
+  // uncompressed value is shared with the store; a compressed value is
+  // decompressed on every call, hence the caller should drop it once done.
+  // Returns nullptr if the tensor is not part of a selected model. Safe to
+  // call concurrently, e.g., from every thread of an aggregation.
+  std::shared_ptr<const std::string> ResolveTensorValue(const TensorSpec &tensor_spec);
+
+  // Returns the number of bytes held for the models returned by
+  // SelectModels() since the last ResetState(), i.e., the structure of the
+  // models and the tensor values they refer to, every value counted once.
+  size_t GetSelectedBytes();
+
   // Proper release of resources and model store shutdown.
   virtual void Shutdown() = 0;
 
@@ -59,11 +107,85 @@ class ModelStore {
   // Returns the count of models inserted for each learner.
   virtual int GetLearnerLineageLength(std::string learner_id) = 0;
 
+  // Returns the number of bytes the store currently holds for the models
+  // of all learners (tensor values, after deduplication and compression,
+  // and model structure).
+  virtual size_t GetResidentBytes() = 0;
+
+  // Sets the number of most recent models of every learner that the
+  // byte-budget eviction policy must never evict, i.e., the lineage length
+  // required by the aggregation rule.
+  void SetProtectedLineageLength(int lineage_length) {
+    m_protected_lineage_length = lineage_length > 0 ? lineage_length : 1;
+  }
+
  protected:
+  // A tensor value moved out of a stored model, along with its digest
+  // and the dtype of the variable it belongs to.
+  struct DetachedTensorValue {
+    TensorDigest digest;
+    std::string value;
+    DType dtype;
+  };
+
+  // Tensor values are stored content-addressed: on insertion every variable's
+  // value is moved out of the model and replaced by its 128-bit digest, so
+  // that bit-identical tensors (frozen layers, untouched embeddings, learners
+  // that did not move away from the community model) are kept only once.
+  // Returns the detached values in variable order.
+  static std::vector<DetachedTensorValue> DetachTensorValues(Model *model);
+  static DetachedTensorValue DetachTensorValue(Model_Variable *variable);
+
+  // Converts a detached tensor value to the blob kept by the store, i.e.,
+  // compresses it if tensor compression is enabled, and back.
+  std::string EncodeTensorBlob(DetachedTensorValue *detached) const;
+  bool DecodeTensorBlob(const std::string &blob, std::string *value) const;
+
+  // Whether the blob holds the given tensor value. The digest is not
+  // collision resistant (anyone can craft a tensor with the digest of, e.g.,
+  // a community model tensor), hence a digest match must be confirmed
+  // against the stored bytes before a blob is shared.
+  bool MatchesTensorBlob(const std::string &blob, const std::string &value) const;
+
+  // The digest under which a value is stored when a different value is
+  // already stored under `digest`. Only the high half of the digest changes.
+  static TensorDigest ProbeTensorDigest(const TensorDigest &digest);
+
+  // Returns the digest that DetachTensorValues() left in place of the value.
+  static TensorDigest GetTensorDigest(const Model_Variable &variable);
+
+  // Returns the tensor spec of the variable, whether plaintext or ciphertext.
+  static TensorSpec *MutableTensorSpec(Model_Variable *variable);
+
+  // Keeps a selected model, which carries digests in place of its tensor
+  // values, until ResetState(), along with the blobs of its tensor values
+  // (in variable order), and returns the model to hand out. The blobs stay
+  // resolvable even if the store releases them in the meantime.
+  const Model *KeepSelectedModel(const std::string &learner_id, Model &&model,
+                                 std::vector<std::shared_ptr<const std::string>> &&blobs);
+
+  // Releases the models kept by KeepSelectedModel(), on ResetState().
+  void ReleaseSelectedModels();
+
+  // Whether the resident bytes exceed the budget of the byte-budget policy.
+  bool ExceedsByteBudget(size_t resident_bytes) const {
+    return m_model_store_specs.has_byte_budget_eviction() &&
+        resident_bytes > m_model_store_specs.byte_budget_eviction().max_resident_bytes();
+  }
+
   ModelStoreSpecs m_model_store_specs; 
 
-  // Keep track of the models that have been part of the model_store.
-  std::map<std::string, std::vector<Model>> m_model_store_cache;
+  std::atomic<int> m_protected_lineage_length{1};
+
+  // The models selected by SelectModels() since the last ResetState(),
+  // along with the blobs of their tensor values by digest. The models are
+  // only ever appended (a deque keeps the references to them valid) and are
+  // not erased along with the learner's stored models, since an ongoing
+  // aggregation might still read them.
+  std::shared_mutex m_model_store_cache_mutex;
+  std::map<std::string, std::deque<Model>> m_model_store_cache;
+  absl::flat_hash_map<TensorDigest, std::shared_ptr<const std::string>> m_selected_tensor_blobs;
+  size_t m_selected_bytes = 0;
   
 };
 
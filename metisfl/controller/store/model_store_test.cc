@@ -4,7 +4,10 @@
 
 #include <gtest/gtest.h>
 
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <thread>
 
 using namespace std;
 
@@ -97,6 +100,18 @@ class ModelStoreTest : public ::testing::Test {
     return model;
   }
 
+  // Restores the tensor values of a selected model, whose variables carry
+  // the digests of their values.
+  Model RestoreModel(const Model *selected_model) const {
+    Model model = *selected_model;
+    for (auto &variable: *model.mutable_variables()) {
+      auto *tensor_spec = variable.mutable_plaintext_tensor()->mutable_tensor_spec();
+      auto value = model_store->ResolveTensorValue(*tensor_spec);
+      tensor_spec->set_value(value ? *value : "");
+    }
+    return model;
+  }
+
   void InsertOneModelSingleLearner(const ModelStoreConfig &config) {
 
     InitModelStore(config);
@@ -340,6 +355,390 @@ class ModelStoreTest : public ::testing::Test {
     model_store->Expunge();
   }
 
+  template<typename StoreT>
+  void TestTensorDeduplication(const ModelStoreConfig &config) {
+    InitModelStore(config);
+    auto *store = dynamic_cast<StoreT *>(model_store.get());
+    ASSERT_NE(store, nullptr);
+
+    // Every variable of a generated model holds the same values, and
+    // models generated with a different padding differ in all values.
+    Model model_a = GenerateModel(100, 10, 1);
+    Model model_b = GenerateModel(100, 10, 2);
+    std::string learner_id_1 = "localhost::50051";
+    std::string learner_id_2 = "localhost::50052";
+
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{
+        {learner_id_1, model_a}, {learner_id_2, model_a}});
+    EXPECT_EQ(store->GetNumTensorBlobs(), 1);
+
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{{learner_id_1, model_b}});
+    EXPECT_EQ(store->GetNumTensorBlobs(), 2);
+
+    // Selected models must be restored with their original tensor values.
+    auto ret = model_store->SelectModels(std::vector<std::pair<std::string, int>>{
+        {learner_id_1, 2}, {learner_id_2, 1}});
+    ASSERT_EQ(ret[learner_id_1].size(), 2);
+    ASSERT_EQ(ret[learner_id_2].size(), 1);
+    EXPECT_EQ(RestoreModel(ret[learner_id_1][0]).SerializeAsString(), model_a.SerializeAsString());
+    EXPECT_EQ(RestoreModel(ret[learner_id_1][1]).SerializeAsString(), model_b.SerializeAsString());
+    EXPECT_EQ(RestoreModel(ret[learner_id_2][0]).SerializeAsString(), model_a.SerializeAsString());
+    model_store->ResetState();
+
+    // The shared blob is released only once no model references it.
+    model_store->EraseModels(std::vector<std::string>{learner_id_2});
+    EXPECT_EQ(store->GetNumTensorBlobs(), 2);
+    model_store->EraseModels(std::vector<std::string>{learner_id_1});
+    EXPECT_EQ(store->GetNumTensorBlobs(), 0);
+
+    model_store->Expunge();
+  }
+
+  // Returns a value of the same length that differs from the given value,
+  // yet has the same digest. The first 16-byte block of the value is
+  // altered, and the second block is chosen so that the digest state after
+  // it is the same as the original one; MurmurHash3's block step is
+  // invertible, whatever the seed.
+  static std::string CollideTensorDigest(const std::string &value) {
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+    auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+    auto rotr = [](uint64_t x, int r) { return (x >> r) | (x << (64 - r)); };
+    auto inverse = [](uint64_t a) {
+      uint64_t x = a;
+      for (int i = 0; i < 6; ++i) x *= 2 - a * x;
+      return x;
+    };
+    auto block = [&](uint64_t *h1, uint64_t *h2, uint64_t k1, uint64_t k2) {
+      k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; *h1 ^= k1;
+      *h1 = rotl(*h1, 27); *h1 += *h2; *h1 = *h1 * 5 + 0x52dce729;
+      k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; *h2 ^= k2;
+      *h2 = rotl(*h2, 31); *h2 += *h1; *h2 = *h2 * 5 + 0x38495ab5;
+    };
+    std::vector<uint64_t> k(4);
+    std::memcpy(k.data(), value.data(), 32);
+
+    uint64_t t1 = 0, t2 = 0;
+    block(&t1, &t2, k[0], k[1]);
+    block(&t1, &t2, k[2], k[3]);
+
+    k[0] ^= 1;
+    uint64_t g1 = 0, g2 = 0;
+    block(&g1, &g2, k[0], k[1]);
+    auto x1 = rotr((t1 - 0x52dce729) * inverse(5) - g2, 27) ^ g1;
+    k[2] = rotr(x1 * inverse(c2), 31) * inverse(c1);
+    auto x2 = rotr((t2 - 0x38495ab5) * inverse(5) - t1, 31) ^ g2;
+    k[3] = rotr(x2 * inverse(c1), 33) * inverse(c2);
+
+    auto collided = value;
+    std::memcpy(&collided[0], k.data(), 32);
+    return collided;
+  }
+
+  template<typename StoreT>
+  void TestTensorDigestCollision(const ModelStoreConfig &config) {
+    InitModelStore(config);
+    auto *store = dynamic_cast<StoreT *>(model_store.get());
+    ASSERT_NE(store, nullptr);
+
+    // A learner uploads a tensor crafted to collide with the tensor of
+    // another learner's model, e.g., a frozen layer of the community model.
+    Model model_a = GenerateModel(100, 2, 1);
+    Model model_b = model_a;
+    auto *tensor_spec = model_b.mutable_variables(0)->mutable_plaintext_tensor()->mutable_tensor_spec();
+    tensor_spec->set_value(CollideTensorDigest(tensor_spec->value()));
+    ASSERT_NE(model_b.variables(0).plaintext_tensor().tensor_spec().value(),
+              model_a.variables(0).plaintext_tensor().tensor_spec().value());
+    ASSERT_EQ(DigestBytes(model_b.variables(0).plaintext_tensor().tensor_spec().value()),
+              DigestBytes(model_a.variables(0).plaintext_tensor().tensor_spec().value()));
+    std::string learner_id_1 = "localhost::50051";
+    std::string learner_id_2 = "localhost::50052";
+    std::string learner_id_3 = "localhost::50053";
+
+    // The colliding values are stored apart; the crafted value is still
+    // shared with the learners that upload it too, as is the value of the
+    // second (untouched) variable.
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{
+        {learner_id_2, model_b}, {learner_id_1, model_a}, {learner_id_3, model_b}});
+    EXPECT_EQ(store->GetNumTensorBlobs(), 2);
+
+    auto ret = model_store->SelectModels(std::vector<std::pair<std::string, int>>{
+        {learner_id_1, 1}, {learner_id_2, 1}, {learner_id_3, 1}});
+    ASSERT_EQ(ret[learner_id_1].size(), 1);
+    ASSERT_EQ(ret[learner_id_2].size(), 1);
+    ASSERT_EQ(ret[learner_id_3].size(), 1);
+    EXPECT_EQ(RestoreModel(ret[learner_id_1][0]).SerializeAsString(), model_a.SerializeAsString());
+    EXPECT_EQ(RestoreModel(ret[learner_id_2][0]).SerializeAsString(), model_b.SerializeAsString());
+    EXPECT_EQ(RestoreModel(ret[learner_id_3][0]).SerializeAsString(), model_b.SerializeAsString());
+    model_store->ResetState();
+
+    model_store->EraseModels(std::vector<std::string>{learner_id_2, learner_id_3});
+    EXPECT_EQ(store->GetNumTensorBlobs(), 1);
+    model_store->EraseModels(std::vector<std::string>{learner_id_1});
+    EXPECT_EQ(store->GetNumTensorBlobs(), 0);
+    model_store->Expunge();
+  }
+
+  void TestTensorCompression(const ModelStoreConfig &uncompressed_config,
+                             const ModelStoreConfig &compressed_config) {
+    // The values of a generated model vary slowly, as model weights do.
+    Model model = GenerateModel(1000, 10, 1);
+    std::string learner_id = "localhost::50051";
+
+    InitModelStore(uncompressed_config);
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{{learner_id, model}});
+    auto uncompressed_bytes = model_store->GetResidentBytes();
+    model_store->Expunge();
+
+    InitModelStore(compressed_config);
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{{learner_id, model}});
+    EXPECT_LT(model_store->GetResidentBytes(), uncompressed_bytes / 2);
+
+    // Compressed models are restored with their original tensor values.
+    auto ret = model_store->SelectModels(std::vector<std::pair<std::string, int>>{{learner_id, 1}});
+    ASSERT_EQ(ret[learner_id].size(), 1);
+    EXPECT_EQ(RestoreModel(ret[learner_id][0]).SerializeAsString(), model.SerializeAsString());
+    model_store->ResetState();
+
+    model_store->EraseModels(std::vector<std::string>{learner_id});
+    EXPECT_EQ(model_store->GetResidentBytes(), 0);
+    model_store->Expunge();
+  }
+
+  void TestConcurrentInsertAndSelect(const ModelStoreConfig &config) {
+    InitModelStore(config);
+    const int num_learners = 8;
+    const int num_models = 20;
+
+    // One learner keeps its models selected (as an ongoing aggregation
+    // would) while all learners, including itself, insert new models.
+    std::string selected_learner_id = "localhost::50050";
+    Model selected_model = GenerateModel(100, 10, 100);
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{
+        {selected_learner_id, selected_model}});
+    auto selected = model_store->SelectModels(
+        std::vector<std::pair<std::string, int>>{{selected_learner_id, 1}});
+    ASSERT_EQ(selected[selected_learner_id].size(), 1);
+
+    std::vector<std::thread> writers;
+    for (int learner = 0; learner < num_learners; ++learner) {
+      writers.emplace_back([this, learner, num_models] {
+        std::string learner_id = "localhost::" + std::to_string(50051 + learner);
+        for (int counter = 0; counter < num_models; ++counter) {
+          model_store->InsertModel(std::vector<std::pair<std::string, Model>>{
+              {learner_id, GenerateModel(100, 10, counter)}});
+        }
+      });
+    }
+    for (int counter = 0; counter < num_models; ++counter) {
+      model_store->InsertModel(std::vector<std::pair<std::string, Model>>{
+          {selected_learner_id, GenerateModel(100, 10, counter)}});
+    }
+    for (auto &writer: writers) {
+      writer.join();
+    }
+
+    // The selected model is unaffected by the eviction of the stored one.
+    EXPECT_EQ(RestoreModel(selected[selected_learner_id][0]).SerializeAsString(),
+              selected_model.SerializeAsString());
+    for (int learner = 0; learner < num_learners; ++learner) {
+      std::string learner_id = "localhost::" + std::to_string(50051 + learner);
+      EXPECT_EQ(model_store->GetLearnerLineageLength(learner_id),
+                std::min(num_models, model_store->GetConfiguredLineageLength()));
+    }
+    model_store->Expunge();
+  }
+
+  template<typename StoreT>
+  void TestEraseRemovesLearnerLineage(const ModelStoreConfig &config) {
+    InitModelStore(config);
+    auto *store = dynamic_cast<StoreT *>(model_store.get());
+    ASSERT_NE(store, nullptr);
+    std::string learner_id_1 = "localhost::50051";
+    std::string learner_id_2 = "localhost::50052";
+    std::string learner_id_3 = "localhost::50053";
+
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{
+        {learner_id_1, GenerateModel(100, 10, 1)}, {learner_id_2, GenerateModel(100, 10, 2)}});
+    EXPECT_EQ(store->GetNumLearnerLineages(), 2);
+
+    // Looking up a learner without models does not create its lineage.
+    EXPECT_EQ(model_store->GetLearnerLineageLength(learner_id_3), 0);
+    auto ret = model_store->SelectModels(
+        std::vector<std::pair<std::string, int>>{{learner_id_3, 0}});
+    EXPECT_TRUE(ret[learner_id_3].empty());
+    model_store->EraseModels(std::vector<std::string>{learner_id_3});
+    EXPECT_EQ(store->GetNumLearnerLineages(), 2);
+
+    // Erasing the models of a learner removes its lineage as well.
+    model_store->EraseModels(std::vector<std::string>{learner_id_1});
+    EXPECT_EQ(store->GetNumLearnerLineages(), 1);
+    EXPECT_EQ(model_store->GetLearnerLineageLength(learner_id_1), 0);
+    EXPECT_EQ(store->GetNumLearnerLineages(), 1);
+
+    // The learner starts a new lineage if it rejoins.
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{
+        {learner_id_1, GenerateModel(100, 10, 3)}});
+    EXPECT_EQ(store->GetNumLearnerLineages(), 2);
+    EXPECT_EQ(model_store->GetLearnerLineageLength(learner_id_1), 1);
+
+    model_store->Expunge();
+  }
+
+  void TestSelectedModelsOutliveErase(const ModelStoreConfig &config) {
+    InitModelStore(config);
+    Model model_a = GenerateModel(100, 10, 1);
+    Model model_b = GenerateModel(100, 10, 2);
+    std::string learner_id = "localhost::50051";
+
+    // An aggregation holds the models of an earlier selection while the
+    // learner is selected again and then erased (e.g., evicted as dead).
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{{learner_id, model_a}});
+    auto first = model_store->SelectModels(
+        std::vector<std::pair<std::string, int>>{{learner_id, 1}});
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{{learner_id, model_b}});
+    auto second = model_store->SelectModels(
+        std::vector<std::pair<std::string, int>>{{learner_id, 1}});
+    model_store->EraseModels(std::vector<std::string>{learner_id});
+    EXPECT_EQ(model_store->GetLearnerLineageLength(learner_id), 0);
+
+    ASSERT_EQ(first[learner_id].size(), 1);
+    ASSERT_EQ(second[learner_id].size(), 1);
+    EXPECT_EQ(RestoreModel(first[learner_id][0]).SerializeAsString(), model_a.SerializeAsString());
+    EXPECT_EQ(RestoreModel(second[learner_id][0]).SerializeAsString(), model_b.SerializeAsString());
+    model_store->ResetState();
+    model_store->Expunge();
+  }
+
+  void TestSelectionMemory(const ModelStoreConfig &config, bool shares_values) {
+    InitModelStore(config);
+    const int num_learners = 8;
+
+    // The learners did not move away from the community model, hence their
+    // models hold the same tensor values.
+    Model model = GenerateModel(1000, 10, 1);
+    for (int learner = 0; learner < num_learners; ++learner) {
+      model_store->InsertModel(std::vector<std::pair<std::string, Model>>{
+          {"localhost::" + std::to_string(50051 + learner), model}});
+    }
+    auto resident_bytes = model_store->GetResidentBytes();
+
+    // Selecting the models of all learners copies none of their tensor
+    // values: the bytes held for the selection peak at the bytes of the
+    // (deduplicated) models in the store, rather than at the bytes of
+    // every model in full.
+    std::vector<std::pair<std::string, int>> learner_pairs;
+    for (int learner = 0; learner < num_learners; ++learner) {
+      learner_pairs.emplace_back("localhost::" + std::to_string(50051 + learner), 1);
+    }
+    auto ret = model_store->SelectModels(learner_pairs);
+    ASSERT_EQ(ret.size(), num_learners);
+    EXPECT_LE(model_store->GetSelectedBytes(), resident_bytes);
+    EXPECT_LT(model_store->GetSelectedBytes(), model.ByteSizeLong());
+    for (const auto &[learner_id, selected_models]: ret) {
+      ASSERT_EQ(selected_models.size(), 1);
+      EXPECT_LT(selected_models[0]->ByteSizeLong(), model.ByteSizeLong() / 10);
+    }
+
+    // The models restore the same tensor value, without copying it if it
+    // is stored uncompressed.
+    const auto tensor_spec_1 = ret["localhost::50051"][0]->variables(0).plaintext_tensor().tensor_spec();
+    const auto &tensor_spec_2 = ret["localhost::50052"][0]->variables(0).plaintext_tensor().tensor_spec();
+    auto value_1 = model_store->ResolveTensorValue(tensor_spec_1);
+    auto value_2 = model_store->ResolveTensorValue(tensor_spec_2);
+    ASSERT_NE(value_1, nullptr);
+    ASSERT_NE(value_2, nullptr);
+    EXPECT_EQ(*value_1, model.variables(0).plaintext_tensor().tensor_spec().value());
+    EXPECT_EQ(value_1 == value_2, shares_values);
+
+    model_store->ResetState();
+    EXPECT_EQ(model_store->GetSelectedBytes(), 0);
+    EXPECT_EQ(model_store->ResolveTensorValue(tensor_spec_1), nullptr);
+    model_store->Expunge();
+  }
+
+  void TestByteBudgetEviction(const ModelStoreConfig &unbounded_config,
+                              const std::function<ModelStoreConfig(uint64_t)> &budget_config) {
+    // Measure the resident bytes of a single model.
+    InitModelStore(unbounded_config);
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{
+        {"localhost::50050", GenerateModel(100, 10, 1)}});
+    auto model_bytes = model_store->GetResidentBytes();
+    ASSERT_GT(model_bytes, 0);
+    model_store->Expunge();
+    EXPECT_EQ(model_store->GetResidentBytes(), 0);
+
+    // A budget of three (distinct) models across two learners.
+    InitModelStore(budget_config(3 * model_bytes));
+    model_store->SetProtectedLineageLength(1);
+    std::string learner_id_1 = "localhost::50051";
+    std::string learner_id_2 = "localhost::50052";
+    for (int counter = 0; counter < 5; ++counter) {
+      model_store->InsertModel(std::vector<std::pair<std::string, Model>>{
+          {learner_id_1, GenerateModel(100, 10, 2 * counter)},
+          {learner_id_2, GenerateModel(100, 10, 2 * counter + 1)}});
+      EXPECT_LE(model_store->GetResidentBytes(), 3 * model_bytes);
+    }
+    EXPECT_GE(model_store->GetLearnerLineageLength(learner_id_1), 1);
+    EXPECT_GE(model_store->GetLearnerLineageLength(learner_id_2), 1);
+    EXPECT_EQ(model_store->GetLearnerLineageLength(learner_id_1) +
+              model_store->GetLearnerLineageLength(learner_id_2), 3);
+    model_store->Expunge();
+
+    // The protected models are kept even if they exceed the budget.
+    InitModelStore(budget_config(1));
+    model_store->SetProtectedLineageLength(2);
+    for (int counter = 0; counter < 5; ++counter) {
+      model_store->InsertModel(std::vector<std::pair<std::string, Model>>{
+          {learner_id_1, GenerateModel(100, 10, 2 * counter)},
+          {learner_id_2, GenerateModel(100, 10, 2 * counter + 1)}});
+    }
+    EXPECT_EQ(model_store->GetLearnerLineageLength(learner_id_1), 2);
+    EXPECT_EQ(model_store->GetLearnerLineageLength(learner_id_2), 2);
+    auto ret = model_store->SelectModels(std::vector<std::pair<std::string, int>>{{learner_id_1, 2}});
+    ASSERT_EQ(ret[learner_id_1].size(), 2);
+    EXPECT_EQ(RestoreModel(ret[learner_id_1][1]).SerializeAsString(), GenerateModel(100, 10, 8).SerializeAsString());
+    model_store->Expunge();
+  }
+
+  void TestModelWriter(const ModelStoreConfig &config) {
+    InitModelStore(config);
+    Model model = GenerateModel(100, 10, 1);
+    std::string learner_id = "localhost::50051";
+
+    // A model inserted variable by variable is the same as a model inserted
+    // at once, and it occupies the same number of bytes.
+    model_store->InsertModel(std::vector<std::pair<std::string, Model>>{{learner_id, model}});
+    auto model_bytes = model_store->GetResidentBytes();
+    model_store->Expunge();
+
+    auto writer = model_store->NewModelWriter(learner_id);
+    for (auto variable: model.variables()) {
+      writer->AppendVariable(std::move(variable));
+    }
+    EXPECT_EQ(model_store->GetLearnerLineageLength(learner_id), 0);
+    writer->Commit();
+    writer.reset();
+    EXPECT_EQ(model_store->GetLearnerLineageLength(learner_id), 1);
+    EXPECT_EQ(model_store->GetResidentBytes(), model_bytes);
+
+    auto ret = model_store->SelectModels(std::vector<std::pair<std::string, int>>{{learner_id, 1}});
+    ASSERT_EQ(ret[learner_id].size(), 1);
+    EXPECT_EQ(RestoreModel(ret[learner_id][0]).SerializeAsString(), model.SerializeAsString());
+    model_store->ResetState();
+
+    // A writer that is not committed leaves the store unchanged.
+    Model discarded_model = GenerateModel(100, 10, 2);
+    writer = model_store->NewModelWriter(learner_id);
+    for (auto variable: discarded_model.variables()) {
+      writer->AppendVariable(std::move(variable));
+    }
+    writer.reset();
+    EXPECT_EQ(model_store->GetLearnerLineageLength(learner_id), 1);
+    EXPECT_EQ(model_store->GetResidentBytes(), model_bytes);
+    model_store->Expunge();
+  }
+
 };
 
 class InMemoryModelStoreTest : public ModelStoreTest {
@@ -541,5 +940,156 @@ TEST_F(RedisModelStoreTest, TestCountOfModelsInsertedForOneLearnerRedis) {
   TestCountOfModelsInserted(store_config, count_of_models_to_insert);
 }
 
+/**
+ * Design a test case to check that bit-identical tensors are stored once.
+ * **/
+TEST_F(InMemoryModelStoreTest, TestTensorDeduplicationInMemoryStore) {
+  InMemoryModelStoreTest::ConfigModelStore(-1);
+  TestTensorDeduplication<HashMapModelStore>(store_config);
+}
+
+TEST_F(RedisModelStoreTest, TestTensorDeduplicationRedis) {
+  RedisModelStoreTest::ConfigModelStore(-1);
+  TestTensorDeduplication<RedisModelStore>(store_config);
+}
+
+/**
+ * Design a test case to check that a crafted digest collision does not
+ * replace the tensor values of other models.
+ * **/
+TEST_F(InMemoryModelStoreTest, TestTensorDigestCollisionInMemoryStore) {
+  InMemoryModelStoreTest::ConfigModelStore(-1);
+  TestTensorDigestCollision<HashMapModelStore>(store_config);
+}
+
+TEST_F(InMemoryModelStoreTest, TestTensorDigestCollisionCompressedInMemoryStore) {
+  store_specs.mutable_tensor_compression()->set_codec(TensorCompression_Codec_DEFLATE);
+  InMemoryModelStoreTest::ConfigModelStore(-1);
+  TestTensorDigestCollision<HashMapModelStore>(store_config);
+}
+
+TEST_F(RedisModelStoreTest, TestTensorDigestCollisionRedis) {
+  RedisModelStoreTest::ConfigModelStore(-1);
+  TestTensorDigestCollision<RedisModelStore>(store_config);
+}
+
+/**
+ * Design a test case to check that compressed tensors take fewer resident
+ * bytes and are restored on select.
+ * **/
+TEST_F(InMemoryModelStoreTest, TestTensorCompressionInMemoryStore) {
+  InMemoryModelStoreTest::ConfigModelStore(-1);
+  auto uncompressed_config = store_config;
+  store_specs.mutable_tensor_compression()->set_codec(TensorCompression_Codec_DEFLATE);
+  InMemoryModelStoreTest::ConfigModelStore(-1);
+  TestTensorCompression(uncompressed_config, store_config);
+}
+
+TEST_F(RedisModelStoreTest, TestTensorCompressionRedis) {
+  RedisModelStoreTest::ConfigModelStore(-1);
+  auto uncompressed_config = store_config;
+  store_specs.mutable_tensor_compression()->set_codec(TensorCompression_Codec_DEFLATE);
+  RedisModelStoreTest::ConfigModelStore(-1);
+  TestTensorCompression(uncompressed_config, store_config);
+}
+
+/**
+ * Design a test case to insert models concurrently while models are selected.
+ * **/
+TEST_F(InMemoryModelStoreTest, TestConcurrentInsertAndSelectInMemoryStore) {
+  InMemoryModelStoreTest::ConfigModelStore(5);
+  TestConcurrentInsertAndSelect(store_config);
+}
+
+TEST_F(RedisModelStoreTest, TestConcurrentInsertAndSelectRedis) {
+  RedisModelStoreTest::ConfigModelStore(5);
+  TestConcurrentInsertAndSelect(store_config);
+}
+
+/**
+ * Design a test case to keep selected models valid after their learner is erased.
+ * **/
+TEST_F(InMemoryModelStoreTest, TestSelectedModelsOutliveEraseInMemoryStore) {
+  InMemoryModelStoreTest::ConfigModelStore(1);
+  TestSelectedModelsOutliveErase(store_config);
+}
+
+TEST_F(RedisModelStoreTest, TestSelectedModelsOutliveEraseRedis) {
+  RedisModelStoreTest::ConfigModelStore(1);
+  TestSelectedModelsOutliveErase(store_config);
+}
+
+/**
+ * Design a test case to remove the lineage of a learner once its models are
+ * erased, and to never create one when a learner is only looked up.
+ * **/
+TEST_F(InMemoryModelStoreTest, TestEraseRemovesLearnerLineageInMemoryStore) {
+  InMemoryModelStoreTest::ConfigModelStore(-1);
+  TestEraseRemovesLearnerLineage<HashMapModelStore>(store_config);
+}
+
+TEST_F(RedisModelStoreTest, TestEraseRemovesLearnerLineageRedis) {
+  RedisModelStoreTest::ConfigModelStore(-1);
+  TestEraseRemovesLearnerLineage<RedisModelStore>(store_config);
+}
+
+/**
+ * Design a test case to check that selecting models does not copy their
+ * tensor values.
+ * **/
+TEST_F(InMemoryModelStoreTest, TestSelectionMemoryInMemoryStore) {
+  InMemoryModelStoreTest::ConfigModelStore(-1);
+  TestSelectionMemory(store_config, /* shares_values */ true);
+}
+
+TEST_F(InMemoryModelStoreTest, TestSelectionMemoryCompressedInMemoryStore) {
+  store_specs.mutable_tensor_compression()->set_codec(TensorCompression_Codec_DEFLATE);
+  InMemoryModelStoreTest::ConfigModelStore(-1);
+  TestSelectionMemory(store_config, /* shares_values */ false);
+}
+
+TEST_F(RedisModelStoreTest, TestSelectionMemoryRedis) {
+  RedisModelStoreTest::ConfigModelStore(-1);
+  TestSelectionMemory(store_config, /* shares_values */ true);
+}
+
+/**
+ * Design a test case to keep the models of all learners within a byte budget.
+ * **/
+TEST_F(InMemoryModelStoreTest, TestByteBudgetEvictionInMemoryStore) {
+  InMemoryModelStoreTest::ConfigModelStore(-1);
+  auto unbounded_config = store_config;
+  TestByteBudgetEviction(unbounded_config, [this](uint64_t max_resident_bytes) {
+    store_specs.mutable_byte_budget_eviction()->set_max_resident_bytes(max_resident_bytes);
+    *in_memory_store.mutable_model_store_specs() = store_specs;
+    *store_config.mutable_in_memory_store() = in_memory_store;
+    return store_config;
+  });
+}
+
+TEST_F(RedisModelStoreTest, TestByteBudgetEvictionRedis) {
+  RedisModelStoreTest::ConfigModelStore(-1);
+  auto unbounded_config = store_config;
+  TestByteBudgetEviction(unbounded_config, [this](uint64_t max_resident_bytes) {
+    store_specs.mutable_byte_budget_eviction()->set_max_resident_bytes(max_resident_bytes);
+    *redis_db_store.mutable_model_store_specs() = store_specs;
+    *store_config.mutable_redis_db_store() = redis_db_store;
+    return store_config;
+  });
+}
+
+/**
+ * Design a test case to insert a model one variable at a time.
+ * **/
+TEST_F(InMemoryModelStoreTest, TestModelWriterInMemoryStore) {
+  InMemoryModelStoreTest::ConfigModelStore(-1);
+  TestModelWriter(store_config);
+}
+
+TEST_F(RedisModelStoreTest, TestModelWriterRedis) {
+  RedisModelStoreTest::ConfigModelStore(-1);
+  TestModelWriter(store_config);
+}
+
 } // namespace
 } // namespace metisfl::controller
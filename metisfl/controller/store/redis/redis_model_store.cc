@@ -1,6 +1,10 @@
 
 #include "metisfl/controller/store/redis/redis_model_store.h"
 
+#include <algorithm>
+#include <set>
+#include <tuple>
+
 namespace metisfl::controller {
 
 RedisModelStore::RedisModelStore(const RedisDBStore &config) : ModelStore(config.model_store_specs()) {
@@ -16,10 +20,15 @@ RedisModelStore::~RedisModelStore() {
 void RedisModelStore::Expunge() {
   // WARNING: flushing the entire database.
   PLOG(WARNING) << "Flush Redis Database.";
+  std::lock_guard<std::mutex> lock(learner_mutex);
   auto *redis_reply = (redisReply *) redisCommand(m_redis_context, "flushdb");
   freeReplyObject(redis_reply);
 
   learner_lineage_.clear();
+  model_infos_.clear();
+  tensor_blob_refs_.clear();
+  resident_bytes_ = 0;
+  ReleaseSelectedModels();
 }
 
 int RedisModelStore::GetConfiguredLineageLength() {
@@ -31,7 +40,9 @@ int RedisModelStore::GetConfiguredLineageLength() {
 }
 
 int RedisModelStore::GetLearnerLineageLength(std::string learner_id) {
-  return (int) learner_lineage_[learner_id].size();
+  std::lock_guard<std::mutex> lock(learner_mutex);
+  auto itr = learner_lineage_.find(learner_id);
+  return itr != learner_lineage_.end() ? (int) itr->second.size() : 0;
 }
 
 void RedisModelStore::EraseModels(const std::vector<std::string> &learner_ids) {
@@ -40,6 +51,8 @@ void RedisModelStore::EraseModels(const std::vector<std::string> &learner_ids) {
   // We would need to remove models before removing entry form Controller's
   // learners_ collection.
 
+  std::lock_guard<std::mutex> lock(learner_mutex);
+
   for (auto &learner_id: learner_ids) {
     // Get all model keys associated with the learner_id.
     std::vector<std::string> model_keys = FindModelKeys(learner_id, 0);
@@ -50,9 +63,10 @@ void RedisModelStore::EraseModels(const std::vector<std::string> &learner_ids) {
 
       auto *redis_reply = (redisReply *) redisCommand(m_redis_context, get_command.c_str());
       freeReplyObject(redis_reply);
+      ReleaseTensorBlobs(model_key);
 
     }
-    learner_lineage_[learner_id].clear();
+    learner_lineage_.erase(learner_id);
   }
 
 }
@@ -64,7 +78,7 @@ void RedisModelStore::InsertModel(std::vector<std::pair<std::string, Model>> lea
   for (auto &learner_pair: learner_pairs) {
 
     std::string learner_id = learner_pair.first;
-    Model model = learner_pair.second;
+    Model model = std::move(learner_pair.second);
 
     // This is only applicable on the k-Recent-Models policy.
     if (m_model_store_specs.has_lineage_length_eviction()) {
@@ -88,34 +102,140 @@ void RedisModelStore::InsertModel(std::vector<std::pair<std::string, Model>> lea
 
     // The Model is inserted a List where each entry is a serialized Model_Variable
     // We choose this design over serializing whole model for scalability.
-    Model &to_serialize_mdl = model;
-
-    for (int index = 0; index < (int) to_serialize_mdl.variables_size(); index++) {
+    // The tensor values are stored separately, once per distinct value, under
+    // their content digest; the list entries carry the digest instead.
+    auto detached_values = DetachTensorValues(&model);
+    ResolveTensorBlobKeys(&model, &detached_values);
+    auto &model_info = model_infos_[model_key];
+    model_info.inserted_at = model_info.accessed_at = ++clock_;
+    int pending_replies = 0;
+
+    for (int index = 0; index < (int) model.variables_size(); index++) {
+
+      auto &detached = detached_values[index];
+      model_info.tensor_digests.push_back(detached.digest);
+      auto blob_key = TensorBlobKey(detached.digest);
+      auto &blob_info = tensor_blob_refs_[blob_key];
+      if (blob_info.ref_count++ == 0) {
+        auto blob = EncodeTensorBlob(&detached);
+        blob_info.num_bytes = blob.length();
+        resident_bytes_ += blob_info.num_bytes;
+        redisAppendCommand(m_redis_context, "SET %b %b",
+                           blob_key.c_str(), (size_t) blob_key.length(),
+                           blob.c_str(), (size_t) blob.length());
+        ++pending_replies;
+      }
 
       std::string tensor_serialized;
-      const ::metisfl::Model_Variable &to_serialize_mv = to_serialize_mdl.variables(index);
+      const ::metisfl::Model_Variable &to_serialize_mv = model.variables(index);
       to_serialize_mv.SerializeToString(&tensor_serialized);
+      model_info.num_bytes += tensor_serialized.length();
+
+      redisAppendCommand(m_redis_context, "RPUSH %b %b",
+                         model_key.c_str(),
+                         (size_t) model_key.length(),
+                         tensor_serialized.c_str(),
+                         (size_t) tensor_serialized.length());
+      ++pending_replies;
+    }
 
-      auto *redis_reply = (redisReply *) redisCommand(m_redis_context, "RPUSH %b %b",
-                                                      model_key.c_str(),
-                                                      (size_t) model_key.length(),
-                                                      tensor_serialized.c_str(),
-                                                      (size_t) tensor_serialized.length());
+    // All commands of the model are pipelined; collect their replies.
+    while (pending_replies-- > 0) {
+      redisReply *redis_reply = nullptr;
+      if (redisGetReply(m_redis_context, (void **) &redis_reply) != REDIS_OK) {
+        PLOG(ERROR) << "Redis error while inserting model: " << m_redis_context->errstr;
+        break;
+      }
       // TODO(stripeli) Need to check for error (if any) and handle it.
       freeReplyObject(redis_reply);
     }
 
     // Model Inserted into Redis Successfully. Update learner_lineage_ reference.
+    resident_bytes_ += model_info.num_bytes;
     learner_lineage_[learner_id].push_back(model_key);
 
+    if (ExceedsByteBudget(resident_bytes_)) {
+      EvictToByteBudget();
+    }
+
+  }
+
+}
+
+void RedisModelStore::ResolveTensorBlobKeys(Model *model,
+                                            std::vector<DetachedTensorValue> *detached_values) {
+
+  // The stored blobs that the values' digests refer to are fetched at once.
+  std::set<std::string> stored_keys;
+  for (const auto &detached: *detached_values) {
+    auto blob_key = TensorBlobKey(detached.digest);
+    if (tensor_blob_refs_.find(blob_key) != tensor_blob_refs_.end()) {
+      stored_keys.insert(blob_key);
+    }
+  }
+  std::map<std::string, std::string> stored_blobs;
+  FetchTensorBlobs(std::vector<std::string>(stored_keys.begin(), stored_keys.end()),
+                   &stored_blobs);
+
+  // The blobs that the model adds, along with the variable whose value
+  // each of them will hold.
+  std::map<std::string, int> added_blobs;
+  for (int index = 0; index < (int) detached_values->size(); ++index) {
+    auto &detached = (*detached_values)[index];
+    while (true) {
+      auto blob_key = TensorBlobKey(detached.digest);
+      auto added = added_blobs.find(blob_key);
+      if (added != added_blobs.end()) {
+        if ((*detached_values)[added->second].value == detached.value) break;
+      } else if (tensor_blob_refs_.find(blob_key) == tensor_blob_refs_.end()) {
+        added_blobs.emplace(blob_key, index);
+        break;
+      } else {
+        // A probed key has not been fetched along with the rest.
+        if (stored_blobs.find(blob_key) == stored_blobs.end()) {
+          FetchTensorBlobs({blob_key}, &stored_blobs);
+        }
+        if (MatchesTensorBlob(stored_blobs[blob_key], detached.value)) break;
+      }
+      detached.digest = ProbeTensorDigest(detached.digest);
+    }
+    MutableTensorSpec(model->mutable_variables(index))->set_value(detached.digest.ToBytes());
+  }
+
+}
+
+void RedisModelStore::FetchTensorBlobs(const std::vector<std::string> &blob_keys,
+                                       std::map<std::string, std::string> *blob_values) {
+
+  if (blob_keys.empty()) {
+    return;
+  }
+
+  std::vector<const char *> argv{"MGET"};
+  std::vector<size_t> argvlen{4};
+  for (const auto &blob_key: blob_keys) {
+    argv.push_back(blob_key.c_str());
+    argvlen.push_back(blob_key.length());
+    (*blob_values)[blob_key].clear();
   }
+  auto *redis_reply = (redisReply *) redisCommandArgv(m_redis_context, (int) argv.size(),
+                                                      argv.data(), argvlen.data());
+  for (auto idx = 0; redis_reply && idx < (int) redis_reply->elements; idx++) {
+    auto *blob_reply = redis_reply->element[idx];
+    if (blob_reply->type == REDIS_REPLY_STRING) {
+      (*blob_values)[blob_keys[idx]].assign(blob_reply->str, blob_reply->len);
+    } else {
+      PLOG(ERROR) << "Missing tensor blob: " << blob_keys[idx];
+    }
+  }
+  freeReplyObject(redis_reply);
 
 }
 
 void RedisModelStore::ResetState() {
   // Erase all models as they are no longer needed. Reclaim the memory.
-  PLOG(INFO) << "Removing Models! Processed Batch Size: " << m_model_store_cache.size();
-  m_model_store_cache.clear();
+  PLOG(INFO) << "Removing Models! Processed Batch Size: " << GetSelectedBytes() << " bytes.";
+  ReleaseSelectedModels();
 }
 
 std::map<std::string, std::vector<const Model *>>
@@ -137,11 +257,12 @@ RedisModelStore::SelectModels(std::vector<std::pair<std::string, int>> learner_p
 
     std::string learner_id = learner_pair.first;
     int index = learner_pair.second; // The number of models to select from store.
-    int lineage_length = GetLearnerLineageLength(learner_id);
+    auto lineage = learner_lineage_.find(learner_id);
+    int lineage_length = lineage != learner_lineage_.end() ? (int) lineage->second.size() : 0;
 
     // Check if index is less than size of
     // lineage return empty models.
-    if (index > learner_lineage_[learner_id].size()) {
+    if (index > lineage_length) {
       PLOG(WARNING) << "Index larger than lineage size";
       reply_models[learner_id].clear();
       continue;
@@ -155,6 +276,10 @@ RedisModelStore::SelectModels(std::vector<std::pair<std::string, int>> learner_p
 
     // Get the keys for the models we want to return.
     std::vector<std::string> model_keys = FindModelKeys(learner_id, index);
+    auto accessed_at = ++clock_;
+    for (const auto &model_key: model_keys) {
+      model_infos_[model_key].accessed_at = accessed_at;
+    }
 
     // Step #1: Start the Redis Transaction to submit all the queries.
     auto *redis_reply = (redisReply *) redisCommand(m_redis_context, "MULTI");
@@ -186,45 +311,58 @@ RedisModelStore::SelectModels(std::vector<std::pair<std::string, int>> learner_p
 
     // Step #4: Deserialize the model from the Redis Reply.
     // The values in the reply are stored in-order of their transaction query.
-    for (auto list_index = 0; list_index < (int) redis_reply->elements; list_index++) {
+    // Since the keys were fetched latest to oldest, we traverse the reply
+    // backwards to restore the models in committed (ascending) order.
+    std::vector<Model> selected_models;
+    selected_models.reserve(redis_reply->elements);
+    for (auto list_index = (int) redis_reply->elements - 1; list_index >= 0; list_index--) {
 
       auto *model_reply = redis_reply->element[list_index];
       Model model;
 
       for (auto idx1 = 0; idx1 < (int) model_reply->elements; idx1++) {
-        /*Parse The Serialized String into a regular String for building new Model*/
-        std::string str_construct_tensor;
-        for (auto idx2 = 0; idx2 < (int) model_reply->element[idx1]->len; idx2++) {
-          str_construct_tensor += model_reply->element[idx1]->str[idx2];
-        }
-
-        Model_Variable modelVariable;
-        modelVariable.ParseFromString(str_construct_tensor); // String //
-        (*model.add_variables()) = modelVariable;
+        model.add_variables()->ParseFromArray(model_reply->element[idx1]->str,
+                                              (int) model_reply->element[idx1]->len);
       }
-      /* We need to store the Models imported from Redis into
-      a variable that lives till batch completion. Defined in step#1 and step#2 */
-
-      // Step#1: Store into the local temp store.
-      m_model_store_cache[learner_id].push_back(model);
+      selected_models.push_back(std::move(model));
 
     }
 
     freeReplyObject(redis_reply);
 
+    // Step #5: Fetch each distinct tensor value referenced by the models once.
+    std::set<std::string> blob_keys;
+    for (const auto &model: selected_models) {
+      for (const auto &variable: model.variables()) {
+        blob_keys.insert(TensorBlobKey(GetTensorDigest(variable)));
+      }
+    }
+    std::map<std::string, std::string> blob_values;
+    FetchTensorBlobs(std::vector<std::string>(blob_keys.begin(), blob_keys.end()),
+                     &blob_values);
+    std::map<std::string, std::shared_ptr<const std::string>> blobs;
+    for (auto &[blob_key, blob_value]: blob_values) {
+      blobs[blob_key] = std::make_shared<const std::string>(std::move(blob_value));
+    }
+
+    /* We need to store the Models imported from Redis into
+    a variable that lives till batch completion (ResetState). The models
+    keep the digests of their tensor values, which are resolved (and
+    decoded) on demand; every distinct value is kept once. The models
+    of a previous selection might still be aggregated; hence, we append. */
+    for (auto &model: selected_models) {
+      std::vector<std::shared_ptr<const std::string>> model_blobs;
+      for (const auto &variable: model.variables()) {
+        model_blobs.push_back(blobs[TensorBlobKey(GetTensorDigest(variable))]);
+      }
+      reply_models[learner_id].push_back(
+          KeepSelectedModel(learner_id, std::move(model), std::move(model_blobs)));
+    }
+
     auto elapsed_model_desz_time = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::high_resolution_clock::now() - start_model_desz);
     PLOG(INFO) << "Model Desz Time " << elapsed_model_desz_time.count() << " ms";
 
-    /* Step#2: Return reference to the local temp store.
-    This formula ensures that if multiple models are required
-    they are all to be returned as pointer in correct order. */
-
-    for (auto hidx = index; hidx > 0; hidx--) {
-      const Model *ptr_latest_model = &m_model_store_cache[learner_id][lineage_length - hidx];
-      reply_models[learner_id].push_back(ptr_latest_model);
-    }
-
   }
 
   return reply_models;
@@ -244,16 +382,21 @@ std::vector<std::string> RedisModelStore::FindModelKeys(const std::string &learn
 
   std::vector<std::string> model_keys_;
 
+  auto lineage = learner_lineage_.find(learner_id);
+  if (lineage == learner_lineage_.end()) {
+    return model_keys_;
+  }
+
   // If non-positive (x <= 0): reply all model keys
   if (index <= 0) {
-    return learner_lineage_[learner_id];
+    return lineage->second;
   }
 
   // If (x>0) reply current and num-1 latest runtime metadata.
-  uint32_t last_index = learner_lineage_[learner_id].size() - 1;
+  uint32_t last_index = lineage->second.size() - 1;
   int counter = 0;
   while (counter++ < index) {
-    model_keys_.push_back(learner_lineage_[learner_id][last_index--]);
+    model_keys_.push_back(lineage->second[last_index--]);
   }
 
   return model_keys_;
@@ -293,12 +436,83 @@ void RedisModelStore::EraseModel(const std::pair<std::string, std::string> &key_
     std::string get_command = "DEL " + model_key;
     auto *redis_reply = (redisReply *) redisCommand(m_redis_context, get_command.c_str());
     freeReplyObject(redis_reply);
+    ReleaseTensorBlobs(model_key);
 
     learner_lineage_[learner_id].erase(key_to_remove);
   }
 
 }
 
+void RedisModelStore::ReleaseTensorBlobs(const std::string &model_key) {
+
+  auto model_itr = model_infos_.find(model_key);
+  if (model_itr == model_infos_.end()) {
+    return;
+  }
+
+  resident_bytes_ -= model_itr->second.num_bytes;
+  for (const auto &digest: model_itr->second.tensor_digests) {
+    auto blob_key = TensorBlobKey(digest);
+    auto ref_itr = tensor_blob_refs_.find(blob_key);
+    if (ref_itr == tensor_blob_refs_.end() || --ref_itr->second.ref_count > 0) {
+      continue;
+    }
+    resident_bytes_ -= ref_itr->second.num_bytes;
+    tensor_blob_refs_.erase(ref_itr);
+    auto *redis_reply = (redisReply *) redisCommand(m_redis_context, "DEL %b",
+                                                    blob_key.c_str(), (size_t) blob_key.length());
+    freeReplyObject(redis_reply);
+  }
+  model_infos_.erase(model_itr);
+
+}
+
+size_t RedisModelStore::GetResidentBytes() {
+  std::lock_guard<std::mutex> lock(learner_mutex);
+  return resident_bytes_;
+}
+
+void RedisModelStore::EvictToByteBudget() {
+
+  // Collect the models that can be evicted, i.e., all but the protected
+  // most recent models of every learner, and order them by eviction order.
+  bool lru_order = m_model_store_specs.byte_budget_eviction().order() ==
+      ByteBudgetEviction_Order_LEAST_RECENTLY_USED;
+  size_t protected_length = m_protected_lineage_length;
+
+  std::vector<std::tuple<uint64_t, std::string, std::string>> candidates;
+  for (const auto &[learner_id, model_keys]: learner_lineage_) {
+    if (model_keys.size() <= protected_length) continue;
+    for (size_t idx = 0; idx < model_keys.size() - protected_length; ++idx) {
+      const auto &model_info = model_infos_[model_keys[idx]];
+      candidates.emplace_back(
+          lru_order ? model_info.accessed_at : model_info.inserted_at,
+          learner_id, model_keys[idx]);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  // Evict one model at a time, since deduplicated tensors are freed
+  // only once their last reference is gone.
+  int num_evicted = 0;
+  for (const auto &[order_tick, learner_id, model_key]: candidates) {
+    if (!ExceedsByteBudget(resident_bytes_)) break;
+    EraseModel(std::pair<std::string, std::string>(learner_id, model_key));
+    ++num_evicted;
+  }
+
+  PLOG(INFO) << "Evicted " << num_evicted << " models to fit the byte budget.";
+  if (ExceedsByteBudget(resident_bytes_)) {
+    PLOG(WARNING) << "The models required for aggregation (" << resident_bytes_
+                  << " bytes) exceed the byte budget.";
+  }
+
+}
+
+std::string RedisModelStore::TensorBlobKey(const TensorDigest &digest) {
+  return "tensor_blob_" + digest.ToHex();
+}
+
 void RedisModelStore::Shutdown() {
   redisFree(m_redis_context);
   PLOG(INFO) << "Disconnected from Redis.";
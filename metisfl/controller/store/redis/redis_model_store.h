@@ -6,6 +6,7 @@
 #include "hiredis/hiredis.h"
 
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 namespace metisfl::controller {
@@ -29,6 +30,13 @@ class RedisModelStore : public ModelStore {
     return "RedisModelStore";
   }
 
+  size_t GetResidentBytes() override;
+
+  // Number of distinct tensor values currently held in Redis by this store.
+  size_t GetNumTensorBlobs() const { return tensor_blob_refs_.size(); }
+  // Number of learners whose lineage is held by this store.
+  size_t GetNumLearnerLineages() const { return learner_lineage_.size(); }
+
  private:
   // A ctr that keeps track of models key numbers. The model key is not reusable.
   std::map<std::string, int> map_model_key_counter; 
@@ -36,10 +44,58 @@ class RedisModelStore : public ModelStore {
   // Track the model_keys' associated with the learner. 
   std::map<std::string, std::vector<std::string>> learner_lineage_;
 
+  // Track the tensor digests referenced by each model key, in variable
+  // order, so that the shared tensor blobs can be released on erase, along
+  // with the bytes and the insertion/access order of the model.
+  struct StoredModelInfo {
+    std::vector<TensorDigest> tensor_digests;
+    size_t num_bytes = 0;
+    uint64_t inserted_at = 0;
+    uint64_t accessed_at = 0;
+  };
+  std::map<std::string, StoredModelInfo> model_infos_;
+
+  // Number of variables (across all stored models) referencing each blob.
+  // The reference count is kept here rather than in Redis, because this
+  // store is the only writer of its blob keys.
+  struct TensorBlobInfo {
+    uint32_t ref_count = 0;
+    size_t num_bytes = 0;
+  };
+  std::map<std::string, TensorBlobInfo> tensor_blob_refs_;
+
+  // Bytes held in Redis for all stored models, and a logical clock for
+  // the insertion and access order of the models.
+  size_t resident_bytes_ = 0;
+  uint64_t clock_ = 0;
+
   redisContext *m_redis_context = nullptr;
 
   void EraseModel(const std::pair<std::string, std::string>& key_pair);
 
+  // Decrement the reference count of the model's tensor blobs and delete
+  // the blobs that are no longer referenced.
+  void ReleaseTensorBlobs(const std::string& model_key);
+
+  // Evicts models across all learners, in the configured order, until the
+  // resident bytes are within the byte budget. The most recent (protected)
+  // models of every learner are never evicted.
+  void EvictToByteBudget();
+
+  // Redis key under which the tensor value with the given digest is stored.
+  static std::string TensorBlobKey(const TensorDigest& digest);
+
+  // Sets the digest of every detached value (and of its variable) to the
+  // key of the blob that holds the value. A stored blob is shared only if
+  // it holds the same value; a different value with the same digest is
+  // stored under a probe of the digest.
+  void ResolveTensorBlobKeys(Model* model, std::vector<DetachedTensorValue>* detached_values);
+
+  // Fetches the given tensor blobs with a single MGET. A missing blob is
+  // returned empty.
+  void FetchTensorBlobs(const std::vector<std::string>& blob_keys,
+                        std::map<std::string, std::string>* blob_values);
+
   // Retrieve the model_keys upto index specified.
   // Latest to oldest. <latest, prev, prev>
   std::vector<std::string> FindModelKeys(const std::string& learner_id, int index);
@@ -51,6 +107,8 @@ class RedisModelStore : public ModelStore {
 
   // This will restrict multiple threads/learners from inserting 
   // their models in Redis using C API as its not concurrency-safe.
+  // It guards every public operation, hence the Redis store is safe
+  // to use concurrently, though its operations are serialized.
   std::mutex learner_mutex;
 
 };
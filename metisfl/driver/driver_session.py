@@ -252,7 +252,13 @@ class DriverSessionBase(object):
         communication_specs_pb = proto_messages_factory.MetisProtoMessages.construct_communication_specs_pb(
             protocol=self.federation_environment.communication_protocol.name,
             semi_sync_lambda=self.federation_environment.communication_protocol.semi_synchronous_lambda,
-            semi_sync_recompute_num_updates=self.federation_environment.communication_protocol.semi_sync_recompute_num_updates)
+            semi_sync_recompute_num_updates=self.federation_environment.communication_protocol.semi_sync_recompute_num_updates,
+            sync_quorum_ratio=self.federation_environment.communication_protocol.sync_quorum_ratio,
+            sync_round_deadline_secs=self.federation_environment.communication_protocol.sync_round_deadline_secs,
+            async_buffer_size=self.federation_environment.communication_protocol.async_buffer_size,
+            sync_align_local_updates=self.federation_environment.communication_protocol.sync_align_local_updates,
+            async_task_budget_ms=self.federation_environment.communication_protocol.async_task_budget_ms,
+            sync_max_staleness=self.federation_environment.communication_protocol.sync_max_staleness)
         optimizer_pb_kwargs = self.federation_environment.local_model_config.optimizer_config.optimizer_pb_kwargs
         optimizer_pb = \
             proto_messages_factory.ModelProtoMessages.construct_optimizer_config_pb_from_kwargs(optimizer_pb_kwargs)
@@ -261,20 +267,31 @@ class DriverSessionBase(object):
             epochs=self.federation_environment.local_model_config.local_epochs,
             optimizer_pb=optimizer_pb,
             percent_validation=self.federation_environment.local_model_config.validation_percentage)
+        aggregation_rule = self.federation_environment.global_model_config.aggregation_rule
+        staleness_discount_pb = proto_messages_factory.MetisProtoMessages.construct_staleness_discount_pb(
+            function=aggregation_rule.aggregation_rule_staleness_discount,
+            polynomial_exponent=aggregation_rule.aggregation_rule_staleness_polynomial_exponent,
+            hinge_slope=aggregation_rule.aggregation_rule_staleness_hinge_slope,
+            hinge_threshold=aggregation_rule.aggregation_rule_staleness_hinge_threshold)
         aggregation_rule_pb = proto_messages_factory.MetisProtoMessages.construct_aggregation_rule_pb(
-            rule_name=self.federation_environment.global_model_config.aggregation_rule.aggregation_rule_name,
-            scaling_factor=self.federation_environment.global_model_config.aggregation_rule.aggregation_rule_scaling_factor,
-            stride_length=self.federation_environment.global_model_config.aggregation_rule.aggregation_rule_stride_length,
-            he_scheme_config_pb=self._controller_he_scheme_config_pb)
+            rule_name=aggregation_rule.aggregation_rule_name,
+            scaling_factor=aggregation_rule.aggregation_rule_scaling_factor,
+            stride_length=aggregation_rule.aggregation_rule_stride_length,
+            he_scheme_config_pb=self._controller_he_scheme_config_pb,
+            staleness_discount_pb=staleness_discount_pb)
         global_model_specs_pb = proto_messages_factory.MetisProtoMessages.construct_global_model_specs(
             aggregation_rule_pb=aggregation_rule_pb,
-            learners_participation_ratio=self.federation_environment.global_model_config.participation_ratio)
+            learners_participation_ratio=self.federation_environment.global_model_config.participation_ratio,
+            cohort_sampling=self.federation_environment.global_model_config.cohort_sampling,
+            min_participation_rate=self.federation_environment.global_model_config.min_participation_rate)
         model_store_config_pb = proto_messages_factory.MetisProtoMessages.construct_model_store_config_pb(
             name=self.federation_environment.model_store_config.name,
             eviction_policy=self.federation_environment.model_store_config.eviction_policy,
             lineage_length=self.federation_environment.model_store_config.eviction_lineage_length,
             store_hostname=self.federation_environment.model_store_config.connection_configs.hostname,
-            store_port=self.federation_environment.model_store_config.connection_configs.port)
+            store_port=self.federation_environment.model_store_config.connection_configs.port,
+            max_resident_bytes=self.federation_environment.model_store_config.eviction_max_resident_bytes,
+            eviction_order=self.federation_environment.model_store_config.eviction_order)
         init_controller_cmd = MetisInitServicesCmdFactory().init_controller_target(
             controller_server_entity_pb_ser=controller_server_entity_pb.SerializeToString(),
             global_model_specs_pb_ser=global_model_specs_pb.SerializeToString(),
@@ -398,20 +415,49 @@ class DriverSessionBase(object):
         learners_id = [learner.id for learner in learners_collection]
         learners_descriptors_dict = MessageToDict(learners_pb,
                                                   preserving_proto_field_name=True)
-        learners_results = self._driver_controller_grpc_client \
-            .get_local_task_lineage(-1, learners_id)
+        learners_results = self._collect_local_task_lineage(learners_id)
         learners_results_dict = MessageToDict(learners_results,
                                               preserving_proto_field_name=True)
         self._federation_statistics["learners_descriptor"] = learners_descriptors_dict
         self._federation_statistics["learners_models_results"] = learners_results_dict
 
+    def _collect_lineage(self, get_lineage_page, lineage_field, page_size=100):
+        # The lineage is retrieved page by page, so that no single reply
+        # carries the whole history of the federation. The pages are merged
+        # into the reply of the first page.
+        lineage_pb = get_lineage_page(num_backtracks=0, page_size=page_size, cursor=0)
+        cursor = lineage_pb.next_cursor
+        while True:
+            page_pb = get_lineage_page(num_backtracks=0, page_size=page_size, cursor=cursor)
+            if page_pb.next_cursor == cursor:
+                break
+            getattr(lineage_pb, lineage_field).extend(getattr(page_pb, lineage_field))
+            cursor = page_pb.next_cursor
+        return lineage_pb
+
+    def _collect_local_task_lineage(self, learners_id, page_size=100):
+        # Same as _collect_lineage, but the tasks of every learner are merged
+        # into the learner's entry of the first page.
+        get_lineage_page = self._driver_controller_grpc_client.get_local_task_lineage
+        lineage_pb = get_lineage_page(0, learners_id, page_size=page_size, cursor=0)
+        cursor = lineage_pb.next_cursor
+        while True:
+            page_pb = get_lineage_page(0, learners_id, page_size=page_size, cursor=cursor)
+            if page_pb.next_cursor == cursor:
+                break
+            for learner_id, tasks_pb in page_pb.learner_task.items():
+                lineage_pb.learner_task[learner_id].task_metadata.extend(tasks_pb.task_metadata)
+            cursor = page_pb.next_cursor
+        return lineage_pb
+
     def _collect_global_statistics(self):
-        runtime_metadata_pb = self._driver_controller_grpc_client \
-            .get_runtime_metadata(num_backtracks=0)
+        runtime_metadata_pb = self._collect_lineage(
+            self._driver_controller_grpc_client.get_runtime_metadata, "metadata")
         runtime_metadata_dict = MessageToDict(runtime_metadata_pb,
                                               preserving_proto_field_name=True)
-        community_results = self._driver_controller_grpc_client \
-            .get_community_model_evaluation_lineage(-1)
+        community_results = self._collect_lineage(
+            self._driver_controller_grpc_client.get_community_model_evaluation_lineage,
+            "community_evaluation")
         community_results_dict = MessageToDict(community_results,
                                                preserving_proto_field_name=True)
         self._federation_statistics["federation_runtime_metadata"] = runtime_metadata_dict
@@ -435,8 +481,9 @@ class DriverSessionBase(object):
                 # ping controller for latest execution stats
                 time.sleep(request_every_secs)
 
+                # The most recent runtime metadata refer to the current global iteration.
                 metadata_pb = self._driver_controller_grpc_client \
-                    .get_runtime_metadata(num_backtracks=0).metadata
+                    .get_runtime_metadata(num_backtracks=1).metadata
 
                 # First condition is to check if we reached the desired
                 # number of federation rounds for synchronous execution.
@@ -1,7 +1,10 @@
 import cloudpickle
+import functools
 import gc
+import grpc
 import queue
 import os
+import threading
 
 import multiprocessing as mp
 import metisfl.utils.proto_messages_factory as proto_factory
@@ -101,6 +104,15 @@ class Learner(object):
         # TODO(stripeli): if we want to be more secure, we can dump an encrypted version of auth_token and learner_id
         self.__learner_id_fp = os.path.join(self.__learner_credentials_fp, "learner_id.txt")
         self.__auth_token_fp = os.path.join(self.__learner_credentials_fp, "auth_token.txt")
+        # The most recently fetched community model. A newer community model is fetched
+        # as a delta against it, since consecutive community models differ little.
+        self._community_model_lock = threading.Lock()
+        self._community_model_version = 0
+        self._community_model_pb = None
+        # Once the learner has joined the federation, it sends heartbeats to the controller
+        # through a background thread, at the interval the controller asks for.
+        self._heartbeat_thread = None
+        self._heartbeat_stop = threading.Event()
 
     def __getstate__(self):
         """
@@ -118,6 +130,10 @@ class Learner(object):
         del self_dict['_inference_tasks_pool']
         del self_dict['_inference_tasks_futures_q']
         del self_dict['_learner_controller_client']
+        del self_dict['_community_model_lock']
+        del self_dict['_community_model_pb']
+        del self_dict['_heartbeat_thread']
+        del self_dict['_heartbeat_stop']
         return self_dict
 
     def _empty_tasks_q(self, future_tasks_q, forceful=False):
@@ -194,12 +210,19 @@ class Learner(object):
         _generic_tasks_pool.join()
         return res
 
-    def _mark_learning_task_completed(self, training_future):
+    def _mark_learning_task_completed(self, training_future, evaluation_future=None):
         # If the returned future was completed successfully and was not cancelled,
         # meaning it did complete its running job, then notify the controller.
         if training_future.done() and not training_future.cancelled():
             completed_task_pb = training_future.result()
-            self._learner_controller_client.mark_task_completed(
+            if evaluation_future is not None and not evaluation_future.cancelled():
+                # The evaluations of the federated model are reported along with the completed task.
+                try:
+                    completed_task_pb.federated_model_evaluations.CopyFrom(evaluation_future.result())
+                except Exception as e:
+                    MetisLogger.error("Learner {} failed to evaluate the federated model: {}"
+                                      .format(self.host_port_identifier(), e))
+            self._learner_controller_client.mark_task_completed_stream(
                 learner_id=self.__learner_id,
                 auth_token=self.__auth_token,
                 completed_task_pb=completed_task_pb,
@@ -269,9 +292,51 @@ class Learner(object):
                                                             test_dataset_meta[1],
                                                             is_classification,
                                                             is_regression)
+        if status and self._heartbeat_thread is None:
+            self._heartbeat_thread = threading.Thread(target=self._send_heartbeats, daemon=True)
+            self._heartbeat_thread.start()
         return status
 
+    def _send_heartbeats(self):
+        # The first heartbeat is sent right after joining the federation. Its response carries
+        # the interval of the next heartbeats; if the interval is 0, the controller does not
+        # track the learners' liveness and no more heartbeats are sent.
+        interval_secs = 1
+        while True:
+            try:
+                response = self._learner_controller_client.learner_heartbeat(
+                    self.__learner_id, self.__auth_token, request_timeout=interval_secs)
+                if response.heartbeat_interval_secs == 0:
+                    return
+                interval_secs = response.heartbeat_interval_secs
+            except grpc.RpcError as rpc_error:
+                if rpc_error.code() == grpc.StatusCode.NOT_FOUND:
+                    # The controller evicted the learner, e.g., after a network partition.
+                    MetisLogger.warning("Learner {} was evicted from the federation, re-joining."
+                                        .format(self.host_port_identifier()))
+                    self.join_federation()
+                else:
+                    MetisLogger.warning("Heartbeat of learner {} failed: {}"
+                                        .format(self.host_port_identifier(), rpc_error))
+            if self._heartbeat_stop.wait(interval_secs):
+                return
+
+    def fetch_community_model(self, version):
+        # Blocking call. The community model is streamed by the controller in chunks.
+        with self._community_model_lock:
+            if version == self._community_model_version:
+                return self._community_model_pb
+            self._community_model_pb = self._learner_controller_client.fetch_community_model(
+                learner_id=self.__learner_id,
+                auth_token=self.__auth_token,
+                version=version,
+                base_version=self._community_model_version,
+                base_model_pb=self._community_model_pb.model if self._community_model_pb else None)
+            self._community_model_version = version
+            return self._community_model_pb
+
     def leave_federation(self):
+        self._heartbeat_stop.set()
         status = self._learner_controller_client.leave_federation(self.__learner_id, self.__auth_token, block=False)
         # Make sure that all pending tasks have been processed.
         self._learner_controller_client.shutdown()
@@ -375,9 +440,23 @@ class Learner(object):
 
     def run_learning_task(self, learning_task_pb: metis_pb2.LearningTask,
                           hyperparameters_pb: metis_pb2.Hyperparameters, model_pb: model_pb2.Model,
-                          cancel_running_tasks=False, block=False, verbose=False):
+                          evaluate_model=False, cancel_running_tasks=False, block=False, verbose=False):
         # If `cancel_running_tasks` is True, we perform a forceful shutdown of running tasks, else graceful.
         self._empty_tasks_q(future_tasks_q=self._training_tasks_futures_q, forceful=cancel_running_tasks)
+        # If requested, the received model is also evaluated on all local datasets (in the evaluation
+        # pool, while training), and the evaluations are sent to the controller with the completed task.
+        evaluation_future = None
+        if evaluate_model:
+            self._empty_tasks_q(future_tasks_q=self._evaluation_tasks_futures_q, forceful=False)
+            evaluation_datasets_pb = [
+                learner_pb2.EvaluateModelRequest.dataset_to_eval.TRAINING,
+                learner_pb2.EvaluateModelRequest.dataset_to_eval.VALIDATION,
+                learner_pb2.EvaluateModelRequest.dataset_to_eval.TEST]
+            evaluation_future = self._evaluation_tasks_pool.schedule(
+                function=self.model_evaluate,
+                args=[model_pb, hyperparameters_pb.batch_size, evaluation_datasets_pb,
+                      metis_pb2.EvaluationMetrics(), verbose])
+            self._evaluation_tasks_futures_q.put(evaluation_future)
         # Submit the learning/training task to the Process Pool and add a callback to send the
         # trained local model to the controller when the learning task is complete. Given that
         # local training could span from seconds to hours, we cannot keep the grpc connection
@@ -387,7 +466,8 @@ class Learner(object):
             function=self.model_train,
             args=[learning_task_pb, hyperparameters_pb, model_pb, verbose])
         # The following callback will trigger the request to the controller to receive the next task.
-        future.add_done_callback(self._mark_learning_task_completed)
+        future.add_done_callback(functools.partial(
+            self._mark_learning_task_completed, evaluation_future=evaluation_future))
         self._training_tasks_futures_q.put(future)
         if block:
             future.result()
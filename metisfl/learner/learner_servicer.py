@@ -90,6 +90,9 @@ class LearnerServicer(learner_pb2_grpc.LearnerServiceServicer):
             self.__grpc_server.grpc_endpoint.listening_endpoint))
         self.__community_models_received += 1
         federated_model = request.federated_model
+        if request.federated_model_version:
+            # The controller sent only the version of the community model to train on.
+            federated_model = self.learner.fetch_community_model(request.federated_model_version)
         num_contributors = federated_model.num_contributors
         model_pb = federated_model.model
         learning_task_pb = request.task
@@ -99,6 +102,7 @@ class LearnerServicer(learner_pb2_grpc.LearnerServiceServicer):
         # of a new training task the learner needs to cancel all running training tasks.
         is_task_submitted = self.learner.run_learning_task(
             learning_task_pb, hyperparameters_pb, model_pb,
+            evaluate_model=request.evaluate_federated_model,
             cancel_running_tasks=True,
             block=False,
             verbose=True)
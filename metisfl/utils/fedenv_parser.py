@@ -42,6 +42,29 @@ class CommunicationProtocol(object):
         if self.specifications and self.is_semi_synchronous:
             self.semi_synchronous_lambda = self.specifications.get("SemiSynchronousLambda", None)
             self.semi_sync_recompute_num_updates = self.specifications.get("SemiSynchronousRecomputeSteps", None)
+        # A (semi-)synchronous round can be released before all learners complete their task,
+        # once a quorum of the learners have completed it or once the round deadline has passed.
+        self.sync_quorum_ratio, self.sync_round_deadline_secs = None, None
+        if self.specifications and not self.is_asynchronous:
+            self.sync_quorum_ratio = self.specifications.get("SynchronousQuorumRatio", None)
+            self.sync_round_deadline_secs = self.specifications.get("SynchronousRoundDeadlineSecs", None)
+        # A synchronous federation can assign the learners' local updates based on their throughput,
+        # so that all learners are predicted to complete their task along with the slowest learner.
+        self.sync_align_local_updates = None
+        if self.specifications and self.is_synchronous:
+            self.sync_align_local_updates = self.specifications.get("SynchronousAlignLocalUpdates", None)
+        # A synchronous federation can pipeline its rounds, so that the learners that complete their task
+        # run ahead on the next rounds, at most the given number of rounds, while the round awaits the rest.
+        self.sync_max_staleness = None
+        if self.specifications and self.is_synchronous:
+            self.sync_max_staleness = self.specifications.get("SynchronousMaxStaleness", None)
+        # An asynchronous federation aggregates the learners' updates in batches of the given buffer size,
+        # and can assign the learners' local updates based on their throughput, so that every task takes
+        # the given budget.
+        self.async_buffer_size, self.async_task_budget_ms = None, None
+        if self.specifications and self.is_asynchronous:
+            self.async_buffer_size = self.specifications.get("AsynchronousBufferSize", None)
+            self.async_task_budget_ms = self.specifications.get("AsynchronousTaskBudgetMs", None)
 
 
 class FHEScheme(object):
@@ -61,6 +84,15 @@ class AggregationRule(object):
             self.aggregation_rule_specifications.get("ScalingFactor", None)
         self.aggregation_rule_stride_length = \
             self.aggregation_rule_specifications.get("StrideLength", -1)
+        # The models can be discounted by their staleness, polynomially or with a hinge function.
+        self.aggregation_rule_staleness_discount = \
+            self.aggregation_rule_specifications.get("StalenessDiscount", None)
+        self.aggregation_rule_staleness_polynomial_exponent = \
+            self.aggregation_rule_specifications.get("StalenessPolynomialExponent", None)
+        self.aggregation_rule_staleness_hinge_slope = \
+            self.aggregation_rule_specifications.get("StalenessHingeSlope", None)
+        self.aggregation_rule_staleness_hinge_threshold = \
+            self.aggregation_rule_specifications.get("StalenessHingeThreshold", None)
 
     def __str__(self):
         return """ RuleName: {}, RuleScalingFactor: {}, RuleStrideLength: {} """.format(
@@ -74,6 +106,10 @@ class GlobalModelConfig(object):
     def __init__(self, global_model_map):
         self.aggregation_rule = AggregationRule(global_model_map.get("AggregationRule", None))
         self.participation_ratio = global_model_map.get("ParticipationRatio", 1)
+        # How the learners participating in a round are sampled, if the participation ratio is less than 1.
+        self.cohort_sampling = global_model_map.get("CohortSampling", "Uniform")
+        # The minimum fraction of the rounds in which every learner participates, if the fastest learners are sampled.
+        self.min_participation_rate = global_model_map.get("MinParticipationRate", None)
 
 
 class LocalModelConfig(object):
@@ -92,11 +128,15 @@ class ModelStoreConfig(object):
             self.name = "InMemory"
             self.eviction_policy = "LineageLengthEviction"
             self.eviction_lineage_length = 1
+            self.eviction_max_resident_bytes = None
+            self.eviction_order = None
             self.connection_configs = ConnectionConfigsBase({})
         else:
             self.name = model_store_map.get("Name", None)
             self.eviction_policy = model_store_map.get("EvictionPolicy")
             self.eviction_lineage_length = model_store_map.get("LineageLength", 1)
+            self.eviction_max_resident_bytes = model_store_map.get("MaxResidentBytes", None)
+            self.eviction_order = model_store_map.get("EvictionOrder", None)
             self.connection_configs = ConnectionConfigsBase(model_store_map.get("ConnectionConfigs", {}))
 
 
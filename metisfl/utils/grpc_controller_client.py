@@ -3,9 +3,15 @@ import grpc
 import metisfl.utils.proto_messages_factory as proto_factory
 
 from metisfl.utils.metis_logger import MetisLogger
+from metisfl.utils.model_delta import apply_model_delta
 from metisfl.utils.grpc_services import GRPCServerClient
 from metisfl.utils.ssl_configurator import SSLConfigurator
-from metisfl.proto import controller_pb2_grpc
+from metisfl.proto import controller_pb2_grpc, model_pb2
+
+
+# The size of every chunk of a local model that is uploaded to the controller. Same as the
+# size of the community model chunks sent by the controller.
+_MODEL_CHUNK_BYTES = 1 << 20
 
 
 class GRPCControllerClient(GRPCServerClient):
@@ -13,6 +19,8 @@ class GRPCControllerClient(GRPCServerClient):
     def __init__(self, controller_server_entity, max_workers=1):
         super(GRPCControllerClient, self).__init__(controller_server_entity, max_workers)
         self._stub = controller_pb2_grpc.ControllerServiceStub(self._channel)
+        # Whether the controller accepts local models as a stream of chunks.
+        self._streams_completed_tasks = True
 
     def check_health_status(self, request_retries=1, request_timeout=None, block=True):
         def _request(_timeout=None):
@@ -119,6 +127,13 @@ class GRPCControllerClient(GRPCServerClient):
         else:
             self.executor_pool.put(future)
 
+    def learner_heartbeat(self, learner_id, auth_token, request_timeout=None):
+        # The heartbeat is sent right away rather than through the executor, so that it is
+        # not queued behind a (long-running) upload of the learner's local model.
+        learner_heartbeat_request_pb = proto_factory.ControllerServiceProtoMessages \
+            .construct_learner_heartbeat_request_pb(learner_id=learner_id, auth_token=auth_token)
+        return self._stub.LearnerHeartbeat(learner_heartbeat_request_pb, timeout=request_timeout)
+
     def leave_federation(self, learner_id, auth_token, request_retries=1, request_timeout=None, block=True):
         def _request(_timeout=None):
             leave_federation_request_pb = proto_factory.ControllerServiceProtoMessages \
@@ -162,12 +177,123 @@ class GRPCControllerClient(GRPCServerClient):
         else:
             self.executor_pool.put(future)
 
-    def get_community_model_evaluation_lineage(self, num_backtracks,
+    def mark_task_completed_stream(self, learner_id, auth_token, completed_task_pb,
+                                   request_retries=1, request_timeout=None, block=True):
+        # Same as mark_task_completed, but the local model is sent as a sequence of chunks, hence
+        # it is not bound by the maximum gRPC message size. If the controller does not support
+        # the streaming upload, the task is sent with the unary request instead.
+        def _request(_timeout=None):
+            MetisLogger.info("Sending local completed task, learner {}.".format(learner_id))
+            response = None
+            if self._streams_completed_tasks:
+                mark_task_completed_chunks_pb = proto_factory.ControllerServiceProtoMessages \
+                    .construct_mark_task_completed_chunks_pb(learner_id=learner_id,
+                                                             auth_token=auth_token,
+                                                             completed_learning_task_pb=completed_task_pb,
+                                                             max_chunk_bytes=_MODEL_CHUNK_BYTES)
+                try:
+                    response = self._stub.MarkTaskCompletedStream(mark_task_completed_chunks_pb,
+                                                                  timeout=_timeout)
+                except grpc.RpcError as rpc_error:
+                    if rpc_error.code() != grpc.StatusCode.UNIMPLEMENTED:
+                        raise
+                    MetisLogger.warning("Controller does not support streamed local models, "
+                                        "falling back to unary requests.")
+                    self._streams_completed_tasks = False
+            if response is None:
+                mark_task_completed_request_pb = proto_factory.ControllerServiceProtoMessages \
+                    .construct_mark_task_completed_request_pb(learner_id=learner_id,
+                                                              auth_token=auth_token,
+                                                              completed_learning_task_pb=completed_task_pb)
+                response = self._stub.MarkTaskCompleted(mark_task_completed_request_pb, timeout=_timeout)
+            MetisLogger.info("Sent local completed task, learner {}.".format(learner_id))
+            return response
+
+        if request_retries > 1:
+            future = self.executor.schedule(function=self.request_with_timeout,
+                                            args=(_request, request_timeout, request_retries))
+        else:
+            future = self.executor.schedule(_request)
+
+        if block:
+            return future.result()
+        else:
+            self.executor_pool.put(future)
+
+    def fetch_community_model(self, learner_id, auth_token, version, base_version=0, base_model_pb=None,
+                              request_retries=1, request_timeout=None, block=True):
+        def _fetch(_base_version, _timeout=None):
+            fetch_community_model_request_pb = proto_factory.ControllerServiceProtoMessages \
+                .construct_fetch_community_model_request_pb(learner_id=learner_id,
+                                                            auth_token=auth_token,
+                                                            version=version,
+                                                            base_version=_base_version)
+            MetisLogger.info("Fetching community model version {}, learner {}.".format(version, learner_id))
+            # The model is received as a sequence of chunks, which are deserialized while the rest
+            # of the model is still being received. A variable whose value exceeds a single chunk
+            # is split across consecutive chunks, hence its value parts are joined once complete.
+            federated_model_pb = model_pb2.FederatedModel()
+            delta_base_version = 0
+            variable_value_parts = []
+
+            def _tensor_spec(variable_pb):
+                return getattr(variable_pb, variable_pb.WhichOneof("tensor")).tensor_spec
+
+            def _join_variable_value():
+                if variable_value_parts:
+                    _tensor_spec(federated_model_pb.model.variables[-1]).value = b"".join(variable_value_parts)
+                    variable_value_parts.clear()
+
+            for chunk_pb in self._stub.FetchCommunityModel(fetch_community_model_request_pb, timeout=_timeout):
+                if chunk_pb.HasField("federated_model"):
+                    delta_base_version = chunk_pb.delta_base_version
+                    federated_model_pb.num_contributors = chunk_pb.federated_model.num_contributors
+                    federated_model_pb.global_iteration = chunk_pb.federated_model.global_iteration
+                    continue
+                model_chunk_pb = chunk_pb.model_chunk
+                if model_chunk_pb.continues_variable:
+                    if not variable_value_parts:
+                        variable_value_parts.append(_tensor_spec(federated_model_pb.model.variables[-1]).value)
+                    variable_value_parts.append(_tensor_spec(model_chunk_pb.variables[0]).value)
+                    continue
+                _join_variable_value()
+                federated_model_pb.model.variables.extend(model_chunk_pb.variables)
+            _join_variable_value()
+            return federated_model_pb, delta_base_version
+
+        def _request(_timeout=None):
+            federated_model_pb, delta_base_version = _fetch(base_version, _timeout)
+            if delta_base_version and (delta_base_version != base_version or base_model_pb is None):
+                # The delta does not apply to the model the learner holds, hence the full model is fetched.
+                MetisLogger.warning("Community model version {} was sent as a delta against version {} "
+                                    "instead of {}, learner {}. Fetching the full model."
+                                    .format(version, delta_base_version, base_version, learner_id))
+                federated_model_pb, delta_base_version = _fetch(0, _timeout)
+            if delta_base_version:
+                # The controller sent the model as a delta against the model the learner holds.
+                apply_model_delta(base_model_pb, federated_model_pb.model)
+            MetisLogger.info("Fetched community model version {}, learner {}.".format(version, learner_id))
+            return federated_model_pb
+
+        if request_retries > 1:
+            future = self.executor.schedule(function=self.request_with_timeout,
+                                            args=(_request, request_timeout, request_retries))
+        else:
+            future = self.executor.schedule(_request)
+
+        if block:
+            return future.result()
+        else:
+            self.executor_pool.put(future)
+
+    def get_community_model_evaluation_lineage(self, num_backtracks, page_size=0, cursor=0,
                                                request_retries=1, request_timeout=None, block=True):
         def _request(_timeout=None):
             get_community_model_evaluation_lineage_request_pb = \
                 proto_factory.ControllerServiceProtoMessages\
-                    .construct_get_community_model_evaluation_lineage_request_pb(num_backtracks)
+                    .construct_get_community_model_evaluation_lineage_request_pb(num_backtracks,
+                                                                                 page_size=page_size,
+                                                                                 cursor=cursor)
             MetisLogger.info("Requesting community model evaluation lineage for {} backtracks.".format(num_backtracks))
             response = self._stub.GetCommunityModelEvaluationLineage(
                 get_community_model_evaluation_lineage_request_pb, timeout=_timeout)
@@ -185,13 +311,15 @@ class GRPCControllerClient(GRPCServerClient):
         else:
             self.executor_pool.put(future)
 
-    def get_local_task_lineage(self, num_backtracks, learner_ids,
+    def get_local_task_lineage(self, num_backtracks, learner_ids, page_size=0, cursor=0,
                                request_retries=1, request_timeout=None, block=True):
         def _request(_timeout=None):
             get_local_task_lineage_request_pb = \
                 proto_factory.ControllerServiceProtoMessages \
                     .construct_get_local_task_lineage_request_pb(num_backtracks=num_backtracks,
-                                                                 learner_ids=learner_ids)
+                                                                 learner_ids=learner_ids,
+                                                                 page_size=page_size,
+                                                                 cursor=cursor)
             MetisLogger.info("Requesting local model evaluation lineage for {} backtracks.".format(num_backtracks))
             response = self._stub.GetLocalTaskLineage(
                 get_local_task_lineage_request_pb, timeout=_timeout)
@@ -229,11 +357,14 @@ class GRPCControllerClient(GRPCServerClient):
         else:
             self.executor_pool.put(future)
 
-    def get_runtime_metadata(self, num_backtracks, request_retries=1, request_timeout=None, block=True):
+    def get_runtime_metadata(self, num_backtracks, page_size=0, cursor=0,
+                             request_retries=1, request_timeout=None, block=True):
         def _request(_timeout=None):
             get_runtime_metadata_pb = \
                 proto_factory.ControllerServiceProtoMessages\
-                  .construct_get_runtime_metadata_lineage_request_pb(num_backtracks=num_backtracks)
+                  .construct_get_runtime_metadata_lineage_request_pb(num_backtracks=num_backtracks,
+                                                                     page_size=page_size,
+                                                                     cursor=cursor)
             MetisLogger.info("Requesting runtime metadata lineage.")
             response = self._stub.GetRuntimeMetadataLineage(get_runtime_metadata_pb, timeout=_timeout)
             MetisLogger.info("Received runtime metadata lineage.")
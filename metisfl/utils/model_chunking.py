@@ -0,0 +1,55 @@
+from metisfl.proto import model_pb2
+
+
+def _tensor_field(variable_pb):
+    return variable_pb.WhichOneof("tensor")
+
+
+def split_model_into_chunks(model_pb, max_chunk_bytes):
+    """
+    Splits the model into chunks, in variables order, such that the encoded size of every
+    chunk is about max_chunk_bytes or less (see model_chunking.cc). Variables are kept whole
+    whenever they fit into a chunk; a larger variable is split into a first chunk and
+    consecutive continuation chunks (see ModelChunk). The chunks are generated one at a time,
+    hence at most one chunk is held in memory on top of the model.
+    """
+    chunk_pb = None
+    chunk_bytes = 0
+    for variable_pb in model_pb.variables:
+        variable_bytes = variable_pb.ByteSize()
+        if chunk_pb is None or (chunk_bytes > 0 and chunk_bytes + variable_bytes > max_chunk_bytes):
+            if chunk_pb is not None:
+                yield chunk_pb
+            chunk_pb, chunk_bytes = model_pb2.ModelChunk(), 0
+
+        if variable_bytes <= max_chunk_bytes:
+            chunk_pb.variables.add().CopyFrom(variable_pb)
+            chunk_bytes += variable_bytes
+            continue
+
+        # The variable does not fit into a single chunk. The first chunk carries the
+        # variable's structure along with the first part of the value, and every
+        # continuation chunk carries only the next part of the value.
+        tensor_field = _tensor_field(variable_pb)
+        tensor_spec_pb = getattr(variable_pb, tensor_field).tensor_spec
+        value = tensor_spec_pb.value
+        part_bytes = max(max_chunk_bytes, 1)
+
+        head_pb = chunk_pb.variables.add(name=variable_pb.name, trainable=variable_pb.trainable)
+        head_spec_pb = getattr(head_pb, tensor_field).tensor_spec
+        head_spec_pb.length = tensor_spec_pb.length
+        head_spec_pb.dimensions.extend(tensor_spec_pb.dimensions)
+        head_spec_pb.type.CopyFrom(tensor_spec_pb.type)
+        head_spec_pb.value = value[:part_bytes]
+
+        for offset in range(part_bytes, len(value), part_bytes):
+            yield chunk_pb
+            chunk_pb = model_pb2.ModelChunk(continues_variable=True)
+            getattr(chunk_pb.variables.add(), tensor_field).tensor_spec.value = \
+                value[offset:offset + part_bytes]
+
+        # The next variable starts a new chunk.
+        chunk_bytes = max_chunk_bytes
+
+    if chunk_pb is not None:
+        yield chunk_pb
@@ -0,0 +1,56 @@
+import struct
+import zlib
+
+import numpy as np
+
+# Every compressed tensor value starts with a fixed-size header (see tensor_compression.cc):
+#   [codec: 1 byte][element width: 1 byte][uncompressed size: 8 bytes]
+_HEADER_SIZE = 10
+_CODEC_RAW = 0
+_CODEC_SHUFFLE_DEFLATE = 1
+
+
+def _tensor_spec(variable_pb):
+    return getattr(variable_pb, variable_pb.WhichOneof("tensor")).tensor_spec
+
+
+def _decompress_tensor_value(compressed):
+    codec, width = compressed[0], compressed[1]
+    size, = struct.unpack_from("<Q", compressed, 2)
+    if codec == _CODEC_RAW:
+        value = compressed[_HEADER_SIZE:]
+    elif codec == _CODEC_SHUFFLE_DEFLATE:
+        value = zlib.decompress(compressed[_HEADER_SIZE:])
+        if width > 1:
+            # Regroups the i-th byte of every element back with the element. Trailing
+            # bytes that do not form a whole element were not shuffled.
+            shuffled = np.frombuffer(value, dtype=np.uint8)
+            shuffled_bytes = (size // width) * width
+            unshuffled = shuffled.copy()
+            unshuffled[:shuffled_bytes] = shuffled[:shuffled_bytes].reshape(width, -1).T.reshape(-1)
+            value = unshuffled.tobytes()
+    else:
+        raise ValueError("Unknown tensor value codec: {}".format(codec))
+    if len(value) != size:
+        raise ValueError("Malformed compressed tensor value.")
+    return value
+
+
+def apply_model_delta(base_model_pb, delta_model_pb):
+    """
+    Restores in place the model that the controller encoded as a delta against the base model,
+    i.e., the value of every variable is the compressed XOR of the value of the model's variable
+    and the value of the base model's variable (see controller/common/model_delta.h).
+    """
+    if len(base_model_pb.variables) != len(delta_model_pb.variables):
+        raise ValueError("Model delta does not match the base model.")
+    for base_variable_pb, variable_pb in zip(base_model_pb.variables, delta_model_pb.variables):
+        base_value = _tensor_spec(base_variable_pb).value
+        tensor_spec = _tensor_spec(variable_pb)
+        xor_value = _decompress_tensor_value(tensor_spec.value)
+        if len(xor_value) != len(base_value):
+            raise ValueError("Model delta does not match the base model.")
+        tensor_spec.value = np.bitwise_xor(
+            np.frombuffer(xor_value, dtype=np.uint8),
+            np.frombuffer(base_value, dtype=np.uint8)).tobytes()
+    return delta_model_pb
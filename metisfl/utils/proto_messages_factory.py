@@ -4,22 +4,38 @@ import sys
 import numpy as np
 
 from metisfl.proto import controller_pb2, learner_pb2, model_pb2, metis_pb2, service_common_pb2
+from metisfl.utils.model_chunking import split_model_into_chunks
 
 
 class ControllerServiceProtoMessages(object):
 
     @classmethod
-    def construct_get_community_model_evaluation_lineage_request_pb(cls, num_backtracks):
-        return controller_pb2.GetCommunityModelEvaluationLineageRequest(num_backtracks=num_backtracks)
+    def construct_fetch_community_model_request_pb(cls, learner_id, auth_token, version, base_version=0):
+        return controller_pb2.FetchCommunityModelRequest(learner_id=learner_id,
+                                                         auth_token=auth_token,
+                                                         version=version,
+                                                         base_version=base_version)
 
     @classmethod
-    def construct_get_local_task_lineage_request_pb(cls, num_backtracks, learner_ids):
+    def construct_get_community_model_evaluation_lineage_request_pb(cls, num_backtracks,
+                                                                    page_size=0, cursor=0):
+        return controller_pb2.GetCommunityModelEvaluationLineageRequest(num_backtracks=num_backtracks,
+                                                                        page_size=page_size,
+                                                                        cursor=cursor)
+
+    @classmethod
+    def construct_get_local_task_lineage_request_pb(cls, num_backtracks, learner_ids,
+                                                    page_size=0, cursor=0):
         return controller_pb2.GetLocalTaskLineageRequest(num_backtracks=num_backtracks,
-                                                         learner_ids=learner_ids)
+                                                         learner_ids=learner_ids,
+                                                         page_size=page_size,
+                                                         cursor=cursor)
 
     @classmethod
-    def construct_get_runtime_metadata_lineage_request_pb(cls, num_backtracks):
-        return controller_pb2.GetRuntimeMetadataLineageRequest(num_backtracks=num_backtracks)
+    def construct_get_runtime_metadata_lineage_request_pb(cls, num_backtracks, page_size=0, cursor=0):
+        return controller_pb2.GetRuntimeMetadataLineageRequest(num_backtracks=num_backtracks,
+                                                               page_size=page_size,
+                                                               cursor=cursor)
 
     @classmethod
     def construct_get_participating_learners_request_pb(cls):
@@ -30,6 +46,10 @@ class ControllerServiceProtoMessages(object):
         return controller_pb2.JoinFederationRequest(server_entity=server_entity_pb,
                                                     local_dataset_spec=local_dataset_spec_pb)
 
+    @classmethod
+    def construct_learner_heartbeat_request_pb(cls, learner_id, auth_token):
+        return controller_pb2.LearnerHeartbeatRequest(learner_id=learner_id, auth_token=auth_token)
+
     @classmethod
     def construct_leave_federation_request_pb(cls, learner_id, auth_token):
         return controller_pb2.LeaveFederationRequest(learner_id=learner_id, auth_token=auth_token)
@@ -40,6 +60,26 @@ class ControllerServiceProtoMessages(object):
                                                        auth_token=auth_token,
                                                        task=completed_learning_task_pb)
 
+    @classmethod
+    def construct_mark_task_completed_chunks_pb(cls, learner_id, auth_token, completed_learning_task_pb,
+                                                max_chunk_bytes):
+        # The first message carries the task without its model, and every following
+        # message the next chunk of the model. The task's model is not copied.
+        first_chunk_pb = controller_pb2.MarkTaskCompletedChunk()
+        first_chunk_pb.request.learner_id = learner_id
+        first_chunk_pb.request.auth_token = auth_token
+        task_pb = first_chunk_pb.request.task
+        for field_descriptor, value in completed_learning_task_pb.ListFields():
+            if field_descriptor.name == "model":
+                continue
+            if field_descriptor.message_type is not None:
+                getattr(task_pb, field_descriptor.name).CopyFrom(value)
+            else:
+                setattr(task_pb, field_descriptor.name, value)
+        yield first_chunk_pb
+        for model_chunk_pb in split_model_into_chunks(completed_learning_task_pb.model, max_chunk_bytes):
+            yield controller_pb2.MarkTaskCompletedChunk(model_chunk=model_chunk_pb)
+
     @classmethod
     def construct_replace_community_model_request_pb(cls, federated_model_pb):
         assert isinstance(federated_model_pb, model_pb2.FederatedModel)
@@ -259,12 +299,72 @@ class MetisProtoMessages(object):
     @classmethod
     def construct_controller_params_pb(cls, server_entity_pb, global_model_specs_pb,
                                        communication_specs_pb, model_store_config_pb,
-                                       model_hyperparams_pb):
+                                       model_hyperparams_pb, checkpoint_specs_pb=None,
+                                       servicer_specs_pb=None, lineage_specs_pb=None,
+                                       liveness_specs_pb=None):
         return metis_pb2.ControllerParams(server_entity=server_entity_pb,
                                           global_model_specs=global_model_specs_pb,
                                           communication_specs=communication_specs_pb,
                                           model_store_config=model_store_config_pb,
-                                          model_hyperparams=model_hyperparams_pb)
+                                          model_hyperparams=model_hyperparams_pb,
+                                          checkpoint_specs=checkpoint_specs_pb,
+                                          servicer_specs=servicer_specs_pb,
+                                          lineage_specs=lineage_specs_pb,
+                                          liveness_specs=liveness_specs_pb)
+
+    @classmethod
+    def construct_checkpoint_specs_pb(cls, checkpoint_dir=None, checkpoint_interval=None):
+        if checkpoint_interval is None:
+            checkpoint_interval = 1
+        assert checkpoint_interval > 0, "Checkpoint interval value needs to be positive!"
+        return metis_pb2.CheckpointSpecs(checkpoint_dir=checkpoint_dir,
+                                         checkpoint_interval=checkpoint_interval)
+
+    @classmethod
+    def construct_servicer_specs_pb(cls, num_control_workers=None, num_model_workers=None):
+        # If not set (0), the controller picks the number of workers.
+        if num_control_workers is None:
+            num_control_workers = 0
+        if num_model_workers is None:
+            num_model_workers = 0
+        assert num_control_workers >= 0, "Number of control workers cannot be negative!"
+        assert num_model_workers >= 0, "Number of model workers cannot be negative!"
+        return metis_pb2.ServicerSpecs(num_control_workers=num_control_workers,
+                                       num_model_workers=num_model_workers)
+
+    @classmethod
+    def construct_lineage_specs_pb(cls, max_retained_rounds=None, max_retained_local_tasks=None,
+                                   spill_dir=None):
+        # If not set (0), the controller picks the number of retained entries.
+        if max_retained_rounds is None:
+            max_retained_rounds = 0
+        if max_retained_local_tasks is None:
+            max_retained_local_tasks = 0
+        if spill_dir is None:
+            spill_dir = ""
+        assert max_retained_rounds >= 0, "Number of retained rounds cannot be negative!"
+        assert max_retained_local_tasks >= 0, "Number of retained local tasks cannot be negative!"
+        return metis_pb2.LineageSpecs(max_retained_rounds=max_retained_rounds,
+                                      max_retained_local_tasks=max_retained_local_tasks,
+                                      spill_dir=spill_dir)
+
+    @classmethod
+    def construct_liveness_specs_pb(cls, heartbeat_interval_secs=None, suspect_after_missed_beats=None,
+                                    dead_after_missed_beats=None):
+        # If the heartbeat interval is not set (0), the learners' liveness is not tracked.
+        # If the missed heartbeats are not set (0), the controller picks their number.
+        if heartbeat_interval_secs is None:
+            heartbeat_interval_secs = 0
+        if suspect_after_missed_beats is None:
+            suspect_after_missed_beats = 0
+        if dead_after_missed_beats is None:
+            dead_after_missed_beats = 0
+        assert heartbeat_interval_secs >= 0, "Heartbeat interval cannot be negative!"
+        assert suspect_after_missed_beats >= 0, "Number of missed heartbeats cannot be negative!"
+        assert dead_after_missed_beats >= 0, "Number of missed heartbeats cannot be negative!"
+        return metis_pb2.LivenessSpecs(heartbeat_interval_secs=heartbeat_interval_secs,
+                                       suspect_after_missed_beats=suspect_after_missed_beats,
+                                       dead_after_missed_beats=dead_after_missed_beats)
 
     @classmethod
     def construct_controller_modelhyperparams_pb(cls, batch_size, epochs, optimizer_pb, percent_validation):
@@ -283,11 +383,23 @@ class MetisProtoMessages(object):
         return metis_pb2.LineageLengthEviction(lineage_length=lineage_length)
 
     @classmethod
-    def construct_eviction_policy_pb(cls, policy_name, lineage_length):
+    def construct_byte_budget_eviction_pb(cls, max_resident_bytes, eviction_order=None):
+        assert max_resident_bytes > 0, "Max resident bytes value needs to be positive!"
+        if eviction_order and eviction_order.upper() == "LEASTRECENTLYUSED":
+            order_pb = metis_pb2.ByteBudgetEviction.LEAST_RECENTLY_USED
+        else:
+            order_pb = metis_pb2.ByteBudgetEviction.OLDEST_FIRST
+        return metis_pb2.ByteBudgetEviction(max_resident_bytes=max_resident_bytes, order=order_pb)
+
+    @classmethod
+    def construct_eviction_policy_pb(cls, policy_name, lineage_length,
+                                     max_resident_bytes=None, eviction_order=None):
         if policy_name.upper() == "NOEVICTION":
             return MetisProtoMessages.construct_no_eviction_pb()
         elif policy_name.upper() == "LINEAGELENGTHEVICTION":
             return MetisProtoMessages.construct_lineage_length_eviction_pb(lineage_length)
+        elif policy_name.upper() == "BYTEBUDGETEVICTION":
+            return MetisProtoMessages.construct_byte_budget_eviction_pb(max_resident_bytes, eviction_order)
 
     @classmethod
     def construct_model_store_specs_pb(cls, eviction_policy_pb):
@@ -295,13 +407,17 @@ class MetisProtoMessages(object):
             return metis_pb2.ModelStoreSpecs(no_eviction=eviction_policy_pb)
         elif isinstance(eviction_policy_pb, metis_pb2.LineageLengthEviction):
             return metis_pb2.ModelStoreSpecs(lineage_length_eviction=eviction_policy_pb)
+        elif isinstance(eviction_policy_pb, metis_pb2.ByteBudgetEviction):
+            return metis_pb2.ModelStoreSpecs(byte_budget_eviction=eviction_policy_pb)
         else:
             raise RuntimeError("Not a supported protobuff eviction policy.")
 
     @classmethod
     def construct_model_store_config_pb(cls, name, eviction_policy,
-                                        lineage_length=None, store_hostname=None, store_port=None):
-        eviction_policy_pb = MetisProtoMessages.construct_eviction_policy_pb(eviction_policy, lineage_length)
+                                        lineage_length=None, store_hostname=None, store_port=None,
+                                        max_resident_bytes=None, eviction_order=None):
+        eviction_policy_pb = MetisProtoMessages.construct_eviction_policy_pb(
+            eviction_policy, lineage_length, max_resident_bytes, eviction_order)
         model_store_specs_pb = MetisProtoMessages.construct_model_store_specs_pb(eviction_policy_pb)
         if name.upper() == "INMEMORY":
             model_store_pb = MetisProtoMessages.construct_in_memory_store_pb(model_store_specs_pb)
@@ -340,7 +456,26 @@ class MetisProtoMessages(object):
         return metis_pb2.PWA(he_scheme_config=he_scheme_config_pb)
 
     @classmethod
-    def construct_aggregation_rule_specs_pb(cls, scaling_factor):
+    def construct_staleness_discount_pb(cls, function=None, polynomial_exponent=None, hinge_slope=None,
+                                        hinge_threshold=None):
+        if function is None:
+            function_pb = metis_pb2.StalenessDiscount.Function.DEFAULT
+        elif function.upper() == "NONE":
+            function_pb = metis_pb2.StalenessDiscount.Function.NONE
+        elif function.upper() == "POLYNOMIAL":
+            function_pb = metis_pb2.StalenessDiscount.Function.POLYNOMIAL
+        elif function.upper() == "HINGE":
+            function_pb = metis_pb2.StalenessDiscount.Function.HINGE
+        else:
+            raise RuntimeError("Unsupported staleness discount.")
+
+        return metis_pb2.StalenessDiscount(function=function_pb,
+                                           polynomial_exponent=polynomial_exponent,
+                                           hinge_slope=hinge_slope,
+                                           hinge_threshold=hinge_threshold)
+
+    @classmethod
+    def construct_aggregation_rule_specs_pb(cls, scaling_factor, staleness_discount_pb=None):
         if scaling_factor.upper() == "NUMCOMPLETEDBATCHES":
             scaling_factor_pb = metis_pb2.AggregationRuleSpecs.ScalingFactor.NUM_COMPLETED_BATCHES
         elif scaling_factor.upper() == "NUMPARTICIPANTS":
@@ -351,11 +486,14 @@ class MetisProtoMessages(object):
             scaling_factor_pb = metis_pb2.AggregationRuleSpecs.ScalingFactor.UNKNOWN
             raise RuntimeError("Unsupported scaling factor.")
 
-        return metis_pb2.AggregationRuleSpecs(scaling_factor=scaling_factor_pb)
+        return metis_pb2.AggregationRuleSpecs(scaling_factor=scaling_factor_pb,
+                                              staleness_discount=staleness_discount_pb)
 
     @classmethod
-    def construct_aggregation_rule_pb(cls, rule_name, scaling_factor, stride_length, he_scheme_config_pb):
-        aggregation_rule_specs_pb = MetisProtoMessages.construct_aggregation_rule_specs_pb(scaling_factor)
+    def construct_aggregation_rule_pb(cls, rule_name, scaling_factor, stride_length, he_scheme_config_pb,
+                                      staleness_discount_pb=None):
+        aggregation_rule_specs_pb = MetisProtoMessages.construct_aggregation_rule_specs_pb(
+            scaling_factor, staleness_discount_pb)
         if rule_name.upper() == "FEDAVG":
             return metis_pb2.AggregationRule(fed_avg=MetisProtoMessages.construct_fed_avg_pb(),
                                              aggregation_rule_specs=aggregation_rule_specs_pb)
@@ -373,12 +511,32 @@ class MetisProtoMessages(object):
             raise RuntimeError("Unsupported rule name.")
 
     @classmethod
-    def construct_global_model_specs(cls, aggregation_rule_pb, learners_participation_ratio):
+    def construct_global_model_specs(cls, aggregation_rule_pb, learners_participation_ratio, cohort_sampling="UNIFORM",
+                                     min_participation_rate=None):
+        if cohort_sampling.upper() == "UNIFORM":
+            cohort_sampling_pb = metis_pb2.GlobalModelSpecs.CohortSampling.UNIFORM
+        elif cohort_sampling.upper() == "NUMTRAININGEXAMPLES":
+            cohort_sampling_pb = metis_pb2.GlobalModelSpecs.CohortSampling.NUM_TRAINING_EXAMPLES
+        elif cohort_sampling.upper() == "FASTEST":
+            cohort_sampling_pb = metis_pb2.GlobalModelSpecs.CohortSampling.FASTEST
+        else:
+            raise RuntimeError("Unsupported cohort sampling.")
+
+        # If not set (0), only the fastest learners participate under the FASTEST cohort sampling.
+        if min_participation_rate is None:
+            min_participation_rate = 0
+        assert 0 <= min_participation_rate <= 1, "Minimum participation rate needs to be in [0, 1]!"
+
         return metis_pb2.GlobalModelSpecs(aggregation_rule=aggregation_rule_pb,
-                                          learners_participation_ratio=learners_participation_ratio)
+                                          learners_participation_ratio=learners_participation_ratio,
+                                          cohort_sampling=cohort_sampling_pb,
+                                          min_participation_rate=min_participation_rate)
 
     @classmethod
-    def construct_communication_specs_pb(cls, protocol, semi_sync_lambda=None, semi_sync_recompute_num_updates=None):
+    def construct_communication_specs_pb(cls, protocol, semi_sync_lambda=None, semi_sync_recompute_num_updates=None,
+                                         sync_quorum_ratio=None, sync_round_deadline_secs=None,
+                                         async_buffer_size=None, sync_align_local_updates=None,
+                                         async_task_budget_ms=None, sync_max_staleness=None):
         if protocol.upper() == "SYNCHRONOUS":
             protocol_pb = metis_pb2.CommunicationSpecs.Protocol.SYNCHRONOUS
         elif protocol.upper() == "ASYNCHRONOUS":
@@ -391,7 +549,13 @@ class MetisProtoMessages(object):
         return metis_pb2.CommunicationSpecs(protocol=protocol_pb,
                                             protocol_specs=metis_pb2.ProtocolSpecs(
                                                 semi_sync_lambda=semi_sync_lambda,
-                                                semi_sync_recompute_num_updates=semi_sync_recompute_num_updates))
+                                                semi_sync_recompute_num_updates=semi_sync_recompute_num_updates,
+                                                sync_quorum_ratio=sync_quorum_ratio,
+                                                sync_round_deadline_secs=sync_round_deadline_secs,
+                                                async_buffer_size=async_buffer_size,
+                                                sync_align_local_updates=sync_align_local_updates,
+                                                async_task_budget_ms=async_task_budget_ms,
+                                                sync_max_staleness=sync_max_staleness))
 
 
 class ModelProtoMessages(object):
@@ -2,7 +2,8 @@ import unittest
 
 import numpy as np
 
-from metisfl.utils.proto_messages_factory import ModelProtoMessages
+from metisfl.proto import metis_pb2, model_pb2
+from metisfl.utils.proto_messages_factory import ControllerServiceProtoMessages, ModelProtoMessages
 
 
 class TensorSpecProtoTest(unittest.TestCase):
@@ -48,5 +49,45 @@ class TensorSpecProtoTest(unittest.TestCase):
         self._generate_and_validate_np_array("f8")
 
 
+class MarkTaskCompletedChunksProtoTest(unittest.TestCase):
+
+    def _generate_task(self):
+        task_pb = metis_pb2.CompletedLearningTask(aux_metadata="aux")
+        task_pb.execution_metadata.global_iteration = 3
+        for name, size in [("small_1", 10), ("large", 1000), ("small_2", 10)]:
+            tensor_spec = ModelProtoMessages.TensorSpecProto.numpy_array_to_proto_tensor_spec(
+                np.arange(size, dtype="f4"))
+            variable_pb = task_pb.model.variables.add(name=name, trainable=True)
+            variable_pb.plaintext_tensor.tensor_spec.CopyFrom(tensor_spec)
+        return task_pb
+
+    def test_chunks_restore_task(self):
+        task_pb = self._generate_task()
+        chunks_pb = list(ControllerServiceProtoMessages.construct_mark_task_completed_chunks_pb(
+            learner_id="learner", auth_token="token", completed_learning_task_pb=task_pb,
+            max_chunk_bytes=1024))
+
+        # The first chunk carries the task without its model.
+        self.assertEqual(chunks_pb[0].WhichOneof("chunk"), "request")
+        self.assertEqual(chunks_pb[0].request.learner_id, "learner")
+        self.assertFalse(chunks_pb[0].request.task.HasField("model"))
+        self.assertEqual(chunks_pb[0].request.task.execution_metadata.global_iteration, 3)
+        self.assertEqual(chunks_pb[0].request.task.aux_metadata, "aux")
+
+        # The large variable (4000 bytes) is split across four chunks, and every chunk is
+        # bounded, besides the encoding of the variable's structure.
+        self.assertEqual(len(chunks_pb), 1 + 6)
+        restored_pb = model_pb2.Model()
+        for chunk_pb in chunks_pb[1:]:
+            model_chunk_pb = chunk_pb.model_chunk
+            self.assertLessEqual(model_chunk_pb.ByteSize(), 1024 + 64)
+            if model_chunk_pb.continues_variable:
+                restored_pb.variables[-1].plaintext_tensor.tensor_spec.value += \
+                    model_chunk_pb.variables[0].plaintext_tensor.tensor_spec.value
+            else:
+                restored_pb.variables.extend(model_chunk_pb.variables)
+        self.assertEqual(restored_pb, task_pb.model)
+
+
 if __name__ == "__main__":
     unittest.main()